@@ -0,0 +1,107 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <libdunfell/dunfell.h>
+#include <locale.h>
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context = NULL;
+  gchar *format_str = NULL;
+  DflLogFormat format;
+  DflParser *parser = NULL;
+  DflWriter *writer = NULL;
+  DflEventSequence *sequence = NULL;
+  GError *error = NULL;
+  int status = 0;
+  const GOptionEntry entries[] = {
+    { "format", 'f', 0, G_OPTION_ARG_STRING, &format_str,
+      "Format to write the output log in: ‘binary’ (default) or ‘text’",
+      "FORMAT" },
+    { NULL, },
+  };
+
+  setlocale (LC_ALL, "");
+
+  context = g_option_context_new ("INPUT OUTPUT");
+  g_option_context_set_summary (context,
+                                "Convert a Dunfell log between the text and "
+                                "binary formats.");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      status = 2;
+      goto done;
+    }
+
+  if (argc != 3)
+    {
+      g_printerr ("Expected an input and an output filename.\n");
+      status = 2;
+      goto done;
+    }
+
+  if (format_str == NULL || g_strcmp0 (format_str, "binary") == 0)
+    format = DFL_LOG_FORMAT_BINARY;
+  else if (g_strcmp0 (format_str, "text") == 0)
+    format = DFL_LOG_FORMAT_TEXT;
+  else
+    {
+      g_printerr ("Unknown format ‘%s’.\n", format_str);
+      status = 2;
+      goto done;
+    }
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_file (parser, argv[1], &error);
+
+  if (error != NULL)
+    {
+      g_printerr ("Error loading ‘%s’: %s\n", argv[1], error->message);
+      status = 1;
+      goto done;
+    }
+
+  sequence = dfl_parser_get_event_sequence (parser);
+
+  writer = dfl_writer_new ();
+  dfl_writer_save_to_file (writer, sequence, format, argv[2], &error);
+
+  if (error != NULL)
+    {
+      g_printerr ("Error saving ‘%s’: %s\n", argv[2], error->message);
+      status = 1;
+      goto done;
+    }
+
+done:
+  g_clear_error (&error);
+  g_clear_object (&writer);
+  g_clear_object (&parser);
+  g_free (format_str);
+  g_option_context_free (context);
+
+  return status;
+}
@@ -118,6 +118,7 @@ static const struct {
   { G_TYPE_INT64, "min-dispatch-duration" },
   { G_TYPE_INT64, "median-dispatch-duration" },
   { G_TYPE_INT64, "max-dispatch-duration" },
+  { DFL_TYPE_DURATION, "handoff-latency" },
 };
 
 G_DEFINE_TYPE_WITH_CODE (DwlSourceModel, dwl_source_model, G_TYPE_OBJECT,
@@ -73,6 +73,8 @@ struct _DwlStatisticsPane
   GtkLabel *n_tasks;
   GtkLabel *n_long_dispatches;
   GtkLabel *n_thread_switches;
+  GtkLabel *dispatch_percentiles;
+  GtkLabel *lateness_percentiles;
 };
 
 G_DEFINE_TYPE (DwlStatisticsPane, dwl_statistics_pane, GTK_TYPE_BIN)
@@ -103,6 +105,10 @@ dwl_statistics_pane_class_init (DwlStatisticsPaneClass *klass)
                                         DwlStatisticsPane, n_long_dispatches);
   gtk_widget_class_bind_template_child (widget_class,
                                         DwlStatisticsPane, n_thread_switches);
+  gtk_widget_class_bind_template_child (widget_class,
+                                        DwlStatisticsPane, dispatch_percentiles);
+  gtk_widget_class_bind_template_child (widget_class,
+                                        DwlStatisticsPane, lateness_percentiles);
 
   object_class->get_property = dwl_statistics_pane_get_property;
   object_class->set_property = dwl_statistics_pane_set_property;
@@ -307,6 +313,10 @@ dwl_statistics_pane_update_overall_statistics (DwlStatisticsPane *self)
   g_autoptr (GPtrArray) tasks = NULL;  /* (element-type DflTask) */
   g_autofree gchar *n_sources = NULL, *n_tasks = NULL;
   g_autofree gchar *n_long_dispatches = NULL, *n_thread_switches = NULL;
+  g_autofree gchar *dispatch_percentiles = NULL;
+  g_autofree gchar *lateness_percentiles = NULL;
+  g_autoptr (DflHistogram) dispatch_histogram = NULL;
+  g_autoptr (DflHistogram) lateness_histogram = NULL;
 
   sources = dfl_model_dup_sources (self->model);
   tasks = dfl_model_dup_tasks (self->model);
@@ -319,8 +329,31 @@ dwl_statistics_pane_update_overall_statistics (DwlStatisticsPane *self)
   n_thread_switches = g_strdup_printf ("%" G_GSIZE_FORMAT,
                                        dfl_model_get_n_main_context_thread_switches (self->model));
 
+  dispatch_histogram = dfl_model_dup_dispatch_histogram (self->model);
+  dispatch_percentiles = g_strdup_printf ("%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT,
+                                          dfl_histogram_get_percentile (dispatch_histogram, 50.0),
+                                          dfl_histogram_get_percentile (dispatch_histogram, 90.0),
+                                          dfl_histogram_get_percentile (dispatch_histogram, 99.0),
+                                          dfl_histogram_get_percentile (dispatch_histogram, 99.9));
+
+  lateness_histogram = dfl_model_dup_lateness_histogram (self->model,
+                                                         DFL_ID_INVALID);
+  lateness_percentiles = g_strdup_printf ("%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT " / "
+                                          "%" G_GINT64_FORMAT,
+                                          dfl_histogram_get_percentile (lateness_histogram, 50.0),
+                                          dfl_histogram_get_percentile (lateness_histogram, 90.0),
+                                          dfl_histogram_get_percentile (lateness_histogram, 99.0),
+                                          dfl_histogram_get_percentile (lateness_histogram, 99.9));
+
   gtk_label_set_text (self->n_sources, n_sources);
   gtk_label_set_text (self->n_tasks, n_tasks);
   gtk_label_set_text (self->n_long_dispatches, n_long_dispatches);
   gtk_label_set_text (self->n_thread_switches, n_thread_switches);
+  gtk_label_set_text (self->dispatch_percentiles, dispatch_percentiles);
+  gtk_label_set_text (self->lateness_percentiles, lateness_percentiles);
 }
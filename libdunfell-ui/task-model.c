@@ -117,6 +117,9 @@ static const struct {
   { G_TYPE_BOOLEAN, "run-in-thread-cancelled" },
   { DFL_TYPE_DURATION, "run-duration" },
   { DFL_TYPE_DURATION, "run-in-thread-duration" },
+  { DFL_TYPE_DURATION, "queue-wait-duration" },
+  { DFL_TYPE_DURATION, "return-handoff-duration" },
+  { DFL_TYPE_DURATION, "callback-delivery-duration" },
 };
 
 G_DEFINE_TYPE_WITH_CODE (DwlTaskModel, dwl_task_model, G_TYPE_OBJECT,
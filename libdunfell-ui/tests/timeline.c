@@ -0,0 +1,157 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "libdunfell/event-sequence.h"
+#include "libdunfell/main-context.h"
+#include "libdunfell/parser.h"
+#include "libdunfell-ui/timeline-private.h"
+
+
+/* Test that rows are only aggregated when there are more elements than rows,
+ * and each row spans at least one microsecond. */
+static void
+test_timeline_should_aggregate (void)
+{
+  /* Rows 0 to 9 inclusive. */
+  g_assert_false (dwl_timeline_should_aggregate (0.5, 0, 0, 9));
+  g_assert_false (dwl_timeline_should_aggregate (0.5, 10, 0, 9));
+  g_assert_true (dwl_timeline_should_aggregate (0.5, 11, 0, 9));
+
+  /* Zoomed in too far. */
+  g_assert_false (dwl_timeline_should_aggregate (1.0, 11, 0, 9));
+  g_assert_false (dwl_timeline_should_aggregate (2.0, 1000, 0, 9));
+
+  /* A single row. */
+  g_assert_false (dwl_timeline_should_aggregate (0.1, 1, 5, 5));
+  g_assert_true (dwl_timeline_should_aggregate (0.1, 2, 5, 5));
+}
+
+static GPtrArray/*<owned DflMainContext>*/ *
+parser_helper (const gchar *log)
+{
+  DflParser *parser = NULL;
+  DflEventSequence *sequence;
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  GError *error = NULL;
+
+  /* Parse the log into an event sequence. */
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log, strlen (log),
+                             &error);
+  g_assert_no_error (error);
+
+  sequence = dfl_parser_get_event_sequence (parser);
+  g_assert_nonnull (sequence);
+
+  /* Analyse the event sequence. */
+  main_contexts = dfl_main_context_factory_from_event_sequence (sequence);
+  dfl_event_sequence_walk (sequence);
+
+  g_object_unref (parser);
+
+  return main_contexts;  /* transfer */
+}
+
+static void
+assert_dispatch_row (DflMainContext *main_context,
+                     DflTimestamp    row_start,
+                     DflTimestamp    row_end,
+                     gsize           n_elements,
+                     DflDuration     sum_duration,
+                     DflDuration     max_duration)
+{
+  DflTimeSequenceSummary summary;
+
+  dwl_timeline_summarise_dispatch_row (main_context, row_start, row_end,
+                                       &summary);
+
+  g_assert_cmpuint (summary.n_elements, ==, n_elements);
+  g_assert_cmpint (summary.sum_duration, ==, sum_duration);
+  g_assert_cmpint (summary.max_duration, ==, max_duration);
+
+  if (n_elements > 0)
+    {
+      g_assert_cmpuint (summary.first_thread_id, ==, 1000);
+      g_assert_cmpuint (summary.n_thread_switches, ==, 0);
+    }
+}
+
+/* Test that each row’s summary only counts the time spent dispatching inside
+ * the row, including a dispatch which started in an earlier row, and ignores
+ * the durations of dispatches which never finished. */
+static void
+test_timeline_dispatch_rows (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+
+  /* Timestamps: 1+; thread ID: 1000; context ID: 666. The last dispatch never
+   * finishes. */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_before_dispatch,5,1000,666\n"
+    "g_main_context_after_dispatch,25,1000,666\n"
+    "g_main_context_before_dispatch,30,1000,666\n"
+    "g_main_context_after_dispatch,32,1000,666\n"
+    "g_main_context_before_dispatch,34,1000,666\n"
+    "g_main_context_after_dispatch,35,1000,666\n"
+    "g_main_context_before_dispatch,45,1000,666\n"
+    "g_main_context_after_dispatch,48,1000,666\n"
+    "g_main_context_before_dispatch,60,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  /* The long dispatch’s time is split between the rows it covers, but its
+   * full duration is the maximum in each of them. */
+  assert_dispatch_row (context, 0, 10, 1, 5, 20);
+  assert_dispatch_row (context, 10, 20, 1, 10, 20);
+  assert_dispatch_row (context, 20, 30, 1, 5, 20);
+
+  /* A dispatch ending at the start of a row is not in it. */
+  assert_dispatch_row (context, 25, 35, 2, 3, 2);
+  assert_dispatch_row (context, 30, 40, 2, 3, 2);
+  assert_dispatch_row (context, 40, 50, 1, 3, 3);
+  assert_dispatch_row (context, 50, 60, 0, 0, 0);
+
+  /* The unfinished dispatch is counted, but not its duration. */
+  assert_dispatch_row (context, 60, 70, 1, 0, 0);
+  assert_dispatch_row (context, 40, 70, 2, 3, 3);
+
+  g_ptr_array_unref (main_contexts);
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/timeline/should-aggregate",
+                   test_timeline_should_aggregate);
+  g_test_add_func ("/timeline/dispatch-rows", test_timeline_dispatch_rows);
+
+  return g_test_run ();
+}
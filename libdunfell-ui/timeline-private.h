@@ -0,0 +1,54 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DWL_TIMELINE_PRIVATE_H
+#define DWL_TIMELINE_PRIVATE_H
+
+#include <glib.h>
+
+#include "libdunfell/main-context.h"
+#include "libdunfell/time-sequence.h"
+#include "libdunfell/types.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Helpers for drawing aggregated marks when the timeline is zoomed out, so
+ * the tests can check them without a widget.
+ *
+ * dwl_timeline_should_aggregate() returns whether to draw one mark per pixel
+ * row, rather than every element, for a sequence with @n_visible_elements in
+ * the rows [@min_visible_y, @max_visible_y] at the given @zoom (pixels per
+ * microsecond).
+ *
+ * dwl_timeline_summarise_dispatch_row() summarises the dispatches of
+ * @main_context in the pixel row covering [@row_start, @row_end). See its
+ * documentation in timeline.c.
+ */
+gboolean dwl_timeline_should_aggregate       (gdouble                 zoom,
+                                              gsize                   n_visible_elements,
+                                              gint                    min_visible_y,
+                                              gint                    max_visible_y);
+void     dwl_timeline_summarise_dispatch_row (DflMainContext         *main_context,
+                                              DflTimestamp            row_start,
+                                              DflTimestamp            row_end,
+                                              DflTimeSequenceSummary *summary);
+
+G_END_DECLS
+
+#endif /* !DWL_TIMELINE_PRIVATE_H */
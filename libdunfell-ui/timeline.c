@@ -46,6 +46,7 @@
 #include "libdunfell/types.h"
 #include "libdunfell-ui/enums.h"
 #include "libdunfell-ui/timeline.h"
+#include "libdunfell-ui/timeline-private.h"
 
 
 static void dwl_timeline_get_property (GObject    *object,
@@ -108,6 +109,9 @@ struct _DwlTimeline
   GPtrArray/*<owned DflSource>*/ *sources;  /* owned */
   GPtrArray/*<owned DflTask>*/ *tasks;  /* owned */
 
+  /* Map from thread ID to (index in @threads + 1). */
+  GHashTable/*<owned DflThreadId, guint>*/ *thread_indices;  /* owned */
+
   gfloat zoom;  /* pixels per unit time */
 
   /* Cached dimensions. */
@@ -282,6 +286,7 @@ dwl_timeline_dispose (GObject *object)
   g_clear_pointer (&self->main_contexts, g_ptr_array_unref);
   g_clear_pointer (&self->threads, g_ptr_array_unref);
   g_clear_pointer (&self->tasks, g_ptr_array_unref);
+  g_clear_pointer (&self->thread_indices, g_hash_table_unref);
   g_clear_pointer (&self->hover_element.iter, dfl_time_sequence_iter_free);
   g_clear_pointer (&self->selected_element.iter, dfl_time_sequence_iter_free);
 
@@ -336,10 +341,12 @@ add_default_css (GtkStyleContext *context)
     "timeline.hundred_millisecond_marker_label { color: #555753 }\n"
     "timeline.thousand_millisecond_marker { color: #555753 }\n"
     "timeline.thousand_millisecond_marker_label { color: #2e3436 }\n"
+    "timeline.main_context_contention { color: #cc0000 }\n"
     "timeline.main_context_dispatch { background-color: #3465a4; "
                                      "border: 1px solid #2e3436 }\n"
     "timeline.main_context_dispatch_hover { background-color: #729fcf }\n"
     "timeline.main_context_dispatch_selected { background-color: #729fcf }\n"
+    "timeline.main_context_dispatch_aggregate { border: none }\n"
     "timeline.source { background-color: #c17d11 }\n"
     "timeline.source_hover { background-color: #e9b96e }\n"
     "timeline.source_selected { background-color: #73d216 }\n"
@@ -368,6 +375,7 @@ add_default_css (GtkStyleContext *context)
 #define HEADER_HEIGHT 100 /* pixels */
 #define FOOTER_HEIGHT 30 /* pixels */
 #define MAIN_CONTEXT_ACQUIRED_WIDTH 3 /* pixels */
+#define MAIN_CONTEXT_CONTENTION_DASH 4 /* pixels */
 #define MAIN_CONTEXT_DISPATCH_WIDTH 10 /* pixels */
 #define SOURCE_BORDER_WIDTH 1 /* pixel */
 #define SOURCE_OFFSET 20 /* pixels */
@@ -397,9 +405,21 @@ update_cache (DwlTimeline *self)
   min_timestamp = G_MAXUINT64;
   max_timestamp = 0;
 
+  g_clear_pointer (&self->thread_indices, g_hash_table_unref);
+  self->thread_indices = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                                g_free, NULL);
+
   for (i = 0; i < self->threads->len; i++)
     {
       DflThread *thread = self->threads->pdata[i];
+      DflThreadId *key = g_new (DflThreadId, 1);
+
+      /* Keep the last thread with a given ID, to match
+       * dfl_model_lookup_thread(). */
+      *key = dfl_thread_get_id (thread);
+      g_hash_table_replace (self->thread_indices, key,
+                            GUINT_TO_POINTER (i + 1));
+
       min_timestamp = MIN (min_timestamp, dfl_thread_get_new_timestamp (thread));
       max_timestamp = MAX (max_timestamp, dfl_thread_get_free_timestamp (thread));
     }
@@ -544,19 +564,13 @@ static guint
 thread_id_to_index (DwlTimeline *self,
                     DflThreadId  thread_id)
 {
-  guint thread_index, n_threads;
+  guint thread_index;
 
-  n_threads = self->threads->len;
+  thread_index = GPOINTER_TO_UINT (g_hash_table_lookup (self->thread_indices,
+                                                        &thread_id));
+  g_assert (thread_index > 0 && thread_index <= self->threads->len);
 
-  /* TODO: This should not be so slow. */
-  for (thread_index = 0; thread_index < n_threads; thread_index++)
-    {
-      if (dfl_thread_get_id (self->threads->pdata[thread_index]) == thread_id)
-        break;
-    }
-  g_assert (thread_index < n_threads);
-
-  return thread_index;
+  return thread_index - 1;
 }
 
 /* Get the X coordinate of the centre of the given thread. */
@@ -1042,6 +1056,335 @@ draw_task_return_propagate_lines (DwlTimeline *self,
     }
 }
 
+/* Add a vertical line for a main context thread ownership span to the
+ * current path. */
+static void
+add_thread_ownership_to_path (DwlTimeline *self,
+                              cairo_t     *cr,
+                              DflThreadId  thread_id,
+                              gint         y,
+                              gint         height)
+{
+  gdouble thread_centre;
+  guint thread_index;
+
+  thread_index = thread_id_to_index (self, thread_id);
+  thread_centre = thread_index_to_centre (self, thread_index);
+
+  cairo_move_to (cr, thread_centre + 0.5, y + 0.5);
+  cairo_line_to (cr, thread_centre + 0.5, y + height + 0.5);
+}
+
+typedef struct
+{
+  DwlTimeline *timeline;
+  cairo_t *cr;
+} ContentionPathData;
+
+/* Add a vertical line for a main context contention interval to the current
+ * path, on the column of the thread which was waiting. Intervals which never
+ * ended are skipped. */
+static gboolean
+add_contention_to_path_cb (DflTimeSequenceIter *iter,
+                           gpointer             user_data)
+{
+  ContentionPathData *data = user_data;
+  DwlTimeline *self = data->timeline;
+  DflMainContextContentionData *contention_data;
+  DflTimestamp timestamp;
+
+  timestamp = dfl_time_sequence_iter_get_timestamp (iter);
+  contention_data = dfl_time_sequence_iter_get_data (iter);
+
+  if (contention_data->duration < 0)
+    return TRUE;
+
+  add_thread_ownership_to_path (self, data->cr, contention_data->thread_id,
+                                timestamp_to_y (self,
+                                                timestamp - self->min_timestamp),
+                                MAX (1,
+                                     duration_to_pixels (self,
+                                                         contention_data->duration)));
+
+  return TRUE;
+}
+
+/* Draw a single main context dispatch, highlighting it if it is hovered or
+ * selected. @iter must point to the dispatch. */
+static void
+draw_main_context_dispatch (DwlTimeline                *self,
+                            cairo_t                    *cr,
+                            guint                       main_context_index,
+                            DflTimeSequenceIter        *iter,
+                            DflTimestamp                timestamp,
+                            DflMainContextDispatchData *data)
+{
+  GtkStyleContext *context;
+  gdouble thread_centre, dispatch_width, dispatch_height;
+  gint timestamp_y;
+  guint thread_index;
+  gboolean is_hover, is_selected;
+
+  context = gtk_widget_get_style_context (GTK_WIDGET (self));
+
+  thread_index = thread_id_to_index (self, data->thread_id);
+  thread_centre = thread_index_to_centre (self, thread_index);
+  timestamp_y = timestamp_to_y (self, timestamp - self->min_timestamp);
+
+  dispatch_width = MAIN_CONTEXT_DISPATCH_WIDTH;
+  dispatch_height = duration_to_pixels (self, data->duration);
+
+  is_hover = (self->hover_element.type == ELEMENT_CONTEXT_DISPATCH &&
+              self->hover_element.index == main_context_index &&
+              dfl_time_sequence_iter_equal (self->hover_element.iter, iter));
+  is_selected = (self->selected_element.type == ELEMENT_CONTEXT_DISPATCH &&
+                 self->selected_element.index == main_context_index &&
+                 dfl_time_sequence_iter_equal (self->selected_element.iter,
+                                               iter));
+
+  if (is_hover)
+    gtk_style_context_add_class (context, "main_context_dispatch_hover");
+  if (is_selected)
+    gtk_style_context_add_class (context, "main_context_dispatch_selected");
+
+  gtk_render_background (context, cr,
+                         thread_centre - dispatch_width / 2.0,
+                         timestamp_y,
+                         dispatch_width,
+                         dispatch_height);
+  gtk_render_frame (context, cr,
+                    thread_centre - dispatch_width / 2.0,
+                    timestamp_y,
+                    dispatch_width,
+                    dispatch_height);
+
+  if (is_selected)
+    gtk_style_context_remove_class (context, "main_context_dispatch_selected");
+  if (is_hover)
+    gtk_style_context_remove_class (context, "main_context_dispatch_hover");
+}
+
+/* Draw a single mark summarising all the main context dispatches which start
+ * in pixel row @y, which spans @row_duration. They must all be on the same
+ * thread. The mark is as tall as the longest of the dispatches, and its
+ * opacity shows what fraction of the row was spent dispatching. */
+static void
+draw_main_context_dispatch_aggregate (DwlTimeline                  *self,
+                                      cairo_t                      *cr,
+                                      gint                          y,
+                                      DflDuration                   row_duration,
+                                      const DflTimeSequenceSummary *summary)
+{
+  GtkStyleContext *context;
+  gdouble thread_centre, dispatch_width, busy_fraction;
+  gint dispatch_height;
+  guint thread_index;
+
+  context = gtk_widget_get_style_context (GTK_WIDGET (self));
+
+  thread_index = thread_id_to_index (self, summary->first_thread_id);
+  thread_centre = thread_index_to_centre (self, thread_index);
+
+  dispatch_width = MAIN_CONTEXT_DISPATCH_WIDTH;
+  dispatch_height = MAX (1, duration_to_pixels (self, summary->max_duration));
+  busy_fraction = CLAMP ((gdouble) summary->sum_duration / row_duration,
+                         0.25, 1.0);
+
+  gtk_style_context_add_class (context, "main_context_dispatch_aggregate");
+
+  /* Clip to the mark first, so the group is only as big as the mark rather
+   * than the whole widget. */
+  cairo_save (cr);
+  cairo_rectangle (cr, thread_centre - dispatch_width / 2.0, y,
+                   dispatch_width, dispatch_height);
+  cairo_clip (cr);
+
+  cairo_push_group (cr);
+  gtk_render_background (context, cr,
+                         thread_centre - dispatch_width / 2.0, y,
+                         dispatch_width, dispatch_height);
+  cairo_pop_group_to_source (cr);
+  cairo_paint_with_alpha (cr, busy_fraction);
+
+  cairo_restore (cr);
+
+  gtk_style_context_remove_class (context, "main_context_dispatch_aggregate");
+}
+
+/* Get the range of timestamps [@row_start, @row_end) which timestamp_to_y()
+ * maps to pixel row @y. */
+static void
+y_to_row_timestamps (DwlTimeline  *self,
+                     gint          y,
+                     DflTimestamp *row_start,
+                     DflTimestamp *row_end)
+{
+  *row_start = self->min_timestamp +
+               (DflTimestamp) ceil ((y - HEADER_HEIGHT) / self->zoom);
+  *row_end = self->min_timestamp +
+             (DflTimestamp) ceil ((y + 1 - HEADER_HEIGHT) / self->zoom);
+}
+
+/* Whether to draw aggregated marks per pixel row for a sequence with
+ * @n_visible_elements in the visible rows, rather than drawing every element.
+ * This is only worthwhile if there are more elements than rows, and only
+ * possible if each row spans at least one unit of time. */
+gboolean
+dwl_timeline_should_aggregate (gdouble zoom,
+                               gsize   n_visible_elements,
+                               gint    min_visible_y,
+                               gint    max_visible_y)
+{
+  return (zoom < 1.0 &&
+          n_visible_elements > (gsize) (max_visible_y - min_visible_y + 1));
+}
+
+static gboolean
+should_aggregate (DwlTimeline *self,
+                  gsize        n_visible_elements,
+                  gint         min_visible_y,
+                  gint         max_visible_y)
+{
+  return dwl_timeline_should_aggregate (self->zoom, n_visible_elements,
+                                        min_visible_y, max_visible_y);
+}
+
+typedef struct
+{
+  DflTimestamp row_start;
+  DflTimestamp row_end;
+  DflTimeSequenceSummary *summary;  /* (unowned) */
+} SeedRowData;
+
+/* Add a dispatch which started before the row, and is still in progress at its
+ * start, to the row’s summary. Only the part of it inside the row counts
+ * towards the time spent dispatching in the row, but its full duration is used
+ * for the minimum and maximum, as for the dispatches which start in the
+ * row. */
+static gboolean
+seed_row_cb (DflTimeSequenceIter *iter,
+             gpointer             user_data)
+{
+  SeedRowData *data = user_data;
+  DflTimestamp timestamp;
+  const DflMainContextDispatchData *dispatch_data;
+  DflTimeSequenceSummary *summary = data->summary;
+  DflDuration overlap;
+
+  timestamp = dfl_time_sequence_iter_get_timestamp (iter);
+  dispatch_data = dfl_time_sequence_iter_get_data (iter);
+
+  if (timestamp >= data->row_start)
+    return FALSE;
+  if (dispatch_data->duration < 0 ||
+      timestamp + dispatch_data->duration <= data->row_start)
+    return TRUE;
+
+  overlap = MIN (timestamp + dispatch_data->duration,
+                 data->row_end) - data->row_start;
+
+  if (summary->n_elements == 0)
+    {
+      summary->min_duration = dispatch_data->duration;
+      summary->last_thread_id = dispatch_data->thread_id;
+    }
+  else
+    {
+      summary->min_duration = MIN (summary->min_duration,
+                                   dispatch_data->duration);
+
+      if (summary->first_thread_id != dispatch_data->thread_id)
+        summary->n_thread_switches++;
+    }
+
+  summary->n_elements++;
+  summary->first_thread_id = dispatch_data->thread_id;
+  summary->sum_duration += overlap;
+  summary->max_duration = MAX (summary->max_duration,
+                               dispatch_data->duration);
+
+  return TRUE;
+}
+
+/*
+ * dwl_timeline_summarise_dispatch_row:
+ * @main_context: a #DflMainContext
+ * @row_start: timestamp of the start of the row (inclusive)
+ * @row_end: timestamp of the end of the row (exclusive)
+ * @summary: (out caller-allocates): return location for the summary
+ *
+ * Summarise the dispatches of @main_context which overlap the pixel row
+ * [@row_start, @row_end), for drawing an aggregated mark for the row. This is
+ * the summary of the dispatches which start in the row, seeded with the
+ * dispatch in progress at @row_start, so a long dispatch counts towards every
+ * row it covers. @min_duration and @max_duration use the full durations of the
+ * dispatches. @sum_duration only counts
+ * the time inside the row, so it is the time the context spent dispatching
+ * in the row; the dispatches of a context never overlap, so only the last one
+ * can extend past @row_end.
+ *
+ * Dispatches which never finished (with a duration of -1) are counted in
+ * @n_elements, but not in the durations. They are rare, as only the last
+ * dispatch of a context can be unfinished, so rows containing one are
+ * summarised by iterating over their dispatches.
+ */
+void
+dwl_timeline_summarise_dispatch_row (DflMainContext         *main_context,
+                                     DflTimestamp            row_start,
+                                     DflTimestamp            row_end,
+                                     DflTimeSequenceSummary *summary)
+{
+  SeedRowData data;
+
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (main_context));
+  g_return_if_fail (row_start <= row_end);
+  g_return_if_fail (summary != NULL);
+
+  dfl_main_context_get_dispatch_summary (main_context, row_start, row_end,
+                                         summary);
+
+  if (summary->n_elements > 0 && summary->min_duration >= 0 &&
+      summary->max_end_timestamp > row_end)
+    summary->sum_duration -= summary->max_end_timestamp - row_end;
+  else if (summary->n_elements > 0 && summary->min_duration < 0)
+    {
+      DflTimeSequenceIter iter;
+      DflTimestamp timestamp;
+      DflMainContextDispatchData *dispatch_data;
+
+      summary->sum_duration = 0;
+      summary->min_duration = G_MAXINT64;
+      summary->max_duration = 0;
+
+      dfl_main_context_dispatch_iter (main_context, &iter, row_start);
+
+      while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                          (gpointer *) &dispatch_data) &&
+             timestamp < row_end)
+        {
+          if (timestamp < row_start || dispatch_data->duration < 0)
+            continue;
+
+          summary->sum_duration += MIN (timestamp + dispatch_data->duration,
+                                        row_end) - timestamp;
+          summary->min_duration = MIN (summary->min_duration,
+                                       dispatch_data->duration);
+          summary->max_duration = MAX (summary->max_duration,
+                                       dispatch_data->duration);
+        }
+
+      if (summary->min_duration == G_MAXINT64)
+        summary->min_duration = 0;
+    }
+
+  data.row_start = row_start;
+  data.row_end = row_end;
+  data.summary = summary;
+  dfl_main_context_dispatch_foreach_overlapping (main_context, row_start,
+                                                 row_start, seed_row_cb,
+                                                 &data);
+}
+
 static gboolean
 dwl_timeline_draw (GtkWidget *widget,
                    cairo_t   *cr)
@@ -1052,6 +1395,8 @@ dwl_timeline_draw (GtkWidget *widget,
   guint i, n_threads;
   DflTimestamp min_timestamp, max_timestamp, t;
   DflTimestamp min_visible_timestamp, max_visible_timestamp;
+  DflTimestamp visible_end_timestamp;
+  gint min_visible_y, max_visible_y;
 
   context = gtk_widget_get_style_context (widget);
   widget_width = gtk_widget_get_allocated_width (widget);
@@ -1250,14 +1595,26 @@ dwl_timeline_draw (GtkWidget *widget,
       gtk_style_context_remove_class (context, "thread_header");
     }
 
-  /* Draw the main contexts on top. */
+  /* Draw the main contexts on top. When zoomed out far enough that there are
+   * more spans than pixel rows, draw one aggregated mark per pixel row instead
+   * of every span. */
+  min_visible_y = timestamp_to_y (self, min_visible_timestamp - min_timestamp);
+  max_visible_y = timestamp_to_y (self, max_visible_timestamp - min_timestamp);
+  visible_end_timestamp = (max_visible_timestamp < G_MAXUINT64) ?
+                          max_visible_timestamp + 1 : 0;
+
   for (i = 0; i < self->main_contexts->len; i++)
     {
       DflMainContext *main_context = self->main_contexts->pdata[i];
       DflTimeSequenceIter iter;
       DflTimestamp timestamp;
-      DflThreadOwnershipData *data;
+      DflThreadOwnershipData *ownership_data;
+      DflMainContextDispatchData *dispatch_data;
+      DflTimeSequenceSummary summary;
+      ContentionPathData contention_path_data;
+      const gdouble contention_dash = MAIN_CONTEXT_CONTENTION_DASH;
       GdkRGBA color;
+      gint y;
 
       /* Iterate through the thread ownership events. */
       gtk_style_context_add_class (context, "main_context");
@@ -1270,27 +1627,72 @@ dwl_timeline_draw (GtkWidget *widget,
       cairo_set_line_width (cr, MAIN_CONTEXT_ACQUIRED_WIDTH);
       cairo_new_path (cr);
 
-      dfl_main_context_thread_ownership_iter (main_context, &iter,
-                                              min_visible_timestamp);
+      dfl_main_context_get_thread_ownership_summary (main_context,
+                                                     min_visible_timestamp,
+                                                     visible_end_timestamp,
+                                                     &summary);
 
-      while (dfl_time_sequence_iter_next (&iter, &timestamp, (gpointer *) &data) &&
-             timestamp <= max_visible_timestamp)
+      if (should_aggregate (self, summary.n_elements, min_visible_y,
+                            max_visible_y))
         {
-          gdouble thread_centre;
-          gint timestamp_y;
-          guint thread_index;
+          for (y = min_visible_y; y <= max_visible_y; y++)
+            {
+              DflTimestamp row_start, row_end;
 
-          thread_index = thread_id_to_index (self, data->thread_id);
-          thread_centre = thread_index_to_centre (self, thread_index);
-          timestamp_y = timestamp_to_y (self, timestamp - min_timestamp);
-
-          cairo_move_to (cr,
-                         thread_centre + 0.5,
-                         timestamp_y + 0.5);
-          cairo_line_to (cr,
-                         thread_centre + 0.5,
-                         timestamp_y +
-                         duration_to_pixels (self, data->duration) + 0.5);
+              y_to_row_timestamps (self, y, &row_start, &row_end);
+              dfl_main_context_get_thread_ownership_summary (main_context,
+                                                             row_start,
+                                                             row_end,
+                                                             &summary);
+
+              if (summary.n_elements == 0)
+                continue;
+
+              if (summary.n_thread_switches == 0)
+                {
+                  add_thread_ownership_to_path (self, cr,
+                                                summary.first_thread_id, y,
+                                                MAX (1,
+                                                     duration_to_pixels (self,
+                                                                         summary.max_duration)));
+                  continue;
+                }
+
+              /* The row contains spans on several threads, so add them
+               * individually. */
+              dfl_main_context_thread_ownership_iter (main_context, &iter,
+                                                      row_start);
+
+              while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                                  (gpointer *) &ownership_data) &&
+                     timestamp < row_end)
+                {
+                  if (timestamp < row_start)
+                    continue;
+
+                  add_thread_ownership_to_path (self, cr,
+                                                ownership_data->thread_id, y,
+                                                duration_to_pixels (self,
+                                                                    ownership_data->duration));
+                }
+            }
+        }
+      else
+        {
+          dfl_main_context_thread_ownership_iter (main_context, &iter,
+                                                  min_visible_timestamp);
+
+          while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &ownership_data) &&
+                 timestamp <= max_visible_timestamp)
+            {
+              add_thread_ownership_to_path (self, cr,
+                                            ownership_data->thread_id,
+                                            timestamp_to_y (self,
+                                                            timestamp - min_timestamp),
+                                            duration_to_pixels (self,
+                                                                ownership_data->duration));
+            }
         }
 
       gdk_cairo_set_source_rgba (cr, &color);
@@ -1299,54 +1701,104 @@ dwl_timeline_draw (GtkWidget *widget,
       cairo_restore (cr);
       gtk_style_context_remove_class (context, "main_context");
 
+      /* Draw the intervals where threads were waiting to acquire the main
+       * context from another thread as dashed lines. There are normally few
+       * enough of these that they are never aggregated. */
+      gtk_style_context_add_class (context, "main_context_contention");
+      cairo_save (cr);
+
+      gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget),
+                                   &color);
+
+      cairo_set_line_width (cr, MAIN_CONTEXT_ACQUIRED_WIDTH);
+      cairo_set_dash (cr, &contention_dash, 1, 0.0);
+      cairo_new_path (cr);
+
+      contention_path_data.timeline = self;
+      contention_path_data.cr = cr;
+      dfl_main_context_contention_foreach_overlapping (main_context,
+                                                       min_visible_timestamp,
+                                                       max_visible_timestamp,
+                                                       add_contention_to_path_cb,
+                                                       &contention_path_data);
+
+      gdk_cairo_set_source_rgba (cr, &color);
+      cairo_stroke (cr);
+
+      cairo_restore (cr);
+      gtk_style_context_remove_class (context, "main_context_contention");
+
       /* Iterate through the dispatch events. */
       gtk_style_context_add_class (context, "main_context_dispatch");
 
-      dfl_main_context_dispatch_iter (main_context, &iter,
-                                      min_visible_timestamp);
+      dfl_main_context_get_dispatch_summary (main_context,
+                                             min_visible_timestamp,
+                                             visible_end_timestamp, &summary);
 
-      while (dfl_time_sequence_iter_next (&iter, &timestamp, (gpointer *) &data) &&
-             timestamp <= max_visible_timestamp)
+      if (should_aggregate (self, summary.n_elements, min_visible_y,
+                            max_visible_y))
         {
-          gdouble thread_centre, dispatch_width, dispatch_height;
-          gint timestamp_y;
-          guint thread_index;
+          for (y = min_visible_y; y <= max_visible_y; y++)
+            {
+              DflTimestamp row_start, row_end;
 
-          thread_index = thread_id_to_index (self, data->thread_id);
-          thread_centre = thread_index_to_centre (self, thread_index);
-          timestamp_y = timestamp_to_y (self, timestamp - min_timestamp);
+              y_to_row_timestamps (self, y, &row_start, &row_end);
+              dwl_timeline_summarise_dispatch_row (main_context, row_start,
+                                                   row_end, &summary);
+
+              if (summary.n_elements == 0)
+                continue;
 
-          dispatch_width = MAIN_CONTEXT_DISPATCH_WIDTH;
-          dispatch_height = duration_to_pixels (self, data->duration);
+              if (summary.n_thread_switches == 0)
+                {
+                  draw_main_context_dispatch_aggregate (self, cr, y,
+                                                        row_end - row_start,
+                                                        &summary);
+                  continue;
+                }
+
+              /* The row contains dispatches on several threads, so draw them
+               * individually. */
+              dfl_main_context_dispatch_iter (main_context, &iter, row_start);
+
+              while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                                  (gpointer *) &dispatch_data) &&
+                     timestamp < row_end)
+                {
+                  if (timestamp < row_start)
+                    continue;
+
+                  draw_main_context_dispatch (self, cr, i, &iter, timestamp,
+                                              dispatch_data);
+                }
+            }
 
+          /* Make sure the hovered and selected dispatches are still
+           * visible. */
           if (self->hover_element.type == ELEMENT_CONTEXT_DISPATCH &&
-              self->hover_element.index == i &&
-              dfl_time_sequence_iter_equal (self->hover_element.iter, &iter))
-            gtk_style_context_add_class (context, "main_context_dispatch_hover");
+              self->hover_element.index == i)
+            draw_main_context_dispatch (self, cr, i, self->hover_element.iter,
+                                        dfl_time_sequence_iter_get_timestamp (self->hover_element.iter),
+                                        dfl_time_sequence_iter_get_data (self->hover_element.iter));
           if (self->selected_element.type == ELEMENT_CONTEXT_DISPATCH &&
-              self->selected_element.index == i &&
-              dfl_time_sequence_iter_equal (self->selected_element.iter, &iter))
-            gtk_style_context_add_class (context, "main_context_dispatch_selected");
-
-          gtk_render_background (context, cr,
-                                 thread_centre - dispatch_width / 2.0,
-                                 timestamp_y,
-                                 dispatch_width,
-                                 dispatch_height);
-          gtk_render_frame (context, cr,
-                            thread_centre - dispatch_width / 2.0,
-                            timestamp_y,
-                            dispatch_width,
-                            dispatch_height);
+              self->selected_element.index == i)
+            draw_main_context_dispatch (self, cr, i,
+                                        self->selected_element.iter,
+                                        dfl_time_sequence_iter_get_timestamp (self->selected_element.iter),
+                                        dfl_time_sequence_iter_get_data (self->selected_element.iter));
+        }
+      else
+        {
+          dfl_main_context_dispatch_iter (main_context, &iter,
+                                          min_visible_timestamp);
 
-          if (self->selected_element.type == ELEMENT_CONTEXT_DISPATCH &&
-              self->selected_element.index == i &&
-              dfl_time_sequence_iter_equal (self->selected_element.iter, &iter))
-            gtk_style_context_remove_class (context, "main_context_dispatch_selected");
-          if (self->hover_element.type == ELEMENT_CONTEXT_DISPATCH &&
-              self->hover_element.index == i &&
-              dfl_time_sequence_iter_equal (self->hover_element.iter, &iter))
-            gtk_style_context_remove_class (context, "main_context_dispatch_hover");
+          while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &dispatch_data) &&
+                 timestamp <= max_visible_timestamp)
+            {
+              draw_main_context_dispatch (self, cr, i, &iter, timestamp,
+                                          dispatch_data);
+            }
         }
 
       gtk_style_context_remove_class (context, "main_context_dispatch");
@@ -1525,10 +1977,14 @@ dwl_timeline_draw (GtkWidget *widget,
           while (dfl_time_sequence_iter_next (&source_iter, &source_timestamp,
                                               (gpointer *) &source_data))
             {
-              if (source_data->thread_id != main_context_data->thread_id ||
-                  source_timestamp < main_context_timestamp ||
-                  source_timestamp > main_context_timestamp +
+              /* The dispatches are in timestamp order, so stop once past the
+               * end of the main context dispatch. */
+              if (source_timestamp > main_context_timestamp +
                   main_context_data->duration)
+                break;
+
+              if (source_data->thread_id != main_context_data->thread_id ||
+                  source_timestamp < main_context_timestamp)
                 continue;
 
               draw_source_dispatch_line (self, cr, source, source_x, source_y,
@@ -1682,6 +2138,56 @@ dwl_timeline_scroll_event (GtkWidget      *widget,
   return GDK_EVENT_PROPAGATE;
 }
 
+typedef struct
+{
+  DwlTimeline *timeline;  /* unowned */
+  gdouble x;
+  gdouble y;
+  DflTimeSequenceIter *iter;  /* owned; nullable; set when a hit is found */
+} HoverDispatchData;
+
+/* Check whether a main context dispatch is under the pointer; if so, stop
+ * searching. */
+static gboolean
+hover_dispatch_cb (DflTimeSequenceIter *iter,
+                   gpointer             user_data)
+{
+  HoverDispatchData *data = user_data;
+  DwlTimeline *self = data->timeline;
+  DflTimestamp timestamp;
+  DflMainContextDispatchData *dispatch_data;
+  gdouble thread_centre, dispatch_width, dispatch_height;
+  gdouble dispatch_left, dispatch_right, dispatch_top, dispatch_bottom;
+  gint timestamp_y;
+  guint thread_index;
+
+  timestamp = dfl_time_sequence_iter_get_timestamp (iter);
+  dispatch_data = dfl_time_sequence_iter_get_data (iter);
+
+  thread_index = thread_id_to_index (self, dispatch_data->thread_id);
+  thread_centre = thread_index_to_centre (self, thread_index);
+  timestamp_y = timestamp_to_y (self, timestamp - self->min_timestamp);
+
+  dispatch_width = MAIN_CONTEXT_DISPATCH_WIDTH;
+  dispatch_height = duration_to_pixels (self, dispatch_data->duration);
+
+  dispatch_left = thread_centre - dispatch_width / 2.0;
+  dispatch_right = thread_centre + dispatch_width / 2.0;
+  dispatch_bottom = timestamp_y;
+  dispatch_top = timestamp_y + dispatch_height;
+
+  if (data->x >= dispatch_left &&
+      data->x <= dispatch_right &&
+      data->y >= dispatch_bottom &&
+      data->y <= dispatch_top)
+    {
+      data->iter = dfl_time_sequence_iter_copy (iter);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 dwl_timeline_motion_notify_event (GtkWidget      *widget,
                                   GdkEventMotion *event)
@@ -1751,46 +2257,36 @@ dwl_timeline_motion_notify_event (GtkWidget      *widget,
         }
     }
 
-  /* What about main context dispatches? */
-  for (i = 0; i < self->main_contexts->len; i++)
+  /* What about main context dispatches? Only the dispatches which were in
+   * progress around the pointer’s timestamp need to be checked. Allow a little
+   * slop either side for rounding in timestamp_to_y() and
+   * duration_to_pixels(). */
+  if (event->y >= HEADER_HEIGHT)
     {
-      DflMainContext *main_context = self->main_contexts->pdata[i];
-      DflTimeSequenceIter iter;
-      DflTimestamp timestamp;
-      DflThreadOwnershipData *data;
+      DflTimestamp pointer_timestamp, slop, window_start, window_end;
 
-      /* Iterate through the thread ownership events. */
+      pointer_timestamp = min_timestamp +
+                          (DflTimestamp) ((event->y - HEADER_HEIGHT) / self->zoom);
+      slop = 1 + (DflTimestamp) (1.0 / self->zoom);
+      window_start = (pointer_timestamp > slop) ? pointer_timestamp - slop : 0;
+      window_end = pointer_timestamp + slop;
 
-      /* TODO: Set the start timestamp according to the clip area */
-      dfl_main_context_dispatch_iter (main_context, &iter, 0);
-
-      while (dfl_time_sequence_iter_next (&iter, &timestamp, (gpointer *) &data))
+      for (i = 0; i < self->main_contexts->len; i++)
         {
-          gdouble thread_centre, dispatch_width, dispatch_height;
-          gdouble dispatch_left, dispatch_right, dispatch_top, dispatch_bottom;
-          gint timestamp_y;
-          guint thread_index;
-
-          thread_index = thread_id_to_index (self, data->thread_id);
-          thread_centre = thread_index_to_centre (self, thread_index);
-          timestamp_y = timestamp_to_y (self, timestamp - min_timestamp);
-
-          dispatch_width = MAIN_CONTEXT_DISPATCH_WIDTH;
-          dispatch_height = duration_to_pixels (self, data->duration);
+          DflMainContext *main_context = self->main_contexts->pdata[i];
+          HoverDispatchData data = { self, event->x, event->y, NULL };
 
-          dispatch_left = thread_centre - dispatch_width / 2.0;
-          dispatch_right = thread_centre + dispatch_width / 2.0;
-          dispatch_bottom = timestamp_y;
-          dispatch_top = timestamp_y + dispatch_height;
+          dfl_main_context_dispatch_foreach_overlapping (main_context,
+                                                         window_start,
+                                                         window_end,
+                                                         hover_dispatch_cb,
+                                                         &data);
 
-          if (event->x >= dispatch_left &&
-              event->x <= dispatch_right &&
-              event->y >= dispatch_bottom &&
-              event->y <= dispatch_top)
+          if (data.iter != NULL)
             {
               new_hover_type = ELEMENT_CONTEXT_DISPATCH;
               new_hover_index = i;
-              new_hover_iter = dfl_time_sequence_iter_copy (&iter);
+              new_hover_iter = g_steal_pointer (&data.iter);
               goto done;
             }
         }
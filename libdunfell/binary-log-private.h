@@ -0,0 +1,105 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_BINARY_LOG_PRIVATE_H
+#define DFL_BINARY_LOG_PRIVATE_H
+
+#include <glib.h>
+
+#include "event-private.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Binary log format, version 2.0.
+ *
+ * All integers are little-endian. A log is a #DflBinaryLogHeader followed by
+ * zero or more blocks, each of which is a #DflBinaryBlockHeader followed by
+ * #DflBinaryBlockHeader.length bytes of payload. Blocks of unknown types must
+ * be skipped.
+ *
+ * A %DFL_BINARY_BLOCK_STRINGS block contains #DflBinaryBlockHeader.n_entries
+ * strings, each stored as a guint32 length followed by that many bytes of
+ * UTF-8 (with no nul terminator). Strings are numbered from zero in the order
+ * they appear in the file, across all string blocks. Each string is stored
+ * only once.
+ *
+ * A %DFL_BINARY_BLOCK_EVENTS block contains #DflBinaryBlockHeader.n_entries
+ * #DflBinaryEventRecords. Each parameter of an event is stored in one of the
+ * fixed-width parameter slots, typed according to the event type’s
+ * #DflEventTypeData.parameter_types: %DFL_PARAMETER_TYPE_ID as a guint64,
+ * %DFL_PARAMETER_TYPE_INT64 as a gint64, and %DFL_PARAMETER_TYPE_STRING as the
+ * number of a string from an earlier string block. Unused slots are zero.
+ * Events with an unknown #DflEventType should be skipped.
+ */
+
+#define DFL_BINARY_LOG_MAGIC "\x89" "DFL\r\n\x1a\n"
+#define DFL_BINARY_LOG_MAGIC_LENGTH 8
+#define DFL_BINARY_LOG_VERSION_MAJOR 2
+#define DFL_BINARY_LOG_VERSION_MINOR 0
+
+/* Changing this changes the size of #DflBinaryEventRecord, which would need a
+ * new major version of the format. */
+#define DFL_BINARY_LOG_MAX_PARAMETERS 6
+
+G_STATIC_ASSERT (DFL_EVENT_MAX_PARAMETERS <= DFL_BINARY_LOG_MAX_PARAMETERS);
+
+typedef struct
+{
+  guint8 magic[DFL_BINARY_LOG_MAGIC_LENGTH];
+  guint16 version_major;
+  guint16 version_minor;
+  guint32 reserved;  /* zero */
+  guint64 initial_timestamp;
+} DflBinaryLogHeader;
+
+G_STATIC_ASSERT (sizeof (DflBinaryLogHeader) == 24);
+
+typedef enum
+{
+  DFL_BINARY_BLOCK_STRINGS = 1,
+  DFL_BINARY_BLOCK_EVENTS = 2,
+} DflBinaryBlockType;
+
+typedef struct
+{
+  guint32 block_type;  /* DflBinaryBlockType */
+  guint32 n_entries;
+  guint64 length;  /* of the payload, in bytes, excluding this header */
+} DflBinaryBlockHeader;
+
+G_STATIC_ASSERT (sizeof (DflBinaryBlockHeader) == 16);
+
+typedef struct
+{
+  guint16 event_type;  /* DflEventType */
+  guint16 n_parameters;
+  guint32 reserved;  /* zero */
+  guint64 timestamp;
+  guint64 thread_id;
+  guint64 parameters[DFL_BINARY_LOG_MAX_PARAMETERS];
+} DflBinaryEventRecord;
+
+G_STATIC_ASSERT (sizeof (DflBinaryEventRecord) == 72);
+
+/* Maximum number of records the writer puts in each events block. */
+#define DFL_BINARY_LOG_BLOCK_SIZE 4096
+
+G_END_DECLS
+
+#endif /* !DFL_BINARY_LOG_PRIVATE_H */
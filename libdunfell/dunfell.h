@@ -22,14 +22,17 @@
 /* Core files */
 #include <libdunfell/event.h>
 #include <libdunfell/event-sequence.h>
+#include <libdunfell/histogram.h>
 #include <libdunfell/main-context.h>
 #include <libdunfell/model.h>
 #include <libdunfell/parser.h>
+#include <libdunfell/profile.h>
 #include <libdunfell/source.h>
 #include <libdunfell/thread.h>
 #include <libdunfell/task.h>
 #include <libdunfell/time-sequence.h>
 #include <libdunfell/types.h>
 #include <libdunfell/version.h>
+#include <libdunfell/writer.h>
 
 #endif /* !DFL_H */
@@ -0,0 +1,150 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_EVENT_PRIVATE_H
+#define DFL_EVENT_PRIVATE_H
+
+#include <glib.h>
+
+#include "event.h"
+
+G_BEGIN_DECLS
+
+/* Maximum number of parameters of any event type, excluding the event type,
+ * timestamp and thread ID. */
+#define DFL_EVENT_MAX_PARAMETERS 6
+
+/*
+ * DflParameterType:
+ * @DFL_PARAMETER_TYPE_ID: an unsigned ID, such as a pointer or a boolean
+ * @DFL_PARAMETER_TYPE_INT64: a signed integer
+ * @DFL_PARAMETER_TYPE_STRING: a UTF-8 string, such as a symbol name
+ * @DFL_PARAMETER_TYPE_BYTES: a string which is not valid UTF-8; never used in
+ *    schemas, but may be stored in a #DflEventParameter for events constructed
+ *    with dfl_event_new()
+ *
+ * Types of event parameters, used in #DflEventTypeData.parameter_types.
+ */
+typedef enum
+{
+  DFL_PARAMETER_TYPE_ID = 'i',
+  DFL_PARAMETER_TYPE_INT64 = 'n',
+  DFL_PARAMETER_TYPE_STRING = 's',
+  DFL_PARAMETER_TYPE_BYTES = 'b',
+} DflParameterType;
+
+/*
+ * DflEventParameterValue:
+ * @id: value of a %DFL_PARAMETER_TYPE_ID parameter
+ * @int64: value of a %DFL_PARAMETER_TYPE_INT64 parameter
+ * @string: value of a %DFL_PARAMETER_TYPE_STRING or %DFL_PARAMETER_TYPE_BYTES
+ *    parameter
+ *
+ * Value of a decoded event parameter, without its type. #DflEventStore stores
+ * these separately from the types, so each parameter takes 9 bytes rather
+ * than the 16 of a padded #DflEventParameter.
+ */
+typedef union
+{
+  DflId id;
+  gint64 int64;
+  const gchar *string;
+} DflEventParameterValue;
+
+/*
+ * DflEventParameter:
+ * @type: type of the stored value; this is the type from the event type’s
+ *    schema, unless the parameter could not be decoded as that type, in which
+ *    case it is stored as a string
+ * @value: the value; strings are interned in the #DflStringTable of the
+ *    #DflEventStore holding the event, or owned by the #DflEvent for events
+ *    constructed with dfl_event_new()
+ *
+ * A decoded event parameter.
+ */
+typedef struct
+{
+  DflParameterType type;
+  DflEventParameterValue value;
+} DflEventParameter;
+
+/*
+ * DflEventTypeData:
+ * @name: name of the event type, as it appears in text logs
+ * @name_length: length of @name in bytes
+ * @parameter_types: one #DflParameterType character for each parameter
+ * @n_parameters: number of parameters (excluding the event type, timestamp
+ *    and thread ID)
+ * @interned_name: interned copy of @name
+ *
+ * Schema for an event type.
+ */
+typedef struct
+{
+  const gchar *name;
+  gsize name_length;
+  const gchar *parameter_types;
+  guint n_parameters;
+  const gchar *interned_name;
+} DflEventTypeData;
+
+/*
+ * DflStringTable:
+ *
+ * A reference counted set of interned strings, shared by a #DflEventStore and
+ * the #DflEvents loaded from it, whose string parameters point into it. The
+ * strings are stored in a #GStringChunk, so they never move, and are numbered
+ * in the order they were first interned. Strings may be interned from several
+ * threads at once.
+ */
+typedef struct _DflStringTable DflStringTable;
+
+DflStringTable *dfl_string_table_new           (void);
+DflStringTable *dfl_string_table_ref           (DflStringTable *table);
+void            dfl_string_table_unref         (DflStringTable *table);
+const gchar    *dfl_string_table_intern        (DflStringTable *table,
+                                                const gchar    *str);
+guint           dfl_string_table_get_n_strings (DflStringTable *table);
+const gchar    *dfl_string_table_get_string    (DflStringTable *table,
+                                                guint           index);
+gboolean        dfl_string_table_lookup_index  (DflStringTable *table,
+                                                const gchar    *str,
+                                                guint          *index);
+
+void                    dfl_event_type_table_ensure (void);
+const DflEventTypeData *dfl_event_type_get_data     (DflEventType  event_type);
+DflEventType            dfl_event_type_from_name    (const gchar  *name,
+                                                     gsize         length);
+
+void dfl_event_reset (DflEvent                     *self,
+                      const gchar                  *event_type,
+                      DflEventType                  event_type_enum,
+                      DflTimestamp                  timestamp,
+                      DflThreadId                   thread_id,
+                      const guint8                 *parameter_types,
+                      const DflEventParameterValue *parameter_values,
+                      guint                         n_parameters,
+                      DflStringTable               *strings);
+
+DflEventType             dfl_event_get_event_type_enum (DflEvent *self);
+const DflEventParameter *dfl_event_get_parameters      (DflEvent *self,
+                                                        guint    *n_parameters);
+
+G_END_DECLS
+
+#endif /* !DFL_EVENT_PRIVATE_H */
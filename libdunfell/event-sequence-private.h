@@ -0,0 +1,108 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_EVENT_SEQUENCE_PRIVATE_H
+#define DFL_EVENT_SEQUENCE_PRIVATE_H
+
+#include <glib.h>
+
+#include "event.h"
+#include "event-private.h"
+#include "event-sequence.h"
+
+G_BEGIN_DECLS
+
+/*
+ * DflEventStore:
+ * @timestamps: timestamp of each event
+ * @thread_ids: thread ID of each event
+ * @event_types: #DflEventType of each event, stored as a #guint8
+ * @parameter_offsets: index into @parameter_types and @parameter_values of the
+ *    first parameter of each event; this has one more element than there are
+ *    events, so that the parameters of event `i` are those from
+ *    `parameter_offsets[i]` to `parameter_offsets[i + 1]`
+ * @parameter_types: #DflParameterType of each parameter of all the events,
+ *    stored as a #guint8
+ * @parameter_values: value of each parameter of all the events
+ * @unknown_event_types: (nullable): map from event index to interned event
+ *    type name for events whose type is %DFL_EVENT_TYPE_UNKNOWN; %NULL if
+ *    there are none
+ * @strings: string table holding all the string parameters in @parameters
+ *
+ * Columnar storage for a list of events, used to back #DflEventSequence
+ * without allocating a #DflEvent object for each event. Known event types are
+ * stored as their #DflEventType; the few events constructed with
+ * dfl_event_new() using unknown event types keep their names in
+ * @unknown_event_types.
+ */
+typedef struct
+{
+  GArray/*<DflTimestamp>*/ *timestamps;  /* owned */
+  GArray/*<DflThreadId>*/ *thread_ids;  /* owned */
+  GArray/*<guint8>*/ *event_types;  /* owned */
+  GArray/*<guint>*/ *parameter_offsets;  /* owned */
+  GArray/*<guint8>*/ *parameter_types;  /* owned */
+  GArray/*<DflEventParameterValue>*/ *parameter_values;  /* owned */
+  GHashTable/*<guint, unowned utf8>*/ *unknown_event_types;  /* owned; nullable */
+  DflStringTable *strings;  /* owned */
+} DflEventStore;
+
+void  dfl_event_store_init              (DflEventStore *store);
+void  dfl_event_store_init_with_strings (DflEventStore  *store,
+                                         DflStringTable *strings);
+void  dfl_event_store_init_view         (DflEventStore       *store,
+                                         const DflEventStore *other);
+void  dfl_event_store_clear             (DflEventStore *store);
+guint dfl_event_store_get_n_events      (const DflEventStore *store);
+
+const gchar *dfl_event_store_intern (DflEventStore *store,
+                                     const gchar   *str);
+
+void dfl_event_store_append        (DflEventStore           *store,
+                                    DflEventType             event_type,
+                                    DflTimestamp             timestamp,
+                                    DflThreadId              thread_id,
+                                    const DflEventParameter *parameters,
+                                    guint                    n_parameters);
+void dfl_event_store_append_event  (DflEventStore           *store,
+                                    DflEvent                *event);
+void dfl_event_store_append_store  (DflEventStore           *store,
+                                    DflEventStore           *other);
+
+DflEventType                  dfl_event_store_get_event_type      (const DflEventStore  *store,
+                                                                   guint                 index);
+const gchar                  *dfl_event_store_get_event_type_name (const DflEventStore  *store,
+                                                                   guint                 index);
+const DflEventParameterValue *dfl_event_store_get_parameters      (const DflEventStore  *store,
+                                                                   guint                 index,
+                                                                   const guint8        **types,
+                                                                   guint                *n_parameters);
+void                          dfl_event_store_load_event          (const DflEventStore  *store,
+                                                                   guint                 index,
+                                                                   DflEvent             *event);
+
+DflEventSequence    *dfl_event_sequence_new_from_store (DflEventStore    *store,
+                                                        DflTimestamp      initial_timestamp);
+void                 dfl_event_sequence_append_store   (DflEventSequence *self,
+                                                        DflEventStore    *store);
+const DflEventStore *dfl_event_sequence_get_store      (DflEventSequence *self);
+DflEventSequence    *dfl_event_sequence_new_view       (DflEventSequence *self);
+
+G_END_DECLS
+
+#endif /* !DFL_EVENT_SEQUENCE_PRIVATE_H */
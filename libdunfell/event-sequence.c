@@ -38,6 +38,13 @@
  * guarantees about which order the walkers which match a particular event are
  * called in.
  *
+ * The events are stored in columns (timestamps, thread IDs, event types and
+ * parameters) rather than as #DflEvent objects, so that large logs can be
+ * loaded without allocating an object per event. #DflEvent objects are created
+ * on demand: g_list_model_get_item() returns a new #DflEvent each time it is
+ * called, and the #DflEvent passed to each walker is only valid for the
+ * duration of the walker callback.
+ *
  * Walkers can be installed on the #DflEventSequence using
  * dfl_event_sequence_add_walker(), which may be called at any time before or
  * during a walk over the event sequence (i.e. it may be called from with a
@@ -49,6 +56,10 @@
  * Any walkers remaining in the #DflEventSequence when it is destroyed are
  * freed.
  *
+ * Walkers are indexed by event type and ID, so the cost of a walk is
+ * proportional to the number of events plus the number of walker callbacks
+ * made, rather than to the number of walkers installed.
+ *
  * # Walker Groups # {#walker-groups}
  *
  * In order to simplify adding groups of walkers to a #DflEventSequence to match
@@ -74,34 +85,65 @@
 #include <string.h>
 
 #include "event.h"
+#include "event-private.h"
 #include "event-sequence.h"
+#include "event-sequence-private.h"
 
 
 static void dfl_event_sequence_list_model_init (GListModelInterface *iface);
 static void dfl_event_sequence_dispose (GObject *object);
+static void dfl_event_sequence_finalize (GObject *object);
 static GType dfl_event_sequence_get_item_type (GListModel *list);
 static guint dfl_event_sequence_get_n_items (GListModel *list);
 static gpointer dfl_event_sequence_get_item (GListModel  *list,
                                              guint        position);
 
+typedef struct _DflEventSequenceWalkerBucket DflEventSequenceWalkerBucket;
+
 typedef struct
 {
   const gchar *event_type;  /* nullable, unowned, interned */
   DflId id;  /* could be %DFL_ID_INVALID */
-  DflEventWalker walker;
+  DflEventWalker walker;  /* %NULL once the walker has been removed */
   gpointer user_data;  /* nullable */
   GDestroyNotify destroy_user_data;  /* nullable */
+  DflEventSequenceWalkerBucket *bucket;  /* unowned */
+  guint first_event;  /* index of the first event to dispatch to the walker */
 } DflEventSequenceWalkerClosure;
 
+/* All the walkers matching a given event type and ID, in the order they were
+ * added. The event type and ID may be unset to match any event type or ID.
+ * Removed walkers are left in place (with a %NULL walker) until the bucket is
+ * compacted, so that buckets can be modified while they are being
+ * dispatched. */
+struct _DflEventSequenceWalkerBucket
+{
+  const gchar *event_type;  /* nullable, unowned, interned */
+  DflId id;  /* could be %DFL_ID_INVALID */
+  GPtrArray/*<owned DflEventSequenceWalkerClosure>*/ *closures;  /* owned; elements owned */
+  guint n_removed;  /* number of removed walkers in @closures */
+};
+
 struct _DflEventSequence
 {
   GObject parent;
 
-  DflEvent **events;  /* owned */
-  guint n_events;
+  DflEventStore store;
   guint64 initial_timestamp;
 
-  GArray/*<DflEventWalkerClosure>*/ *walkers;  /* owned */
+  /* Walkers by ID, and the dispatch index of walkers by event type and ID. The
+   * wildcard bucket matches all events, and isn’t in @walker_buckets. */
+  GHashTable/*<guint, unowned DflEventSequenceWalkerClosure>*/ *walkers;  /* owned */
+  GHashTable/*<owned DflEventSequenceWalkerBucket, unowned DflEventSequenceWalkerBucket>*/ *walker_buckets;  /* owned */
+  DflEventSequenceWalkerBucket *wildcard_walkers;  /* owned */
+  guint next_walker_id;
+  guint n_id_walkers;  /* number of walkers with an ID set */
+
+  /* State for the walk in progress, if any. */
+  gboolean walking;
+  guint walk_position;  /* index of the event being dispatched */
+  DflEvent *walk_event;  /* (owned) (nullable) */
+  GPtrArray/*<unowned DflEventSequenceWalkerBucket>*/ *dirty_buckets;  /* owned */
 
   GArray/*<guint>*/ *walker_group;  /* owned; nullable */
 };
@@ -116,6 +158,7 @@ dfl_event_sequence_class_init (DflEventSequenceClass *klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->dispose = dfl_event_sequence_dispose;
+  gobject_class->finalize = dfl_event_sequence_finalize;
 }
 
 static void
@@ -127,48 +170,156 @@ dfl_event_sequence_list_model_init (GListModelInterface *iface)
 }
 
 static void
-walkers_clear_cb (gpointer user_data)
+walker_closure_clear (DflEventSequenceWalkerClosure *closure)
 {
-  DflEventSequenceWalkerClosure *closure = user_data;
-
   if (closure->user_data != NULL && closure->destroy_user_data != NULL)
     closure->destroy_user_data (closure->user_data);
 
-  closure->event_type = NULL;
-  closure->id = DFL_ID_INVALID;
   closure->walker = NULL;
   closure->user_data = NULL;
   closure->destroy_user_data = NULL;
 }
 
+static void
+walker_closure_free (DflEventSequenceWalkerClosure *closure)
+{
+  walker_closure_clear (closure);
+  g_free (closure);
+}
+
+static DflEventSequenceWalkerBucket *
+walker_bucket_new (const gchar *event_type,
+                   DflId        id)
+{
+  DflEventSequenceWalkerBucket *bucket = NULL;
+
+  bucket = g_new0 (DflEventSequenceWalkerBucket, 1);
+  bucket->event_type = event_type;
+  bucket->id = id;
+  bucket->closures = g_ptr_array_new ();
+
+  return bucket;
+}
+
+static void
+walker_bucket_free (DflEventSequenceWalkerBucket *bucket)
+{
+  guint i;
+
+  for (i = 0; i < bucket->closures->len; i++)
+    walker_closure_free (g_ptr_array_index (bucket->closures, i));
+
+  g_ptr_array_unref (bucket->closures);
+  g_free (bucket);
+}
+
+static guint
+walker_bucket_hash (gconstpointer key)
+{
+  const DflEventSequenceWalkerBucket *bucket = key;
+
+  return g_direct_hash (bucket->event_type) ^ g_int64_hash (&bucket->id);
+}
+
+static gboolean
+walker_bucket_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const DflEventSequenceWalkerBucket *bucket_a = a;
+  const DflEventSequenceWalkerBucket *bucket_b = b;
+
+  return (bucket_a->event_type == bucket_b->event_type &&
+          bucket_a->id == bucket_b->id);
+}
+
+/* Find the bucket for walkers matching @event_type and @id, or %NULL if there
+ * are none. */
+static DflEventSequenceWalkerBucket *
+lookup_walker_bucket (DflEventSequence *self,
+                      const gchar      *event_type,
+                      DflId             id)
+{
+  DflEventSequenceWalkerBucket key;
+
+  if (event_type == NULL && id == DFL_ID_INVALID)
+    return self->wildcard_walkers;
+
+  key.event_type = event_type;
+  key.id = id;
+
+  return g_hash_table_lookup (self->walker_buckets, &key);
+}
+
+/* Drop the removed walkers from @bucket, preserving the order of the others,
+ * and drop @bucket from the index if it’s then empty. */
+static void
+compact_walker_bucket (DflEventSequence             *self,
+                       DflEventSequenceWalkerBucket *bucket)
+{
+  guint i, j;
+
+  for (i = 0, j = 0; i < bucket->closures->len; i++)
+    {
+      DflEventSequenceWalkerClosure *closure;
+
+      closure = g_ptr_array_index (bucket->closures, i);
+
+      if (closure->walker == NULL)
+        walker_closure_free (closure);
+      else
+        bucket->closures->pdata[j++] = closure;
+    }
+
+  g_ptr_array_set_size (bucket->closures, j);
+  bucket->n_removed = 0;
+
+  if (bucket->closures->len == 0 && bucket != self->wildcard_walkers)
+    g_hash_table_remove (self->walker_buckets, bucket);
+}
+
 static void
 dfl_event_sequence_init (DflEventSequence *self)
 {
-  self->walkers = g_array_new (FALSE, FALSE,
-                               sizeof (DflEventSequenceWalkerClosure));
-  g_array_set_clear_func (self->walkers, walkers_clear_cb);
+  self->walkers = g_hash_table_new (NULL, NULL);
+  self->walker_buckets = g_hash_table_new_full (walker_bucket_hash,
+                                                walker_bucket_equal,
+                                                (GDestroyNotify) walker_bucket_free,
+                                                NULL);
+  self->wildcard_walkers = walker_bucket_new (NULL, DFL_ID_INVALID);
+  self->next_walker_id = 1;
+  self->dirty_buckets = g_ptr_array_new ();
+
+  dfl_event_store_init (&self->store);
 }
 
 static void
 dfl_event_sequence_dispose (GObject *object)
 {
   DflEventSequence *self = DFL_EVENT_SEQUENCE (object);
-  guint i;
 
   /* The programmer must have closed any walker groups before disposing the
    * event sequence. */
   g_assert (self->walker_group == NULL);
 
-  for (i = 0; i < self->n_events; i++)
-    g_object_unref (self->events[i]);
+  /* Freeing the buckets frees the walkers. */
+  g_clear_pointer (&self->walkers, g_hash_table_unref);
+  g_clear_pointer (&self->walker_buckets, g_hash_table_unref);
+  g_clear_pointer (&self->wildcard_walkers, walker_bucket_free);
+  g_clear_pointer (&self->dirty_buckets, g_ptr_array_unref);
+
+  /* Chain up to the parent class */
+  G_OBJECT_CLASS (dfl_event_sequence_parent_class)->dispose (object);
+}
 
-  g_clear_pointer (&self->events, g_free);
-  self->n_events = 0;
+static void
+dfl_event_sequence_finalize (GObject *object)
+{
+  DflEventSequence *self = DFL_EVENT_SEQUENCE (object);
 
-  g_clear_pointer (&self->walkers, g_array_unref);
+  dfl_event_store_clear (&self->store);
 
   /* Chain up to the parent class */
-  G_OBJECT_CLASS (dfl_event_sequence_parent_class)->dispose (object);
+  G_OBJECT_CLASS (dfl_event_sequence_parent_class)->finalize (object);
 }
 
 static GType
@@ -182,19 +333,426 @@ dfl_event_sequence_get_n_items (GListModel *list)
 {
   DflEventSequence *self = DFL_EVENT_SEQUENCE (list);
 
-  return self->n_events;
+  return dfl_event_store_get_n_events (&self->store);
 }
 
+/* Create a new #DflEvent wrapper for each call, since the events aren’t stored
+ * as objects. */
 static gpointer
 dfl_event_sequence_get_item (GListModel  *list,
                              guint        position)
 {
   DflEventSequence *self = DFL_EVENT_SEQUENCE (list);
+  DflEvent *event = NULL;
 
-  if (position >= self->n_events)
+  if (position >= dfl_event_store_get_n_events (&self->store))
     return NULL;
 
-  return self->events[position];
+  event = g_object_new (DFL_TYPE_EVENT, NULL);
+  dfl_event_store_load_event (&self->store, position, event);
+
+  return event;
+}
+
+/*
+ * dfl_event_store_init:
+ * @store: an uninitialised #DflEventStore
+ *
+ * Initialise @store to contain no events, with a new string table. Free it
+ * with dfl_event_store_clear().
+ */
+void
+dfl_event_store_init (DflEventStore *store)
+{
+  DflStringTable *strings = NULL;
+
+  strings = dfl_string_table_new ();
+  dfl_event_store_init_with_strings (store, strings);
+  dfl_string_table_unref (strings);
+}
+
+/*
+ * dfl_event_store_init_with_strings:
+ * @store: an uninitialised #DflEventStore
+ * @strings: a #DflStringTable
+ *
+ * Initialise @store to contain no events, interning its strings in @strings.
+ * Stores which share a string table can be appended to each other without
+ * re-interning their strings; this is used to parse chunks of a log in
+ * parallel. Free it with dfl_event_store_clear().
+ */
+void
+dfl_event_store_init_with_strings (DflEventStore  *store,
+                                   DflStringTable *strings)
+{
+  guint zero = 0;
+
+  dfl_event_type_table_ensure ();
+
+  store->timestamps = g_array_new (FALSE, FALSE, sizeof (DflTimestamp));
+  store->thread_ids = g_array_new (FALSE, FALSE, sizeof (DflThreadId));
+  store->event_types = g_array_new (FALSE, FALSE, sizeof (guint8));
+  store->parameter_offsets = g_array_new (FALSE, FALSE, sizeof (guint));
+  store->parameter_types = g_array_new (FALSE, FALSE, sizeof (guint8));
+  store->parameter_values = g_array_new (FALSE, FALSE,
+                                         sizeof (DflEventParameterValue));
+  store->unknown_event_types = NULL;
+  store->strings = dfl_string_table_ref (strings);
+
+  g_array_append_val (store->parameter_offsets, zero);
+}
+
+/*
+ * dfl_event_store_init_view:
+ * @store: an uninitialised #DflEventStore
+ * @other: an initialised #DflEventStore
+ *
+ * Initialise @store to share the events in @other, without copying them. Free
+ * it with dfl_event_store_clear(). Neither store may be modified while the
+ * other is in use.
+ */
+void
+dfl_event_store_init_view (DflEventStore       *store,
+                           const DflEventStore *other)
+{
+  store->timestamps = g_array_ref (other->timestamps);
+  store->thread_ids = g_array_ref (other->thread_ids);
+  store->event_types = g_array_ref (other->event_types);
+  store->parameter_offsets = g_array_ref (other->parameter_offsets);
+  store->parameter_types = g_array_ref (other->parameter_types);
+  store->parameter_values = g_array_ref (other->parameter_values);
+  store->unknown_event_types = (other->unknown_event_types != NULL) ?
+                               g_hash_table_ref (other->unknown_event_types) :
+                               NULL;
+  store->strings = dfl_string_table_ref (other->strings);
+}
+
+/*
+ * dfl_event_store_clear:
+ * @store: a #DflEventStore
+ *
+ * Free the contents of @store. It must be initialised again with
+ * dfl_event_store_init() before being reused.
+ */
+void
+dfl_event_store_clear (DflEventStore *store)
+{
+  g_clear_pointer (&store->timestamps, g_array_unref);
+  g_clear_pointer (&store->thread_ids, g_array_unref);
+  g_clear_pointer (&store->event_types, g_array_unref);
+  g_clear_pointer (&store->parameter_offsets, g_array_unref);
+  g_clear_pointer (&store->parameter_types, g_array_unref);
+  g_clear_pointer (&store->parameter_values, g_array_unref);
+  g_clear_pointer (&store->unknown_event_types, g_hash_table_unref);
+  g_clear_pointer (&store->strings, dfl_string_table_unref);
+}
+
+/*
+ * dfl_event_store_get_n_events:
+ * @store: a #DflEventStore
+ *
+ * Get the number of events in @store.
+ *
+ * Returns: number of events
+ */
+guint
+dfl_event_store_get_n_events (const DflEventStore *store)
+{
+  return store->timestamps->len;
+}
+
+/*
+ * dfl_event_store_intern:
+ * @store: a #DflEventStore
+ * @str: a nul-terminated string
+ *
+ * Intern @str in the string table of @store, so it can be used as a parameter
+ * of events appended to @store.
+ *
+ * Returns: (transfer none): the interned string
+ */
+const gchar *
+dfl_event_store_intern (DflEventStore *store,
+                        const gchar   *str)
+{
+  return dfl_string_table_intern (store->strings, str);
+}
+
+/* Intern the string parameters in @store from index @first_parameter onwards,
+ * which point into some other string table, in @store’s own table. */
+static void
+intern_parameters (DflEventStore *store,
+                   guint          first_parameter)
+{
+  guint i;
+
+  for (i = first_parameter; i < store->parameter_types->len; i++)
+    {
+      guint8 type = g_array_index (store->parameter_types, guint8, i);
+      DflEventParameterValue *value;
+
+      value = &g_array_index (store->parameter_values, DflEventParameterValue,
+                              i);
+
+      if (type == DFL_PARAMETER_TYPE_STRING || type == DFL_PARAMETER_TYPE_BYTES)
+        value->string = dfl_string_table_intern (store->strings,
+                                                 value->string);
+    }
+}
+
+/*
+ * dfl_event_store_append:
+ * @store: a #DflEventStore
+ * @event_type: a known event type
+ * @timestamp: timestamp when the event happened
+ * @thread_id: ID of the thread the event happened in
+ * @parameters: (array length=n_parameters): decoded parameters, of the types
+ *    given by the schema for @event_type (or strings, if they couldn’t be
+ *    decoded as those types); any strings must have been interned with
+ *    dfl_event_store_intern()
+ * @n_parameters: number of items in @parameters
+ *
+ * Append an event to @store. This is used by the parser, which has already
+ * decoded the parameters, and avoids allocating a #DflEvent for every event.
+ */
+void
+dfl_event_store_append (DflEventStore           *store,
+                        DflEventType             event_type,
+                        DflTimestamp             timestamp,
+                        DflThreadId              thread_id,
+                        const DflEventParameter *parameters,
+                        guint                    n_parameters)
+{
+  guint8 event_type_byte = event_type;
+  guint offset, i;
+
+  g_return_if_fail (n_parameters == 0 || parameters != NULL);
+  g_return_if_fail ((guint) event_type <= G_MAXUINT8);
+
+  g_array_append_val (store->timestamps, timestamp);
+  g_array_append_val (store->thread_ids, thread_id);
+  g_array_append_val (store->event_types, event_type_byte);
+
+  /* Split the parameters into the type and value columns. */
+  offset = store->parameter_types->len;
+  g_array_set_size (store->parameter_types, offset + n_parameters);
+  g_array_set_size (store->parameter_values, offset + n_parameters);
+
+  for (i = 0; i < n_parameters; i++)
+    {
+      g_array_index (store->parameter_types, guint8, offset + i) =
+        parameters[i].type;
+      g_array_index (store->parameter_values, DflEventParameterValue,
+                     offset + i) = parameters[i].value;
+    }
+
+  offset += n_parameters;
+  g_array_append_val (store->parameter_offsets, offset);
+}
+
+/*
+ * dfl_event_store_append_event:
+ * @store: a #DflEventStore
+ * @event: a #DflEvent
+ *
+ * Append a copy of @event to @store. @event is not referenced; its string
+ * parameters are copied into the string table of @store.
+ */
+void
+dfl_event_store_append_event (DflEventStore *store,
+                              DflEvent      *event)
+{
+  DflEventType event_type;
+  const DflEventParameter *parameters;
+  guint n_parameters, first_parameter;
+
+  event_type = dfl_event_get_event_type_enum (event);
+  parameters = dfl_event_get_parameters (event, &n_parameters);
+
+  if (event_type == DFL_EVENT_TYPE_UNKNOWN)
+    {
+      if (store->unknown_event_types == NULL)
+        store->unknown_event_types = g_hash_table_new (NULL, NULL);
+
+      g_hash_table_insert (store->unknown_event_types,
+                           GUINT_TO_POINTER (dfl_event_store_get_n_events (store)),
+                           (gpointer) dfl_event_get_event_type (event));
+    }
+
+  first_parameter = store->parameter_types->len;
+  dfl_event_store_append (store, event_type,
+                          dfl_event_get_timestamp (event),
+                          dfl_event_get_thread_id (event),
+                          parameters, n_parameters);
+  intern_parameters (store, first_parameter);
+}
+
+/*
+ * dfl_event_store_append_store:
+ * @store: a #DflEventStore
+ * @other: another #DflEventStore
+ *
+ * Move all the events from @other to the end of @store. @other is left
+ * empty, but keeps its string table. If the two stores have different string
+ * tables, the strings from @other are interned in the table of @store.
+ */
+void
+dfl_event_store_append_store (DflEventStore *store,
+                              DflEventStore *other)
+{
+  DflStringTable *other_strings = NULL;
+  guint n_events, n_other_events, parameters_base, i;
+
+  n_events = dfl_event_store_get_n_events (store);
+  n_other_events = dfl_event_store_get_n_events (other);
+  parameters_base = store->parameter_types->len;
+
+  g_return_if_fail (n_other_events <= G_MAXUINT - n_events);
+
+  g_array_append_vals (store->timestamps, other->timestamps->data,
+                       n_other_events);
+  g_array_append_vals (store->thread_ids, other->thread_ids->data,
+                       n_other_events);
+  g_array_append_vals (store->event_types, other->event_types->data,
+                       n_other_events);
+  g_array_append_vals (store->parameter_types, other->parameter_types->data,
+                       other->parameter_types->len);
+  g_array_append_vals (store->parameter_values, other->parameter_values->data,
+                       other->parameter_values->len);
+
+  if (other->strings != store->strings)
+    intern_parameters (store, parameters_base);
+
+  /* Skip the leading zero offset from @other, and rebase the rest. */
+  for (i = 1; i <= n_other_events; i++)
+    {
+      guint offset = g_array_index (other->parameter_offsets, guint, i) +
+                     parameters_base;
+      g_array_append_val (store->parameter_offsets, offset);
+    }
+
+  if (other->unknown_event_types != NULL)
+    {
+      GHashTableIter iter;
+      gpointer key, value;
+
+      if (store->unknown_event_types == NULL)
+        store->unknown_event_types = g_hash_table_new (NULL, NULL);
+
+      g_hash_table_iter_init (&iter, other->unknown_event_types);
+
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        g_hash_table_insert (store->unknown_event_types,
+                             GUINT_TO_POINTER (GPOINTER_TO_UINT (key) + n_events),
+                             value);
+    }
+
+  other_strings = dfl_string_table_ref (other->strings);
+  dfl_event_store_clear (other);
+  dfl_event_store_init_with_strings (other, other_strings);
+  dfl_string_table_unref (other_strings);
+}
+
+/*
+ * dfl_event_store_get_event_type:
+ * @store: a #DflEventStore
+ * @index: index of the event
+ *
+ * Get the type of the event at @index.
+ *
+ * Returns: the event type, or %DFL_EVENT_TYPE_UNKNOWN if it’s not known
+ */
+DflEventType
+dfl_event_store_get_event_type (const DflEventStore *store,
+                                guint                index)
+{
+  return g_array_index (store->event_types, guint8, index);
+}
+
+/*
+ * dfl_event_store_get_event_type_name:
+ * @store: a #DflEventStore
+ * @index: index of the event
+ *
+ * Get the name of the type of the event at @index.
+ *
+ * Returns: (nullable): the interned event type name
+ */
+const gchar *
+dfl_event_store_get_event_type_name (const DflEventStore *store,
+                                     guint                index)
+{
+  DflEventType event_type;
+
+  event_type = dfl_event_store_get_event_type (store, index);
+
+  if (event_type != DFL_EVENT_TYPE_UNKNOWN)
+    return dfl_event_type_get_data (event_type)->interned_name;
+  else if (store->unknown_event_types != NULL)
+    return g_hash_table_lookup (store->unknown_event_types,
+                                GUINT_TO_POINTER (index));
+  else
+    return NULL;
+}
+
+/*
+ * dfl_event_store_get_parameters:
+ * @store: a #DflEventStore
+ * @index: index of the event
+ * @types: (out) (optional) (array length=n_parameters) (transfer none): return
+ *    location for the #DflParameterType of each parameter
+ * @n_parameters: (out): return location for the number of parameters
+ *
+ * Get the decoded parameters of the event at @index.
+ *
+ * Returns: (array length=n_parameters) (transfer none): the parameter values
+ */
+const DflEventParameterValue *
+dfl_event_store_get_parameters (const DflEventStore  *store,
+                                guint                 index,
+                                const guint8        **types,
+                                guint                *n_parameters)
+{
+  guint start, end;
+
+  start = g_array_index (store->parameter_offsets, guint, index);
+  end = g_array_index (store->parameter_offsets, guint, index + 1);
+
+  *n_parameters = end - start;
+
+  if (types != NULL)
+    *types = &g_array_index (store->parameter_types, guint8, start);
+
+  return &g_array_index (store->parameter_values, DflEventParameterValue,
+                         start);
+}
+
+/*
+ * dfl_event_store_load_event:
+ * @store: a #DflEventStore
+ * @index: index of the event
+ * @event: a #DflEvent which nothing else holds a reference to
+ *
+ * Overwrite @event with the contents of the event at @index.
+ */
+void
+dfl_event_store_load_event (const DflEventStore *store,
+                            guint                index,
+                            DflEvent            *event)
+{
+  const DflEventParameterValue *values;
+  const guint8 *types;
+  guint n_parameters;
+
+  values = dfl_event_store_get_parameters (store, index, &types,
+                                           &n_parameters);
+
+  dfl_event_reset (event,
+                   dfl_event_store_get_event_type_name (store, index),
+                   dfl_event_store_get_event_type (store, index),
+                   g_array_index (store->timestamps, DflTimestamp, index),
+                   g_array_index (store->thread_ids, DflThreadId, index),
+                   types, values, n_parameters, store->strings);
 }
 
 /**
@@ -214,25 +772,191 @@ dfl_event_sequence_new (const DflEvent **events,
                         guint            n_events,
                         guint64          initial_timestamp)
 {
-  DflEventSequence *obj = NULL;
+  DflEventStore store;
   guint i;
 
   g_return_val_if_fail (n_events == 0 || events != NULL, NULL);
-  g_return_val_if_fail (n_events < G_MAXUINT / sizeof (DflEvent *), NULL);
+
+  dfl_event_store_init (&store);
+
+  /* Copy the events into the sequence’s own storage. */
+  for (i = 0; i < n_events; i++)
+    {
+      if (!DFL_IS_EVENT (events[i]))
+        {
+          dfl_event_store_clear (&store);
+          g_return_val_if_fail (DFL_IS_EVENT (events[i]), NULL);
+        }
+
+      dfl_event_store_append_event (&store, (DflEvent *) events[i]);
+    }
+
+  return dfl_event_sequence_new_from_store (&store, initial_timestamp);
+}
+
+/*
+ * dfl_event_sequence_new_from_store:
+ * @store: a #DflEventStore, which is left empty
+ * @initial_timestamp: the timestamp of the start of the sequence (before the
+ *    first event)
+ *
+ * Version of dfl_event_sequence_new() which takes ownership of the contents of
+ * @store, rather than copying from #DflEvent objects. @store keeps sharing the
+ * string table with the new sequence, so events added to it later can be
+ * appended to the sequence without re-interning their strings.
+ *
+ * Returns: (transfer full): a new #DflEventSequence
+ */
+DflEventSequence *
+dfl_event_sequence_new_from_store (DflEventStore *store,
+                                   DflTimestamp   initial_timestamp)
+{
+  DflEventSequence *obj = NULL;
 
   obj = g_object_new (DFL_TYPE_EVENT_SEQUENCE, NULL);
-  obj->events = g_memdup (events, sizeof (DflEvent *) * n_events);
-  obj->n_events = n_events;
+
+  dfl_event_store_clear (&obj->store);
+  obj->store = *store;
   obj->initial_timestamp = initial_timestamp;
 
-  /* Reference all the events. */
+  dfl_event_store_init_with_strings (store, obj->store.strings);
+
+  return obj;
+}
+
+/**
+ * dfl_event_sequence_append:
+ * @self: a #DflEventSequence
+ * @events: (array length=n_events): array of #DflEvents to append
+ * @n_events: number of items in @events
+ *
+ * Append @events to the end of the sequence, for example as they are parsed
+ * from a log which is still being written. #GListModel::items-changed is
+ * emitted for them.
+ *
+ * This must not be called while walking the sequence.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_event_sequence_append (DflEventSequence  *self,
+                           const DflEvent   **events,
+                           guint              n_events)
+{
+  DflEventStore store;
+  guint i;
+
+  g_return_if_fail (DFL_IS_EVENT_SEQUENCE (self));
+  g_return_if_fail (n_events == 0 || events != NULL);
+
+  if (n_events == 0)
+    return;
+
+  dfl_event_store_init (&store);
+
   for (i = 0; i < n_events; i++)
     {
-      g_return_val_if_fail (DFL_IS_EVENT (obj->events[i]), NULL);
-      g_object_ref (obj->events[i]);
+      if (!DFL_IS_EVENT (events[i]))
+        {
+          dfl_event_store_clear (&store);
+          g_return_if_fail (DFL_IS_EVENT (events[i]));
+        }
+
+      dfl_event_store_append_event (&store, (DflEvent *) events[i]);
     }
 
-  return obj;
+  dfl_event_sequence_append_store (self, &store);
+  dfl_event_store_clear (&store);
+}
+
+/*
+ * dfl_event_sequence_append_store:
+ * @self: a #DflEventSequence
+ * @store: a #DflEventStore, which is left empty
+ *
+ * Version of dfl_event_sequence_append() which moves the events out of
+ * @store, rather than copying from #DflEvent objects.
+ */
+void
+dfl_event_sequence_append_store (DflEventSequence *self,
+                                 DflEventStore    *store)
+{
+  guint position, n_events;
+
+  g_return_if_fail (DFL_IS_EVENT_SEQUENCE (self));
+
+  position = dfl_event_store_get_n_events (&self->store);
+  n_events = dfl_event_store_get_n_events (store);
+
+  if (n_events == 0)
+    return;
+
+  dfl_event_store_append_store (&self->store, store);
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, n_events);
+}
+
+/*
+ * dfl_event_sequence_get_store:
+ * @self: a #DflEventSequence
+ *
+ * Get the columnar storage for the events in the sequence, for code which
+ * wants to iterate over them without creating #DflEvent wrappers.
+ *
+ * Returns: (transfer none): the event storage
+ */
+const DflEventStore *
+dfl_event_sequence_get_store (DflEventSequence *self)
+{
+  g_return_val_if_fail (DFL_IS_EVENT_SEQUENCE (self), NULL);
+
+  return &self->store;
+}
+
+/*
+ * dfl_event_sequence_new_view:
+ * @self: a #DflEventSequence
+ *
+ * Create a new #DflEventSequence which shares the events in @self, but has its
+ * own set of walkers. This allows several sets of walkers to walk over the same
+ * events concurrently, in different threads. @self must not be modified while
+ * the view exists.
+ *
+ * Returns: (transfer full): a new #DflEventSequence
+ */
+DflEventSequence *
+dfl_event_sequence_new_view (DflEventSequence *self)
+{
+  DflEventSequence *view = NULL;
+
+  g_return_val_if_fail (DFL_IS_EVENT_SEQUENCE (self), NULL);
+
+  view = g_object_new (DFL_TYPE_EVENT_SEQUENCE, NULL);
+
+  dfl_event_store_clear (&view->store);
+  dfl_event_store_init_view (&view->store, &self->store);
+  view->initial_timestamp = self->initial_timestamp;
+
+  return view;
+}
+
+/**
+ * dfl_event_sequence_get_initial_timestamp:
+ * @self: a #DflEventSequence
+ *
+ * Get the timestamp of the start of the sequence, as passed to
+ * dfl_event_sequence_new(). This is no later than the timestamp of the first
+ * event.
+ *
+ * Returns: initial timestamp of the sequence
+ * Since: UNRELEASED
+ */
+DflTimestamp
+dfl_event_sequence_get_initial_timestamp (DflEventSequence *self)
+{
+  g_return_val_if_fail (DFL_IS_EVENT_SEQUENCE (self), 0);
+
+  return self->initial_timestamp;
 }
 
 /**
@@ -343,26 +1067,49 @@ dfl_event_sequence_add_walker (DflEventSequence *self,
                                gpointer          user_data,
                                GDestroyNotify    destroy_user_data)
 {
-  DflEventSequenceWalkerClosure closure;
+  DflEventSequenceWalkerClosure *closure = NULL;
+  DflEventSequenceWalkerBucket *bucket = NULL;
+  guint walker_id;
 
   g_return_val_if_fail (DFL_IS_EVENT_SEQUENCE (self), 0);
   g_return_val_if_fail (event_type == NULL || *event_type != '\0', 0);
   g_return_val_if_fail (event_type != NULL || id == DFL_ID_INVALID, 0);
   g_return_val_if_fail (walker != NULL, 0);
 
-  closure.event_type = g_intern_string (event_type);
-  closure.id = id;
-  closure.walker = walker;
-  closure.user_data = user_data;
-  closure.destroy_user_data = destroy_user_data;
+  event_type = g_intern_string (event_type);
+
+  closure = g_new0 (DflEventSequenceWalkerClosure, 1);
+  closure->event_type = event_type;
+  closure->id = id;
+  closure->walker = walker;
+  closure->user_data = user_data;
+  closure->destroy_user_data = destroy_user_data;
+
+  /* Walkers added during a walk start matching from the next event. */
+  closure->first_event = self->walking ? self->walk_position + 1 : 0;
+
+  bucket = lookup_walker_bucket (self, event_type, id);
+
+  if (bucket == NULL)
+    {
+      bucket = walker_bucket_new (event_type, id);
+      g_hash_table_add (self->walker_buckets, bucket);
+    }
+
+  closure->bucket = bucket;
+  g_ptr_array_add (bucket->closures, closure);
+
+  if (id != DFL_ID_INVALID)
+    self->n_id_walkers++;
 
-  g_array_append_val (self->walkers, closure);
+  walker_id = self->next_walker_id++;
+  g_assert (walker_id != 0);
+  g_hash_table_insert (self->walkers, GUINT_TO_POINTER (walker_id), closure);
 
   if (self->walker_group != NULL)
-    g_array_append_val (self->walker_group, self->walkers->len);
+    g_array_append_val (self->walker_group, walker_id);
 
-  g_assert (self->walkers->len != 0);
-  return self->walkers->len;
+  return walker_id;
 }
 
 /**
@@ -383,17 +1130,86 @@ dfl_event_sequence_remove_walker (DflEventSequence *self,
                                   guint             walker_id)
 {
   DflEventSequenceWalkerClosure *closure;
+  DflEventSequenceWalkerBucket *bucket;
 
   g_return_if_fail (DFL_IS_EVENT_SEQUENCE (self));
-  g_return_if_fail (walker_id != 0 && walker_id <= self->walkers->len);
+  g_return_if_fail (walker_id != 0);
 
-  /* Clear the given element of the walkers array, but don’t remove it so we
-   * don’t muck up the IDs of other walkers. */
-  closure = &g_array_index (self->walkers, DflEventSequenceWalkerClosure,
-                            walker_id - 1);
+  closure = g_hash_table_lookup (self->walkers, GUINT_TO_POINTER (walker_id));
+  g_return_if_fail (closure != NULL);
 
-  g_return_if_fail (closure->walker != NULL);
-  walkers_clear_cb (closure);
+  g_hash_table_remove (self->walkers, GUINT_TO_POINTER (walker_id));
+
+  if (closure->id != DFL_ID_INVALID)
+    self->n_id_walkers--;
+
+  /* Clear the closure, but leave it in its bucket until the bucket is
+   * compacted, in case the bucket is currently being dispatched. */
+  walker_closure_clear (closure);
+  bucket = closure->bucket;
+  bucket->n_removed++;
+
+  if (!self->walking)
+    compact_walker_bucket (self, bucket);
+  else if (bucket->n_removed == 1)
+    g_ptr_array_add (self->dirty_buckets, bucket);
+}
+
+/* Replace the reusable event wrapper with a new one. The old one, if any, is
+ * left to whichever walkers hold references to it. */
+static void
+walk_event_renew (DflEventSequence *self)
+{
+  g_clear_object (&self->walk_event);
+  self->walk_event = g_object_new (DFL_TYPE_EVENT, NULL);
+}
+
+/* Load the event at @position into the reusable event wrapper, if it hasn’t
+ * been already. */
+static void
+walk_load_event (DflEventSequence  *self,
+                 guint              position,
+                 gboolean          *loaded)
+{
+  if (*loaded)
+    return;
+
+  /* If a walker kept a reference to the previous event, it can’t be
+   * reused. Walkers run on this thread, so once they have returned, any
+   * reference other than the walk’s own is one they kept. */
+  if (g_atomic_int_get ((gint *) &G_OBJECT (self->walk_event)->ref_count) != 1)
+    walk_event_renew (self);
+
+  dfl_event_store_load_event (&self->store, position, self->walk_event);
+  *loaded = TRUE;
+}
+
+/* Call the walkers in @bucket for the event at @position. */
+static void
+walk_bucket (DflEventSequence              *self,
+             DflEventSequenceWalkerBucket  *bucket,
+             guint                          position,
+             gboolean                      *loaded)
+{
+  guint i, n_closures;
+
+  if (bucket == NULL)
+    return;
+
+  /* Walkers appended to the bucket by these callbacks don’t match until the
+   * next event. Removed walkers stay in place until the bucket is compacted. */
+  for (i = 0, n_closures = bucket->closures->len; i < n_closures; i++)
+    {
+      const DflEventSequenceWalkerClosure *closure;
+
+      closure = g_ptr_array_index (bucket->closures, i);
+
+      if (closure->walker == NULL || position < closure->first_event)
+        continue;
+
+      walk_load_event (self, position, loaded);
+      closure->walker (self, self->walk_event, closure->user_data);
+    }
 }
 
 /**
@@ -409,36 +1225,83 @@ dfl_event_sequence_remove_walker (DflEventSequence *self,
 void
 dfl_event_sequence_walk (DflEventSequence *self)
 {
-  guint i, j;
+  guint i, n_events;
+  GHashTableIter iter;
+  gpointer value;
 
   g_return_if_fail (DFL_IS_EVENT_SEQUENCE (self));
+  g_return_if_fail (!self->walking);
 
-  if (self->walkers->len == 0)
+  if (g_hash_table_size (self->walkers) == 0)
     return;
 
-  for (i = 0; i < self->n_events; i++)
+  /* A single #DflEvent wrapper is reused for all the events, and only loaded
+   * if a walker matches the event. */
+  walk_event_renew (self);
+  n_events = dfl_event_store_get_n_events (&self->store);
+  self->walking = TRUE;
+
+  for (i = 0; i < n_events; i++)
     {
-      DflEvent *event = self->events[i];
+      const gchar *event_type;
+      const DflEventParameterValue *values;
+      const guint8 *types;
+      guint n_parameters;
+      DflId id = DFL_ID_INVALID;
+      gboolean loaded = FALSE;
+
+      self->walk_position = i;
+
+      event_type = dfl_event_store_get_event_type_name (&self->store, i);
+      values = dfl_event_store_get_parameters (&self->store, i, &types,
+                                               &n_parameters);
+
+      /* FIXME: Having the ID hard-coded in index 0 is a bit icky. Read it
+       * straight from the store in the common case, and fall back to the
+       * event for its conversions and warnings otherwise (but only if any
+       * walkers could match on it). */
+      if (n_parameters > 0 && types[0] == DFL_PARAMETER_TYPE_ID)
+        id = values[0].id;
+      else if (n_parameters > 0 && self->n_id_walkers > 0)
+        {
+          walk_load_event (self, i, &loaded);
+          id = dfl_event_get_parameter_id (self->walk_event, 0);
+        }
+
+      walk_bucket (self, self->wildcard_walkers, i, &loaded);
 
-      for (j = 0; j < self->walkers->len; j++)
+      if (event_type != NULL)
         {
-          const DflEventSequenceWalkerClosure *closure;
-
-          closure = &g_array_index (self->walkers,
-                                    DflEventSequenceWalkerClosure, j);
-
-          /* Has the walker been removed? */
-          if (closure->walker == NULL)
-            continue;
-
-          /* FIXME: Having the ID hard-coded in index 0 is a bit icky. */
-          if ((closure->event_type == NULL ||
-               closure->event_type == dfl_event_get_event_type (event)) &&
-              (closure->id == DFL_ID_INVALID ||
-               closure->id == dfl_event_get_parameter_id (event, 0)))
-            {
-              closure->walker (self, event, closure->user_data);
-            }
+          walk_bucket (self,
+                       lookup_walker_bucket (self, event_type, DFL_ID_INVALID),
+                       i, &loaded);
+
+          if (id != DFL_ID_INVALID)
+            walk_bucket (self, lookup_walker_bucket (self, event_type, id),
+                         i, &loaded);
+        }
+
+      /* Free the walkers which were removed while handling this event. */
+      while (self->dirty_buckets->len > 0)
+        {
+          DflEventSequenceWalkerBucket *bucket;
+
+          bucket = g_ptr_array_index (self->dirty_buckets,
+                                      self->dirty_buckets->len - 1);
+          g_ptr_array_remove_index (self->dirty_buckets,
+                                    self->dirty_buckets->len - 1);
+          compact_walker_bucket (self, bucket);
         }
     }
+
+  self->walking = FALSE;
+
+  /* Walkers added during this walk should match from the start of the next
+   * one. */
+  g_hash_table_iter_init (&iter, self->walkers);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    ((DflEventSequenceWalkerClosure *) value)->first_event = 0;
+
+  g_clear_object (&self->walk_event);
 }
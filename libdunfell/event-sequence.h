@@ -41,6 +41,12 @@ DflEventSequence *dfl_event_sequence_new (const DflEvent **events,
                                           guint            n_events,
                                           DflTimestamp     initial_timestamp);
 
+void dfl_event_sequence_append (DflEventSequence  *self,
+                                const DflEvent   **events,
+                                guint              n_events);
+
+DflTimestamp dfl_event_sequence_get_initial_timestamp (DflEventSequence *self);
+
 /**
  * DflEventWalker:
  * @sequence: a #DflEventSequence
@@ -51,6 +57,9 @@ DflEventSequence *dfl_event_sequence_new (const DflEvent **events,
  * sequence, in order. The @user_data is as passed in to
  * dfl_event_sequence_add_walker().
  *
+ * @event may be reused for later events in the sequence once the walker
+ * returns, so it must not be kept; copy any fields which are needed later.
+ *
  * The sequence must not be modified while walking over it.
  *
  * Since: 0.1.0
@@ -35,6 +35,7 @@
 #include <string.h>
 
 #include "event.h"
+#include "event-private.h"
 
 
 static void dfl_event_get_property (GObject      *object,
@@ -45,6 +46,9 @@ static void dfl_event_set_property (GObject      *object,
                                     guint         property_id,
                                     const GValue *value,
                                     GParamSpec   *pspec);
+static void dfl_event_constructed  (GObject      *object);
+
+static gchar **event_get_parameter_strings (DflEvent *self);
 static void dfl_event_finalize     (GObject      *object);
 
 struct _DflEvent
@@ -52,9 +56,21 @@ struct _DflEvent
   GObject parent;
 
   const gchar *event_type;  /* unowned, interned */
+  DflEventType event_type_enum;
   DflTimestamp timestamp;
   DflThreadId thread_id;
-  gchar **parameters;  /* owned, null terminated */
+
+  /* Parameters are decoded according to the event type’s schema when the
+   * event is constructed, so that the getters don’t have to parse them each
+   * time. The string forms are only built if they are asked for. */
+  DflEventParameter *parameters;  /* owned; nullable if n_parameters is 0 */
+  guint n_parameters;
+  guint parameters_size;  /* allocated length of @parameters */
+  gchar **parameter_strings;  /* owned; nullable; null terminated; atomic */
+
+  /* Keeps the string parameters alive for events loaded from a
+   * #DflEventStore. */
+  DflStringTable *strings;  /* owned; nullable */
 };
 
 G_DEFINE_TYPE (DflEvent, dfl_event, G_TYPE_OBJECT)
@@ -74,6 +90,7 @@ dfl_event_class_init (DflEventClass *klass)
 
   object_class->get_property = dfl_event_get_property;
   object_class->set_property = dfl_event_set_property;
+  object_class->constructed = dfl_event_constructed;
   object_class->finalize = dfl_event_finalize;
 
   /**
@@ -167,7 +184,7 @@ dfl_event_get_property (GObject     *object,
       g_value_set_uint64 (value, self->thread_id);
       break;
     case PROP_PARAMETERS:
-      g_value_set_boxed (value, self->parameters);
+      g_value_set_boxed (value, event_get_parameter_strings (self));
       break;
     default:
       g_assert_not_reached ();
@@ -198,25 +215,434 @@ dfl_event_set_property (GObject           *object,
       self->thread_id = g_value_get_uint64 (value);
       break;
     case PROP_PARAMETERS:
-      /* Construct only. */
-      g_assert (self->parameters == NULL);
-      self->parameters = g_value_dup_boxed (value);
+      /* Construct only. The parameters are decoded in constructed(). */
+      g_assert (self->parameter_strings == NULL);
+      self->parameter_strings = g_value_dup_boxed (value);
       break;
     default:
       g_assert_not_reached ();
     }
 }
 
+/* Decode the nul-terminated @str into @parameter as the given @type. If that
+ * fails, it’s stored as a string instead, and the getters emit warnings if
+ * asked for it as another type, as they did before parameters were decoded
+ * up front. @str must outlive @parameter. */
+static void
+parameter_from_string (DflEventParameter *parameter,
+                       DflParameterType   type,
+                       const gchar       *str)
+{
+  gchar *end = NULL;
+
+  switch (type)
+    {
+    case DFL_PARAMETER_TYPE_ID:
+      errno = 0;
+      parameter->value.id = g_ascii_strtoull (str, &end, 10);
+
+      if (errno == 0 && end != str && *end == '\0')
+        {
+          parameter->type = DFL_PARAMETER_TYPE_ID;
+          return;
+        }
+      break;
+    case DFL_PARAMETER_TYPE_INT64:
+      errno = 0;
+      parameter->value.int64 = g_ascii_strtoll (str, &end, 10);
+
+      if (errno == 0 && end != str && *end == '\0')
+        {
+          parameter->type = DFL_PARAMETER_TYPE_INT64;
+          return;
+        }
+      break;
+    case DFL_PARAMETER_TYPE_STRING:
+    case DFL_PARAMETER_TYPE_BYTES:
+    default:
+      break;
+    }
+
+  parameter->type = g_utf8_validate (str, -1, NULL) ?
+                    DFL_PARAMETER_TYPE_STRING : DFL_PARAMETER_TYPE_BYTES;
+  parameter->value.string = str;
+}
+
+static void
+dfl_event_constructed (GObject *object)
+{
+  DflEvent *self = DFL_EVENT (object);
+  const DflEventTypeData *event_data;
+  guint i;
+
+  G_OBJECT_CLASS (dfl_event_parent_class)->constructed (object);
+
+  /* Constructed without properties, to be filled in by dfl_event_reset()? */
+  if (self->event_type == NULL)
+    return;
+
+  dfl_event_type_table_ensure ();
+
+  self->event_type_enum = dfl_event_type_from_name (self->event_type,
+                                                    strlen (self->event_type));
+  event_data = dfl_event_type_get_data (self->event_type_enum);
+
+  self->n_parameters = (self->parameter_strings != NULL) ?
+                       g_strv_length (self->parameter_strings) : 0;
+  self->parameters = g_new0 (DflEventParameter, self->n_parameters);
+  self->parameters_size = self->n_parameters;
+
+  /* Parameters which aren’t in the schema (for example, if the event type is
+   * unknown) are stored as strings. */
+  for (i = 0; i < self->n_parameters; i++)
+    parameter_from_string (&self->parameters[i],
+                           (event_data != NULL && i < event_data->n_parameters) ?
+                           event_data->parameter_types[i] :
+                           DFL_PARAMETER_TYPE_STRING,
+                           self->parameter_strings[i]);
+}
+
 static void
 dfl_event_finalize (GObject *object)
 {
   DflEvent *self = DFL_EVENT (object);
 
-  g_strfreev (self->parameters);
+  g_free (self->parameters);
+  g_strfreev (self->parameter_strings);
+  g_clear_pointer (&self->strings, dfl_string_table_unref);
 
   G_OBJECT_CLASS (dfl_event_parent_class)->finalize (object);
 }
 
+struct _DflStringTable
+{
+  gint ref_count;  /* atomic */
+  GMutex lock;  /* protects the members below */
+  GStringChunk *chunk;  /* owned */
+  GHashTable/*<unowned utf8, guint>*/ *indices;  /* owned */
+  GPtrArray/*<unowned utf8>*/ *strings;  /* owned */
+};
+
+/*
+ * dfl_string_table_new:
+ *
+ * Create a new, empty #DflStringTable.
+ *
+ * Returns: (transfer full): a new #DflStringTable
+ */
+DflStringTable *
+dfl_string_table_new (void)
+{
+  DflStringTable *table = NULL;
+
+  table = g_new0 (DflStringTable, 1);
+  table->ref_count = 1;
+  g_mutex_init (&table->lock);
+  table->chunk = g_string_chunk_new (4096);
+  table->indices = g_hash_table_new (g_str_hash, g_str_equal);
+  table->strings = g_ptr_array_new ();
+
+  return table;
+}
+
+/*
+ * dfl_string_table_ref:
+ * @table: a #DflStringTable
+ *
+ * Add a reference to @table.
+ *
+ * Returns: (transfer full): @table
+ */
+DflStringTable *
+dfl_string_table_ref (DflStringTable *table)
+{
+  g_atomic_int_inc (&table->ref_count);
+
+  return table;
+}
+
+/*
+ * dfl_string_table_unref:
+ * @table: (transfer full): a #DflStringTable
+ *
+ * Remove a reference from @table, freeing it and all its strings if this was
+ * the last one.
+ */
+void
+dfl_string_table_unref (DflStringTable *table)
+{
+  if (!g_atomic_int_dec_and_test (&table->ref_count))
+    return;
+
+  g_ptr_array_unref (table->strings);
+  g_hash_table_unref (table->indices);
+  g_string_chunk_free (table->chunk);
+  g_mutex_clear (&table->lock);
+  g_free (table);
+}
+
+/*
+ * dfl_string_table_intern:
+ * @table: a #DflStringTable
+ * @str: a nul-terminated string
+ *
+ * Intern @str in @table, copying it if it’s not already there. Unlike
+ * g_intern_string(), only the lock for @table is taken, and the string is
+ * freed along with @table.
+ *
+ * Returns: (transfer none): the copy of @str in @table
+ */
+const gchar *
+dfl_string_table_intern (DflStringTable *table,
+                         const gchar    *str)
+{
+  gpointer interned;
+
+  g_mutex_lock (&table->lock);
+
+  if (!g_hash_table_lookup_extended (table->indices, str, &interned, NULL))
+    {
+      interned = g_string_chunk_insert (table->chunk, str);
+      g_hash_table_insert (table->indices, interned,
+                           GUINT_TO_POINTER (table->strings->len));
+      g_ptr_array_add (table->strings, interned);
+    }
+
+  g_mutex_unlock (&table->lock);
+
+  return interned;
+}
+
+/*
+ * dfl_string_table_get_n_strings:
+ * @table: a #DflStringTable
+ *
+ * Get the number of strings interned in @table so far.
+ *
+ * Returns: number of strings
+ */
+guint
+dfl_string_table_get_n_strings (DflStringTable *table)
+{
+  guint n_strings;
+
+  g_mutex_lock (&table->lock);
+  n_strings = table->strings->len;
+  g_mutex_unlock (&table->lock);
+
+  return n_strings;
+}
+
+/*
+ * dfl_string_table_get_string:
+ * @table: a #DflStringTable
+ * @index: index of the string, in the order the strings were interned
+ *
+ * Get the string at @index in @table.
+ *
+ * Returns: (transfer none): the interned string
+ */
+const gchar *
+dfl_string_table_get_string (DflStringTable *table,
+                             guint           index)
+{
+  const gchar *str;
+
+  g_mutex_lock (&table->lock);
+  g_assert (index < table->strings->len);
+  str = table->strings->pdata[index];
+  g_mutex_unlock (&table->lock);
+
+  return str;
+}
+
+/*
+ * dfl_string_table_lookup_index:
+ * @table: a #DflStringTable
+ * @str: a nul-terminated string
+ * @index: (out): return location for the index of @str
+ *
+ * Look up the index of @str in @table, by value.
+ *
+ * Returns: %TRUE if @str is in @table, %FALSE otherwise
+ */
+gboolean
+dfl_string_table_lookup_index (DflStringTable *table,
+                               const gchar    *str,
+                               guint          *index)
+{
+  gpointer value;
+  gboolean found;
+
+  g_mutex_lock (&table->lock);
+  found = g_hash_table_lookup_extended (table->indices, str, NULL, &value);
+  g_mutex_unlock (&table->lock);
+
+  if (found)
+    *index = GPOINTER_TO_UINT (value);
+
+  return found;
+}
+
+#define EVENT_TYPE_DATA(type, name, parameter_types) \
+  [type] = { name, sizeof (name) - 1, \
+             parameter_types, sizeof (parameter_types) - 1, NULL }
+
+/* Schemas for all the known event types, indexed by #DflEventType. The
+ * @interned_name fields are filled in by dfl_event_type_table_ensure(). */
+static DflEventTypeData event_type_array[] =
+{
+  [DFL_EVENT_TYPE_UNKNOWN] = { NULL, 0, "", 0, NULL },
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_NEW, "g_main_context_new", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_ACQUIRE, "g_main_context_acquire", "ii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_RELEASE, "g_main_context_release", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_FREE, "g_main_context_free", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_DISPATCH, "g_main_context_before_dispatch", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_DISPATCH, "g_main_context_after_dispatch", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_NEW, "g_source_new", "issssi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_BEFORE_FREE, "g_source_before_free", "iis"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_BEFORE_DISPATCH, "g_source_before_dispatch", "issi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_AFTER_DISPATCH, "g_source_after_dispatch", "isi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_SET_NAME, "g_source_set_name", "is"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_ADD_CHILD_SOURCE, "g_source_add_child_source", "ii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_ATTACH, "g_source_attach", "iii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_DESTROY, "g_source_destroy", "ii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_THREAD_SPAWNED, "g_thread_spawned", "iis"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_NEW, "g_task_new", "iiisi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_SET_SOURCE_TAG, "g_task_set_source_tag", "is"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_BEFORE_RETURN, "g_task_before_return", "iisi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_PROPAGATE, "g_task_propagate", "ii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_BEFORE_RUN_IN_THREAD, "g_task_before_run_in_thread", "is"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_TASK_AFTER_RUN_IN_THREAD, "g_task_after_run_in_thread", "ii"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_PREPARE, "g_main_context_before_prepare", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_PREPARE, "g_main_context_after_prepare", "inn"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_QUERY, "g_main_context_before_query", "in"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_QUERY, "g_main_context_after_query", "inn"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_CHECK, "g_main_context_before_check", "inn"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_CHECK, "g_main_context_after_check", "in"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_AFTER_PREPARE, "g_source_after_prepare", "isn"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_AFTER_CHECK, "g_source_after_check", "isi"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP, "g_main_context_wakeup", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP_ACKNOWLEDGE, "g_main_context_wakeup_acknowledge", "i"),
+  EVENT_TYPE_DATA (DFL_EVENT_TYPE_G_SOURCE_SET_READY_TIME, "g_source_set_ready_time", "in"),
+};
+
+/* Open-addressed hash table mapping event type names to #DflEventType, built
+ * once from event_type_array by dfl_event_type_table_ensure(). This means the
+ * parser doesn’t need to take the string interning lock or do a linear search
+ * for each line. Zero entries in the table are empty. The table size must be a
+ * power of two, and is kept to at least twice the number of event types so
+ * that probe sequences are short. */
+#define EVENT_TYPE_TABLE_SIZE 128
+G_STATIC_ASSERT (EVENT_TYPE_TABLE_SIZE >= 2 * G_N_ELEMENTS (event_type_array));
+
+static guint8 event_type_table[EVENT_TYPE_TABLE_SIZE];
+
+/* The event types share long prefixes, so hash their length and last few
+ * characters. */
+static inline guint
+event_type_hash (const gchar *name,
+                 gsize        length)
+{
+  if (length < 3)
+    return length;
+
+  return (length * 31 +
+          (guchar) name[length - 1] * 7 +
+          (guchar) name[length - 2] * 3 +
+          (guchar) name[length - 3]);
+}
+
+/*
+ * dfl_event_type_table_ensure:
+ *
+ * Build the lookup table used by dfl_event_type_from_name(), and intern the
+ * event type names. This must be called before any of the other
+ * dfl_event_type_*() functions. It is thread safe, and cheap to call again.
+ */
+void
+dfl_event_type_table_ensure (void)
+{
+  static gsize initialised = 0;
+  guint i;
+
+  if (!g_once_init_enter (&initialised))
+    return;
+
+  for (i = DFL_EVENT_TYPE_UNKNOWN + 1; i < G_N_ELEMENTS (event_type_array); i++)
+    {
+      DflEventTypeData *data = &event_type_array[i];
+      guint slot;
+
+      g_assert (data->n_parameters <= DFL_EVENT_MAX_PARAMETERS);
+
+      data->interned_name = g_intern_static_string (data->name);
+
+      for (slot = event_type_hash (data->name, data->name_length) &
+                  (EVENT_TYPE_TABLE_SIZE - 1);
+           event_type_table[slot] != DFL_EVENT_TYPE_UNKNOWN;
+           slot = (slot + 1) & (EVENT_TYPE_TABLE_SIZE - 1));
+
+      event_type_table[slot] = i;
+    }
+
+  g_once_init_leave (&initialised, 1);
+}
+
+/*
+ * dfl_event_type_get_data:
+ * @event_type: an event type
+ *
+ * Get the schema for @event_type. If @event_type is not known (for example,
+ * because it came from a binary log written by a newer version of Dunfell),
+ * %NULL is returned.
+ *
+ * Returns: (nullable): schema for the event type
+ */
+const DflEventTypeData *
+dfl_event_type_get_data (DflEventType event_type)
+{
+  if (event_type == DFL_EVENT_TYPE_UNKNOWN ||
+      (guint) event_type >= G_N_ELEMENTS (event_type_array))
+    return NULL;
+
+  return &event_type_array[event_type];
+}
+
+/*
+ * dfl_event_type_from_name:
+ * @name: (array length=length): event type name; not necessarily
+ *    nul-terminated
+ * @length: length of @name in bytes
+ *
+ * Look up the type of an event by its name. The only string comparison is a
+ * memcmp() with the single candidate name which matches the hash (or very
+ * occasionally, a few candidates); this is needed to reject unknown event
+ * types.
+ *
+ * Returns: the event type, or %DFL_EVENT_TYPE_UNKNOWN if it’s not known
+ */
+DflEventType
+dfl_event_type_from_name (const gchar *name,
+                          gsize        length)
+{
+  guint slot;
+  DflEventType candidate;
+
+  for (slot = event_type_hash (name, length) & (EVENT_TYPE_TABLE_SIZE - 1);
+       (candidate = event_type_table[slot]) != DFL_EVENT_TYPE_UNKNOWN;
+       slot = (slot + 1) & (EVENT_TYPE_TABLE_SIZE - 1))
+    {
+      const DflEventTypeData *data = &event_type_array[candidate];
+
+      if (data->name_length == length &&
+          memcmp (data->name, name, length) == 0)
+        return candidate;
+    }
+
+  return DFL_EVENT_TYPE_UNKNOWN;
+}
+
 /**
  * dfl_event_new:
  * @event_type: event type
@@ -246,6 +672,159 @@ dfl_event_new (const gchar         *event_type,
                        NULL);
 }
 
+/*
+ * dfl_event_reset:
+ * @self: a #DflEvent
+ * @event_type: (nullable): interned event type name
+ * @event_type_enum: the event type, or %DFL_EVENT_TYPE_UNKNOWN
+ * @timestamp: timestamp when the event happened
+ * @thread_id: ID of the thread the event happened in
+ * @parameter_types: (array length=n_parameters): #DflParameterType of each
+ *    parameter
+ * @parameter_values: (array length=n_parameters): decoded parameter values;
+ *    any strings must be interned in @strings
+ * @n_parameters: number of parameters
+ * @strings: (nullable): string table holding the string parameters, which the
+ *    event keeps a reference to
+ *
+ * Overwrite the contents of @self with the given event. This is used by
+ * #DflEventSequence to create #DflEvent wrappers around its columnar storage
+ * on demand, and to reuse a single wrapper while walking over the sequence.
+ * It must only be called on events which nothing else holds a reference to.
+ */
+void
+dfl_event_reset (DflEvent                     *self,
+                 const gchar                  *event_type,
+                 DflEventType                  event_type_enum,
+                 DflTimestamp                  timestamp,
+                 DflThreadId                   thread_id,
+                 const guint8                 *parameter_types,
+                 const DflEventParameterValue *parameter_values,
+                 guint                         n_parameters,
+                 DflStringTable               *strings)
+{
+  guint i;
+
+  g_return_if_fail (DFL_IS_EVENT (self));
+  g_return_if_fail (n_parameters == 0 ||
+                    (parameter_types != NULL && parameter_values != NULL));
+
+  self->event_type = event_type;
+  self->event_type_enum = event_type_enum;
+  self->timestamp = timestamp;
+  self->thread_id = thread_id;
+
+  /* Reuse the parameters array if it’s big enough. */
+  if (n_parameters > self->parameters_size)
+    {
+      g_free (self->parameters);
+      self->parameters = g_new (DflEventParameter, n_parameters);
+      self->parameters_size = n_parameters;
+    }
+
+  for (i = 0; i < n_parameters; i++)
+    {
+      self->parameters[i].type = parameter_types[i];
+      self->parameters[i].value = parameter_values[i];
+    }
+
+  self->n_parameters = n_parameters;
+
+  g_clear_pointer (&self->parameter_strings, g_strfreev);
+
+  /* The walk reuses one event for a whole sequence, so this rarely changes. */
+  if (self->strings != strings)
+    {
+      g_clear_pointer (&self->strings, dfl_string_table_unref);
+      self->strings = (strings != NULL) ? dfl_string_table_ref (strings) : NULL;
+    }
+}
+
+/*
+ * dfl_event_get_event_type_enum:
+ * @self: a #DflEvent
+ *
+ * Get the type of the event as a #DflEventType, rather than as a string.
+ *
+ * Returns: the event type, or %DFL_EVENT_TYPE_UNKNOWN if it’s not known
+ */
+DflEventType
+dfl_event_get_event_type_enum (DflEvent *self)
+{
+  g_return_val_if_fail (DFL_IS_EVENT (self), DFL_EVENT_TYPE_UNKNOWN);
+
+  return self->event_type_enum;
+}
+
+/*
+ * dfl_event_get_parameters:
+ * @self: a #DflEvent
+ * @n_parameters: (out): return location for the number of parameters
+ *
+ * Get the decoded parameters of the event.
+ *
+ * Returns: (array length=n_parameters) (transfer none): the parameters
+ */
+const DflEventParameter *
+dfl_event_get_parameters (DflEvent *self,
+                          guint    *n_parameters)
+{
+  g_return_val_if_fail (DFL_IS_EVENT (self), NULL);
+  g_return_val_if_fail (n_parameters != NULL, NULL);
+
+  *n_parameters = self->n_parameters;
+
+  return self->parameters;
+}
+
+/* Get the parameters formatted as strings, building them on first use. This
+ * may race with other threads, in which case one copy is thrown away. */
+static gchar **
+event_get_parameter_strings (DflEvent *self)
+{
+  gchar **parameter_strings;
+  guint i;
+
+  parameter_strings = g_atomic_pointer_get (&self->parameter_strings);
+
+  if (parameter_strings != NULL)
+    return parameter_strings;
+
+  parameter_strings = g_new0 (gchar *, self->n_parameters + 1);
+
+  for (i = 0; i < self->n_parameters; i++)
+    {
+      const DflEventParameter *parameter = &self->parameters[i];
+
+      switch (parameter->type)
+        {
+        case DFL_PARAMETER_TYPE_ID:
+          parameter_strings[i] = g_strdup_printf ("%" G_GUINT64_FORMAT,
+                                                  parameter->value.id);
+          break;
+        case DFL_PARAMETER_TYPE_INT64:
+          parameter_strings[i] = g_strdup_printf ("%" G_GINT64_FORMAT,
+                                                  parameter->value.int64);
+          break;
+        case DFL_PARAMETER_TYPE_STRING:
+        case DFL_PARAMETER_TYPE_BYTES:
+          parameter_strings[i] = g_strdup (parameter->value.string);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  if (!g_atomic_pointer_compare_and_exchange (&self->parameter_strings, NULL,
+                                              parameter_strings))
+    {
+      g_strfreev (parameter_strings);
+      parameter_strings = g_atomic_pointer_get (&self->parameter_strings);
+    }
+
+  return parameter_strings;
+}
+
 /**
  * dfl_event_get_event_type:
  * @self: a #DflEvent
@@ -313,33 +892,36 @@ DflId
 dfl_event_get_parameter_id (DflEvent *self,
                             guint     parameter_index)
 {
-  gsize i;
+  const DflEventParameter *parameter;
+  guint64 retval;
+  const gchar *end;
 
   g_return_val_if_fail (DFL_IS_EVENT (self), DFL_ID_INVALID);
+  g_return_val_if_fail (parameter_index < self->n_parameters, DFL_ID_INVALID);
 
-  for (i = 0; self->parameters[i] != NULL; i++)
-    {
-      if (i == parameter_index)
-        {
-          guint64 retval;
-          const gchar *end;
-
-          retval = g_ascii_strtoull (self->parameters[i], (gchar **) &end, 10);
-
-          if (errno == ERANGE || end == self->parameters[i] || *end != '\0')
-            g_warning ("Event parameter ‘%s’ cannot be interpreted as an ID.",
-                       self->parameters[i]);
+  parameter = &self->parameters[parameter_index];
 
-          return retval;
-        }
+  switch (parameter->type)
+    {
+    case DFL_PARAMETER_TYPE_ID:
+      return parameter->value.id;
+    case DFL_PARAMETER_TYPE_INT64:
+      return (DflId) parameter->value.int64;
+    case DFL_PARAMETER_TYPE_STRING:
+    case DFL_PARAMETER_TYPE_BYTES:
+      /* The parameter couldn’t be decoded as an ID when the event was
+       * constructed, so this will almost certainly fail. */
+      errno = 0;
+      retval = g_ascii_strtoull (parameter->value.string, (gchar **) &end, 10);
+
+      if (errno == ERANGE || end == parameter->value.string || *end != '\0')
+        g_warning ("Event parameter ‘%s’ cannot be interpreted as an ID.",
+                   parameter->value.string);
+
+      return retval;
+    default:
+      g_assert_not_reached ();
     }
-
-  /* Invalid @parameter_index. This check will always be hit if this code is
-   * reached, as the check is actually performed more efficiently in the loop
-   * above. */
-  g_return_val_if_fail (parameter_index < g_strv_length (self->parameters),
-                        DFL_ID_INVALID);
-  return DFL_ID_INVALID;
 }
 
 /**
@@ -356,31 +938,28 @@ const gchar *
 dfl_event_get_parameter_utf8 (DflEvent *self,
                               guint     parameter_index)
 {
-  gsize i;
+  const DflEventParameter *parameter;
 
   g_return_val_if_fail (DFL_IS_EVENT (self), NULL);
+  g_return_val_if_fail (parameter_index < self->n_parameters, NULL);
+
+  parameter = &self->parameters[parameter_index];
 
-  for (i = 0; self->parameters[i] != NULL; i++)
+  switch (parameter->type)
     {
-      if (i == parameter_index)
-        {
-          if (!g_utf8_validate (self->parameters[i], -1, NULL))
-            {
-              g_warning ("Event parameter %" G_GSIZE_FORMAT " cannot be "
-                         "interpreted as UTF-8.", i);
-              return NULL;
-            }
-
-          return self->parameters[i];
-        }
+    case DFL_PARAMETER_TYPE_STRING:
+      /* Validated when the event was constructed. */
+      return parameter->value.string;
+    case DFL_PARAMETER_TYPE_BYTES:
+      g_warning ("Event parameter %u cannot be interpreted as UTF-8.",
+                 parameter_index);
+      return NULL;
+    case DFL_PARAMETER_TYPE_ID:
+    case DFL_PARAMETER_TYPE_INT64:
+      return event_get_parameter_strings (self)[parameter_index];
+    default:
+      g_assert_not_reached ();
     }
-
-  /* Invalid @parameter_index. This check will always be hit if this code is
-   * reached, as the check is actually performed more efficiently in the loop
-   * above. */
-  g_return_val_if_fail (parameter_index < g_strv_length (self->parameters),
-                        NULL);
-  return NULL;
 }
 
 /**
@@ -397,31 +976,36 @@ gint64
 dfl_event_get_parameter_int64 (DflEvent *self,
                                guint     parameter_index)
 {
-  gsize i;
+  const DflEventParameter *parameter;
+  gint64 retval;
+  const gchar *end;
 
   g_return_val_if_fail (DFL_IS_EVENT (self), 0);
+  g_return_val_if_fail (parameter_index < self->n_parameters, 0);
 
-  for (i = 0; self->parameters[i] != NULL; i++)
-    {
-      if (i == parameter_index)
-        {
-          gint64 retval;
-          const gchar *end;
-
-          retval = g_ascii_strtoll (self->parameters[i], (gchar **) &end, 10);
+  parameter = &self->parameters[parameter_index];
 
-          if (errno == ERANGE || end == self->parameters[i] || *end != '\0')
-            g_warning ("Event parameter ‘%s’ cannot be interpreted as an int64.",
-                       self->parameters[i]);
-
-          return retval;
-        }
+  switch (parameter->type)
+    {
+    case DFL_PARAMETER_TYPE_INT64:
+      return parameter->value.int64;
+    case DFL_PARAMETER_TYPE_ID:
+      if (parameter->value.id > G_MAXINT64)
+        g_warning ("Event parameter ‘%" G_GUINT64_FORMAT "’ cannot be "
+                   "interpreted as an int64.", parameter->value.id);
+
+      return (gint64) parameter->value.id;
+    case DFL_PARAMETER_TYPE_STRING:
+    case DFL_PARAMETER_TYPE_BYTES:
+      errno = 0;
+      retval = g_ascii_strtoll (parameter->value.string, (gchar **) &end, 10);
+
+      if (errno == ERANGE || end == parameter->value.string || *end != '\0')
+        g_warning ("Event parameter ‘%s’ cannot be interpreted as an int64.",
+                   parameter->value.string);
+
+      return retval;
+    default:
+      g_assert_not_reached ();
     }
-
-  /* Invalid @parameter_index. This check will always be hit if this code is
-   * reached, as the check is actually performed more efficiently in the loop
-   * above. */
-  g_return_val_if_fail (parameter_index < g_strv_length (self->parameters),
-                        DFL_ID_INVALID);
-  return DFL_ID_INVALID;
 }
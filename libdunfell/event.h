@@ -27,6 +27,98 @@
 
 G_BEGIN_DECLS
 
+/**
+ * DflEventType:
+ * @DFL_EVENT_TYPE_UNKNOWN: An event type not recognised by the parser.
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_NEW: `g_main_context_new`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_ACQUIRE: `g_main_context_acquire`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_RELEASE: `g_main_context_release`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_FREE: `g_main_context_free`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_DISPATCH: `g_main_context_before_dispatch`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_DISPATCH: `g_main_context_after_dispatch`
+ * @DFL_EVENT_TYPE_G_SOURCE_NEW: `g_source_new`
+ * @DFL_EVENT_TYPE_G_SOURCE_BEFORE_FREE: `g_source_before_free`
+ * @DFL_EVENT_TYPE_G_SOURCE_BEFORE_DISPATCH: `g_source_before_dispatch`
+ * @DFL_EVENT_TYPE_G_SOURCE_AFTER_DISPATCH: `g_source_after_dispatch`
+ * @DFL_EVENT_TYPE_G_SOURCE_SET_NAME: `g_source_set_name`
+ * @DFL_EVENT_TYPE_G_SOURCE_ADD_CHILD_SOURCE: `g_source_add_child_source`
+ * @DFL_EVENT_TYPE_G_SOURCE_ATTACH: `g_source_attach`
+ * @DFL_EVENT_TYPE_G_SOURCE_DESTROY: `g_source_destroy`
+ * @DFL_EVENT_TYPE_G_THREAD_SPAWNED: `g_thread_spawned`
+ * @DFL_EVENT_TYPE_G_TASK_NEW: `g_task_new`
+ * @DFL_EVENT_TYPE_G_TASK_SET_SOURCE_TAG: `g_task_set_source_tag`
+ * @DFL_EVENT_TYPE_G_TASK_BEFORE_RETURN: `g_task_before_return`
+ * @DFL_EVENT_TYPE_G_TASK_PROPAGATE: `g_task_propagate`
+ * @DFL_EVENT_TYPE_G_TASK_BEFORE_RUN_IN_THREAD: `g_task_before_run_in_thread`
+ * @DFL_EVENT_TYPE_G_TASK_AFTER_RUN_IN_THREAD: `g_task_after_run_in_thread`
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_PREPARE: `g_main_context_before_prepare`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_PREPARE: `g_main_context_after_prepare`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_QUERY: `g_main_context_before_query`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_QUERY: `g_main_context_after_query`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_CHECK: `g_main_context_before_check`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_CHECK: `g_main_context_after_check`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_SOURCE_AFTER_PREPARE: `g_source_after_prepare`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_SOURCE_AFTER_CHECK: `g_source_after_check`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP: `g_main_context_wakeup`
+ *    (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP_ACKNOWLEDGE:
+ *    `g_main_context_wakeup_acknowledge` (Since: UNRELEASED)
+ * @DFL_EVENT_TYPE_G_SOURCE_SET_READY_TIME: `g_source_set_ready_time`
+ *    (Since: UNRELEASED)
+ *
+ * The types of event which can appear in a log, each corresponding to a probe
+ * point in GLib.
+ *
+ * These values are stored in binary logs, so new event types must only ever
+ * be appended.
+ *
+ * Since: UNRELEASED
+ */
+typedef enum
+{
+  DFL_EVENT_TYPE_UNKNOWN = 0,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_NEW,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_ACQUIRE,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_RELEASE,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_FREE,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_DISPATCH,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_DISPATCH,
+  DFL_EVENT_TYPE_G_SOURCE_NEW,
+  DFL_EVENT_TYPE_G_SOURCE_BEFORE_FREE,
+  DFL_EVENT_TYPE_G_SOURCE_BEFORE_DISPATCH,
+  DFL_EVENT_TYPE_G_SOURCE_AFTER_DISPATCH,
+  DFL_EVENT_TYPE_G_SOURCE_SET_NAME,
+  DFL_EVENT_TYPE_G_SOURCE_ADD_CHILD_SOURCE,
+  DFL_EVENT_TYPE_G_SOURCE_ATTACH,
+  DFL_EVENT_TYPE_G_SOURCE_DESTROY,
+  DFL_EVENT_TYPE_G_THREAD_SPAWNED,
+  DFL_EVENT_TYPE_G_TASK_NEW,
+  DFL_EVENT_TYPE_G_TASK_SET_SOURCE_TAG,
+  DFL_EVENT_TYPE_G_TASK_BEFORE_RETURN,
+  DFL_EVENT_TYPE_G_TASK_PROPAGATE,
+  DFL_EVENT_TYPE_G_TASK_BEFORE_RUN_IN_THREAD,
+  DFL_EVENT_TYPE_G_TASK_AFTER_RUN_IN_THREAD,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_PREPARE,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_PREPARE,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_QUERY,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_QUERY,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_BEFORE_CHECK,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_AFTER_CHECK,
+  DFL_EVENT_TYPE_G_SOURCE_AFTER_PREPARE,
+  DFL_EVENT_TYPE_G_SOURCE_AFTER_CHECK,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP,
+  DFL_EVENT_TYPE_G_MAIN_CONTEXT_WAKEUP_ACKNOWLEDGE,
+  DFL_EVENT_TYPE_G_SOURCE_SET_READY_TIME,
+} DflEventType;
+
 /**
  * DflEvent:
  *
@@ -0,0 +1,401 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2015, 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:histogram
+ * @short_description: bounded-memory histogram of durations
+ * @stability: Unstable
+ * @include: libdunfell/histogram.h
+ *
+ * A #DflHistogram counts non-negative durations in log-linear buckets, in the
+ * style of an HDR histogram. Durations below 64 are counted exactly; above
+ * that, each power of two is split into 32 equally sized buckets, so any
+ * recorded duration is represented to within about 3% of its true value.
+ *
+ * Memory use is bounded by the number of buckets (1888 in the worst case), and
+ * in practice only the range of buckets between the smallest and largest
+ * recorded durations is allocated. Percentile queries scan the buckets, so
+ * take time bounded by that number, independent of how many durations have
+ * been recorded.
+ *
+ * Since: UNRELEASED
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <string.h>
+
+#include "histogram.h"
+
+
+/* Durations below SUB_BUCKET_COUNT each get their own bucket. Each larger
+ * power of two gets SUB_BUCKET_HALF_COUNT buckets. */
+#define SUB_BUCKET_BITS 6
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+#define SUB_BUCKET_HALF_COUNT (SUB_BUCKET_COUNT / 2)
+/* Enough to cover every value up to G_MAXINT64. */
+#define N_BUCKETS (SUB_BUCKET_COUNT + \
+                   (63 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF_COUNT)
+
+struct _DflHistogram
+{
+  guint64 n_values;
+  DflDuration min_value;  /* G_MAXINT64 if @n_values is 0 */
+  DflDuration max_value;  /* 0 if @n_values is 0 */
+
+  /* Counts for buckets [@first_bucket, @first_bucket + @n_buckets). */
+  guint first_bucket;
+  guint n_buckets;
+  guint64 *counts;  /* owned; nullable */
+};
+
+G_DEFINE_BOXED_TYPE (DflHistogram, dfl_histogram,
+                     dfl_histogram_copy, dfl_histogram_free)
+
+/* Like g_bit_storage(), but for 64-bit values on all platforms. */
+static guint
+bit_storage64 (guint64 value)
+{
+  if (value >> 32 != 0)
+    return 32 + g_bit_storage ((gulong) (value >> 32));
+  else
+    return g_bit_storage ((gulong) value);
+}
+
+static guint
+value_to_bucket (DflDuration value)
+{
+  guint shift;
+
+  g_assert (value >= 0);
+
+  if (value < SUB_BUCKET_COUNT)
+    return value;
+
+  shift = bit_storage64 (value) - SUB_BUCKET_BITS;
+
+  return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF_COUNT +
+         ((value >> shift) - SUB_BUCKET_HALF_COUNT);
+}
+
+/* Get the largest value which is counted in the given bucket. */
+static DflDuration
+bucket_get_highest_value (guint bucket)
+{
+  guint shift;
+  guint64 sub_bucket;
+
+  g_assert (bucket < N_BUCKETS);
+
+  if (bucket < SUB_BUCKET_COUNT)
+    return bucket;
+
+  shift = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF_COUNT + 1;
+  sub_bucket = (bucket - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF_COUNT +
+               SUB_BUCKET_HALF_COUNT;
+
+  return (DflDuration) (((sub_bucket + 1) << shift) - 1);
+}
+
+/* Extend the allocated range of buckets to include @bucket, and return a
+ * pointer to its count. */
+static guint64 *
+dfl_histogram_ensure_bucket (DflHistogram *self,
+                             guint         bucket)
+{
+  g_assert (bucket < N_BUCKETS);
+
+  if (self->counts == NULL)
+    {
+      self->first_bucket = bucket;
+      self->n_buckets = 1;
+      self->counts = g_new0 (guint64, 1);
+    }
+  else if (bucket < self->first_bucket)
+    {
+      guint64 *new_counts;
+      guint n_new_buckets;
+
+      n_new_buckets = self->first_bucket - bucket;
+      new_counts = g_new0 (guint64, self->n_buckets + n_new_buckets);
+      memcpy (new_counts + n_new_buckets, self->counts,
+              self->n_buckets * sizeof (*self->counts));
+
+      g_free (self->counts);
+      self->counts = new_counts;
+      self->first_bucket = bucket;
+      self->n_buckets += n_new_buckets;
+    }
+  else if (bucket >= self->first_bucket + self->n_buckets)
+    {
+      guint new_n_buckets;
+
+      new_n_buckets = bucket - self->first_bucket + 1;
+      self->counts = g_renew (guint64, self->counts, new_n_buckets);
+      memset (self->counts + self->n_buckets, 0,
+              (new_n_buckets - self->n_buckets) * sizeof (*self->counts));
+      self->n_buckets = new_n_buckets;
+    }
+
+  return &self->counts[bucket - self->first_bucket];
+}
+
+/**
+ * dfl_histogram_new:
+ *
+ * Create a new, empty #DflHistogram.
+ *
+ * Returns: (transfer full): a new #DflHistogram
+ * Since: UNRELEASED
+ */
+DflHistogram *
+dfl_histogram_new (void)
+{
+  DflHistogram *self;
+
+  self = g_new0 (DflHistogram, 1);
+  self->min_value = G_MAXINT64;
+
+  return self;
+}
+
+/**
+ * dfl_histogram_copy:
+ * @self: a #DflHistogram
+ *
+ * Copy a #DflHistogram.
+ *
+ * Returns: (transfer full): a copy of @self
+ * Since: UNRELEASED
+ */
+DflHistogram *
+dfl_histogram_copy (const DflHistogram *self)
+{
+  DflHistogram *copy;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  copy = g_new0 (DflHistogram, 1);
+  *copy = *self;
+
+  if (self->counts != NULL)
+    {
+      copy->counts = g_new (guint64, self->n_buckets);
+      memcpy (copy->counts, self->counts,
+              self->n_buckets * sizeof (*self->counts));
+    }
+
+  return copy;
+}
+
+/**
+ * dfl_histogram_free:
+ * @self: (transfer full): a #DflHistogram
+ *
+ * Free a #DflHistogram.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_histogram_free (DflHistogram *self)
+{
+  g_return_if_fail (self != NULL);
+
+  g_free (self->counts);
+  g_free (self);
+}
+
+/**
+ * dfl_histogram_record:
+ * @self: a #DflHistogram
+ * @value: duration to record; must be non-negative
+ *
+ * Add @value to the histogram.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_histogram_record (DflHistogram *self,
+                      DflDuration   value)
+{
+  guint64 *count;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (value >= 0);
+
+  count = dfl_histogram_ensure_bucket (self, value_to_bucket (value));
+  *count += 1;
+
+  self->n_values++;
+  self->min_value = MIN (self->min_value, value);
+  self->max_value = MAX (self->max_value, value);
+}
+
+/**
+ * dfl_histogram_merge:
+ * @self: a #DflHistogram
+ * @other: another #DflHistogram
+ *
+ * Add all the values recorded in @other to @self. @other is not modified.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_histogram_merge (DflHistogram       *self,
+                     const DflHistogram *other)
+{
+  guint i;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (other != NULL);
+  g_return_if_fail (self != other);
+
+  if (other->n_values == 0)
+    return;
+
+  /* Ensure the extremes first so the range is only extended twice. */
+  dfl_histogram_ensure_bucket (self, other->first_bucket);
+  dfl_histogram_ensure_bucket (self,
+                               other->first_bucket + other->n_buckets - 1);
+
+  for (i = 0; i < other->n_buckets; i++)
+    self->counts[other->first_bucket + i - self->first_bucket] +=
+      other->counts[i];
+
+  self->n_values += other->n_values;
+  self->min_value = MIN (self->min_value, other->min_value);
+  self->max_value = MAX (self->max_value, other->max_value);
+}
+
+/**
+ * dfl_histogram_get_n_values:
+ * @self: a #DflHistogram
+ *
+ * Get the number of values recorded in the histogram.
+ *
+ * Returns: number of recorded values
+ * Since: UNRELEASED
+ */
+guint64
+dfl_histogram_get_n_values (const DflHistogram *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->n_values;
+}
+
+/**
+ * dfl_histogram_get_min:
+ * @self: a #DflHistogram
+ *
+ * Get the smallest value recorded in the histogram. This is exact.
+ *
+ * Returns: smallest recorded value, or 0 if the histogram is empty
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_histogram_get_min (const DflHistogram *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return (self->n_values > 0) ? self->min_value : 0;
+}
+
+/**
+ * dfl_histogram_get_max:
+ * @self: a #DflHistogram
+ *
+ * Get the largest value recorded in the histogram. This is exact.
+ *
+ * Returns: largest recorded value, or 0 if the histogram is empty
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_histogram_get_max (const DflHistogram *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
+
+  return self->max_value;
+}
+
+/**
+ * dfl_histogram_get_percentile:
+ * @self: a #DflHistogram
+ * @percentile: percentile to query, between 0.0 and 100.0 inclusive
+ *
+ * Get the value at the given @percentile of the recorded values, using the
+ * nearest-rank method: the result is (an approximation of) the smallest
+ * recorded value such that at least @percentile percent of the recorded
+ * values are less than or equal to it. For example, a @percentile of 50.0
+ * gives the median; for an even number of values, this is the lower of the
+ * two middle values.
+ *
+ * The result is the largest value which falls in the same bucket as the exact
+ * answer, clamped to the range of recorded values; so it is exact for values
+ * below 64, and within about 3% of the exact answer otherwise. The 0th and
+ * 100th percentiles are the exact minimum and maximum.
+ *
+ * Returns: value at the given percentile, or 0 if the histogram is empty
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_histogram_get_percentile (const DflHistogram *self,
+                              gdouble             percentile)
+{
+  gdouble exact_rank;
+  guint64 rank, cumulative_count;
+  guint i;
+
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (percentile >= 0.0 && percentile <= 100.0, 0);
+
+  if (self->n_values == 0)
+    return 0;
+
+  /* Round the rank up, without pulling in libm for ceil(). */
+  exact_rank = percentile / 100.0 * self->n_values;
+  rank = (guint64) exact_rank;
+  if ((gdouble) rank < exact_rank)
+    rank++;
+
+  rank = CLAMP (rank, 1, self->n_values);
+
+  if (rank == 1)
+    return self->min_value;
+  else if (rank == self->n_values)
+    return self->max_value;
+
+  cumulative_count = 0;
+
+  for (i = 0; i < self->n_buckets; i++)
+    {
+      cumulative_count += self->counts[i];
+
+      if (cumulative_count >= rank)
+        {
+          DflDuration value;
+
+          value = bucket_get_highest_value (self->first_bucket + i);
+
+          return CLAMP (value, self->min_value, self->max_value);
+        }
+    }
+
+  g_assert_not_reached ();
+}
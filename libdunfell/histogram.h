@@ -0,0 +1,59 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2015, 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_HISTOGRAM_H
+#define DFL_HISTOGRAM_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "types.h"
+
+G_BEGIN_DECLS
+
+/**
+ * DflHistogram:
+ *
+ * All the fields in this structure are private.
+ *
+ * Since: UNRELEASED
+ */
+typedef struct _DflHistogram DflHistogram;
+
+GType dfl_histogram_get_type (void);
+
+DflHistogram *dfl_histogram_new  (void);
+DflHistogram *dfl_histogram_copy (const DflHistogram *self);
+void          dfl_histogram_free (DflHistogram       *self);
+
+void dfl_histogram_record (DflHistogram       *self,
+                           DflDuration         value);
+void dfl_histogram_merge  (DflHistogram       *self,
+                           const DflHistogram *other);
+
+guint64     dfl_histogram_get_n_values   (const DflHistogram *self);
+DflDuration dfl_histogram_get_min        (const DflHistogram *self);
+DflDuration dfl_histogram_get_max        (const DflHistogram *self);
+DflDuration dfl_histogram_get_percentile (const DflHistogram *self,
+                                          gdouble             percentile);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (DflHistogram, dfl_histogram_free)
+
+G_END_DECLS
+
+#endif /* !DFL_HISTOGRAM_H */
@@ -35,12 +35,22 @@
 #include <string.h>
 
 #include "event.h"
+#include "histogram.h"
 #include "main-context.h"
 #include "time-sequence.h"
 
 
 static void dfl_main_context_dispose (GObject *object);
 
+/* A contention interval in @contention_events which is waiting for the owner
+ * to release the context. */
+typedef struct
+{
+  DflMainContextContentionData *contention;  /* unowned */
+  gsize index;  /* of @contention in @contention_events */
+  DflTimestamp timestamp;
+} ContentionPending;
+
 struct _DflMainContext
 {
   GObject parent;
@@ -58,10 +68,61 @@ struct _DflMainContext
    * this main context. */
   DflTimeSequence/*<DflThreadId>*/ thread_acquisition_failure_events;
 
+  /* Sequence of intervals where a thread was trying to acquire this main
+   * context while another thread owned it, keyed by the timestamp of the first
+   * failed acquire in each. */
+  DflTimeSequence/*<DflMainContextContentionData>*/ contention_events;
+
+  /* State for main_context_acquire_release_cb() while walking the event
+   * sequence: the contention intervals which have not ended yet, at most one
+   * per thread. These point into @contention_events. */
+  GArray/*<ContentionPending>*/ *contention_pending;  /* owned */
+
+  /* State for main_context_acquire_release_cb() while walking the event
+   * sequence: the number of times the current owner has recursively acquired
+   * the context, or 0 if it is not owned. */
+  guint owner_depth;
+
   /* Sequence of thread IDs and the duration between the start and end of the
    * dispatch. A duration of ≥ 0 is valid; < 0 is not. */
   DflTimeSequence/*<DflMainContextDispatchData>*/ dispatch_events;
 
+  /* Histogram of the valid durations in @dispatch_events, built lazily by
+   * dfl_main_context_ensure_dispatch_histogram(). */
+  DflHistogram *dispatch_histogram;  /* owned; nullable */
+  gsize dispatch_histogram_n_elements;
+
+  /* Sequence of main context iterations, broken down into phases, keyed by the
+   * timestamp of the start of the prepare phase. */
+  DflTimeSequence/*<DflMainContextIterationData>*/ iteration_events;
+
+  /* State for main_context_iteration_cb() while walking the event sequence:
+   * the last iteration event seen, and whether it was part of an iteration
+   * which has not finished dispatching yet. */
+  const gchar *iteration_last_event_type;  /* interned; nullable */
+  DflTimestamp iteration_last_timestamp;
+  gboolean iteration_in_progress;
+
+  /* Sequence of wakeups of this main context, keyed by the timestamp of the
+   * first g_main_context_wakeup() call in each. */
+  DflTimeSequence/*<DflMainContextWakeupData>*/ wakeup_events;
+
+  /* State for main_context_wakeup_cb() while walking the event sequence: the
+   * wakeup waiting to be acknowledged, and the acknowledged wakeup waiting to
+   * be dispatched. These point into @wakeup_events. */
+  DflMainContextWakeupData *wakeup_unacknowledged;  /* unowned; nullable */
+  gsize wakeup_unacknowledged_index;
+  DflTimestamp wakeup_unacknowledged_timestamp;
+  DflMainContextWakeupData *wakeup_undispatched;  /* unowned; nullable */
+  gsize wakeup_undispatched_index;
+  DflTimestamp wakeup_undispatched_timestamp;
+
+  /* Histogram of the valid durations of cross-thread wakeups in
+   * @wakeup_events, built lazily by
+   * dfl_main_context_ensure_wakeup_histogram(). */
+  DflHistogram *wakeup_histogram;  /* owned; nullable */
+  gsize wakeup_histogram_n_elements;
+
   /* TODO */
   DflTimeSequence source_events;
   DflTimeSequence thread_default_events;
@@ -82,10 +143,43 @@ dfl_main_context_init (DflMainContext *self)
 {
   dfl_time_sequence_init (&self->thread_ownership_events,
                           sizeof (DflThreadOwnershipData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&self->thread_ownership_events,
+                                      G_STRUCT_OFFSET (DflThreadOwnershipData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflThreadOwnershipData,
+                                                       thread_id));
   dfl_time_sequence_init (&self->thread_acquisition_failure_events,
                           sizeof (DflThreadId), NULL, 0);
+  dfl_time_sequence_init (&self->contention_events,
+                          sizeof (DflMainContextContentionData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&self->contention_events,
+                                      G_STRUCT_OFFSET (DflMainContextContentionData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflMainContextContentionData,
+                                                       thread_id));
+  self->contention_pending = g_array_new (FALSE, FALSE,
+                                          sizeof (ContentionPending));
   dfl_time_sequence_init (&self->dispatch_events,
                           sizeof (DflMainContextDispatchData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&self->dispatch_events,
+                                      G_STRUCT_OFFSET (DflMainContextDispatchData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflMainContextDispatchData,
+                                                       thread_id));
+  dfl_time_sequence_init (&self->iteration_events,
+                          sizeof (DflMainContextIterationData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&self->iteration_events,
+                                      G_STRUCT_OFFSET (DflMainContextIterationData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflMainContextIterationData,
+                                                       thread_id));
+  dfl_time_sequence_init (&self->wakeup_events,
+                          sizeof (DflMainContextWakeupData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&self->wakeup_events,
+                                      G_STRUCT_OFFSET (DflMainContextWakeupData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflMainContextWakeupData,
+                                                       thread_id));
 
 #if 0
 TODO
@@ -99,9 +193,17 @@ dfl_main_context_dispose (GObject *object)
 {
   DflMainContext *self = DFL_MAIN_CONTEXT (object);
 
+  self->wakeup_unacknowledged = NULL;
+  self->wakeup_undispatched = NULL;
+  g_clear_pointer (&self->wakeup_histogram, dfl_histogram_free);
+  dfl_time_sequence_clear (&self->wakeup_events);
+  dfl_time_sequence_clear (&self->iteration_events);
   dfl_time_sequence_clear (&self->dispatch_events);
+  g_clear_pointer (&self->dispatch_histogram, dfl_histogram_free);
   dfl_time_sequence_clear (&self->thread_default_events);
   dfl_time_sequence_clear (&self->source_events);
+  g_clear_pointer (&self->contention_pending, g_array_unref);
+  dfl_time_sequence_clear (&self->contention_events);
   dfl_time_sequence_clear (&self->thread_acquisition_failure_events);
   dfl_time_sequence_clear (&self->thread_ownership_events);
 
@@ -137,6 +239,108 @@ dfl_main_context_new (DflId        id,
 
 #include "event-sequence.h"
 
+/* Handle a failed g_main_context_acquire() call by @thread_id: it is now
+ * waiting for the current owner to release the context. Further failures by
+ * the same thread are coalesced into the same contention interval. */
+static void
+main_context_acquire_failed (DflMainContext *main_context,
+                             DflTimestamp    timestamp,
+                             DflThreadId     thread_id)
+{
+  DflThreadId *failure;
+  DflMainContextContentionData *contention;
+  DflThreadOwnershipData *last_ownership;
+  ContentionPending pending;
+  gsize i;
+
+  failure = dfl_time_sequence_append (&main_context->thread_acquisition_failure_events,
+                                      timestamp);
+  *failure = thread_id;
+
+  for (i = 0; i < main_context->contention_pending->len; i++)
+    {
+      ContentionPending *p = &g_array_index (main_context->contention_pending,
+                                             ContentionPending, i);
+
+      if (p->contention->thread_id == thread_id)
+        {
+          p->contention->n_failures++;
+          return;
+        }
+    }
+
+  last_ownership = dfl_time_sequence_get_last_element (&main_context->thread_ownership_events,
+                                                       NULL);
+
+  contention = dfl_time_sequence_append (&main_context->contention_events,
+                                         timestamp);
+  contention->thread_id = thread_id;
+  contention->duration = -1;  /* will be set by the owner’s release() */
+  contention->owner_thread_id = (last_ownership != NULL &&
+                                 last_ownership->duration < 0) ?
+                                last_ownership->thread_id : 0;
+  contention->n_failures = 1;
+
+  pending.contention = contention;
+  pending.index = dfl_time_sequence_get_n_elements (&main_context->contention_events) - 1;
+  pending.timestamp = timestamp;
+  g_array_append_val (main_context->contention_pending, pending);
+}
+
+/* Handle @thread_id releasing the context: any other thread waiting to acquire
+ * it can now do so, either by retrying or from g_main_context_wait(), so their
+ * contention intervals end. */
+static void
+main_context_release_contention (DflMainContext *main_context,
+                                 DflTimestamp    timestamp,
+                                 DflThreadId     thread_id)
+{
+  gsize i;
+
+  for (i = 0; i < main_context->contention_pending->len; )
+    {
+      ContentionPending *p = &g_array_index (main_context->contention_pending,
+                                             ContentionPending, i);
+
+      if (p->contention->thread_id == thread_id)
+        {
+          i++;
+          continue;
+        }
+
+      p->contention->duration = timestamp - p->timestamp;
+      dfl_time_sequence_invalidate_summary (&main_context->contention_events,
+                                            p->index);
+      g_array_remove_index_fast (main_context->contention_pending, i);
+    }
+}
+
+/* Handle @thread_id successfully acquiring the context: if it was waiting for
+ * the context, its contention interval ends, even if the release by the
+ * previous owner was not logged. */
+static void
+main_context_end_own_contention (DflMainContext *main_context,
+                                 DflTimestamp    timestamp,
+                                 DflThreadId     thread_id)
+{
+  gsize i;
+
+  for (i = 0; i < main_context->contention_pending->len; i++)
+    {
+      ContentionPending *p = &g_array_index (main_context->contention_pending,
+                                             ContentionPending, i);
+
+      if (p->contention->thread_id == thread_id)
+        {
+          p->contention->duration = timestamp - p->timestamp;
+          dfl_time_sequence_invalidate_summary (&main_context->contention_events,
+                                                p->index);
+          g_array_remove_index_fast (main_context->contention_pending, i);
+          return;
+        }
+    }
+}
+
 static void
 main_context_acquire_release_cb (DflEventSequence *sequence,
                                  DflEvent         *event,
@@ -154,6 +358,13 @@ main_context_acquire_release_cb (DflEventSequence *sequence,
   timestamp = dfl_event_get_timestamp (event);
   thread_id = dfl_event_get_thread_id (event);
 
+  /* A failed acquire does not change the owner. */
+  if (is_acquire && dfl_event_get_parameter_id (event, 1) == 0)
+    {
+      main_context_acquire_failed (main_context, timestamp, thread_id);
+      return;
+    }
+
   if (is_acquire)
     {
       DflThreadOwnershipData *last_element;
@@ -162,13 +373,21 @@ main_context_acquire_release_cb (DflEventSequence *sequence,
 
       /* Check that the previous element in the sequence has a valid (non-zero)
        * duration, otherwise no release event was logged and something very odd
-       * is happening.
+       * is happening — unless the owner is acquiring the context recursively,
+       * in which case its ownership continues until the matching release.
        *
        * @last_element will be %NULL if this is the first acquire. */
       last_element = dfl_time_sequence_get_last_element (&main_context->thread_ownership_events,
                                                          &last_timestamp);
 
-      if (last_element != NULL && last_element->duration < 0)
+      if (last_element != NULL && last_element->duration < 0 &&
+          last_element->thread_id == thread_id &&
+          main_context->owner_depth > 0)
+        {
+          main_context->owner_depth++;
+          return;
+        }
+      else if (last_element != NULL && last_element->duration < 0)
         {
           /* TODO: Some better error reporting framework than g_warning(). */
           g_warning ("Saw two g_main_context_acquire() calls in a row for the "
@@ -184,6 +403,9 @@ main_context_acquire_release_cb (DflEventSequence *sequence,
                                                timestamp);
       next_element->thread_id = thread_id;
       next_element->duration = -1;  /* will be set by the paired release() */
+      main_context->owner_depth = 1;
+
+      main_context_end_own_contention (main_context, timestamp, thread_id);
     }
   else
     {
@@ -197,6 +419,16 @@ main_context_acquire_release_cb (DflEventSequence *sequence,
       last_element = dfl_time_sequence_get_last_element (&main_context->thread_ownership_events,
                                                          &last_timestamp);
 
+      /* Releasing a recursive acquire leaves the context owned, so nobody
+       * waiting for it can acquire it yet. */
+      if (last_element != NULL && last_element->duration < 0 &&
+          last_element->thread_id == thread_id &&
+          main_context->owner_depth > 1)
+        {
+          main_context->owner_depth--;
+          return;
+        }
+
       if (last_element == NULL)
         {
           /* TODO: Some better error reporting framework than g_warning(). */
@@ -236,6 +468,9 @@ main_context_acquire_release_cb (DflEventSequence *sequence,
 
       /* Update the element’s duration. */
       last_element->duration = timestamp - last_timestamp;
+      main_context->owner_depth = 0;
+
+      main_context_release_contention (main_context, timestamp, thread_id);
     }
 }
 
@@ -366,6 +601,204 @@ main_context_before_after_dispatch_cb (DflEventSequence *sequence,
     }
 }
 
+/* Add @duration to a phase duration which may still be unknown (-1). Phases
+ * can be repeated within an iteration: for example, GLib re-runs the query
+ * phase if the file descriptor array was too small. */
+static void
+iteration_add_phase_duration (DflDuration *phase_duration,
+                              DflDuration  duration)
+{
+  *phase_duration = MAX (*phase_duration, 0) + duration;
+}
+
+/* Build up the phases of each iteration of the main context. GLib emits, in
+ * order: before_prepare, after_prepare, before_query, after_query, (poll),
+ * before_check, after_check, before_dispatch and after_dispatch. A phase is
+ * only recorded if the event which started it was the previous one seen for
+ * this context, so phases which started before the log did, or which were
+ * interrupted by a nested iteration, are left unknown rather than being
+ * recorded wrongly. */
+static void
+main_context_iteration_cb (DflEventSequence *sequence,
+                           DflEvent         *event,
+                           gpointer          user_data)
+{
+  DflMainContext *main_context = user_data;
+  const gchar *event_type, *last_event_type;
+  DflTimestamp timestamp, iteration_timestamp;
+  DflThreadId thread_id;
+  DflDuration phase_duration;
+  DflMainContextIterationData *iteration;
+
+  /* Does this event correspond to the right main context? */
+  g_assert (dfl_event_get_parameter_id (event, 0) == main_context->id);
+
+  event_type = dfl_event_get_event_type (event);
+  timestamp = dfl_event_get_timestamp (event);
+  thread_id = dfl_event_get_thread_id (event);
+
+  last_event_type = main_context->iteration_last_event_type;
+  phase_duration = timestamp - main_context->iteration_last_timestamp;
+
+  main_context->iteration_last_event_type = event_type;
+  main_context->iteration_last_timestamp = timestamp;
+
+  if (event_type == g_intern_static_string ("g_main_context_before_prepare"))
+    {
+      /* Start the next iteration. */
+      iteration = dfl_time_sequence_append (&main_context->iteration_events,
+                                            timestamp);
+      iteration->thread_id = thread_id;
+      iteration->duration = 0;  /* extended by each following phase */
+      iteration->prepare_duration = -1;
+      iteration->query_duration = -1;
+      iteration->poll_duration = -1;
+      iteration->check_duration = -1;
+      iteration->dispatch_duration = -1;
+      iteration->poll_timeout = -1;
+      iteration->n_ready = -1;
+
+      main_context->iteration_in_progress = TRUE;
+
+      return;
+    }
+
+  /* Ignore events from g_main_context_dispatch() calls outside an iteration,
+   * and from other threads. */
+  iteration = dfl_time_sequence_get_last_element (&main_context->iteration_events,
+                                                  &iteration_timestamp);
+
+  if (!main_context->iteration_in_progress || iteration == NULL ||
+      iteration->thread_id != thread_id)
+    return;
+
+  iteration->duration = timestamp - iteration_timestamp;
+
+  if (event_type == g_intern_static_string ("g_main_context_after_prepare") &&
+      last_event_type == g_intern_static_string ("g_main_context_before_prepare"))
+    {
+      iteration_add_phase_duration (&iteration->prepare_duration,
+                                    phase_duration);
+    }
+  else if (event_type == g_intern_static_string ("g_main_context_after_query") &&
+           last_event_type == g_intern_static_string ("g_main_context_before_query"))
+    {
+      iteration_add_phase_duration (&iteration->query_duration,
+                                    phase_duration);
+      iteration->poll_timeout = dfl_event_get_parameter_int64 (event, 1);
+    }
+  else if (event_type == g_intern_static_string ("g_main_context_before_check") &&
+           last_event_type == g_intern_static_string ("g_main_context_after_query"))
+    {
+      iteration_add_phase_duration (&iteration->poll_duration,
+                                    phase_duration);
+    }
+  else if (event_type == g_intern_static_string ("g_main_context_after_check") &&
+           last_event_type == g_intern_static_string ("g_main_context_before_check"))
+    {
+      iteration_add_phase_duration (&iteration->check_duration,
+                                    phase_duration);
+      iteration->n_ready = dfl_event_get_parameter_int64 (event, 1);
+    }
+  else if (event_type == g_intern_static_string ("g_main_context_after_dispatch") &&
+           last_event_type == g_intern_static_string ("g_main_context_before_dispatch"))
+    {
+      iteration_add_phase_duration (&iteration->dispatch_duration,
+                                    phase_duration);
+    }
+
+  if (event_type == g_intern_static_string ("g_main_context_after_dispatch"))
+    main_context->iteration_in_progress = FALSE;
+}
+
+/* Pair each wakeup of the main context with its acknowledgement, then with the
+ * start of the next dispatch. The wakeup is typically sent from another
+ * thread; it is acknowledged by the thread iterating the context, once poll()
+ * returns, and the dispatch then follows in the same iteration. */
+static void
+main_context_wakeup_cb (DflEventSequence *sequence,
+                        DflEvent         *event,
+                        gpointer          user_data)
+{
+  DflMainContext *main_context = user_data;
+  const gchar *event_type;
+  DflTimestamp timestamp;
+  DflThreadId thread_id;
+
+  /* Does this event correspond to the right main context? */
+  g_assert (dfl_event_get_parameter_id (event, 0) == main_context->id);
+
+  event_type = dfl_event_get_event_type (event);
+  timestamp = dfl_event_get_timestamp (event);
+  thread_id = dfl_event_get_thread_id (event);
+
+  if (event_type == g_intern_static_string ("g_main_context_wakeup"))
+    {
+      DflMainContextWakeupData *wakeup;
+
+      /* GLib only needs to acknowledge one wakeup, however many were sent, so
+       * coalesce them. */
+      if (main_context->wakeup_unacknowledged != NULL)
+        {
+          main_context->wakeup_unacknowledged->n_wakeups++;
+          return;
+        }
+
+      wakeup = dfl_time_sequence_append (&main_context->wakeup_events,
+                                         timestamp);
+      wakeup->thread_id = thread_id;
+      wakeup->duration = -1;  /* will be set by the next dispatch */
+      wakeup->acknowledge_duration = -1;  /* will be set by the acknowledge */
+      wakeup->acknowledge_thread_id = 0;
+      wakeup->n_wakeups = 1;
+
+      main_context->wakeup_unacknowledged = wakeup;
+      main_context->wakeup_unacknowledged_index =
+        dfl_time_sequence_get_n_elements (&main_context->wakeup_events) - 1;
+      main_context->wakeup_unacknowledged_timestamp = timestamp;
+    }
+  else if (event_type ==
+           g_intern_static_string ("g_main_context_wakeup_acknowledge"))
+    {
+      DflMainContextWakeupData *wakeup;
+
+      /* This can happen if the wakeup was sent before logging started. */
+      wakeup = main_context->wakeup_unacknowledged;
+
+      if (wakeup == NULL)
+        return;
+
+      wakeup->acknowledge_duration =
+        timestamp - main_context->wakeup_unacknowledged_timestamp;
+      wakeup->acknowledge_thread_id = thread_id;
+
+      /* If a previously acknowledged wakeup was never followed by a dispatch,
+       * leave its duration unknown. */
+      main_context->wakeup_undispatched = wakeup;
+      main_context->wakeup_undispatched_index =
+        main_context->wakeup_unacknowledged_index;
+      main_context->wakeup_undispatched_timestamp =
+        main_context->wakeup_unacknowledged_timestamp;
+      main_context->wakeup_unacknowledged = NULL;
+    }
+  else
+    {
+      DflMainContextWakeupData *wakeup;
+
+      /* g_main_context_before_dispatch */
+      wakeup = main_context->wakeup_undispatched;
+
+      if (wakeup == NULL || wakeup->acknowledge_thread_id != thread_id)
+        return;
+
+      wakeup->duration = timestamp -
+                         main_context->wakeup_undispatched_timestamp;
+      dfl_time_sequence_invalidate_summary (&main_context->wakeup_events,
+                                            main_context->wakeup_undispatched_index);
+      main_context->wakeup_undispatched = NULL;
+    }
+}
+
 static void
 main_context_new_cb (DflEventSequence *sequence,
                      DflEvent         *event,
@@ -407,6 +840,63 @@ main_context_new_cb (DflEventSequence *sequence,
                                  g_object_ref (main_context),
                                  (GDestroyNotify) g_object_unref);
 
+  dfl_event_sequence_add_walker (sequence, "g_main_context_before_prepare",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_after_prepare",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_before_query",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_after_query",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_before_check",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_after_check",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_before_dispatch",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_after_dispatch",
+                                 main_context_id,
+                                 main_context_iteration_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+
+  dfl_event_sequence_add_walker (sequence, "g_main_context_wakeup",
+                                 main_context_id,
+                                 main_context_wakeup_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_wakeup_acknowledge",
+                                 main_context_id,
+                                 main_context_wakeup_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_main_context_before_dispatch",
+                                 main_context_id,
+                                 main_context_wakeup_cb,
+                                 g_object_ref (main_context),
+                                 (GDestroyNotify) g_object_unref);
+
   dfl_event_sequence_end_walker_group (sequence, "g_main_context_free",
                                        main_context_id);
 
@@ -531,42 +1021,465 @@ dfl_main_context_dispatch_iter (DflMainContext      *self,
 }
 
 /**
- * dfl_main_context_get_n_thread_switches:
+ * dfl_main_context_iteration_iter:
  * @self: a #DflMainContext
+ * @iter: an uninitialised #DflTimeSequenceIter to use
+ * @start: optional timestamp to start iterating from, or 0
  *
- * TODO
+ * Initialise @iter to iterate over the iterations of this main context, from
+ * @start onwards. The elements are #DflMainContextIterationData, and their
+ * timestamps are the start of the prepare phase.
  *
- * Returns: number of times this main context has switched between threads
  * Since: UNRELEASED
  */
-gsize
-dfl_main_context_get_n_thread_switches (DflMainContext *self)
+void
+dfl_main_context_iteration_iter (DflMainContext      *self,
+                                 DflTimeSequenceIter *iter,
+                                 DflTimestamp         start)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (iter != NULL);
+
+  dfl_time_sequence_iter_init (iter, &self->iteration_events, start);
+}
+
+/**
+ * dfl_main_context_wakeup_iter:
+ * @self: a #DflMainContext
+ * @iter: an uninitialised #DflTimeSequenceIter to use
+ * @start: optional timestamp to start iterating from, or 0
+ *
+ * Initialise @iter to iterate over the wakeups of this main context, from
+ * @start onwards. The elements are #DflMainContextWakeupData, and their
+ * timestamps are those of the first g_main_context_wakeup() call in each.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_wakeup_iter (DflMainContext      *self,
+                              DflTimeSequenceIter *iter,
+                              DflTimestamp         start)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (iter != NULL);
+
+  dfl_time_sequence_iter_init (iter, &self->wakeup_events, start);
+}
+
+/**
+ * dfl_main_context_contention_iter:
+ * @self: a #DflMainContext
+ * @iter: an uninitialised #DflTimeSequenceIter to use
+ * @start: optional timestamp to start iterating from, or 0
+ *
+ * Initialise @iter to iterate over the intervals where a thread was trying to
+ * acquire this main context while another thread owned it, from @start
+ * onwards. The elements are #DflMainContextContentionData, and their
+ * timestamps are those of the first failed g_main_context_acquire() call in
+ * each.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_contention_iter (DflMainContext      *self,
+                                  DflTimeSequenceIter *iter,
+                                  DflTimestamp         start)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (iter != NULL);
+
+  dfl_time_sequence_iter_init (iter, &self->contention_events, start);
+}
+
+/**
+ * dfl_main_context_thread_ownership_foreach_overlapping:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each thread ownership span overlapping the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each thread ownership span which overlaps [@start, @end], in
+ * timestamp order. See dfl_time_sequence_foreach_overlapping().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_thread_ownership_foreach_overlapping (DflMainContext             *self,
+                                                       DflTimestamp                start,
+                                                       DflTimestamp                end,
+                                                       DflTimeSequenceOverlapFunc  func,
+                                                       gpointer                    user_data)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (func != NULL);
+
+  dfl_time_sequence_foreach_overlapping (&self->thread_ownership_events,
+                                         start, end, func, user_data);
+}
+
+/**
+ * dfl_main_context_dispatch_foreach_overlapping:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each dispatch overlapping the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each dispatch which overlaps [@start, @end], in timestamp
+ * order. See dfl_time_sequence_foreach_overlapping().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_dispatch_foreach_overlapping (DflMainContext             *self,
+                                               DflTimestamp                start,
+                                               DflTimestamp                end,
+                                               DflTimeSequenceOverlapFunc  func,
+                                               gpointer                    user_data)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (func != NULL);
+
+  dfl_time_sequence_foreach_overlapping (&self->dispatch_events, start, end,
+                                         func, user_data);
+}
+
+/**
+ * dfl_main_context_iteration_foreach_overlapping:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each iteration overlapping the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each main context iteration which overlaps [@start, @end], in
+ * timestamp order. See dfl_time_sequence_foreach_overlapping().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_iteration_foreach_overlapping (DflMainContext             *self,
+                                                DflTimestamp                start,
+                                                DflTimestamp                end,
+                                                DflTimeSequenceOverlapFunc  func,
+                                                gpointer                    user_data)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (func != NULL);
+
+  dfl_time_sequence_foreach_overlapping (&self->iteration_events, start, end,
+                                         func, user_data);
+}
+
+/**
+ * dfl_main_context_contention_foreach_overlapping:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each contention interval overlapping the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each contention interval which overlaps [@start, @end], in
+ * timestamp order. See dfl_main_context_contention_iter() and
+ * dfl_time_sequence_foreach_overlapping().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_contention_foreach_overlapping (DflMainContext             *self,
+                                                 DflTimestamp                start,
+                                                 DflTimestamp                end,
+                                                 DflTimeSequenceOverlapFunc  func,
+                                                 gpointer                    user_data)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (func != NULL);
+
+  dfl_time_sequence_foreach_overlapping (&self->contention_events, start, end,
+                                         func, user_data);
+}
+
+/**
+ * dfl_main_context_get_thread_ownership_summary:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive), or 0
+ * @end: timestamp to end the window at (exclusive), or 0 to include all
+ *    thread ownership spans from @start onwards
+ * @summary: (out caller-allocates): return location for the summary
+ *
+ * Summarise the thread ownership spans which start in [@start, @end). See
+ * dfl_time_sequence_get_summary().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_get_thread_ownership_summary (DflMainContext         *self,
+                                               DflTimestamp            start,
+                                               DflTimestamp            end,
+                                               DflTimeSequenceSummary *summary)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (summary != NULL);
+
+  dfl_time_sequence_get_summary (&self->thread_ownership_events, start, end,
+                                 summary);
+}
+
+/**
+ * dfl_main_context_get_dispatch_summary:
+ * @self: a #DflMainContext
+ * @start: timestamp to start the window at (inclusive), or 0
+ * @end: timestamp to end the window at (exclusive), or 0 to include all
+ *    dispatches from @start onwards
+ * @summary: (out caller-allocates): return location for the summary
+ *
+ * Summarise the dispatches which start in [@start, @end). See
+ * dfl_time_sequence_get_summary().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_main_context_get_dispatch_summary (DflMainContext         *self,
+                                       DflTimestamp            start,
+                                       DflTimestamp            end,
+                                       DflTimeSequenceSummary *summary)
+{
+  g_return_if_fail (DFL_IS_MAIN_CONTEXT (self));
+  g_return_if_fail (summary != NULL);
+
+  dfl_time_sequence_get_summary (&self->dispatch_events, start, end, summary);
+}
+
+/* Build (or rebuild, if more dispatches have been appended since) the
+ * histogram of dispatch durations. See dfl_source_get_dispatch_histogram() for
+ * why this is not done during the walk. */
+static void
+dfl_main_context_ensure_dispatch_histogram (DflMainContext *self)
 {
   DflTimeSequenceIter iter;
-  gsize count;
-  DflMainContextDispatchData *dispatch_data, *prev_dispatch_data;
+  DflMainContextDispatchData *dispatch_data;
+  gsize n_elements;
 
-  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), 0);
+  n_elements = dfl_time_sequence_get_n_elements (&self->dispatch_events);
 
-  dfl_time_sequence_iter_init (&iter, &self->dispatch_events, 0);
-  count = 0;
+  if (self->dispatch_histogram != NULL &&
+      self->dispatch_histogram_n_elements == n_elements)
+    return;
 
-  if (!dfl_time_sequence_iter_next (&iter, NULL,
-                                    (gpointer *) &prev_dispatch_data))
-    return 0;
+  g_clear_pointer (&self->dispatch_histogram, dfl_histogram_free);
+  self->dispatch_histogram = dfl_histogram_new ();
+  self->dispatch_histogram_n_elements = n_elements;
+
+  dfl_time_sequence_iter_init (&iter, &self->dispatch_events, 0);
 
   while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &dispatch_data))
     {
-      if (dispatch_data->thread_id != prev_dispatch_data->thread_id)
-        {
-          if (count == G_MAXSIZE)
-            return G_MAXSIZE;
+      if (dispatch_data->duration >= 0)
+        dfl_histogram_record (self->dispatch_histogram,
+                              dispatch_data->duration);
+    }
+}
 
-          count++;
-        }
+/**
+ * dfl_main_context_get_dispatch_histogram:
+ * @self: a #DflMainContext
+ *
+ * Get a histogram of the durations of all the dispatches of this main context,
+ * which can be used to query percentiles of the dispatch duration. Dispatches
+ * which never finished are not included.
+ *
+ * Returns: (transfer none): histogram of dispatch durations
+ * Since: UNRELEASED
+ */
+const DflHistogram *
+dfl_main_context_get_dispatch_histogram (DflMainContext *self)
+{
+  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), NULL);
+
+  dfl_main_context_ensure_dispatch_histogram (self);
+
+  return self->dispatch_histogram;
+}
+
+/* Build (or rebuild, if more wakeups have been appended since) the histogram
+ * of cross-thread wakeup latencies. */
+static void
+dfl_main_context_ensure_wakeup_histogram (DflMainContext *self)
+{
+  DflTimeSequenceIter iter;
+  DflMainContextWakeupData *wakeup_data;
+  gsize n_elements;
+
+  n_elements = dfl_time_sequence_get_n_elements (&self->wakeup_events);
+
+  if (self->wakeup_histogram != NULL &&
+      self->wakeup_histogram_n_elements == n_elements)
+    return;
+
+  g_clear_pointer (&self->wakeup_histogram, dfl_histogram_free);
+  self->wakeup_histogram = dfl_histogram_new ();
+  self->wakeup_histogram_n_elements = n_elements;
+
+  dfl_time_sequence_iter_init (&iter, &self->wakeup_events, 0);
+
+  while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &wakeup_data))
+    {
+      if (wakeup_data->duration >= 0 &&
+          wakeup_data->thread_id != wakeup_data->acknowledge_thread_id)
+        dfl_histogram_record (self->wakeup_histogram, wakeup_data->duration);
+    }
+}
+
+/**
+ * dfl_main_context_get_wakeup_histogram:
+ * @self: a #DflMainContext
+ *
+ * Get a histogram of the latencies from another thread waking up this main
+ * context (for example, with g_main_context_invoke()) to the context starting
+ * to dispatch, which can be used to query percentiles of the latency. Wakeups
+ * sent from the thread iterating the context, and wakeups which were never
+ * dispatched, are not included.
+ *
+ * Returns: (transfer none): histogram of cross-thread wakeup latencies
+ * Since: UNRELEASED
+ */
+const DflHistogram *
+dfl_main_context_get_wakeup_histogram (DflMainContext *self)
+{
+  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), NULL);
+
+  dfl_main_context_ensure_wakeup_histogram (self);
+
+  return self->wakeup_histogram;
+}
+
+/**
+ * dfl_main_context_get_iteration_phase_totals:
+ * @self: a #DflMainContext
+ * @prepare_duration: (out) (optional): return location for the total time
+ *    spent in the prepare phase
+ * @query_duration: (out) (optional): return location for the total time spent
+ *    in the query phase
+ * @poll_duration: (out) (optional): return location for the total time spent
+ *    polling
+ * @check_duration: (out) (optional): return location for the total time spent
+ *    in the check phase
+ * @dispatch_duration: (out) (optional): return location for the total time
+ *    spent in the dispatch phase
+ *
+ * Sum the time spent in each phase over all the iterations of this main
+ * context, to compare the overhead of the main loop itself against the time
+ * spent dispatching callbacks. Phases which are unknown for an iteration are
+ * not counted. All durations are in microseconds.
+ *
+ * Returns: number of iterations of this main context
+ * Since: UNRELEASED
+ */
+gsize
+dfl_main_context_get_iteration_phase_totals (DflMainContext *self,
+                                             DflDuration    *prepare_duration,
+                                             DflDuration    *query_duration,
+                                             DflDuration    *poll_duration,
+                                             DflDuration    *check_duration,
+                                             DflDuration    *dispatch_duration)
+{
+  DflTimeSequenceIter iter;
+  DflMainContextIterationData *iteration;
+  DflDuration prepare_total = 0, query_total = 0, poll_total = 0;
+  DflDuration check_total = 0, dispatch_total = 0;
+  gsize n_iterations = 0;
+
+  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), 0);
 
-      prev_dispatch_data = dispatch_data;
+  dfl_time_sequence_iter_init (&iter, &self->iteration_events, 0);
+
+  while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &iteration))
+    {
+      prepare_total += MAX (iteration->prepare_duration, 0);
+      query_total += MAX (iteration->query_duration, 0);
+      poll_total += MAX (iteration->poll_duration, 0);
+      check_total += MAX (iteration->check_duration, 0);
+      dispatch_total += MAX (iteration->dispatch_duration, 0);
+      n_iterations++;
     }
 
-  return count;
+  if (prepare_duration != NULL)
+    *prepare_duration = prepare_total;
+  if (query_duration != NULL)
+    *query_duration = query_total;
+  if (poll_duration != NULL)
+    *poll_duration = poll_total;
+  if (check_duration != NULL)
+    *check_duration = check_total;
+  if (dispatch_duration != NULL)
+    *dispatch_duration = dispatch_total;
+
+  return n_iterations;
+}
+
+/**
+ * dfl_main_context_get_contention_totals:
+ * @self: a #DflMainContext
+ * @thread_id: ID of the thread to sum contention for, or 0 for all threads
+ * @n_failures: (out) (optional): return location for the number of failed
+ *    g_main_context_acquire() calls
+ *
+ * Sum the time threads spent waiting to acquire this main context while
+ * another thread owned it, and count their failed acquires. If @thread_id is
+ * non-zero, only the waits and failures of that thread are counted.
+ * Contention intervals which never ended are not included in the total
+ * duration.
+ *
+ * Returns: total contended time, in microseconds
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_main_context_get_contention_totals (DflMainContext *self,
+                                        DflThreadId     thread_id,
+                                        gsize          *n_failures)
+{
+  DflTimeSequenceIter iter;
+  DflMainContextContentionData *contention;
+  DflDuration total_duration = 0;
+  gsize total_n_failures = 0;
+
+  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), 0);
+
+  dfl_time_sequence_iter_init (&iter, &self->contention_events, 0);
+
+  while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &contention))
+    {
+      if (thread_id != 0 && contention->thread_id != thread_id)
+        continue;
+
+      total_duration += MAX (contention->duration, 0);
+      total_n_failures += contention->n_failures;
+    }
+
+  if (n_failures != NULL)
+    *n_failures = total_n_failures;
+
+  return total_duration;
+}
+
+/**
+ * dfl_main_context_get_n_thread_switches:
+ * @self: a #DflMainContext
+ *
+ * TODO
+ *
+ * Returns: number of times this main context has switched between threads
+ * Since: UNRELEASED
+ */
+gsize
+dfl_main_context_get_n_thread_switches (DflMainContext *self)
+{
+  DflTimeSequenceSummary summary;
+
+  g_return_val_if_fail (DFL_IS_MAIN_CONTEXT (self), 0);
+
+  dfl_time_sequence_get_summary (&self->dispatch_events, 0, 0, &summary);
+
+  return summary.n_thread_switches;
 }
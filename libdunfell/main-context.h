@@ -23,6 +23,7 @@
 #include <glib-object.h>
 
 #include "event-sequence.h"
+#include "histogram.h"
 #include "time-sequence.h"
 
 G_BEGIN_DECLS
@@ -57,6 +58,96 @@ typedef struct
   DflDuration duration;
 } DflMainContextDispatchData;
 
+/**
+ * DflMainContextIterationData:
+ * @thread_id: ID of the thread which ran the iteration
+ * @duration: time from the start of the prepare phase to the last phase event
+ *    seen for the iteration; normally the end of the dispatch phase
+ * @prepare_duration: time spent preparing sources, or -1 if unknown
+ * @query_duration: time spent querying sources for file descriptors and a
+ *    timeout, or -1 if unknown
+ * @poll_duration: time between the end of the query and the start of the
+ *    check, which is spent in poll(), or -1 if unknown
+ * @check_duration: time spent checking sources, or -1 if unknown
+ * @dispatch_duration: time spent dispatching sources, or -1 if unknown
+ * @poll_timeout: timeout passed to poll(), in milliseconds; -1 means no
+ *    timeout, or that the query phase is unknown
+ * @n_ready: number of sources found ready by the check phase, or -1 if unknown
+ *
+ * One iteration of a #GMainContext, from g_main_context_iteration() or a
+ * running #GMainLoop, broken down into its phases. All durations are in
+ * microseconds.
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  DflThreadId thread_id;
+  DflDuration duration;
+  DflDuration prepare_duration;
+  DflDuration query_duration;
+  DflDuration poll_duration;
+  DflDuration check_duration;
+  DflDuration dispatch_duration;
+  gint poll_timeout;
+  gint n_ready;
+} DflMainContextIterationData;
+
+/**
+ * DflMainContextWakeupData:
+ * @thread_id: ID of the thread which sent the first wakeup
+ * @duration: time from the first wakeup to the start of the next dispatch on
+ *    the context, or -1 if it was never dispatched
+ * @acknowledge_duration: time from the first wakeup to the context
+ *    acknowledging it, or -1 if it was never acknowledged
+ * @acknowledge_thread_id: ID of the thread which acknowledged the wakeup, or 0
+ *    if it was never acknowledged
+ * @n_wakeups: number of g_main_context_wakeup() calls coalesced into this one
+ *    acknowledgement; always at least 1
+ *
+ * A wakeup of a #GMainContext, as sent by g_main_context_wakeup() from
+ * g_main_context_invoke(), g_source_attach() and similar, paired with the
+ * context acknowledging it and then dispatching. Further wakeups sent before
+ * the first is acknowledged are coalesced with it, so the durations are
+ * measured from the first one. All durations are in microseconds.
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  DflThreadId thread_id;
+  DflDuration duration;
+  DflDuration acknowledge_duration;
+  DflThreadId acknowledge_thread_id;
+  guint n_wakeups;
+} DflMainContextWakeupData;
+
+/**
+ * DflMainContextContentionData:
+ * @thread_id: ID of the thread which tried to acquire the context
+ * @duration: time from the first failed g_main_context_acquire() call to the
+ *    owning thread releasing the context, or -1 if it was never released
+ * @owner_thread_id: ID of the thread which owned the context at the time of
+ *    the first failed acquire, or 0 if unknown
+ * @n_failures: number of failed g_main_context_acquire() calls made by
+ *    @thread_id during the interval; always at least 1
+ *
+ * An interval where a thread was trying to acquire a #GMainContext owned by
+ * another thread, for example from g_main_loop_run() or a blocking
+ * g_main_context_iteration() waiting for the owner to release it. Repeated
+ * failed acquires by the same thread are coalesced until the owner releases
+ * the context. All durations are in microseconds.
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  DflThreadId thread_id;
+  DflDuration duration;
+  DflThreadId owner_thread_id;
+  guint n_failures;
+} DflMainContextContentionData;
+
 /**
  * DflMainContext:
  *
@@ -82,6 +173,59 @@ void dfl_main_context_thread_ownership_iter (DflMainContext      *self,
 void dfl_main_context_dispatch_iter (DflMainContext      *self,
                                      DflTimeSequenceIter *iter,
                                      DflTimestamp         start);
+void dfl_main_context_iteration_iter (DflMainContext      *self,
+                                      DflTimeSequenceIter *iter,
+                                      DflTimestamp         start);
+void dfl_main_context_wakeup_iter (DflMainContext      *self,
+                                   DflTimeSequenceIter *iter,
+                                   DflTimestamp         start);
+void dfl_main_context_contention_iter (DflMainContext      *self,
+                                       DflTimeSequenceIter *iter,
+                                       DflTimestamp         start);
+
+void dfl_main_context_thread_ownership_foreach_overlapping (DflMainContext             *self,
+                                                            DflTimestamp                start,
+                                                            DflTimestamp                end,
+                                                            DflTimeSequenceOverlapFunc  func,
+                                                            gpointer                    user_data);
+void dfl_main_context_dispatch_foreach_overlapping (DflMainContext             *self,
+                                                    DflTimestamp                start,
+                                                    DflTimestamp                end,
+                                                    DflTimeSequenceOverlapFunc  func,
+                                                    gpointer                    user_data);
+void dfl_main_context_iteration_foreach_overlapping (DflMainContext             *self,
+                                                     DflTimestamp                start,
+                                                     DflTimestamp                end,
+                                                     DflTimeSequenceOverlapFunc  func,
+                                                     gpointer                    user_data);
+void dfl_main_context_contention_foreach_overlapping (DflMainContext             *self,
+                                                      DflTimestamp                start,
+                                                      DflTimestamp                end,
+                                                      DflTimeSequenceOverlapFunc  func,
+                                                      gpointer                    user_data);
+
+void dfl_main_context_get_thread_ownership_summary (DflMainContext         *self,
+                                                    DflTimestamp            start,
+                                                    DflTimestamp            end,
+                                                    DflTimeSequenceSummary *summary);
+void dfl_main_context_get_dispatch_summary (DflMainContext         *self,
+                                            DflTimestamp            start,
+                                            DflTimestamp            end,
+                                            DflTimeSequenceSummary *summary);
+
+const DflHistogram *dfl_main_context_get_dispatch_histogram (DflMainContext *self);
+const DflHistogram *dfl_main_context_get_wakeup_histogram   (DflMainContext *self);
+
+gsize dfl_main_context_get_iteration_phase_totals (DflMainContext *self,
+                                                   DflDuration    *prepare_duration,
+                                                   DflDuration    *query_duration,
+                                                   DflDuration    *poll_duration,
+                                                   DflDuration    *check_duration,
+                                                   DflDuration    *dispatch_duration);
+
+DflDuration dfl_main_context_get_contention_totals (DflMainContext *self,
+                                                    DflThreadId     thread_id,
+                                                    gsize          *n_failures);
 
 gsize dfl_main_context_get_n_thread_switches (DflMainContext *self);
 
@@ -38,8 +38,10 @@
 #include <glib-object.h>
 
 #include "event-sequence.h"
+#include "event-sequence-private.h"
 #include "main-context.h"
 #include "model.h"
+#include "profile.h"
 #include "source.h"
 #include "task.h"
 #include "thread.h"
@@ -63,12 +65,33 @@ struct _DflModel
 
   /* Input data. */
   DflEventSequence *event_sequence;  /* (owned) */
+  guint max_threads;  /* 0 for one per processor */
 
   /* Results of analysis. */
   GPtrArray *main_contexts;  /* (owned) (element-type DflMainContext) */
   GPtrArray *threads;  /* (owned) (element-type DflThread) */
   GPtrArray *sources;  /* (owned) (element-type DflSource) */
   GPtrArray *tasks;  /* (owned) (element-type DflTask) */
+
+  /* Lookup tables for the results, by ID. If an ID has been reused, the most
+   * recently created object with that ID is stored. */
+  GHashTable *main_contexts_by_id;  /* (owned) (element-type DflId DflMainContext) */
+  GHashTable *threads_by_id;  /* (owned) (element-type DflThreadId DflThread) */
+  GHashTable *sources_by_id;  /* (owned) (element-type DflId DflSource) */
+  GHashTable *tasks_by_id;  /* (owned) (element-type DflId DflTask) */
+
+  /* Flat profile of all dispatches, built by dfl_model_ensure_profile() when
+   * first needed, sorted by decreasing total duration. */
+  GPtrArray *profile;  /* (owned) (nullable) (element-type DflProfileEntry) */
+
+  /* Profile of task phases, built by dfl_model_ensure_task_profile() when
+   * first needed, sorted by decreasing number of tasks. */
+  GPtrArray *task_profile;  /* (owned) (nullable) (element-type DflTaskProfileEntry) */
+
+  /* Profile of cross-thread source handoffs, built by
+   * dfl_model_ensure_handoff_profile() when first needed, sorted by
+   * decreasing total latency. */
+  GPtrArray *handoff_profile;  /* (owned) (nullable) (element-type DflHandoffProfileEntry) */
 };
 
 G_DEFINE_TYPE (DflModel, dfl_model, G_TYPE_OBJECT)
@@ -76,6 +99,7 @@ G_DEFINE_TYPE (DflModel, dfl_model, G_TYPE_OBJECT)
 typedef enum
 {
   PROP_EVENT_SEQUENCE = 1,
+  PROP_MAX_THREADS,
 } DflModelProperty;
 
 static void
@@ -105,6 +129,28 @@ dfl_model_class_init (DflModelClass *klass)
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_CONSTRUCT_ONLY |
                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * DflModel:max-threads:
+   *
+   * Maximum number of threads to analyse the event sequence in, or 0 to use
+   * up to one per processor. If 1, the analysis is done entirely in the
+   * thread constructing the model. The results are the same however many
+   * threads are used.
+   *
+   * Since: UNRELEASED
+   */
+  g_object_class_install_property (object_class, PROP_MAX_THREADS,
+                                   g_param_spec_uint ("max-threads",
+                                                      "Maximum Threads",
+                                                      "Maximum number of "
+                                                      "threads to analyse "
+                                                      "the event sequence "
+                                                      "in.",
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -126,6 +172,9 @@ dfl_model_get_property (GObject     *object,
     case PROP_EVENT_SEQUENCE:
       g_value_set_object (value, self->event_sequence);
       break;
+    case PROP_MAX_THREADS:
+      g_value_set_uint (value, self->max_threads);
+      break;
     default:
       g_assert_not_reached ();
     }
@@ -146,6 +195,10 @@ dfl_model_set_property (GObject           *object,
       g_assert (self->event_sequence == NULL);
       self->event_sequence = g_value_dup_object (value);
       break;
+    case PROP_MAX_THREADS:
+      /* Construct only. */
+      self->max_threads = g_value_get_uint (value);
+      break;
     default:
       g_assert_not_reached ();
     }
@@ -168,6 +221,15 @@ dfl_model_finalize (GObject *object)
 {
   DflModel *self = DFL_MODEL (object);
 
+  g_clear_pointer (&self->main_contexts_by_id, g_hash_table_unref);
+  g_clear_pointer (&self->threads_by_id, g_hash_table_unref);
+  g_clear_pointer (&self->sources_by_id, g_hash_table_unref);
+  g_clear_pointer (&self->tasks_by_id, g_hash_table_unref);
+
+  g_clear_pointer (&self->profile, g_ptr_array_unref);
+  g_clear_pointer (&self->handoff_profile, g_ptr_array_unref);
+  g_clear_pointer (&self->task_profile, g_ptr_array_unref);
+
   g_clear_pointer (&self->main_contexts, g_ptr_array_unref);
   g_clear_pointer (&self->threads, g_ptr_array_unref);
   g_clear_pointer (&self->sources, g_ptr_array_unref);
@@ -178,18 +240,134 @@ dfl_model_finalize (GObject *object)
   G_OBJECT_CLASS (dfl_model_parent_class)->finalize (object);
 }
 
+typedef GPtrArray *(*FactoryFunc) (DflEventSequence *sequence);
+
+/* A factory which extracts one type of object from the event sequence. Each
+ * runs on its own view of the sequence, so they can walk it concurrently. */
+typedef struct
+{
+  FactoryFunc factory;
+  DflEventSequence *sequence;  /* (owned) */
+  GPtrArray *results;  /* (owned) (nullable) */
+} FactoryData;
+
+/* Allocate a key for a table using g_int64_hash() and g_int64_equal(). Object
+ * IDs are widened to 64 bits so they can share key handling with thread IDs. */
+static guint64 *
+id_key_new (guint64 id)
+{
+  guint64 *key = g_new (guint64, 1);
+
+  *key = id;
+
+  return key;  /* transfer */
+}
+
+static void
+factory_thread_cb (gpointer data,
+                   gpointer user_data)
+{
+  FactoryData *factory = data;
+
+  factory->results = factory->factory (factory->sequence);
+  dfl_event_sequence_walk (factory->sequence);
+
+  /* Free the walkers, and with them, any references they hold to the
+   * results. */
+  g_clear_object (&factory->sequence);
+}
+
 static void
 dfl_model_analyse (DflModel *self)
 {
+  FactoryData factories[] = {
+    { dfl_main_context_factory_from_event_sequence, NULL, NULL },
+    { dfl_thread_factory_from_event_sequence, NULL, NULL },
+    { dfl_source_factory_from_event_sequence, NULL, NULL },
+    { dfl_task_factory_from_event_sequence, NULL, NULL },
+  };
+  GThreadPool *pool = NULL;
+  guint max_threads;
+  gsize i;
+
   g_assert (self->event_sequence != NULL);
 
-  /* Grab various objects out of the event sequence. */
-  self->main_contexts = dfl_main_context_factory_from_event_sequence (self->event_sequence);
-  self->threads = dfl_thread_factory_from_event_sequence (self->event_sequence);
-  self->sources = dfl_source_factory_from_event_sequence (self->event_sequence);
-  self->tasks = dfl_task_factory_from_event_sequence (self->event_sequence);
+  /* Grab various objects out of the event sequence. The factories touch
+   * disjoint sets of objects, so they can each walk the sequence in a
+   * separate thread from a pool. */
+  max_threads = (self->max_threads > 0) ? self->max_threads :
+                                          g_get_num_processors ();
+  max_threads = MIN (max_threads, G_N_ELEMENTS (factories));
+
+  /* This cannot fail, as the pool is not exclusive. */
+  if (max_threads > 1)
+    pool = g_thread_pool_new (factory_thread_cb, NULL, max_threads, FALSE,
+                              NULL);
 
-  dfl_event_sequence_walk (self->event_sequence);
+  for (i = 0; i < G_N_ELEMENTS (factories); i++)
+    {
+      factories[i].sequence = dfl_event_sequence_new_view (self->event_sequence);
+
+      if (pool != NULL)
+        g_thread_pool_push (pool, &factories[i], NULL);
+      else
+        factory_thread_cb (&factories[i], NULL);
+    }
+
+  /* Wait for all the factories to finish. */
+  if (pool != NULL)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  self->main_contexts = factories[0].results;
+  self->threads = factories[1].results;
+  self->sources = factories[2].results;
+  self->tasks = factories[3].results;
+
+  /* Build the lookup tables. The results are in creation order, so later
+   * objects replace earlier ones with the same ID. All the tables are keyed by
+   * 64-bit IDs, so the thread and object tables follow the same policy. */
+  self->main_contexts_by_id = g_hash_table_new_full (g_int64_hash,
+                                                     g_int64_equal,
+                                                     g_free, NULL);
+  self->threads_by_id = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                               g_free, NULL);
+  self->sources_by_id = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                               g_free, NULL);
+  self->tasks_by_id = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                             g_free, NULL);
+
+  for (i = 0; i < self->main_contexts->len; i++)
+    {
+      DflMainContext *main_context = self->main_contexts->pdata[i];
+
+      g_hash_table_replace (self->main_contexts_by_id,
+                            id_key_new (dfl_main_context_get_id (main_context)),
+                            main_context);
+    }
+
+  for (i = 0; i < self->threads->len; i++)
+    {
+      DflThread *thread = self->threads->pdata[i];
+
+      g_hash_table_replace (self->threads_by_id,
+                            id_key_new (dfl_thread_get_id (thread)), thread);
+    }
+
+  for (i = 0; i < self->sources->len; i++)
+    {
+      DflSource *source = self->sources->pdata[i];
+
+      g_hash_table_replace (self->sources_by_id,
+                            id_key_new (dfl_source_get_id (source)), source);
+    }
+
+  for (i = 0; i < self->tasks->len; i++)
+    {
+      DflTask *task = self->tasks->pdata[i];
+
+      g_hash_table_replace (self->tasks_by_id,
+                            id_key_new (dfl_task_get_id (task)), task);
+    }
 }
 
 /**
@@ -301,6 +479,96 @@ dfl_model_dup_tasks (DflModel *self)
   return g_ptr_array_ref (self->tasks);
 }
 
+/**
+ * dfl_model_lookup_main_context:
+ * @self: a #DflModel
+ * @id: ID of the main context to look up
+ *
+ * Look up a #DflMainContext by its ID. If the ID was reused by several main
+ * contexts over the course of the event sequence, the last of them is
+ * returned.
+ *
+ * Returns: (transfer none) (nullable): the main context, or %NULL if none was
+ *    found
+ * Since: UNRELEASED
+ */
+DflMainContext *
+dfl_model_lookup_main_context (DflModel *self,
+                               DflId     id)
+{
+  guint64 key = id;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  return g_hash_table_lookup (self->main_contexts_by_id, &key);
+}
+
+/**
+ * dfl_model_lookup_thread:
+ * @self: a #DflModel
+ * @id: ID of the thread to look up
+ *
+ * Look up a #DflThread by its ID. If the ID was reused by several threads
+ * over the course of the event sequence, the last of them is returned.
+ *
+ * Returns: (transfer none) (nullable): the thread, or %NULL if none was found
+ * Since: UNRELEASED
+ */
+DflThread *
+dfl_model_lookup_thread (DflModel    *self,
+                         DflThreadId  id)
+{
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  return g_hash_table_lookup (self->threads_by_id, &id);
+}
+
+/**
+ * dfl_model_lookup_source:
+ * @self: a #DflModel
+ * @id: ID of the source to look up
+ *
+ * Look up a #DflSource by its ID. Source IDs are the addresses of the sources,
+ * so may be reused after a source is freed; in that case, the last source
+ * with the ID is returned.
+ *
+ * Returns: (transfer none) (nullable): the source, or %NULL if none was found
+ * Since: UNRELEASED
+ */
+DflSource *
+dfl_model_lookup_source (DflModel *self,
+                         DflId     id)
+{
+  guint64 key = id;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  return g_hash_table_lookup (self->sources_by_id, &key);
+}
+
+/**
+ * dfl_model_lookup_task:
+ * @self: a #DflModel
+ * @id: ID of the task to look up
+ *
+ * Look up a #DflTask by its ID. Task IDs are the addresses of the tasks, so
+ * may be reused after a task is freed; in that case, the last task with the
+ * ID is returned.
+ *
+ * Returns: (transfer none) (nullable): the task, or %NULL if none was found
+ * Since: UNRELEASED
+ */
+DflTask *
+dfl_model_lookup_task (DflModel *self,
+                       DflId     id)
+{
+  guint64 key = id;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  return g_hash_table_lookup (self->tasks_by_id, &key);
+}
+
 /**
  * dfl_model_get_n_long_dispatches:
  * @self: a #DflModel
@@ -341,6 +609,481 @@ dfl_model_get_n_long_dispatches (DflModel    *self,
   return total;
 }
 
+/**
+ * dfl_model_dup_dispatch_histogram:
+ * @self: a #DflModel
+ *
+ * Get a histogram of the durations of all the dispatches of all sources, which
+ * can be used to query percentiles of the dispatch duration over the whole
+ * model. See dfl_source_get_dispatch_histogram().
+ *
+ * Returns: (transfer full): a new histogram of dispatch durations
+ * Since: UNRELEASED
+ */
+DflHistogram *
+dfl_model_dup_dispatch_histogram (DflModel *self)
+{
+  g_autoptr (DflHistogram) histogram = NULL;
+  gsize i;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  histogram = dfl_histogram_new ();
+
+  for (i = 0; i < self->sources->len; i++)
+    {
+      DflSource *source = self->sources->pdata[i];
+
+      dfl_histogram_merge (histogram,
+                           dfl_source_get_dispatch_histogram (source));
+    }
+
+  return g_steal_pointer (&histogram);
+}
+
+/**
+ * dfl_model_dup_lateness_histogram:
+ * @self: a #DflModel
+ * @main_context_id: ID of the main context to restrict to, or
+ *    %DFL_ID_INVALID to include all sources
+ *
+ * Get a histogram of how late sources with ready times (such as timeouts) were
+ * dispatched, over all the sources attached to the given main context. See
+ * dfl_source_get_lateness_histogram().
+ *
+ * Returns: (transfer full): a new histogram of dispatch lateness
+ * Since: UNRELEASED
+ */
+DflHistogram *
+dfl_model_dup_lateness_histogram (DflModel *self,
+                                  DflId     main_context_id)
+{
+  g_autoptr (DflHistogram) histogram = NULL;
+  gsize i;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  histogram = dfl_histogram_new ();
+
+  for (i = 0; i < self->sources->len; i++)
+    {
+      DflSource *source = self->sources->pdata[i];
+
+      if (main_context_id != DFL_ID_INVALID &&
+          dfl_source_get_attach_main_context_id (source) != main_context_id)
+        continue;
+
+      dfl_histogram_merge (histogram,
+                           dfl_source_get_lateness_histogram (source));
+    }
+
+  return g_steal_pointer (&histogram);
+}
+
+/* Take the entries out of @entries, which must have no free functions, into a
+ * new array which owns them, sorted by @compare. */
+static GPtrArray *
+profile_new_sorted (GHashTable     *entries,
+                    GDestroyNotify  entry_free,
+                    GCompareFunc    compare)
+{
+  GPtrArray *profile;
+  GHashTableIter hash_iter;
+  gpointer value;
+
+  profile = g_ptr_array_new_full (g_hash_table_size (entries), entry_free);
+
+  g_hash_table_iter_init (&hash_iter, entries);
+
+  while (g_hash_table_iter_next (&hash_iter, NULL, &value))
+    g_ptr_array_add (profile, value);
+
+  g_ptr_array_sort (profile, compare);
+
+  return profile;
+}
+
+/* Copy the first @max_n_entries of @profile (or all of them, if it is 0) into
+ * a new container. */
+static GPtrArray *
+profile_dup_top (GPtrArray *profile,
+                 guint      max_n_entries)
+{
+  GPtrArray *top;
+  guint i, n_entries;
+
+  n_entries = profile->len;
+  if (max_n_entries > 0)
+    n_entries = MIN (n_entries, max_n_entries);
+
+  top = g_ptr_array_sized_new (n_entries);
+
+  for (i = 0; i < n_entries; i++)
+    g_ptr_array_add (top, profile->pdata[i]);
+
+  return top;
+}
+
+/* Profile entries are grouped by all three of their names, any of which may
+ * be %NULL. */
+static guint
+profile_entry_hash (gconstpointer key)
+{
+  const DflProfileEntry *entry = key;
+
+  return ((entry->callback_name != NULL) ? g_str_hash (entry->callback_name) : 0) ^
+         ((entry->dispatch_name != NULL) ? g_str_hash (entry->dispatch_name) : 0) * 31 ^
+         ((entry->source_name != NULL) ? g_str_hash (entry->source_name) : 0) * 37;
+}
+
+static gboolean
+profile_entry_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const DflProfileEntry *entry_a = a, *entry_b = b;
+
+  return (g_strcmp0 (entry_a->callback_name, entry_b->callback_name) == 0 &&
+          g_strcmp0 (entry_a->dispatch_name, entry_b->dispatch_name) == 0 &&
+          g_strcmp0 (entry_a->source_name, entry_b->source_name) == 0);
+}
+
+/* A dispatch which has started but not yet finished, used while building the
+ * profile. */
+typedef struct
+{
+  DflId source_id;
+  DflTimestamp timestamp;
+  DflDuration nested_duration;  /* total duration of directly nested dispatches */
+  DflProfileEntry *entry;  /* (unowned) */
+} ProfileFrame;
+
+/* The dispatches currently in progress on a thread, innermost last. */
+typedef struct
+{
+  DflThreadId thread_id;
+  GArray *frames;  /* (owned) (element-type ProfileFrame) */
+} ProfileStack;
+
+static void
+profile_stack_free (ProfileStack *stack)
+{
+  g_array_unref (stack->frames);
+  g_free (stack);
+}
+
+static gint
+profile_entry_compare_total_duration (gconstpointer a,
+                                      gconstpointer b)
+{
+  const DflProfileEntry *entry_a = *((const DflProfileEntry **) a);
+  const DflProfileEntry *entry_b = *((const DflProfileEntry **) b);
+
+  if (entry_a->total_duration != entry_b->total_duration)
+    return (entry_a->total_duration > entry_b->total_duration) ? -1 : 1;
+  return 0;
+}
+
+static gboolean
+profile_entry_remove_empty_cb (gpointer key,
+                               gpointer value,
+                               gpointer user_data)
+{
+  DflProfileEntry *entry = key;
+
+  if (entry->n_dispatches > 0)
+    return FALSE;
+
+  dfl_profile_entry_free (entry);
+  return TRUE;
+}
+
+/* Build the flat profile, if it has not been built already. This takes a
+ * single pass over the events, which are in timestamp order, and so in order
+ * on each thread. Each thread has a stack of the dispatches in progress on it;
+ * when a dispatch finishes, its duration is added to its entry and to the
+ * nested duration of the dispatch it is directly nested in, which is
+ * subtracted from that dispatch’s self time when it finishes in turn.
+ *
+ * The source for each dispatch is the most recently created one with its ID,
+ * tracked by walking the sources (which are in creation order) alongside the
+ * events. Dispatches which never finished are skipped. */
+static void
+dfl_model_ensure_profile (DflModel *self)
+{
+  g_autoptr (GHashTable) entries = NULL;  /* (element-type DflProfileEntry DflProfileEntry) */
+  g_autoptr (GHashTable) stacks = NULL;  /* (element-type DflThreadId ProfileStack) */
+  g_autoptr (GHashTable) live_sources = NULL;  /* (element-type DflId DflSource) */
+  const DflEventStore *store;
+  guint i, n_events, next_source = 0;
+
+  if (self->profile != NULL)
+    return;
+
+  entries = g_hash_table_new (profile_entry_hash, profile_entry_equal);
+  stacks = g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL,
+                                  (GDestroyNotify) profile_stack_free);
+  live_sources = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+                                       NULL);
+
+  store = dfl_event_sequence_get_store (self->event_sequence);
+  n_events = dfl_event_store_get_n_events (store);
+
+  for (i = 0; i < n_events; i++)
+    {
+      DflEventType event_type;
+      DflTimestamp timestamp;
+      DflThreadId thread_id;
+      const DflEventParameterValue *values;
+      guint n_parameters;
+      DflId source_id;
+      guint64 source_key;
+      ProfileStack *stack;
+
+      event_type = dfl_event_store_get_event_type (store, i);
+
+      if (event_type != DFL_EVENT_TYPE_G_SOURCE_BEFORE_DISPATCH &&
+          event_type != DFL_EVENT_TYPE_G_SOURCE_AFTER_DISPATCH)
+        continue;
+
+      timestamp = g_array_index (store->timestamps, DflTimestamp, i);
+      thread_id = g_array_index (store->thread_ids, DflThreadId, i);
+      values = dfl_event_store_get_parameters (store, i, NULL, &n_parameters);
+      source_id = values[0].id;
+
+      stack = g_hash_table_lookup (stacks, &thread_id);
+
+      if (stack == NULL)
+        {
+          stack = g_new0 (ProfileStack, 1);
+          stack->thread_id = thread_id;
+          stack->frames = g_array_new (FALSE, FALSE, sizeof (ProfileFrame));
+          g_hash_table_insert (stacks, &stack->thread_id, stack);
+        }
+
+      if (event_type == DFL_EVENT_TYPE_G_SOURCE_BEFORE_DISPATCH)
+        {
+          DflSource *source;
+          DflProfileEntry key, *entry;
+          ProfileFrame frame;
+
+          /* Catch up with the sources created before this dispatch. */
+          for (; next_source < self->sources->len; next_source++)
+            {
+              source = self->sources->pdata[next_source];
+
+              if (dfl_source_get_new_timestamp (source) > timestamp)
+                break;
+
+              g_hash_table_replace (live_sources,
+                                    id_key_new (dfl_source_get_id (source)),
+                                    source);
+            }
+
+          source_key = source_id;
+          source = g_hash_table_lookup (live_sources, &source_key);
+
+          key.callback_name = (gchar *) values[2].string;
+          key.dispatch_name = (gchar *) values[1].string;
+          key.source_name = (source != NULL) ? (gchar *) dfl_source_get_name (source) : NULL;
+
+          entry = g_hash_table_lookup (entries, &key);
+
+          if (entry == NULL)
+            {
+              entry = dfl_profile_entry_new (key.callback_name,
+                                             key.dispatch_name,
+                                             key.source_name);
+              g_hash_table_add (entries, entry);
+            }
+
+          frame.source_id = source_id;
+          frame.timestamp = timestamp;
+          frame.nested_duration = 0;
+          frame.entry = entry;
+          g_array_append_val (stack->frames, frame);
+        }
+      else
+        {
+          const ProfileFrame *frame;
+          DflDuration duration;
+          guint depth;
+
+          /* Find the matching dispatch. Any dispatches nested inside it which
+           * are still open never finished, so are dropped. */
+          for (depth = stack->frames->len; depth > 0; depth--)
+            {
+              if (g_array_index (stack->frames, ProfileFrame,
+                                 depth - 1).source_id == source_id)
+                break;
+            }
+
+          if (depth == 0)
+            continue;
+
+          frame = &g_array_index (stack->frames, ProfileFrame, depth - 1);
+          duration = timestamp - frame->timestamp;
+
+          frame->entry->n_dispatches++;
+          frame->entry->total_duration += duration;
+          frame->entry->self_duration += duration - frame->nested_duration;
+          dfl_histogram_record (frame->entry->histogram, duration);
+
+          g_array_set_size (stack->frames, depth - 1);
+
+          if (stack->frames->len > 0)
+            g_array_index (stack->frames, ProfileFrame,
+                           stack->frames->len - 1).nested_duration += duration;
+        }
+    }
+
+  /* Drop the entries for dispatches which never finished, and sort the rest
+   * by total duration. */
+  g_hash_table_foreach_remove (entries, profile_entry_remove_empty_cb, NULL);
+  self->profile = profile_new_sorted (entries,
+                                      (GDestroyNotify) dfl_profile_entry_free,
+                                      profile_entry_compare_total_duration);
+}
+
+/**
+ * dfl_model_dup_profile:
+ * @self: a #DflModel
+ * @max_n_entries: maximum number of entries to return, or 0 for all of them
+ *
+ * Get a flat profile of all the dispatches of all sources in the model, with
+ * one #DflProfileEntry for each distinct combination of callback name,
+ * dispatch function name and source name. The entries are sorted by
+ * decreasing total duration, and only the first @max_n_entries are returned.
+ *
+ * The profile is calculated on the first call, and cached for subsequent
+ * calls. The entries are owned by the model, and remain valid for its
+ * lifetime.
+ *
+ * Returns: (transfer container) (element-type DflProfileEntry): the top
+ *    profile entries
+ * Since: UNRELEASED
+ */
+GPtrArray *
+dfl_model_dup_profile (DflModel *self,
+                       guint     max_n_entries)
+{
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  dfl_model_ensure_profile (self);
+
+  return profile_dup_top (self->profile, max_n_entries);
+}
+
+/* Task profile entries are grouped by both of their names, either of which may
+ * be %NULL. */
+static guint
+task_profile_entry_hash (gconstpointer key)
+{
+  const DflTaskProfileEntry *entry = key;
+
+  return ((entry->source_tag_name != NULL) ? g_str_hash (entry->source_tag_name) : 0) ^
+         ((entry->callback_name != NULL) ? g_str_hash (entry->callback_name) : 0) * 31;
+}
+
+static gboolean
+task_profile_entry_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const DflTaskProfileEntry *entry_a = a, *entry_b = b;
+
+  return (g_strcmp0 (entry_a->source_tag_name, entry_b->source_tag_name) == 0 &&
+          g_strcmp0 (entry_a->callback_name, entry_b->callback_name) == 0);
+}
+
+static gint
+task_profile_entry_compare_n_tasks (gconstpointer a,
+                                    gconstpointer b)
+{
+  const DflTaskProfileEntry *entry_a = *((const DflTaskProfileEntry **) a);
+  const DflTaskProfileEntry *entry_b = *((const DflTaskProfileEntry **) b);
+
+  if (entry_a->n_tasks != entry_b->n_tasks)
+    return (entry_a->n_tasks > entry_b->n_tasks) ? -1 : 1;
+  return 0;
+}
+
+/* Build the task profile, if it has not been built already, in a single pass
+ * over the tasks. */
+static void
+dfl_model_ensure_task_profile (DflModel *self)
+{
+  g_autoptr (GHashTable) entries = NULL;  /* (element-type DflTaskProfileEntry DflTaskProfileEntry) */
+  gsize i;
+
+  if (self->task_profile != NULL)
+    return;
+
+  entries = g_hash_table_new (task_profile_entry_hash,
+                              task_profile_entry_equal);
+
+  for (i = 0; i < self->tasks->len; i++)
+    {
+      DflTask *task = self->tasks->pdata[i];
+      DflTaskProfileEntry key, *entry;
+      DflTaskPhase phase;
+
+      key.source_tag_name = (gchar *) dfl_task_get_source_tag_name (task);
+      key.callback_name = (gchar *) dfl_task_get_callback_name (task);
+
+      entry = g_hash_table_lookup (entries, &key);
+
+      if (entry == NULL)
+        {
+          entry = dfl_task_profile_entry_new (key.source_tag_name,
+                                              key.callback_name);
+          g_hash_table_add (entries, entry);
+        }
+
+      entry->n_tasks++;
+
+      for (phase = 0; phase < DFL_TASK_N_PHASES; phase++)
+        {
+          DflDuration duration = dfl_task_get_phase_duration (task, phase);
+
+          if (duration >= 0)
+            dfl_histogram_record (entry->phase_histograms[phase], duration);
+        }
+    }
+
+  self->task_profile = profile_new_sorted (entries,
+                                           (GDestroyNotify) dfl_task_profile_entry_free,
+                                           task_profile_entry_compare_n_tasks);
+}
+
+/**
+ * dfl_model_dup_task_profile:
+ * @self: a #DflModel
+ * @max_n_entries: maximum number of entries to return, or 0 for all of them
+ *
+ * Get a profile of the lifecycles of all the #GTasks in the model, with one
+ * #DflTaskProfileEntry for each distinct combination of source tag name and
+ * callback name. Each entry has a histogram of the durations of each
+ * #DflTaskPhase of its tasks. The entries are sorted by decreasing number of
+ * tasks, and only the first @max_n_entries are returned.
+ *
+ * The profile is calculated on the first call, and cached for subsequent
+ * calls. The entries are owned by the model, and remain valid for its
+ * lifetime.
+ *
+ * Returns: (transfer container) (element-type DflTaskProfileEntry): the top
+ *    task profile entries
+ * Since: UNRELEASED
+ */
+GPtrArray *
+dfl_model_dup_task_profile (DflModel *self,
+                            guint     max_n_entries)
+{
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  dfl_model_ensure_task_profile (self);
+
+  return profile_dup_top (self->task_profile, max_n_entries);
+}
+
 /**
  * dfl_model_get_n_main_context_thread_switches:
  * @self: a #DflModel
@@ -376,3 +1119,138 @@ dfl_model_get_n_main_context_thread_switches (DflModel *self)
 
   return total;
 }
+
+/**
+ * dfl_model_get_contention_totals:
+ * @self: a #DflModel
+ * @thread_id: ID of the thread to sum contention for, or 0 for all threads
+ * @n_failures: (out) (optional): return location for the number of failed
+ *    g_main_context_acquire() calls
+ *
+ * Sum the time threads spent waiting to acquire main contexts owned by other
+ * threads, and count their failed acquires, over all the main contexts in the
+ * model. See dfl_main_context_get_contention_totals() for the totals of a
+ * single main context.
+ *
+ * Returns: total contended time, in microseconds
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_model_get_contention_totals (DflModel    *self,
+                                 DflThreadId  thread_id,
+                                 gsize       *n_failures)
+{
+  DflDuration total_duration = 0;
+  gsize total_n_failures = 0;
+  gsize i;
+
+  g_return_val_if_fail (DFL_IS_MODEL (self), 0);
+
+  for (i = 0; i < self->main_contexts->len; i++)
+    {
+      DflMainContext *main_context = self->main_contexts->pdata[i];
+      gsize main_context_n_failures;
+
+      total_duration += dfl_main_context_get_contention_totals (main_context,
+                                                                thread_id,
+                                                                &main_context_n_failures);
+      total_n_failures += main_context_n_failures;
+    }
+
+  if (n_failures != NULL)
+    *n_failures = total_n_failures;
+
+  return total_duration;
+}
+
+static gint
+handoff_profile_entry_compare_total_latency (gconstpointer a,
+                                             gconstpointer b)
+{
+  const DflHandoffProfileEntry *entry_a = *((const DflHandoffProfileEntry **) a);
+  const DflHandoffProfileEntry *entry_b = *((const DflHandoffProfileEntry **) b);
+
+  if (entry_a->total_latency != entry_b->total_latency)
+    return (entry_a->total_latency > entry_b->total_latency) ? -1 : 1;
+  return 0;
+}
+
+/* Build the handoff profile, if it has not been built already, in a single
+ * pass over the sources. Entries are grouped by callback name, which may be
+ * %NULL; g_str_hash() cannot handle that, so %NULL names are stored under the
+ * empty string. */
+static void
+dfl_model_ensure_handoff_profile (DflModel *self)
+{
+  g_autoptr (GHashTable) entries = NULL;  /* (element-type utf8 DflHandoffProfileEntry) */
+  gsize i;
+
+  if (self->handoff_profile != NULL)
+    return;
+
+  entries = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < self->sources->len; i++)
+    {
+      DflSource *source = self->sources->pdata[i];
+      DflHandoffProfileEntry *entry;
+      const gchar *callback_name;
+      DflDuration latency;
+
+      latency = dfl_source_get_handoff_latency (source, &callback_name);
+
+      if (latency < 0)
+        continue;
+
+      entry = g_hash_table_lookup (entries,
+                                   (callback_name != NULL) ? callback_name : "");
+
+      if (entry == NULL)
+        {
+          entry = dfl_handoff_profile_entry_new (callback_name);
+          g_hash_table_insert (entries,
+                               (entry->callback_name != NULL) ? entry->callback_name : "",
+                               entry);
+        }
+
+      entry->n_sources++;
+      entry->total_latency += latency;
+      dfl_histogram_record (entry->histogram, latency);
+    }
+
+  self->handoff_profile = profile_new_sorted (entries,
+                                              (GDestroyNotify) dfl_handoff_profile_entry_free,
+                                              handoff_profile_entry_compare_total_latency);
+}
+
+/**
+ * dfl_model_dup_handoff_profile:
+ * @self: a #DflModel
+ * @max_n_entries: maximum number of entries to return, or 0 for all of them
+ *
+ * Get a profile of the sources in the model which were attached from one
+ * thread and first dispatched on another, such as those added with
+ * g_idle_add() from a worker thread, with one #DflHandoffProfileEntry for each
+ * distinct callback name. Each entry has a histogram of the handoff latencies
+ * of its sources; see dfl_source_get_handoff_latency(). The entries are sorted
+ * by decreasing total latency, and only the first @max_n_entries are
+ * returned.
+ *
+ * The profile is calculated on the first call, and cached for subsequent
+ * calls. The entries are owned by the model, and remain valid for its
+ * lifetime.
+ *
+ * Returns: (transfer container) (element-type DflHandoffProfileEntry): the top
+ *    handoff profile entries
+ * Since: UNRELEASED
+ */
+GPtrArray *
+dfl_model_dup_handoff_profile (DflModel *self,
+                               guint     max_n_entries)
+{
+  g_return_val_if_fail (DFL_IS_MODEL (self), NULL);
+
+  dfl_model_ensure_handoff_profile (self);
+
+  return profile_dup_top (self->handoff_profile, max_n_entries);
+}
@@ -23,6 +23,12 @@
 #include <glib-object.h>
 
 #include "event-sequence.h"
+#include "histogram.h"
+#include "main-context.h"
+#include "profile.h"
+#include "source.h"
+#include "task.h"
+#include "thread.h"
 
 G_BEGIN_DECLS
 
@@ -45,9 +51,32 @@ GPtrArray        *dfl_model_dup_threads        (DflModel *self);
 GPtrArray        *dfl_model_dup_sources        (DflModel *self);
 GPtrArray        *dfl_model_dup_tasks          (DflModel *self);
 
+DflMainContext   *dfl_model_lookup_main_context (DflModel    *self,
+                                                 DflId        id);
+DflThread        *dfl_model_lookup_thread       (DflModel    *self,
+                                                 DflThreadId  id);
+DflSource        *dfl_model_lookup_source       (DflModel    *self,
+                                                 DflId        id);
+DflTask          *dfl_model_lookup_task         (DflModel    *self,
+                                                 DflId        id);
+
 gsize dfl_model_get_n_long_dispatches              (DflModel    *self,
                                                     DflDuration  min_duration);
 gsize dfl_model_get_n_main_context_thread_switches (DflModel    *self);
+DflDuration dfl_model_get_contention_totals (DflModel    *self,
+                                             DflThreadId  thread_id,
+                                             gsize       *n_failures);
+
+DflHistogram *dfl_model_dup_dispatch_histogram (DflModel *self);
+DflHistogram *dfl_model_dup_lateness_histogram (DflModel *self,
+                                                DflId     main_context_id);
+
+GPtrArray *dfl_model_dup_profile         (DflModel *self,
+                                          guint     max_n_entries);
+GPtrArray *dfl_model_dup_task_profile    (DflModel *self,
+                                          guint     max_n_entries);
+GPtrArray *dfl_model_dup_handoff_profile (DflModel *self,
+                                          guint     max_n_entries);
 
 G_END_DECLS
 
@@ -0,0 +1,74 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_PARSER_PRIVATE_H
+#define DFL_PARSER_PRIVATE_H
+
+#include <glib.h>
+
+#include "parser.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Entry points into the text log tokeniser, so the tests can check the
+ * vectorised and SWAR code paths against their scalar references.
+ *
+ * dfl_parser_parse_uint64() parses the whole of @data as an unsigned decimal
+ * integer, returning %FALSE if it is empty, contains a non-digit or overflows.
+ *
+ * dfl_parser_tokenize_line() scans the line starting at @line, up to the first
+ * newline or @length bytes, and returns its length. The offsets of the first
+ * few commas in it are stored in @comma_offsets (element type #gsize), and the
+ * total number of commas in @n_commas.
+ */
+gboolean dfl_parser_parse_uint64  (const gchar *data,
+                                   gsize        length,
+                                   gboolean     use_scalar,
+                                   guint64     *value_out);
+gsize    dfl_parser_tokenize_line (const gchar *line,
+                                   gsize        length,
+                                   gboolean     use_scalar,
+                                   GArray      *comma_offsets,
+                                   guint       *n_commas,
+                                   gboolean    *needs_validation);
+
+/*
+ * dfl_parser_load_from_data_in_chunks() is like dfl_parser_load_from_data(),
+ * but always splits the log into @n_chunks chunks to be parsed in parallel,
+ * however small it is.
+ */
+void dfl_parser_load_from_data_in_chunks (DflParser     *self,
+                                          const guint8  *data,
+                                          gsize          length,
+                                          guint          n_chunks,
+                                          GError       **error);
+
+/*
+ * dfl_parser_load_from_stream_in_chunks() is like
+ * dfl_parser_load_from_stream(), but reads and parses the log in chunks of
+ * about @chunk_size bytes, rather than megabytes at a time.
+ */
+void dfl_parser_load_from_stream_in_chunks (DflParser     *self,
+                                            GInputStream  *stream,
+                                            gsize          chunk_size,
+                                            GError       **error);
+
+G_END_DECLS
+
+#endif /* !DFL_PARSER_PRIVATE_H */
@@ -29,25 +29,52 @@
 
 #include "config.h"
 
-#include <errno.h>
 #include <glib.h>
 #include <gio/gio.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "binary-log-private.h"
 #include "event.h"
+#include "event-private.h"
 #include "event-sequence.h"
+#include "event-sequence-private.h"
 #include "parser.h"
+#include "parser-private.h"
+#include "zstd-decompressor-private.h"
+
 
+typedef struct _ParseState ParseState;
 
 static void dfl_parser_dispose (GObject *object);
+static void feed_reset (DflParser *self);
+static void load_from_stream (DflParser     *self,
+                              GInputStream  *base_stream,
+                              gsize          chunk_size,
+                              GCancellable  *cancellable,
+                              GError       **error);
 
 struct _DflParser
 {
   GObject parent;
 
   DflEventSequence *sequence;  /* owned */
+
+  /* State for dfl_parser_feed(). */
+  ParseState *feed_state;  /* owned; nullable */
+  GByteArray *feed_line;  /* owned; nullable; partial line carried over */
+};
+
+enum
+{
+  SIGNAL_EVENTS_PARSED,
 };
 
+static guint signals[SIGNAL_EVENTS_PARSED + 1] = { 0, };
+
 G_DEFINE_TYPE (DflParser, dfl_parser, G_TYPE_OBJECT)
 
 static void
@@ -56,6 +83,32 @@ dfl_parser_class_init (DflParserClass *klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->dispose = dfl_parser_dispose;
+
+  /**
+   * DflParser::events-parsed:
+   * @self: a #DflParser
+   * @position: index of the first new event in the event sequence
+   * @n_events: number of new events
+   *
+   * Emitted by dfl_parser_feed() and dfl_parser_feed_end() once they have
+   * appended newly parsed events to the parser’s #DflEventSequence. It is
+   * also emitted (with @n_events possibly zero) when the event sequence is
+   * first created, once the log header has been parsed; before then,
+   * dfl_parser_get_event_sequence() returns %NULL.
+   *
+   * The new events are the @n_events starting at @position in the sequence.
+   * The sequence also emits #GListModel::items-changed for them.
+   *
+   * Since: UNRELEASED
+   */
+  signals[SIGNAL_EVENTS_PARSED] =
+    g_signal_new ("events-parsed", G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 2,
+                  G_TYPE_UINT, G_TYPE_UINT);
+
+  dfl_event_type_table_ensure ();
 }
 
 static void
@@ -69,55 +122,744 @@ dfl_parser_dispose (GObject *object)
 {
   DflParser *self = DFL_PARSER (object);
 
+  feed_reset (self);
   g_clear_object (&self->sequence);
 
   /* Chain up to the parent class */
   G_OBJECT_CLASS (dfl_parser_parent_class)->dispose (object);
 }
 
+/* Maximum number of components on a line we care about: event type, timestamp,
+ * thread ID, and the parameters for the event type with the most parameters.
+ * Lines with more components than this are always rejected (or ignored, if
+ * their event type is unknown). */
+#define MAX_COMPONENTS (3 + DFL_EVENT_MAX_PARAMETERS)
+
+/* A component of a log line. This points into the buffer being parsed, which
+ * is not nul-terminated at the end of the component; so the @length must
+ * always be used. */
+typedef struct
+{
+  const gchar *data;  /* unowned; not nul-terminated */
+  gsize length;
+} Token;
+
+static gboolean
+token_equal (const Token *token,
+             const gchar *str)
+{
+  return (strncmp (token->data, str, token->length) == 0 &&
+          str[token->length] == '\0');
+}
+
+/* Check whether the 8 bytes in @chunk (loaded little-endian) are all ASCII
+ * digits, without branching on each byte. */
+static inline gboolean
+is_eight_digits (guint64 chunk)
+{
+  return (((chunk & G_GUINT64_CONSTANT (0xF0F0F0F0F0F0F0F0)) |
+           (((chunk + G_GUINT64_CONSTANT (0x0606060606060606)) &
+             G_GUINT64_CONSTANT (0xF0F0F0F0F0F0F0F0)) >> 4)) ==
+          G_GUINT64_CONSTANT (0x3333333333333333));
+}
+
+/* Convert 8 ASCII digits in @chunk (loaded little-endian, and already checked
+ * with is_eight_digits()) to their value, combining pairs of digits in
+ * parallel within the word (SWAR). */
+static inline guint32
+parse_eight_digits (guint64 chunk)
+{
+  const guint64 mask = G_GUINT64_CONSTANT (0x000000FF000000FF);
+  const guint64 mul1 = G_GUINT64_CONSTANT (0x000F424000000064);  /* 100 + (1000000 << 32) */
+  const guint64 mul2 = G_GUINT64_CONSTANT (0x0000271000000001);  /* 1 + (10000 << 32) */
+
+  chunk -= G_GUINT64_CONSTANT (0x3030303030303030);
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+
+  return (guint32) chunk;
+}
+
+/* Parse an unsigned decimal integer from the whole of @token a digit at a
+ * time, checking for overflow on each digit. Returns %FALSE if the token is
+ * empty, contains a non-digit, or overflows a #guint64. This is the reference
+ * for token_to_uint64(). */
+static gboolean
+token_to_uint64_scalar (const Token *token,
+                        guint64     *value_out)
+{
+  guint64 value = 0;
+  gsize i;
+
+  if (token->length == 0)
+    return FALSE;
+
+  for (i = 0; i < token->length; i++)
+    {
+      guint digit = (guint) (token->data[i] - '0');
+
+      if (digit > 9)
+        return FALSE;
+      if (value > (G_MAXUINT64 - digit) / 10)
+        return FALSE;
+
+      value = value * 10 + digit;
+    }
+
+  *value_out = value;
+
+  return TRUE;
+}
+
+/* Parse an unsigned decimal integer from the whole of @token. Returns %FALSE if
+ * the token is empty, contains a non-digit, or overflows a #guint64.
+ *
+ * Up to 19 digits cannot overflow, so those are parsed eight digits at a time
+ * and then a digit at a time, accumulating validity rather than branching on
+ * each digit. Longer (20 digit) values take the slow path. */
+static gboolean
+token_to_uint64 (const Token *token,
+                 guint64     *value_out)
+{
+  const gchar *p = token->data;
+  gsize n_remaining = token->length;
+  guint64 value = 0;
+  guint invalid = 0;
+
+  if (token->length == 0 || token->length > 20)
+    return FALSE;
+
+  if (token->length == 20)
+    return token_to_uint64_scalar (token, value_out);
+
+  for (; n_remaining >= 8; p += 8, n_remaining -= 8)
+    {
+      guint64 chunk;
+
+      memcpy (&chunk, p, sizeof (chunk));
+      chunk = GUINT64_FROM_LE (chunk);
+
+      if (!is_eight_digits (chunk))
+        return FALSE;
+
+      value = value * 100000000 + parse_eight_digits (chunk);
+    }
+
+  for (; n_remaining > 0; p++, n_remaining--)
+    {
+      guint digit = (guint) (*p - '0');
+
+      invalid |= (digit > 9);
+      value = value * 10 + digit;
+    }
+
+  if (invalid)
+    return FALSE;
+
+  *value_out = value;
+
+  return TRUE;
+}
+
+/* Result of scanning a line with tokenize_line(): the offsets of the commas in
+ * it, and whether it needs full UTF-8 validation. */
 typedef struct
 {
-  const gchar *event_type;
-  guint n_parameters;  /* excluding event type, timestamp and thread ID */
-} EventData;
-
-const EventData event_type_array[] =
-{
-  { "g_main_context_new", 1 },
-  { "g_main_context_acquire", 2 },
-  { "g_main_context_release", 1 },
-  { "g_main_context_free", 1 },
-  { "g_main_context_before_dispatch", 1 },
-  { "g_main_context_after_dispatch", 1 },
-  { "g_source_new", 6 },
-  { "g_source_before_free", 3 },
-  { "g_source_before_dispatch", 4 },
-  { "g_source_after_dispatch", 3 },
-  { "g_source_set_name", 2 },
-  { "g_source_add_child_source", 2 },
-  { "g_source_attach", 3 },
-  { "g_source_destroy", 2 },
-  { "g_thread_spawned", 3 },
-  { "g_task_new", 5 },
-  { "g_task_set_source_tag", 2 },
-  { "g_task_before_return", 4 },
-  { "g_task_propagate", 2 },
-  { "g_task_before_run_in_thread", 2 },
-  { "g_task_after_run_in_thread", 2 },
+  gsize length;  /* up to, but not including, the newline */
+  guint n_commas;  /* total; only the first %MAX_COMPONENTS are stored */
+  gsize comma_offsets[MAX_COMPONENTS];
+  gboolean needs_validation;  /* non-ASCII or nul bytes were seen */
+} LineTokens;
+
+/* Scan the rest of a line a byte at a time, from @p (which is within the line
+ * starting at @line) up to the next newline or @data_end. This is the tail of
+ * tokenize_line(), and the reference for its vectorised code. */
+static void
+tokenize_line_scalar (const gchar *line,
+                      const gchar *p,
+                      const gchar *data_end,
+                      LineTokens  *tokens)
+{
+  for (; p < data_end && *p != '\n'; p++)
+    {
+      if (*p == ',')
+        {
+          if (tokens->n_commas < G_N_ELEMENTS (tokens->comma_offsets))
+            tokens->comma_offsets[tokens->n_commas] = p - line;
+          tokens->n_commas++;
+        }
+      else if (*p == '\0' || (guchar) *p >= 0x80)
+        {
+          tokens->needs_validation = TRUE;
+        }
+    }
+
+  tokens->length = p - line;
+}
+
+#if defined(__SSE2__)
+static inline void
+line_tokens_add_commas (LineTokens *tokens,
+                        gsize       block_offset,
+                        guint32     comma_mask)
+{
+  while (comma_mask != 0)
+    {
+      if (tokens->n_commas < G_N_ELEMENTS (tokens->comma_offsets))
+        tokens->comma_offsets[tokens->n_commas] = block_offset +
+                                                  g_bit_nth_lsf (comma_mask, -1);
+      tokens->n_commas++;
+
+      comma_mask &= comma_mask - 1;
+    }
+}
+#endif
+
+/* Scan a line starting at @line in a single pass, finding the end of the line
+ * (the next newline, or @data_end) and the offsets of all the commas in it,
+ * and noting whether it contains any bytes which mean it needs validating as
+ * UTF-8. Pure ASCII lines without nuls are always valid.
+ *
+ * If SSE2 is available (as it always is on x86-64), 16 bytes are compared at
+ * once, and the tail of the buffer is scanned with tokenize_line_scalar(). */
+static void
+tokenize_line (const gchar *line,
+               const gchar *data_end,
+               LineTokens  *tokens)
+{
+  const gchar *p = line;
+
+  tokens->n_commas = 0;
+  tokens->needs_validation = FALSE;
+
+#if defined(__SSE2__)
+  {
+    const __m128i newline = _mm_set1_epi8 ('\n');
+    const __m128i comma = _mm_set1_epi8 (',');
+    const __m128i nul = _mm_setzero_si128 ();
+
+    for (; data_end - p >= 16; p += 16)
+      {
+        __m128i block;
+        guint32 newline_mask, comma_mask, special_mask;
+
+        block = _mm_loadu_si128 ((const __m128i *) p);
+        newline_mask = (guint32) _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, newline));
+        comma_mask = (guint32) _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, comma));
+        special_mask = (guint32) _mm_movemask_epi8 (block) |
+                       (guint32) _mm_movemask_epi8 (_mm_cmpeq_epi8 (block, nul));
+
+        if (newline_mask != 0)
+          {
+            guint newline_offset = g_bit_nth_lsf (newline_mask, -1);
+            guint32 before_newline = (1u << newline_offset) - 1;
+
+            line_tokens_add_commas (tokens, p - line,
+                                    comma_mask & before_newline);
+            tokens->needs_validation |= ((special_mask & before_newline) != 0);
+            tokens->length = (p - line) + newline_offset;
+
+            return;
+          }
+
+        line_tokens_add_commas (tokens, p - line, comma_mask);
+        tokens->needs_validation |= (special_mask != 0);
+      }
+  }
+#endif
+
+  tokenize_line_scalar (line, p, data_end, tokens);
+}
+
+/* Wrappers around token_to_uint64() and tokenize_line(), and their scalar
+ * reference implementations, for the tests. */
+gboolean
+dfl_parser_parse_uint64 (const gchar *data,
+                         gsize        length,
+                         gboolean     use_scalar,
+                         guint64     *value_out)
+{
+  Token token = { data, length };
+
+  return use_scalar ? token_to_uint64_scalar (&token, value_out) :
+                      token_to_uint64 (&token, value_out);
+}
+
+gsize
+dfl_parser_tokenize_line (const gchar *line,
+                          gsize        length,
+                          gboolean     use_scalar,
+                          GArray      *comma_offsets,
+                          guint       *n_commas,
+                          gboolean    *needs_validation)
+{
+  LineTokens tokens;
+
+  if (use_scalar)
+    {
+      tokens.n_commas = 0;
+      tokens.needs_validation = FALSE;
+      tokenize_line_scalar (line, line, line + length, &tokens);
+    }
+  else
+    {
+      tokenize_line (line, line + length, &tokens);
+    }
+
+  g_array_set_size (comma_offsets, 0);
+  g_array_append_vals (comma_offsets, tokens.comma_offsets,
+                       MIN (tokens.n_commas, G_N_ELEMENTS (tokens.comma_offsets)));
+  *n_commas = tokens.n_commas;
+  *needs_validation = tokens.needs_validation;
+
+  return tokens.length;
+}
+
+/* Timestamps seen for a given thread. The first timestamp is needed to check
+ * monotonicity across the boundaries between chunks parsed in parallel. */
+typedef struct
+{
+  guint64 first;
+  guint64 highest;
+} ThreadTimestamps;
+
+/* State carried between lines while parsing a log, regardless of whether it is
+ * coming from a stream, a memory mapping, or dfl_parser_feed(). */
+struct _ParseState
+{
+  guint line_number;
+  guint n_comment_lines;
+  guint file_version;
+  guint64 initial_timestamp;
+  GHashTable/*<owned guint64, owned ThreadTimestamps>*/ *thread_timestamps;  /* owned */
+  DflEventStore events;
+  GString *scratch;  /* owned; reused for each string parameter */
+  /* Cache of the strings interned in @events, to avoid taking its lock. */
+  GHashTable/*<unowned utf8, unowned utf8>*/ *strings;  /* owned */
 };
 
-static const EventData *
-event_data_from_event_type (const gchar *event_type)
+/* Initialise @state to parse a log from the start. If @strings is non-%NULL,
+ * parameters are interned in it, so the events can be appended to another
+ * store using the same string table without re-interning them. */
+static void
+parse_state_init (ParseState     *state,
+                  DflStringTable *strings)
 {
-  guint i;
+  state->line_number = 0;
+  state->n_comment_lines = 0;
+  state->file_version = 0;
+  state->initial_timestamp = 0;
+  state->thread_timestamps = g_hash_table_new_full (g_int64_hash,
+                                                    g_int64_equal,
+                                                    g_free, g_free);
+  if (strings != NULL)
+    dfl_event_store_init_with_strings (&state->events, strings);
+  else
+    dfl_event_store_init (&state->events);
+  state->scratch = g_string_sized_new (256);
+  state->strings = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static void
+parse_state_clear (ParseState *state)
+{
+  dfl_event_store_clear (&state->events);
+  g_clear_pointer (&state->thread_timestamps, g_hash_table_unref);
+  g_clear_pointer (&state->strings, g_hash_table_unref);
 
-  for (i = 0; i < G_N_ELEMENTS (event_type_array); i++)
+  if (state->scratch != NULL)
+    g_string_free (state->scratch, TRUE);
+  state->scratch = NULL;
+}
+
+/* Replace the parser’s event sequence with the events accumulated in @state. */
+static void
+parse_state_finish (ParseState *state,
+                    DflParser  *self)
+{
+  g_clear_object (&self->sequence);
+  self->sequence = dfl_event_sequence_new_from_store (&state->events,
+                                                      state->initial_timestamp);
+}
+
+/* Check that @timestamp is not lower than any previous timestamp from the
+ * thread @thread_id (or than the initial timestamp for the log), and record it
+ * as the highest timestamp for that thread if so. */
+static gboolean
+update_thread_timestamps (ParseState *state,
+                          guint64     thread_id,
+                          guint64     timestamp)
+{
+  ThreadTimestamps *thread_timestamps;
+  guint64 *key = NULL;
+
+  thread_timestamps = g_hash_table_lookup (state->thread_timestamps,
+                                           (gpointer) &thread_id);
+
+  if ((thread_timestamps == NULL && timestamp < state->initial_timestamp) ||
+      (thread_timestamps != NULL && timestamp < thread_timestamps->highest))
+    return FALSE;
+
+  if (thread_timestamps != NULL)
     {
-      if (g_strcmp0 (event_type, event_type_array[i].event_type) == 0)
-        return &event_type_array[i];
+      thread_timestamps->highest = timestamp;
+      return TRUE;
     }
 
-  return NULL;
+  thread_timestamps = g_new0 (ThreadTimestamps, 1);
+  thread_timestamps->first = timestamp;
+  thread_timestamps->highest = timestamp;
+  key = g_new0 (guint64, 1);
+  *key = thread_id;
+
+  g_hash_table_insert (state->thread_timestamps, key, thread_timestamps);
+
+  return TRUE;
+}
+
+/* Intern the @length bytes at @data as a string in the string table of the
+ * events. The interned strings seen so far are cached in @state, so that the
+ * string table’s lock, which is shared with any other chunks being parsed in
+ * parallel, is only taken the first time each string is seen. */
+static const gchar *
+parse_state_intern (ParseState  *state,
+                    const gchar *data,
+                    gsize        length)
+{
+  const gchar *interned;
+
+  g_string_truncate (state->scratch, 0);
+  g_string_append_len (state->scratch, data, length);
+
+  interned = g_hash_table_lookup (state->strings, state->scratch->str);
+
+  if (interned == NULL)
+    {
+      interned = dfl_event_store_intern (&state->events, state->scratch->str);
+      g_hash_table_add (state->strings, (gpointer) interned);
+    }
+
+  return interned;
+}
+
+/* Parse a decimal #gint64, with an optional leading minus sign. */
+static gboolean
+token_to_int64 (const Token *token,
+                gint64      *value_out)
+{
+  Token digits = *token;
+  gboolean negative;
+  guint64 magnitude;
+
+  negative = (digits.length > 0 && digits.data[0] == '-');
+
+  if (negative)
+    {
+      digits.data++;
+      digits.length--;
+    }
+
+  if (!token_to_uint64 (&digits, &magnitude) ||
+      magnitude > (guint64) G_MAXINT64 + (negative ? 1 : 0))
+    return FALSE;
+
+  *value_out = negative ? (gint64) (0 - magnitude) : (gint64) magnitude;
+
+  return TRUE;
+}
+
+/* Decode @token as a parameter of the given @type. If it can’t be decoded as
+ * that type, it’s stored as a string, and dfl_event_get_parameter_id() (for
+ * example) will warn about it if it’s ever used. */
+static void
+token_to_parameter (ParseState        *state,
+                    const Token       *token,
+                    DflParameterType   type,
+                    DflEventParameter *parameter)
+{
+  switch (type)
+    {
+    case DFL_PARAMETER_TYPE_ID:
+      if (token_to_uint64 (token, &parameter->value.id))
+        {
+          parameter->type = DFL_PARAMETER_TYPE_ID;
+          return;
+        }
+      break;
+    case DFL_PARAMETER_TYPE_INT64:
+      if (token_to_int64 (token, &parameter->value.int64))
+        {
+          parameter->type = DFL_PARAMETER_TYPE_INT64;
+          return;
+        }
+      break;
+    case DFL_PARAMETER_TYPE_STRING:
+    case DFL_PARAMETER_TYPE_BYTES:
+    default:
+      break;
+    }
+
+  /* The line has already been validated as UTF-8. */
+  parameter->type = DFL_PARAMETER_TYPE_STRING;
+  parameter->value.string = parse_state_intern (state, token->data,
+                                                token->length);
+}
+
+/* Parse a single line of the log, which has already been scanned by
+ * tokenize_line() into @tokens. The line is not nul-terminated, and is
+ * tokenised in place without copying it, so it may point into a read-only
+ * mapping. */
+static gboolean
+parse_line (ParseState        *state,
+            const gchar       *line,
+            const LineTokens  *tokens,
+            GError           **error)
+{
+  const gchar *end = NULL;
+  const gchar *line_end;
+  gsize length, offset;
+  Token components[MAX_COMPONENTS];
+  guint n_components, i;
+
+  state->line_number++;
+  length = tokens->length;
+
+  /* Note: The line is an arbitrary byte stream. It is not valid UTF-8 and
+   * may contain embedded nuls. Validate that first, unless the tokenizer
+   * found it to be pure ASCII. */
+  if (tokens->needs_validation && !g_utf8_validate (line, length, &end))
+    {
+      /* TODO: Use a proper error code here. */
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                   "Invalid log file line %u — invalid UTF-8 at byte %"
+                   G_GOFFSET_FORMAT,
+                   state->line_number, (goffset) (end - line));
+      return FALSE;
+    }
+
+  /* Ignore whitespace. This only affects the first and last components, as
+   * whitespace is never a comma. */
+  line_end = line + length;
+
+  while (line_end > line && g_ascii_isspace (*(line_end - 1)))
+    line_end--;
+
+  for (offset = 0; line + offset < line_end && g_ascii_isspace (line[offset]);)
+    offset++;
+
+  /* Ignore comment or blank lines. */
+  if (line + offset == line_end || line[offset] == '#')
+    {
+      state->n_comment_lines++;
+      return TRUE;
+    }
+
+  g_debug ("%s: Line: %.*s", G_STRFUNC, (int) (line_end - line - offset),
+           line + offset);
+
+  /* Split into components using the comma offsets. Only the first
+   * %MAX_COMPONENTS are stored, but all of them are counted.
+   * TODO: Formally document log file format. */
+  n_components = tokens->n_commas + 1;
+
+  for (i = 0; i < n_components && i < G_N_ELEMENTS (components); i++)
+    {
+      const gchar *component_end;
+
+      component_end = (i < tokens->n_commas) ?
+                      line + tokens->comma_offsets[i] : line_end;
+
+      components[i].data = line + offset;
+      components[i].length = component_end - components[i].data;
+
+      offset = (component_end - line) + 1;
+    }
+
+  line = components[0].data;
+  length = line_end - line;
+
+  if (token_equal (&components[0], "Dunfell log"))
+    {
+      const Token *version, *timestamp;
+
+      /* Header line? Looks like:
+       *    Dunfell log,1.0,123456
+       * where 1.0 is the log format version, and 123456 is the starting
+       * timestamp. */
+
+      /* Is this the first line? Chunks parsed in parallel count their lines
+       * from zero, but have already seen the header. */
+      if (state->file_version != 0 ||
+          state->line_number - state->n_comment_lines != 1)
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid log file line %u — %s: %.*s",
+                       state->line_number,
+                       "header must be first non-comment line",
+                       (int) length, line);
+          return FALSE;
+        }
+
+      /* Check the number of components. */
+      if (n_components != 3)
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid log file line %u — %s: %.*s",
+                       state->line_number,
+                       "header contains the wrong number of components",
+                       (int) length, line);
+          return FALSE;
+        }
+
+      /* Extract the components. */
+      version = &components[1];
+      timestamp = &components[2];
+
+      /* File version check. */
+      if (!token_equal (version, "1.0"))
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Unsupported log file version ‘%.*s’ on line %u"
+                       "(versions supported: 1.0)",
+                       (int) version->length, version->data,
+                       state->line_number);
+          return FALSE;
+        }
+
+      state->file_version = 1;
+
+      /* Parse the timestamp. */
+      if (!token_to_uint64 (timestamp, &state->initial_timestamp))
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid timestamp ‘%.*s’ on line %u",
+                       (int) timestamp->length, timestamp->data,
+                       state->line_number);
+          return FALSE;
+        }
+    }
+  else
+    {
+      DflEventType event_type_id;
+      const DflEventTypeData *event_data;
+      const Token *event_type;
+      const Token *timestamp;
+      const Token *tid;
+      guint64 timestamp_int, tid_int;
+      DflEventParameter parameters[DFL_EVENT_MAX_PARAMETERS];
+      guint i;
+
+      /* Non-header line. Looks like:
+       *    g_idle_dispatch,1449749875412059,8491,140407983871120,12007776,\
+       *    140408421089918,0x7fb36210027e,14614576,0
+       */
+
+      /* Has there been a header? */
+      if (state->file_version == 0)
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid log file line %u — %s: %.*s",
+                       state->line_number,
+                       "header must be first non-comment line",
+                       (int) length, line);
+          return FALSE;
+        }
+
+      /* Extract the event type. */
+      event_type = &components[0];
+
+      if (event_type->length == 0)
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid log file line %u — %s: %.*s",
+                       state->line_number, "event type not specified",
+                       (int) length, line);
+          return FALSE;
+        }
+
+      /* Match it to an event parser. */
+      event_type_id = dfl_event_type_from_name (event_type->data,
+                                                event_type->length);
+
+      if (event_type_id == DFL_EVENT_TYPE_UNKNOWN)
+        {
+          /* Ignore unknown event types to allow for more probe points to be
+           * added to GLib in future. */
+          g_debug ("%s: Ignoring unrecognised event type ‘%.*s’ on "
+                   "line %u: %.*s", G_STRFUNC,
+                   (int) event_type->length, event_type->data,
+                   state->line_number, (int) length, line);
+          return TRUE;
+        }
+
+      event_data = dfl_event_type_get_data (event_type_id);
+
+      /* Check the number of components (ignoring the event type, timestamp
+       * and thread ID. */
+      if (n_components < 3 || n_components - 3 != event_data->n_parameters)
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid log file line %u — %s: %.*s",
+                       state->line_number,
+                       "event line contains the wrong number of components",
+                       (int) length, line);
+          return FALSE;
+        }
+
+      /* Grab the timestamp and thread ID. */
+      timestamp = &components[1];
+      tid = &components[2];
+
+      if (!token_to_uint64 (timestamp, &timestamp_int))
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid timestamp ‘%.*s’ on line %u",
+                       (int) timestamp->length, timestamp->data,
+                       state->line_number);
+          return FALSE;
+        }
+
+      if (!token_to_uint64 (tid, &tid_int))
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid thread ID ‘%.*s’ on line %u",
+                       (int) tid->length, tid->data, state->line_number);
+          return FALSE;
+        }
+
+      /* Check that the timestamps in each thread are monotonically
+       * increasing. */
+      if (!update_thread_timestamps (state, tid_int, timestamp_int))
+        {
+          /* TODO: Use a proper error code here. */
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                       "Invalid timestamp ‘%.*s’ on line %u: timestamps must "
+                       "be monotonically increasing",
+                       (int) timestamp->length, timestamp->data,
+                       state->line_number);
+          return FALSE;
+        }
+
+      /* Decode the parameters according to the schema. */
+      for (i = 0; i < event_data->n_parameters; i++)
+        token_to_parameter (state, &components[3 + i],
+                            event_data->parameter_types[i], &parameters[i]);
+
+      /* Store the event. */
+      dfl_event_store_append (&state->events, event_type_id, timestamp_int,
+                              tid_int, parameters, event_data->n_parameters);
+    }
+
+  return TRUE;
 }
 
 /**
@@ -134,6 +876,772 @@ dfl_parser_new (void)
   return g_object_new (DFL_TYPE_PARSER, NULL);
 }
 
+/* Parse lines from @data up to @data_end, which does not have to be
+ * nul-terminated. If @stop_after_header is %TRUE, stop once the header line has
+ * been parsed. Returns a pointer to the first unparsed byte, or %NULL on
+ * error. */
+static const gchar *
+parse_lines (ParseState   *state,
+             const gchar  *data,
+             const gchar  *data_end,
+             gboolean      stop_after_header,
+             GError      **error)
+{
+  const gchar *line;
+
+  for (line = data; line < data_end;)
+    {
+      LineTokens tokens;
+      const gchar *newline;
+
+      tokenize_line (line, data_end, &tokens);
+      newline = line + tokens.length;
+
+      if (!parse_line (state, line, &tokens, error))
+        return NULL;
+
+      line = (newline < data_end) ? newline + 1 : data_end;
+
+      if (stop_after_header && state->file_version != 0)
+        break;
+    }
+
+  return line;
+}
+
+/* Minimum number of bytes of log to give to each chunk parsed in parallel.
+ * Below this, the overhead of parsing in parallel isn’t worth it. */
+#define PARALLEL_CHUNK_MIN_SIZE (4 * 1024 * 1024)
+
+/* Number of bytes read from a stream at a time. Each read is parsed as one
+ * chunk, after the partial line at its end has been carried over to the next
+ * read. */
+#define STREAM_CHUNK_SIZE PARALLEL_CHUNK_MIN_SIZE
+
+/* Chunks of the log which have been split off, in order, but not yet added to
+ * @state. They are parsed in parallel on @pool, and at most @max_n_chunks of
+ * them are held at once, which bounds the memory used by the text of the log
+ * when it is being read from a stream. */
+typedef struct
+{
+  ParseState *state;  /* unowned */
+  GThreadPool *pool;  /* owned */
+  GQueue/*<owned ParseChunk>*/ chunks;
+  guint max_n_chunks;
+  GMutex lock;  /* protects ParseChunk.done */
+  GCond cond;
+  GError *error;  /* owned; nullable */
+} ParsePipeline;
+
+/* A section of the log to be parsed by one thread. */
+typedef struct
+{
+  ParseState state;
+  const gchar *data;  /* unowned; not nul-terminated */
+  const gchar *data_end;  /* unowned */
+  GBytes *bytes;  /* owned; nullable; keeps @data alive if set */
+  gboolean success;
+  gboolean done;  /* protected by ParsePipeline.lock */
+} ParseChunk;
+
+static void
+parse_chunk_free (ParseChunk *chunk)
+{
+  parse_state_clear (&chunk->state);
+  g_clear_pointer (&chunk->bytes, g_bytes_unref);
+  g_free (chunk);
+}
+
+static void
+parse_chunk_thread_cb (gpointer data,
+                       gpointer user_data)
+{
+  ParseChunk *chunk = data;
+  ParsePipeline *pipeline = user_data;
+  gboolean success;
+
+  /* Errors are thrown away here: if a chunk fails, it is re-parsed
+   * sequentially in order to report the error with the correct line
+   * number. */
+  success = (parse_lines (&chunk->state, chunk->data, chunk->data_end,
+                          FALSE, NULL) != NULL);
+
+  g_mutex_lock (&pipeline->lock);
+  chunk->success = success;
+  chunk->done = TRUE;
+  g_cond_broadcast (&pipeline->cond);
+  g_mutex_unlock (&pipeline->lock);
+}
+
+/* Merge the per-thread timestamps seen in a chunk into the running totals for
+ * all the chunks before it, checking that the first timestamp for each thread
+ * in the chunk is not lower than the highest one seen in earlier chunks. If
+ * that check fails, @thread_timestamps is left unchanged. */
+static gboolean
+merge_thread_timestamps (GHashTable/*<owned guint64, owned ThreadTimestamps>*/ *thread_timestamps,
+                         GHashTable/*<owned guint64, owned ThreadTimestamps>*/ *chunk_thread_timestamps)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_hash_table_iter_init (&iter, chunk_thread_timestamps);
+
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      const ThreadTimestamps *chunk_timestamps = value;
+      const ThreadTimestamps *timestamps;
+
+      timestamps = g_hash_table_lookup (thread_timestamps, key);
+
+      if (timestamps != NULL && chunk_timestamps->first < timestamps->highest)
+        return FALSE;
+    }
+
+  g_hash_table_iter_init (&iter, chunk_thread_timestamps);
+
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      const ThreadTimestamps *chunk_timestamps = value;
+      ThreadTimestamps *timestamps;
+
+      timestamps = g_hash_table_lookup (thread_timestamps, key);
+
+      if (timestamps != NULL)
+        {
+          timestamps->highest = chunk_timestamps->highest;
+        }
+      else
+        {
+          guint64 *new_key = g_new0 (guint64, 1);
+
+          *new_key = *((const guint64 *) key);
+          g_hash_table_insert (thread_timestamps, new_key,
+                               g_memdup (chunk_timestamps,
+                                         sizeof (*chunk_timestamps)));
+        }
+    }
+
+  return TRUE;
+}
+
+/* Start parsing the rest of the log in chunks, after the header has been
+ * parsed into @state, using at most @n_threads threads. The pool cannot fail
+ * to be created, as it is not exclusive. */
+static void
+parse_pipeline_init (ParsePipeline *pipeline,
+                     ParseState    *state,
+                     guint          n_threads,
+                     guint          max_n_chunks)
+{
+  pipeline->state = state;
+  pipeline->pool = g_thread_pool_new (parse_chunk_thread_cb, pipeline,
+                                      MAX (n_threads, 1), FALSE, NULL);
+  g_queue_init (&pipeline->chunks);
+  pipeline->max_n_chunks = MAX (max_n_chunks, 1);
+  g_mutex_init (&pipeline->lock);
+  g_cond_init (&pipeline->cond);
+  pipeline->error = NULL;
+}
+
+/* Wait for the oldest chunk to be parsed, and add its results to the state.
+ * If it failed to parse, or its timestamps are not monotonic with those of the
+ * chunks before it, re-parse it sequentially following on from them, to find
+ * the error. Later chunks are discarded once there is an error. */
+static void
+parse_pipeline_collect (ParsePipeline *pipeline)
+{
+  ParseState *state = pipeline->state;
+  ParseChunk *chunk;
+
+  chunk = g_queue_pop_head (&pipeline->chunks);
+
+  g_mutex_lock (&pipeline->lock);
+  while (!chunk->done)
+    g_cond_wait (&pipeline->cond, &pipeline->lock);
+  g_mutex_unlock (&pipeline->lock);
+
+  if (pipeline->error != NULL)
+    {
+      /* Discard the chunk. */
+    }
+  else if (chunk->success &&
+           merge_thread_timestamps (state->thread_timestamps,
+                                    chunk->state.thread_timestamps))
+    {
+      dfl_event_store_append_store (&state->events, &chunk->state.events);
+      state->line_number += chunk->state.line_number;
+      state->n_comment_lines += chunk->state.n_comment_lines;
+    }
+  else if (parse_lines (state, chunk->data, chunk->data_end, FALSE,
+                        &pipeline->error) != NULL)
+    {
+      /* The parallel parser and the sequential parser should agree on whether
+       * the log is valid, but don’t report success if they don’t. */
+      g_set_error_literal (&pipeline->error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           "Failed to parse log in parallel.");
+    }
+
+  parse_chunk_free (chunk);
+}
+
+/* Queue the lines from @data to @data_end to be parsed. They must end at the
+ * end of a line, or at the end of the log. If @bytes is non-%NULL, a reference
+ * is kept on it until the chunk has been parsed. Line numbers in the chunk are
+ * counted from zero, and offset once the chunks before it have been
+ * parsed. */
+static void
+parse_pipeline_push (ParsePipeline *pipeline,
+                     const gchar   *data,
+                     const gchar   *data_end,
+                     GBytes        *bytes)
+{
+  ParseChunk *chunk;
+
+  if (pipeline->error != NULL)
+    return;
+
+  while (g_queue_get_length (&pipeline->chunks) >= pipeline->max_n_chunks)
+    parse_pipeline_collect (pipeline);
+
+  chunk = g_new0 (ParseChunk, 1);
+  parse_state_init (&chunk->state, pipeline->state->events.strings);
+  chunk->state.file_version = pipeline->state->file_version;
+  chunk->state.initial_timestamp = pipeline->state->initial_timestamp;
+  chunk->data = data;
+  chunk->data_end = data_end;
+  chunk->bytes = (bytes != NULL) ? g_bytes_ref (bytes) : NULL;
+
+  g_queue_push_tail (&pipeline->chunks, chunk);
+  g_thread_pool_push (pipeline->pool, chunk, NULL);
+}
+
+/* Wait for all the chunks to be parsed and stitch the results together in
+ * order in the state. Returns %FALSE and sets @error if any chunk failed to
+ * parse; in that case, the events in the state are undefined. */
+static gboolean
+parse_pipeline_finish (ParsePipeline  *pipeline,
+                       GError        **error)
+{
+  while (!g_queue_is_empty (&pipeline->chunks))
+    parse_pipeline_collect (pipeline);
+
+  g_thread_pool_free (pipeline->pool, FALSE, TRUE);
+  pipeline->pool = NULL;
+  g_mutex_clear (&pipeline->lock);
+  g_cond_clear (&pipeline->cond);
+
+  if (pipeline->error != NULL)
+    {
+      g_propagate_error (error, pipeline->error);
+      pipeline->error = NULL;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Split the remainder of the log after the header into @n_chunks chunks at
+ * newline boundaries, and parse them in parallel on a pool of at most one
+ * thread per processor. */
+static gboolean
+parse_lines_parallel (ParseState   *state,
+                      const gchar  *data,
+                      const gchar  *data_end,
+                      guint         n_chunks,
+                      GError      **error)
+{
+  ParsePipeline pipeline;
+  const gchar *chunk_start;
+  gsize chunk_size;
+  guint i;
+
+  chunk_size = (data_end - data) / n_chunks;
+  parse_pipeline_init (&pipeline, state,
+                       MIN (n_chunks, g_get_num_processors ()), n_chunks);
+
+  for (i = 0, chunk_start = data; i < n_chunks; i++)
+    {
+      const gchar *chunk_end;
+
+      /* Split at the first newline after the nominal end of the chunk. */
+      if (i == n_chunks - 1 || chunk_start + chunk_size >= data_end)
+        {
+          chunk_end = data_end;
+        }
+      else
+        {
+          chunk_end = memchr (chunk_start + chunk_size, '\n',
+                              data_end - (chunk_start + chunk_size));
+          chunk_end = (chunk_end != NULL) ? chunk_end + 1 : data_end;
+        }
+
+      parse_pipeline_push (&pipeline, chunk_start, chunk_end, NULL);
+
+      chunk_start = chunk_end;
+    }
+
+  return parse_pipeline_finish (&pipeline, error);
+}
+
+/* Set an error about a malformed binary log. */
+static void
+set_binary_error (GError      **error,
+                  const gchar  *data,
+                  const gchar  *p,
+                  const gchar  *message)
+{
+  /* TODO: Use a proper error code here. */
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+               "Invalid binary log at byte %" G_GSIZE_FORMAT " — %s",
+               (gsize) (p - data), message);
+}
+
+/* Parse a string table block from the binary log, adding the strings it
+ * contains to @strings (interned). */
+static gboolean
+parse_binary_strings (ParseState                   *state,
+                      const gchar                  *data,
+                      const gchar                  *payload,
+                      const gchar                  *payload_end,
+                      guint32                       n_entries,
+                      GPtrArray/*<unowned utf8>*/  *strings,
+                      GError                      **error)
+{
+  const gchar *p = payload;
+  guint32 i;
+
+  for (i = 0; i < n_entries; i++)
+    {
+      guint32 length;
+      const gchar *end = NULL;
+
+      if (payload_end - p < (gssize) sizeof (length))
+        {
+          set_binary_error (error, data, p, "truncated string table");
+          return FALSE;
+        }
+
+      memcpy (&length, p, sizeof (length));
+      length = GUINT32_FROM_LE (length);
+      p += sizeof (length);
+
+      if ((gsize) (payload_end - p) < length)
+        {
+          set_binary_error (error, data, p, "truncated string");
+          return FALSE;
+        }
+
+      if (!g_utf8_validate (p, length, &end))
+        {
+          set_binary_error (error, data, end, "invalid UTF-8 in string");
+          return FALSE;
+        }
+
+      g_ptr_array_add (strings, (gpointer) parse_state_intern (state, p, length));
+
+      p += length;
+    }
+
+  return TRUE;
+}
+
+/* Parse an events block from the binary log, converting each record to a
+ * #DflEvent. */
+static gboolean
+parse_binary_events (ParseState                   *state,
+                     const gchar                  *data,
+                     const gchar                  *payload,
+                     const gchar                  *payload_end,
+                     guint32                       n_entries,
+                     GPtrArray/*<unowned utf8>*/  *strings,
+                     GError                      **error)
+{
+  const gchar *p;
+  guint32 i;
+
+  if ((gsize) (payload_end - payload) / sizeof (DflBinaryEventRecord) < n_entries)
+    {
+      set_binary_error (error, data, payload, "truncated events block");
+      return FALSE;
+    }
+
+  for (i = 0, p = payload; i < n_entries; i++, p += sizeof (DflBinaryEventRecord))
+    {
+      DflBinaryEventRecord record;
+      DflEventType event_type;
+      const DflEventTypeData *event_data;
+      guint64 timestamp, tid;
+      DflEventParameter parameters[DFL_EVENT_MAX_PARAMETERS];
+      guint j;
+
+      /* The buffer may not be aligned, so copy the record out. */
+      memcpy (&record, p, sizeof (record));
+      event_type = GUINT16_FROM_LE (record.event_type);
+      timestamp = GUINT64_FROM_LE (record.timestamp);
+      tid = GUINT64_FROM_LE (record.thread_id);
+
+      event_data = dfl_event_type_get_data (event_type);
+
+      if (event_data == NULL)
+        {
+          /* Ignore unknown event types, as with text logs. */
+          g_debug ("%s: Ignoring unrecognised event type %u at byte %"
+                   G_GSIZE_FORMAT, G_STRFUNC, (guint) event_type,
+                   (gsize) (p - data));
+          continue;
+        }
+
+      if (GUINT16_FROM_LE (record.n_parameters) != event_data->n_parameters)
+        {
+          set_binary_error (error, data, p,
+                            "event record has the wrong number of parameters");
+          return FALSE;
+        }
+
+      if (!update_thread_timestamps (state, tid, timestamp))
+        {
+          set_binary_error (error, data, p,
+                            "timestamps must be monotonically increasing");
+          return FALSE;
+        }
+
+      /* Decode the parameters according to the schema. */
+      for (j = 0; j < event_data->n_parameters; j++)
+        {
+          guint64 parameter = GUINT64_FROM_LE (record.parameters[j]);
+
+          parameters[j].type = event_data->parameter_types[j];
+
+          switch ((DflParameterType) event_data->parameter_types[j])
+            {
+            case DFL_PARAMETER_TYPE_ID:
+              parameters[j].value.id = parameter;
+              break;
+            case DFL_PARAMETER_TYPE_INT64:
+              parameters[j].value.int64 = (gint64) parameter;
+              break;
+            case DFL_PARAMETER_TYPE_STRING:
+              if (parameter >= strings->len)
+                {
+                  set_binary_error (error, data, p,
+                                    "event refers to an unknown string");
+                  return FALSE;
+                }
+
+              parameters[j].value.string = strings->pdata[parameter];
+              break;
+            case DFL_PARAMETER_TYPE_BYTES:
+            default:
+              g_assert_not_reached ();
+            }
+        }
+
+      dfl_event_store_append (&state->events, event_type, timestamp, tid,
+                              parameters, event_data->n_parameters);
+    }
+
+  return TRUE;
+}
+
+/* Parse a binary log (see binary-log-private.h) which is entirely in memory,
+ * and which has already been checked to start with the magic bytes. */
+static gboolean
+parse_binary (ParseState   *state,
+              const gchar  *data,
+              gsize         length,
+              GError      **error)
+{
+  DflBinaryLogHeader header;
+  const gchar *p, *data_end;
+  GPtrArray/*<unowned utf8>*/ *strings = NULL;
+  gboolean success = TRUE;
+
+  data_end = data + length;
+
+  if (length < sizeof (header))
+    {
+      set_binary_error (error, data, data, "truncated header");
+      return FALSE;
+    }
+
+  memcpy (&header, data, sizeof (header));
+
+  if (GUINT16_FROM_LE (header.version_major) != DFL_BINARY_LOG_VERSION_MAJOR)
+    {
+      /* TODO: Use a proper error code here. */
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+                   "Unsupported binary log file version %u.%u "
+                   "(versions supported: %u.x)",
+                   (guint) GUINT16_FROM_LE (header.version_major),
+                   (guint) GUINT16_FROM_LE (header.version_minor),
+                   (guint) DFL_BINARY_LOG_VERSION_MAJOR);
+      return FALSE;
+    }
+
+  state->file_version = DFL_BINARY_LOG_VERSION_MAJOR;
+  state->initial_timestamp = GUINT64_FROM_LE (header.initial_timestamp);
+
+  strings = g_ptr_array_new ();
+
+  for (p = data + sizeof (header); p < data_end && success;)
+    {
+      DflBinaryBlockHeader block;
+      const gchar *payload;
+      guint64 block_length;
+
+      if ((gsize) (data_end - p) < sizeof (block))
+        {
+          set_binary_error (error, data, p, "truncated block header");
+          success = FALSE;
+          break;
+        }
+
+      memcpy (&block, p, sizeof (block));
+      block_length = GUINT64_FROM_LE (block.length);
+      payload = p + sizeof (block);
+
+      if ((guint64) (data_end - payload) < block_length)
+        {
+          set_binary_error (error, data, p, "truncated block");
+          success = FALSE;
+          break;
+        }
+
+      switch (GUINT32_FROM_LE (block.block_type))
+        {
+        case DFL_BINARY_BLOCK_STRINGS:
+          success = parse_binary_strings (state, data, payload,
+                                          payload + block_length,
+                                          GUINT32_FROM_LE (block.n_entries),
+                                          strings, error);
+          break;
+        case DFL_BINARY_BLOCK_EVENTS:
+          success = parse_binary_events (state, data, payload,
+                                         payload + block_length,
+                                         GUINT32_FROM_LE (block.n_entries),
+                                         strings, error);
+          break;
+        default:
+          /* Skip unknown blocks, for forwards compatibility. */
+          g_debug ("%s: Ignoring unrecognised block type %u at byte %"
+                   G_GSIZE_FORMAT, G_STRFUNC,
+                   (guint) GUINT32_FROM_LE (block.block_type),
+                   (gsize) (p - data));
+          break;
+        }
+
+      p = payload + block_length;
+    }
+
+  g_ptr_array_unref (strings);
+
+  return success;
+}
+
+/* Magic bytes at the start of compressed logs. */
+#define GZIP_MAGIC "\x1f\x8b"
+#define GZIP_MAGIC_LENGTH 2
+#define ZSTD_MAGIC "\x28\xb5\x2f\xfd"
+#define ZSTD_MAGIC_LENGTH 4
+#define MAX_MAGIC_LENGTH MAX (GZIP_MAGIC_LENGTH, ZSTD_MAGIC_LENGTH)
+
+/* Whether the @length bytes at @data start with the magic bytes of a
+ * compressed log. */
+static gboolean
+is_compressed (const gchar *data,
+               gsize        length)
+{
+  return ((length >= GZIP_MAGIC_LENGTH &&
+           memcmp (data, GZIP_MAGIC, GZIP_MAGIC_LENGTH) == 0) ||
+          (length >= ZSTD_MAGIC_LENGTH &&
+           memcmp (data, ZSTD_MAGIC, ZSTD_MAGIC_LENGTH) == 0));
+}
+
+/* Read up to @length bytes from @stream into its buffer, without consuming
+ * them, and return them. Fewer bytes are returned at the end of the stream.
+ * Returns %NULL on error. */
+static const gchar *
+stream_peek (GBufferedInputStream  *stream,
+             gsize                  length,
+             gsize                 *length_out,
+             GCancellable          *cancellable,
+             GError               **error)
+{
+  gsize available;
+
+  while ((available = g_buffered_input_stream_get_available (stream)) < length)
+    {
+      gssize n_read;
+
+      n_read = g_buffered_input_stream_fill (stream, length - available,
+                                             cancellable, error);
+
+      if (n_read < 0)
+        return NULL;
+      else if (n_read == 0)
+        break;
+    }
+
+  return g_buffered_input_stream_peek_buffer (stream, length_out);
+}
+
+/* Wrap @stream so that the log can be read from it, decompressing it as it is
+ * read if it is compressed. Only one level of compression is supported, so
+ * a compressed log inside another is rejected. Returns %NULL on error. */
+static GInputStream *
+log_stream_new (GInputStream  *stream,
+                GCancellable  *cancellable,
+                GError       **error)
+{
+  GInputStream *buffered = NULL, *decompressed = NULL;
+  GConverter *decompressor = NULL;
+  const gchar *magic;
+  gsize length;
+
+  /* Don’t close the caller’s stream along with the wrapper. */
+  buffered = g_buffered_input_stream_new (stream);
+  g_filter_input_stream_set_close_base_stream (G_FILTER_INPUT_STREAM (buffered),
+                                               FALSE);
+
+  magic = stream_peek (G_BUFFERED_INPUT_STREAM (buffered), MAX_MAGIC_LENGTH,
+                       &length, cancellable, error);
+
+  if (magic == NULL)
+    {
+      g_object_unref (buffered);
+      return NULL;
+    }
+  else if (length >= GZIP_MAGIC_LENGTH &&
+           memcmp (magic, GZIP_MAGIC, GZIP_MAGIC_LENGTH) == 0)
+    {
+      decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+    }
+  else if (length >= ZSTD_MAGIC_LENGTH &&
+           memcmp (magic, ZSTD_MAGIC, ZSTD_MAGIC_LENGTH) == 0)
+    {
+#ifdef HAVE_ZSTD
+      decompressor = G_CONVERTER (dfl_zstd_decompressor_new ());
+#else
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Log is zstd-compressed, but libdunfell was built "
+                           "without zstd support");
+      g_object_unref (buffered);
+      return NULL;
+#endif
+    }
+  else
+    {
+      /* Not compressed. */
+      return buffered;
+    }
+
+  decompressed = g_converter_input_stream_new (buffered, decompressor);
+  g_object_unref (decompressor);
+  g_object_unref (buffered);
+
+  /* Check the decompressed log isn’t compressed again. */
+  buffered = g_buffered_input_stream_new (decompressed);
+  g_object_unref (decompressed);
+
+  magic = stream_peek (G_BUFFERED_INPUT_STREAM (buffered), MAX_MAGIC_LENGTH,
+                       &length, cancellable, error);
+
+  if (magic == NULL)
+    {
+      g_object_unref (buffered);
+      return NULL;
+    }
+  else if (is_compressed (magic, length))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Log is compressed more than once");
+      g_object_unref (buffered);
+      return NULL;
+    }
+
+  return buffered;
+}
+
+/* Parse a log which is entirely in memory, splitting it into lines in place.
+ * @data does not have to be nul-terminated. Large logs are split into chunks
+ * which are parsed in parallel; if @n_chunks is non-zero, the log is split
+ * into that many chunks regardless of its size. Binary logs are detected by
+ * their magic bytes, as are gzip- and zstd-compressed logs, which are
+ * decompressed and parsed as a stream, without decompressing them into memory
+ * first. */
+static void
+load_from_buffer (DflParser    *self,
+                  const gchar  *data,
+                  gsize         length,
+                  guint         n_chunks,
+                  GError      **error)
+{
+  ParseState state;
+  const gchar *body, *data_end;
+  GError *child_error = NULL;
+
+  /* Compressed log? */
+  if (is_compressed (data, length))
+    {
+      GInputStream *stream = NULL;
+
+      stream = g_memory_input_stream_new_from_data (data, length, NULL);
+      load_from_stream (self, stream, STREAM_CHUNK_SIZE, NULL, error);
+      g_object_unref (stream);
+
+      return;
+    }
+
+  /* Loading a whole log abandons any log being fed in incrementally. */
+  feed_reset (self);
+
+  parse_state_init (&state, NULL);
+  data_end = data + length;
+
+  /* Binary log? */
+  if (length >= DFL_BINARY_LOG_MAGIC_LENGTH &&
+      memcmp (data, DFL_BINARY_LOG_MAGIC, DFL_BINARY_LOG_MAGIC_LENGTH) == 0)
+    {
+      if (parse_binary (&state, data, length, &child_error))
+        parse_state_finish (&state, self);
+      else
+        g_propagate_error (error, child_error);
+
+      parse_state_clear (&state);
+
+      return;
+    }
+
+  /* Parse up to and including the header sequentially, since the chunks all
+   * need to know the file version and initial timestamp. */
+  body = parse_lines (&state, data, data_end, TRUE, &child_error);
+
+  if (body != NULL && n_chunks == 0)
+    n_chunks = MIN ((gsize) g_get_num_processors (),
+                    (data_end - body) / PARALLEL_CHUNK_MIN_SIZE);
+
+  if (body == NULL)
+    {
+      /* Error in the header. */
+    }
+  else if (n_chunks > 1 && state.file_version != 0)
+    {
+      parse_lines_parallel (&state, body, data_end, n_chunks, &child_error);
+    }
+  else
+    {
+      parse_lines (&state, body, data_end, FALSE, &child_error);
+    }
+
+  /* Success? */
+  if (child_error == NULL)
+    parse_state_finish (&state, self);
+  else
+    g_propagate_error (error, child_error);
+
+  parse_state_clear (&state);
+}
+
 /**
  * dfl_parser_load_from_data:
  * @self: a #DflParser
@@ -151,17 +1659,30 @@ dfl_parser_load_from_data (DflParser     *self,
                            gssize         length,
                            GError       **error)
 {
-  GInputStream *stream = NULL;
+  g_return_if_fail (DFL_IS_PARSER (self));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (length > 0);
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  load_from_buffer (self, (const gchar *) data, length, 0, error);
+}
 
+/* Like dfl_parser_load_from_data(), but always splitting the log into
+ * @n_chunks chunks to be parsed in parallel, for the tests. */
+void
+dfl_parser_load_from_data_in_chunks (DflParser     *self,
+                                     const guint8  *data,
+                                     gsize          length,
+                                     guint          n_chunks,
+                                     GError       **error)
+{
   g_return_if_fail (DFL_IS_PARSER (self));
   g_return_if_fail (data != NULL);
   g_return_if_fail (length > 0);
+  g_return_if_fail (n_chunks > 0);
   g_return_if_fail (error == NULL || *error == NULL);
 
-  /* Load by creating a stream for the data. */
-  stream = g_memory_input_stream_new_from_data (data, length, NULL);
-  dfl_parser_load_from_stream (self, stream, NULL, error);
-  g_object_unref (stream);
+  load_from_buffer (self, (const gchar *) data, length, n_chunks, error);
 }
 
 /**
@@ -170,7 +1691,9 @@ dfl_parser_load_from_data (DflParser     *self,
  * @filename: path to file to load log from
  * @error: return location for a #GError, or %NULL
  *
- * TODO
+ * Load a log from the file at @filename. If it is a regular file, it is
+ * memory mapped and parsed in place; otherwise (for example, if it is a pipe)
+ * it is read as a stream, as with dfl_parser_load_from_stream().
  *
  * Since: 0.1.0
  */
@@ -181,11 +1704,29 @@ dfl_parser_load_from_file (DflParser    *self,
 {
   GFile *file = NULL;
   GFileInputStream *stream = NULL;
+  GMappedFile *mapped_file = NULL;
 
   g_return_if_fail (DFL_IS_PARSER (self));
   g_return_if_fail (filename != NULL);
   g_return_if_fail (error == NULL || *error == NULL);
 
+  /* Memory map regular files, which avoids copying the log into userspace
+   * buffers and allocating every line. Pipes and other special files can’t be
+   * mapped, so fall back to streaming them. */
+  if (g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+    {
+      mapped_file = g_mapped_file_new (filename, FALSE, error);
+
+      if (mapped_file == NULL)
+        return;
+
+      load_from_buffer (self, g_mapped_file_get_contents (mapped_file),
+                        g_mapped_file_get_length (mapped_file), 0, error);
+      g_mapped_file_unref (mapped_file);
+
+      return;
+    }
+
   /* Load by creating a stream for the file. */
   file = g_file_new_for_path (filename);
   stream = g_file_read (file, NULL, error);
@@ -199,317 +1740,230 @@ dfl_parser_load_from_file (DflParser    *self,
   g_object_unref (stream);
 }
 
-/**
- * dfl_parser_load_from_stream:
- * @self: a #DflParser
- * @stream: input stream to read log from
- * @cancellable: a #GCancellable, or %NULL
- * @error: return location for a #GError, or %NULL
- *
- * TODO
- *
- * Since: 0.1.0
- */
-void
-dfl_parser_load_from_stream (DflParser     *self,
-                             GInputStream  *stream,
-                             GCancellable  *cancellable,
-                             GError       **error)
+/* Find the last newline in the @length bytes at @data. */
+static const gchar *
+find_last_newline (const gchar *data,
+                   gsize        length)
 {
-  GDataInputStream *data_stream = NULL;
-  guint8 *line = NULL;
-  gsize length = 0;
-  guint line_number;
-  guint n_comment_lines;
-  guint64 initial_timestamp;
-  GHashTable/*<owned guint64, owned guint64>*/ *highest_timestamps = NULL;
-  guint file_version;
-  GPtrArray/*<owned DflEvent*>*/ *events = NULL;
-  GError *child_error = NULL;
-
-  g_return_if_fail (DFL_IS_PARSER (self));
-  g_return_if_fail (G_IS_INPUT_STREAM (stream));
-  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
-  g_return_if_fail (error == NULL || *error == NULL);
+  const gchar *p;
 
-  /* Wrap in a data input stream and read line by line. */
-  data_stream = g_data_input_stream_new (stream);
-  n_comment_lines = 0;
-  file_version = 0;
-  initial_timestamp = 0;
-  highest_timestamps = g_hash_table_new_full (g_int64_hash, g_int64_equal,
-                                              g_free, g_free);
-  events = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-
-  for (line_number = 1,
-       line = (guint8 *) g_data_input_stream_read_line (data_stream, &length,
-                                                        cancellable,
-                                                        &child_error);
-       line != NULL;
-       line_number++, g_free (line),
-       line = (guint8 *) g_data_input_stream_read_line (data_stream, &length,
-                                                        cancellable,
-                                                        &child_error))
+  for (p = data + length; p > data; p--)
     {
-      const gchar *end = NULL;
-      gchar **components = NULL;
-
-      /* Note: The line is an arbitrary byte stream. It is not valid UTF-8 and
-       * may contain embedded nuls. Validate that first. */
-      if (!g_utf8_validate ((gchar *) line, length, &end))
-        {
-          /* TODO: Use a proper error code here. */
-          g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                       "Invalid log file line %u — invalid UTF-8 at byte %"
-                       G_GOFFSET_FORMAT,
-                       line_number, (goffset) (((guint8 *) end) - line));
-          break;
-        }
-
-      /* Ignore whitespace. */
-      line = (guint8 *) g_strstrip ((gchar *) line);
-
-      /* Ignore comment or blank lines. */
-      if (line[0] == '\0' || line[0] == '#')
-        {
-          n_comment_lines++;
-          continue;
-        }
+      if (*(p - 1) == '\n')
+        return p - 1;
+    }
 
-      g_debug ("%s: Line: %s", G_STRFUNC, line);
+  return NULL;
+}
 
-      /* Split into components. */
-      /* TODO: Formally document log file format. */
-      components = g_strsplit ((gchar *) line, ",", -1);
+/* Read from @stream into @buffer, after the bytes already in it, until it
+ * holds at least @target_length bytes or the end of the stream is reached.
+ * Returns %FALSE on error. */
+static gboolean
+stream_fill_buffer (GInputStream  *stream,
+                    GByteArray    *buffer,
+                    gsize          target_length,
+                    gboolean      *eof,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  gsize old_length, n_read = 0;
+  gboolean success;
 
-      if (components[0] == NULL)
-        {
-          /* TODO: Use a proper error code here. */
-          g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                       "Invalid log file line %u — %s: %s", line_number,
-                       "not enough components", line);
-          g_strfreev (components);
-          break;
-        }
+  old_length = buffer->len;
 
-      if (g_strcmp0 (components[0], "Dunfell log") == 0)
-        {
-          const gchar *version, *timestamp;
+  if (target_length <= old_length)
+    return TRUE;
 
-          /* Header line? Looks like:
-           *    Dunfell log,1.0,123456
-           * where 1.0 is the log format version, and 123456 is the starting
-           * timestamp. */
+  g_byte_array_set_size (buffer, target_length);
+  success = g_input_stream_read_all (stream, buffer->data + old_length,
+                                     target_length - old_length, &n_read,
+                                     cancellable, error);
+  g_byte_array_set_size (buffer, old_length + n_read);
+  *eof = (old_length + n_read < target_length);
 
-          /* Is this the first line? */
-          if (line_number - n_comment_lines != 1)
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid log file line %u — %s: %s", line_number,
-                           "header must be first non-comment line", line);
-              g_strfreev (components);
-              break;
-            }
+  return success;
+}
 
-          /* Check the number of components. */
-          if (components[1] == NULL || components[2] == NULL ||
-              components[3] != NULL)
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid log file line %u — %s: %s", line_number,
-                           "header contains the wrong number of components",
-                           line);
-              g_strfreev (components);
-              break;
-            }
+/* Parse a text log from @stream, in chunks of about @chunk_size bytes, parsing
+ * each in parallel with reading the next. The partial line at the end
+ * of each chunk is carried over to the start of the next. Compressed logs are
+ * decompressed as they are read. Binary logs, which can’t be split into lines,
+ * are read into memory and parsed as with dfl_parser_load_from_data(). */
+static void
+load_from_stream (DflParser     *self,
+                  GInputStream  *base_stream,
+                  gsize          chunk_size,
+                  GCancellable  *cancellable,
+                  GError       **error)
+{
+  ParseState state;
+  ParsePipeline pipeline;
+  GInputStream *stream = NULL;
+  GByteArray *buffer = NULL;
+  gboolean eof = FALSE;
+  guint n_threads;
+  GError *child_error = NULL;
 
-          /* Extract the components. */
-          version = components[1];
-          timestamp = components[2];
+  /* Loading a whole log abandons any log being fed in incrementally. */
+  feed_reset (self);
 
-          /* File version check. */
-          if (g_strcmp0 (version, "1.0") != 0)
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Unsupported log file version ‘%s’ on line %u"
-                           "(versions supported: 1.0)", version, line_number);
-              g_strfreev (components);
-              break;
-            }
+  stream = log_stream_new (base_stream, cancellable, error);
 
-          file_version = 1;
+  if (stream == NULL)
+    return;
 
-          /* Parse the timestamp. */
-          initial_timestamp = g_ascii_strtoull (timestamp, (gchar **) &end, 10);
+  /* Read at least enough to check for the magic bytes. */
+  buffer = g_byte_array_sized_new (chunk_size);
 
-          if (errno == ERANGE || end == timestamp || *end != '\0')
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid timestamp ‘%s’ on line %u", timestamp,
-                           line_number);
-              g_strfreev (components);
-              break;
-            }
-        }
-      else
-        {
-          const EventData *event_data;
-          const gchar *event_type;
-          const gchar *timestamp;
-          const gchar *tid;
-          guint n_components;
-          guint64 timestamp_int, tid_int;
-          guint64 *highest_timestamp;
-          DflEvent *event = NULL;
-
-          /* Non-header line. Looks like:
-           *    g_idle_dispatch,1449749875412059,8491,140407983871120,12007776,\
-           *    140408421089918,0x7fb36210027e,14614576,0
-           */
-
-          /* Has there been a header? */
-          if (file_version == 0)
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid log file line %u — %s: %s", line_number,
-                           "header must be first non-comment line", line);
-              g_strfreev (components);
-              break;
-            }
+  if (!stream_fill_buffer (stream, buffer,
+                           MAX (chunk_size, DFL_BINARY_LOG_MAGIC_LENGTH),
+                           &eof, cancellable, error))
+    {
+      g_byte_array_unref (buffer);
+      g_object_unref (stream);
+      return;
+    }
 
-          /* Extract the event type. */
-          event_type = g_intern_string (components[0]);
+  if (buffer->len >= DFL_BINARY_LOG_MAGIC_LENGTH &&
+      memcmp (buffer->data, DFL_BINARY_LOG_MAGIC,
+              DFL_BINARY_LOG_MAGIC_LENGTH) == 0)
+    {
+      while (!eof && child_error == NULL)
+        stream_fill_buffer (stream, buffer, buffer->len * 2, &eof,
+                            cancellable, &child_error);
 
-          if (*event_type == '\0')
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid log file line %u — %s: %s", line_number,
-                           "event type not specified", line);
-              g_strfreev (components);
-              break;
-            }
+      if (child_error == NULL)
+        load_from_buffer (self, (const gchar *) buffer->data, buffer->len, 0,
+                          &child_error);
 
-          /* Match it to an event parser. */
-          event_data = event_data_from_event_type (event_type);
+      g_byte_array_unref (buffer);
+      g_object_unref (stream);
 
-          if (event_data == NULL)
-            {
-              /* Ignore unknown event types to allow for more probe points to be
-               * added to GLib in future. */
-              g_debug ("%s: Ignoring unrecognised event type ‘%s’ on "
-                       "line %u: %s", G_STRFUNC, event_type, line_number, line);
-              g_strfreev (components);
-              continue;
-            }
+      if (child_error != NULL)
+        g_propagate_error (error, child_error);
 
-          /* Check the number of components (ignoring the event type, timestamp
-           * and thread ID. */
-          n_components = g_strv_length (components);
+      return;
+    }
 
-          if (n_components < 3 || n_components - 3 != event_data->n_parameters)
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid log file line %u — %s: %s", line_number,
-                           "event line contains the wrong number of components",
-                           line);
-              g_strfreev (components);
-              break;
-            }
+  parse_state_init (&state, NULL);
+  n_threads = g_get_num_processors ();
+  parse_pipeline_init (&pipeline, &state, n_threads, 2 * n_threads);
 
-          /* Grab the timestamp and thread ID. */
-          timestamp = components[1];
-          tid = components[2];
+  while (TRUE)
+    {
+      const gchar *data, *data_end, *split, *body;
+      GByteArray *next_buffer = NULL;
+      GBytes *bytes = NULL;
+      gsize length;
+
+      /* Split off the complete lines, unless this is the end of the log. If
+       * there are none, keep reading until the end of the line. */
+      data = (const gchar *) buffer->data;
+      data_end = data + buffer->len;
+      split = eof ? data_end : find_last_newline (data, buffer->len);
+
+      if (split == NULL)
+        {
+          if (!stream_fill_buffer (stream, buffer,
+                                   MAX (buffer->len * 2, chunk_size),
+                                   &eof, cancellable, &child_error))
+            break;
 
-          timestamp_int = g_ascii_strtoull (timestamp, (gchar **) &end, 10);
+          continue;
+        }
 
-          if (errno == ERANGE || end == timestamp || *end != '\0')
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid timestamp ‘%s’ on line %u", timestamp,
-                           line_number);
-              g_strfreev (components);
-              break;
-            }
+      if (split < data_end)
+        split++;
 
-          tid_int = g_ascii_strtoull (tid, (gchar **) &end, 10);
+      next_buffer = g_byte_array_sized_new (chunk_size);
+      g_byte_array_append (next_buffer, (const guint8 *) split,
+                           data_end - split);
+      g_byte_array_set_size (buffer, split - data);
 
-          if (errno == ERANGE || end == tid || *end != '\0')
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid thread ID ‘%s’ on line %u", tid,
-                           line_number);
-              g_strfreev (components);
-              break;
-            }
+      bytes = g_byte_array_free_to_bytes (buffer);
+      buffer = next_buffer;
 
-          /* Check that the timestamps in each thread are monotonically
-           * increasing. */
-          highest_timestamp = g_hash_table_lookup (highest_timestamps,
-                                                   (gpointer) &tid_int);
+      data = g_bytes_get_data (bytes, &length);
+      data_end = data + length;
 
-          if ((highest_timestamp == NULL && timestamp_int < initial_timestamp) ||
-              (highest_timestamp != NULL && timestamp_int < *highest_timestamp))
-            {
-              /* TODO: Use a proper error code here. */
-              g_set_error (&child_error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
-                           "Invalid timestamp ‘%s’ on line %u: timestamps must "
-                           "be monotonically increasing", timestamp,
-                           line_number);
-              g_strfreev (components);
-              break;
-            }
+      /* The header has to be parsed before any of the chunks, as they all
+       * need to know the file version and initial timestamp. */
+      body = data;
 
-          if (highest_timestamp != NULL)
-            {
-              *highest_timestamp = timestamp_int;
-            }
-          else
-            {
-              guint64 *key = NULL;
+      if (state.file_version == 0)
+        body = parse_lines (&state, data, data_end, TRUE, &child_error);
 
-              highest_timestamp = g_new0 (guint64, 1);
-              *highest_timestamp = timestamp_int;
-              key = g_new0 (guint64, 1);
-              *key = tid_int;
+      if (body != NULL && body < data_end && state.file_version != 0)
+        parse_pipeline_push (&pipeline, body, data_end, bytes);
 
-              g_hash_table_insert (highest_timestamps, key, highest_timestamp);
-            }
+      g_bytes_unref (bytes);
 
-          /* Create the event. */
-          event = dfl_event_new (event_type, timestamp_int, tid_int,
-                                 (const gchar * const *) components + 3);
-          g_ptr_array_add (events, event);  /* transfer ownership */
-        }
+      if (body == NULL || pipeline.error != NULL || eof)
+        break;
 
-      g_strfreev (components);
+      if (!stream_fill_buffer (stream, buffer, chunk_size, &eof, cancellable,
+                               &child_error))
+        break;
     }
 
-  g_free (line);
+  g_byte_array_unref (buffer);
+  g_object_unref (stream);
+
+  /* Wait for the chunks already queued, even if there was an error. */
+  parse_pipeline_finish (&pipeline,
+                         (child_error == NULL) ? &child_error : NULL);
 
   /* Success? */
   if (child_error == NULL)
-    {
-      g_clear_object (&self->sequence);
-      self->sequence = dfl_event_sequence_new ((const DflEvent **) events->pdata,
-                                               events->len, initial_timestamp);
-    }
+    parse_state_finish (&state, self);
   else
-    {
-      g_propagate_error (error, child_error);
-    }
+    g_propagate_error (error, child_error);
+
+  parse_state_clear (&state);
+}
+
+/**
+ * dfl_parser_load_from_stream:
+ * @self: a #DflParser
+ * @stream: input stream to read log from
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Load a log from @stream. Text logs are parsed as they are read, in chunks
+ * which are parsed in parallel, so the whole log is never held in memory at
+ * once.
+ *
+ * Since: 0.1.0
+ */
+void
+dfl_parser_load_from_stream (DflParser     *self,
+                             GInputStream  *stream,
+                             GCancellable  *cancellable,
+                             GError       **error)
+{
+  g_return_if_fail (DFL_IS_PARSER (self));
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  load_from_stream (self, stream, STREAM_CHUNK_SIZE, cancellable, error);
+}
+
+/* Like dfl_parser_load_from_stream(), but reading and parsing the log in
+ * chunks of @chunk_size bytes, for the tests. */
+void
+dfl_parser_load_from_stream_in_chunks (DflParser     *self,
+                                       GInputStream  *stream,
+                                       gsize          chunk_size,
+                                       GError       **error)
+{
+  g_return_if_fail (DFL_IS_PARSER (self));
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+  g_return_if_fail (chunk_size > 0);
+  g_return_if_fail (error == NULL || *error == NULL);
 
-  g_clear_pointer (&events, g_ptr_array_unref);
-  g_clear_pointer (&highest_timestamps, g_hash_table_unref);
-  g_object_unref (data_stream);
+  load_from_stream (self, stream, chunk_size, NULL, error);
 }
 
 static void
@@ -588,6 +2042,204 @@ dfl_parser_load_from_stream_finish (DflParser     *self,
   g_task_propagate_boolean (G_TASK (result), error);
 }
 
+/* Abandon any partially fed log. */
+static void
+feed_reset (DflParser *self)
+{
+  if (self->feed_state != NULL)
+    {
+      parse_state_clear (self->feed_state);
+      g_free (self->feed_state);
+      self->feed_state = NULL;
+    }
+
+  g_clear_pointer (&self->feed_line, g_byte_array_unref);
+}
+
+/* Move the events parsed so far by dfl_parser_feed() into the parser’s event
+ * sequence, creating it if the header has just been parsed, and notify about
+ * them. */
+static void
+feed_publish_events (DflParser *self)
+{
+  ParseState *state = self->feed_state;
+  guint position, n_events;
+
+  n_events = dfl_event_store_get_n_events (&state->events);
+
+  if (state->file_version == 0)
+    {
+      /* Events can’t be parsed before the header. */
+      g_assert (n_events == 0);
+      return;
+    }
+
+  if (self->sequence == NULL)
+    {
+      position = 0;
+      self->sequence = dfl_event_sequence_new_from_store (&state->events,
+                                                          state->initial_timestamp);
+    }
+  else if (n_events > 0)
+    {
+      position = g_list_model_get_n_items (G_LIST_MODEL (self->sequence));
+      dfl_event_sequence_append_store (self->sequence, &state->events);
+    }
+  else
+    {
+      return;
+    }
+
+  /* The events have been moved out of @state->events. */
+  g_signal_emit (self, signals[SIGNAL_EVENTS_PARSED], 0, position, n_events);
+}
+
+/**
+ * dfl_parser_feed:
+ * @self: a #DflParser
+ * @data: (array length=length): next fragment of the log
+ * @length: number of bytes in @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parse the next fragment of a text log which is being received
+ * incrementally, for example because it is still being written by
+ * dunfell-record. Fragments may be split at any byte, including in the middle
+ * of a line: partial lines are kept until the rest of the line is fed in.
+ *
+ * Once the log header has been parsed, dfl_parser_get_event_sequence() returns
+ * a #DflEventSequence which grows as further events are parsed, and
+ * #DflParser::events-parsed is emitted for each batch of new events. Call
+ * dfl_parser_feed_end() once the end of the log has been reached, to parse
+ * any final unterminated line.
+ *
+ * The first call to dfl_parser_feed() after construction, after
+ * dfl_parser_feed_end(), or after an error starts a new log, replacing the
+ * parser’s current event sequence. If an error is returned, events parsed
+ * before the error remain in the sequence.
+ *
+ * Only text logs can be fed in incrementally.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_parser_feed (DflParser     *self,
+                 const guint8  *data,
+                 gsize          length,
+                 GError       **error)
+{
+  const gchar *p, *data_end, *newline;
+  GError *child_error = NULL;
+
+  g_return_if_fail (DFL_IS_PARSER (self));
+  g_return_if_fail (data != NULL || length == 0);
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  /* Starting a new log? */
+  if (self->feed_state == NULL)
+    {
+      g_clear_object (&self->sequence);
+
+      self->feed_state = g_new0 (ParseState, 1);
+      parse_state_init (self->feed_state, NULL);
+      self->feed_line = g_byte_array_new ();
+    }
+
+  p = (const gchar *) data;
+  data_end = p + length;
+
+  /* Complete the line carried over from the previous fragment, if there is
+   * one, copying only as far as the first newline. */
+  if (self->feed_line->len > 0)
+    {
+      newline = memchr (p, '\n', length);
+
+      if (newline == NULL)
+        {
+          g_byte_array_append (self->feed_line, data, length);
+          return;
+        }
+
+      g_byte_array_append (self->feed_line, (const guint8 *) p, newline - p);
+
+      if (parse_lines (self->feed_state, (const gchar *) self->feed_line->data,
+                       (const gchar *) self->feed_line->data + self->feed_line->len,
+                       FALSE, &child_error) == NULL)
+        goto error;
+
+      g_byte_array_set_size (self->feed_line, 0);
+      p = newline + 1;
+    }
+
+  /* Parse all the complete lines in place, and carry over the rest. */
+  newline = find_last_newline (p, data_end - p);
+
+  if (newline != NULL)
+    {
+      if (parse_lines (self->feed_state, p, newline + 1, FALSE,
+                       &child_error) == NULL)
+        goto error;
+
+      p = newline + 1;
+    }
+
+  g_byte_array_append (self->feed_line, (const guint8 *) p, data_end - p);
+
+  feed_publish_events (self);
+
+  return;
+
+error:
+  /* Publish the events before the error, then abandon the log. */
+  feed_publish_events (self);
+  feed_reset (self);
+
+  g_propagate_error (error, child_error);
+}
+
+/**
+ * dfl_parser_feed_end:
+ * @self: a #DflParser
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finish feeding a log into the parser with dfl_parser_feed(). This parses
+ * any final line which was not terminated by a newline. Afterwards,
+ * dfl_parser_get_event_sequence() returns the complete sequence, which is
+ * empty if no log was fed in.
+ *
+ * The next call to dfl_parser_feed() will start a new log.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_parser_feed_end (DflParser  *self,
+                     GError    **error)
+{
+  GError *child_error = NULL;
+
+  g_return_if_fail (DFL_IS_PARSER (self));
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  if (self->feed_state == NULL)
+    dfl_parser_feed (self, NULL, 0, &child_error);
+
+  if (child_error == NULL && self->feed_line->len > 0)
+    parse_lines (self->feed_state, (const gchar *) self->feed_line->data,
+                 (const gchar *) self->feed_line->data + self->feed_line->len,
+                 FALSE, &child_error);
+
+  feed_publish_events (self);
+
+  /* Like dfl_parser_load_from_data(), an empty log gives an empty sequence. */
+  if (child_error == NULL && self->sequence == NULL)
+    self->sequence = dfl_event_sequence_new (NULL, 0,
+                                             self->feed_state->initial_timestamp);
+
+  feed_reset (self);
+
+  if (child_error != NULL)
+    g_propagate_error (error, child_error);
+}
+
 /**
  * dfl_parser_get_event_sequence:
  * @self: a #DflParser
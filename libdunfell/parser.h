@@ -62,6 +62,13 @@ void dfl_parser_load_from_stream_finish (DflParser *self,
                                          GAsyncResult *result,
                                          GError **error);
 
+void dfl_parser_feed (DflParser *self,
+                      const guint8 *data,
+                      gsize length,
+                      GError **error);
+void dfl_parser_feed_end (DflParser *self,
+                          GError **error);
+
 DflEventSequence *dfl_parser_get_event_sequence (DflParser *self);
 
 DflModel *dfl_parser_dup_model (DflParser *self);
@@ -0,0 +1,275 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2015, 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:profile
+ * @short_description: flat profile of dispatches
+ * @stability: Unstable
+ * @include: libdunfell/profile.h
+ *
+ * A flat profile aggregates all the dispatches in a #DflModel by callback,
+ * dispatch function and source name, to show which #GSourceFuncs are taking
+ * the most time in the main loop. Each row of the profile is a
+ * #DflProfileEntry. See dfl_model_dup_profile().
+ *
+ * Similarly, a task profile aggregates all the #GTasks in a #DflModel by
+ * source tag and callback, splitting each into the phases of #DflTaskPhase, to
+ * show where tasks are spending their time. Each row of the task profile is a
+ * #DflTaskProfileEntry. See dfl_model_dup_task_profile().
+ *
+ * Finally, a handoff profile aggregates the sources which were attached from
+ * one thread and dispatched on another by callback, to show how long work
+ * handed back to a main context waits before it runs. Each row of the handoff
+ * profile is a #DflHandoffProfileEntry. See dfl_model_dup_handoff_profile().
+ *
+ * Since: UNRELEASED
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "histogram.h"
+#include "profile.h"
+
+
+G_DEFINE_BOXED_TYPE (DflProfileEntry, dfl_profile_entry,
+                     dfl_profile_entry_copy, dfl_profile_entry_free)
+G_DEFINE_BOXED_TYPE (DflTaskProfileEntry, dfl_task_profile_entry,
+                     dfl_task_profile_entry_copy, dfl_task_profile_entry_free)
+G_DEFINE_BOXED_TYPE (DflHandoffProfileEntry, dfl_handoff_profile_entry,
+                     dfl_handoff_profile_entry_copy,
+                     dfl_handoff_profile_entry_free)
+
+/**
+ * dfl_profile_entry_new:
+ * @callback_name: (nullable): callback name for the entry
+ * @dispatch_name: (nullable): dispatch function name for the entry
+ * @source_name: (nullable): source name for the entry
+ *
+ * Create a new, empty #DflProfileEntry with the given names.
+ *
+ * Returns: (transfer full): a new #DflProfileEntry
+ * Since: UNRELEASED
+ */
+DflProfileEntry *
+dfl_profile_entry_new (const gchar *callback_name,
+                       const gchar *dispatch_name,
+                       const gchar *source_name)
+{
+  DflProfileEntry *entry;
+
+  entry = g_new0 (DflProfileEntry, 1);
+  entry->callback_name = g_strdup (callback_name);
+  entry->dispatch_name = g_strdup (dispatch_name);
+  entry->source_name = g_strdup (source_name);
+  entry->histogram = dfl_histogram_new ();
+
+  return entry;
+}
+
+/**
+ * dfl_profile_entry_copy:
+ * @entry: a #DflProfileEntry
+ *
+ * Make a deep copy of a #DflProfileEntry.
+ *
+ * Returns: (transfer full): a copy of @entry
+ * Since: UNRELEASED
+ */
+DflProfileEntry *
+dfl_profile_entry_copy (const DflProfileEntry *entry)
+{
+  DflProfileEntry *copy;
+
+  g_return_val_if_fail (entry != NULL, NULL);
+
+  copy = g_new0 (DflProfileEntry, 1);
+  copy->callback_name = g_strdup (entry->callback_name);
+  copy->dispatch_name = g_strdup (entry->dispatch_name);
+  copy->source_name = g_strdup (entry->source_name);
+  copy->n_dispatches = entry->n_dispatches;
+  copy->total_duration = entry->total_duration;
+  copy->self_duration = entry->self_duration;
+  copy->histogram = dfl_histogram_copy (entry->histogram);
+
+  return copy;
+}
+
+/**
+ * dfl_profile_entry_free:
+ * @entry: (transfer full): a #DflProfileEntry
+ *
+ * Free a #DflProfileEntry.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_profile_entry_free (DflProfileEntry *entry)
+{
+  g_return_if_fail (entry != NULL);
+
+  g_free (entry->callback_name);
+  g_free (entry->dispatch_name);
+  g_free (entry->source_name);
+  dfl_histogram_free (entry->histogram);
+  g_free (entry);
+}
+
+/**
+ * dfl_task_profile_entry_new:
+ * @source_tag_name: (nullable): source tag name for the entry
+ * @callback_name: (nullable): callback name for the entry
+ *
+ * Create a new, empty #DflTaskProfileEntry with the given names.
+ *
+ * Returns: (transfer full): a new #DflTaskProfileEntry
+ * Since: UNRELEASED
+ */
+DflTaskProfileEntry *
+dfl_task_profile_entry_new (const gchar *source_tag_name,
+                            const gchar *callback_name)
+{
+  DflTaskProfileEntry *entry;
+  gsize i;
+
+  entry = g_new0 (DflTaskProfileEntry, 1);
+  entry->source_tag_name = g_strdup (source_tag_name);
+  entry->callback_name = g_strdup (callback_name);
+
+  for (i = 0; i < G_N_ELEMENTS (entry->phase_histograms); i++)
+    entry->phase_histograms[i] = dfl_histogram_new ();
+
+  return entry;
+}
+
+/**
+ * dfl_task_profile_entry_copy:
+ * @entry: a #DflTaskProfileEntry
+ *
+ * Make a deep copy of a #DflTaskProfileEntry.
+ *
+ * Returns: (transfer full): a copy of @entry
+ * Since: UNRELEASED
+ */
+DflTaskProfileEntry *
+dfl_task_profile_entry_copy (const DflTaskProfileEntry *entry)
+{
+  DflTaskProfileEntry *copy;
+  gsize i;
+
+  g_return_val_if_fail (entry != NULL, NULL);
+
+  copy = g_new0 (DflTaskProfileEntry, 1);
+  copy->source_tag_name = g_strdup (entry->source_tag_name);
+  copy->callback_name = g_strdup (entry->callback_name);
+  copy->n_tasks = entry->n_tasks;
+
+  for (i = 0; i < G_N_ELEMENTS (entry->phase_histograms); i++)
+    copy->phase_histograms[i] = dfl_histogram_copy (entry->phase_histograms[i]);
+
+  return copy;
+}
+
+/**
+ * dfl_task_profile_entry_free:
+ * @entry: (transfer full): a #DflTaskProfileEntry
+ *
+ * Free a #DflTaskProfileEntry.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_task_profile_entry_free (DflTaskProfileEntry *entry)
+{
+  gsize i;
+
+  g_return_if_fail (entry != NULL);
+
+  g_free (entry->source_tag_name);
+  g_free (entry->callback_name);
+
+  for (i = 0; i < G_N_ELEMENTS (entry->phase_histograms); i++)
+    dfl_histogram_free (entry->phase_histograms[i]);
+
+  g_free (entry);
+}
+
+/**
+ * dfl_handoff_profile_entry_new:
+ * @callback_name: (nullable): callback name for the entry
+ *
+ * Create a new, empty #DflHandoffProfileEntry with the given name.
+ *
+ * Returns: (transfer full): a new #DflHandoffProfileEntry
+ * Since: UNRELEASED
+ */
+DflHandoffProfileEntry *
+dfl_handoff_profile_entry_new (const gchar *callback_name)
+{
+  DflHandoffProfileEntry *entry;
+
+  entry = g_new0 (DflHandoffProfileEntry, 1);
+  entry->callback_name = g_strdup (callback_name);
+  entry->histogram = dfl_histogram_new ();
+
+  return entry;
+}
+
+/**
+ * dfl_handoff_profile_entry_copy:
+ * @entry: a #DflHandoffProfileEntry
+ *
+ * Make a deep copy of a #DflHandoffProfileEntry.
+ *
+ * Returns: (transfer full): a copy of @entry
+ * Since: UNRELEASED
+ */
+DflHandoffProfileEntry *
+dfl_handoff_profile_entry_copy (const DflHandoffProfileEntry *entry)
+{
+  DflHandoffProfileEntry *copy;
+
+  g_return_val_if_fail (entry != NULL, NULL);
+
+  copy = g_new0 (DflHandoffProfileEntry, 1);
+  copy->callback_name = g_strdup (entry->callback_name);
+  copy->n_sources = entry->n_sources;
+  copy->total_latency = entry->total_latency;
+  copy->histogram = dfl_histogram_copy (entry->histogram);
+
+  return copy;
+}
+
+/**
+ * dfl_handoff_profile_entry_free:
+ * @entry: (transfer full): a #DflHandoffProfileEntry
+ *
+ * Free a #DflHandoffProfileEntry.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_handoff_profile_entry_free (DflHandoffProfileEntry *entry)
+{
+  g_return_if_fail (entry != NULL);
+
+  g_free (entry->callback_name);
+  dfl_histogram_free (entry->histogram);
+  g_free (entry);
+}
@@ -0,0 +1,141 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2015, 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_PROFILE_H
+#define DFL_PROFILE_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "histogram.h"
+#include "task.h"
+#include "types.h"
+
+G_BEGIN_DECLS
+
+/**
+ * DflProfileEntry:
+ * @callback_name: (nullable): name of the user callback function set with
+ *    g_source_set_callback(), shared by all the dispatches in this entry
+ * @dispatch_name: (nullable): name of the dispatch function for the #GSource
+ *    from #GSourceFuncs, shared by all the dispatches in this entry
+ * @source_name: (nullable): name of the #GSource, as set with
+ *    g_source_set_name(), shared by all the dispatches in this entry
+ * @n_dispatches: number of dispatches aggregated in this entry
+ * @total_duration: sum of the durations of the dispatches, in microseconds
+ * @self_duration: sum of the durations of the dispatches, excluding time
+ *    spent in other dispatches nested inside them on the same thread (for
+ *    example, from a nested #GMainLoop), in microseconds
+ * @histogram: (not nullable): histogram of the durations of the dispatches,
+ *    for querying percentiles
+ *
+ * One row of a flat profile of dispatches, aggregating all the dispatches
+ * with the same callback, dispatch function and source name. See
+ * dfl_model_dup_profile().
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  gchar *callback_name;  /* owned */
+  gchar *dispatch_name;  /* owned */
+  gchar *source_name;  /* owned */
+  gsize n_dispatches;
+  DflDuration total_duration;
+  DflDuration self_duration;
+  DflHistogram *histogram;  /* owned */
+} DflProfileEntry;
+
+GType dfl_profile_entry_get_type (void);
+
+DflProfileEntry *dfl_profile_entry_new  (const gchar           *callback_name,
+                                         const gchar           *dispatch_name,
+                                         const gchar           *source_name);
+DflProfileEntry *dfl_profile_entry_copy (const DflProfileEntry *entry);
+void             dfl_profile_entry_free (DflProfileEntry       *entry);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (DflProfileEntry, dfl_profile_entry_free)
+
+/**
+ * DflTaskProfileEntry:
+ * @source_tag_name: (nullable): name of the source tag set with
+ *    g_task_set_source_tag(), shared by all the tasks in this entry
+ * @callback_name: (nullable): name of the task’s callback function, shared by
+ *    all the tasks in this entry
+ * @n_tasks: number of tasks aggregated in this entry
+ * @phase_histograms: (not nullable): histograms of the durations of each
+ *    #DflTaskPhase, indexed by phase; tasks where a phase did not happen are
+ *    not counted in that phase’s histogram
+ *
+ * One row of a profile of #GTask lifecycles, aggregating all the tasks with
+ * the same source tag and callback. See dfl_model_dup_task_profile().
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  gchar *source_tag_name;  /* owned */
+  gchar *callback_name;  /* owned */
+  gsize n_tasks;
+  DflHistogram *phase_histograms[DFL_TASK_N_PHASES];  /* owned */
+} DflTaskProfileEntry;
+
+GType dfl_task_profile_entry_get_type (void);
+
+DflTaskProfileEntry *dfl_task_profile_entry_new  (const gchar               *source_tag_name,
+                                                  const gchar               *callback_name);
+DflTaskProfileEntry *dfl_task_profile_entry_copy (const DflTaskProfileEntry *entry);
+void                 dfl_task_profile_entry_free (DflTaskProfileEntry       *entry);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (DflTaskProfileEntry, dfl_task_profile_entry_free)
+
+/**
+ * DflHandoffProfileEntry:
+ * @callback_name: (nullable): name of the callback of the first dispatch,
+ *    shared by all the sources in this entry
+ * @n_sources: number of sources aggregated in this entry
+ * @total_latency: sum of the handoff latencies of the sources, in
+ *    microseconds
+ * @histogram: (not nullable): histogram of the handoff latencies of the
+ *    sources, for querying percentiles
+ *
+ * One row of a profile of sources attached from one thread and dispatched on
+ * another, aggregating all the sources with the same callback. See
+ * dfl_source_get_handoff_latency() and dfl_model_dup_handoff_profile().
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  gchar *callback_name;  /* owned */
+  gsize n_sources;
+  DflDuration total_latency;
+  DflHistogram *histogram;  /* owned */
+} DflHandoffProfileEntry;
+
+GType dfl_handoff_profile_entry_get_type (void);
+
+DflHandoffProfileEntry *dfl_handoff_profile_entry_new  (const gchar                  *callback_name);
+DflHandoffProfileEntry *dfl_handoff_profile_entry_copy (const DflHandoffProfileEntry *entry);
+void                    dfl_handoff_profile_entry_free (DflHandoffProfileEntry       *entry);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (DflHandoffProfileEntry, dfl_handoff_profile_entry_free)
+
+G_END_DECLS
+
+#endif /* !DFL_PROFILE_H */
@@ -36,6 +36,7 @@
 
 #include "event.h"
 #include "event-sequence.h"
+#include "histogram.h"
 #include "source.h"
 #include "time-sequence.h"
 
@@ -51,6 +52,35 @@ static void dfl_source_set_property (GObject      *object,
 static void dfl_source_dispose (GObject *object);
 static void dfl_source_dispatch_data_clear (DflSourceDispatchData *data);
 
+/* Estimate of the offset between the wall clock used for event timestamps and
+ * the monotonic clock used for #GSource ready times, taken as a low percentile
+ * of the differences seen between a dispatch timestamp and the ready time it
+ * followed, so that a few dispatches which ran early do not skew it. It is
+ * shared between all the sources from one event sequence, since the offset is
+ * the same for the whole process. */
+typedef struct
+{
+  gint ref_count;  /* atomic */
+  GArray/*<gint64>*/ *deltas;  /* owned */
+  gint64 offset;  /* G_MAXINT64 if no ready times have been dispatched */
+  guint offset_n_deltas;  /* length of @deltas when @offset was computed */
+} SourceClockData;
+
+/* Percentile of the deltas in #SourceClockData used as the clock offset. */
+#define CLOCK_OFFSET_PERCENTILE 5.0
+
+static SourceClockData *source_clock_data_new        (void);
+static SourceClockData *source_clock_data_ref        (SourceClockData *data);
+static void             source_clock_data_unref      (SourceClockData *data);
+static gint64           source_clock_data_get_offset (SourceClockData *data);
+
+/* A dispatch which followed a call to g_source_set_ready_time(). */
+typedef struct
+{
+  DflThreadId thread_id;
+  gint64 ready_time;  /* in the monotonic clock */
+} SourceReadyTimeData;
+
 struct _DflSource
 {
   GObject parent;
@@ -69,6 +99,32 @@ struct _DflSource
    * dispatch. A duration of ≥ 0 is valid; < 0 is not. */
   DflTimeSequence/*<DflSourceDispatchData>*/ dispatch_events;
 
+  /* Histogram of the valid durations in @dispatch_events, built by
+   * dfl_source_ensure_dispatch_histogram() when first needed, and rebuilt if
+   * more dispatches have been appended since. */
+  DflHistogram *dispatch_histogram;  /* owned; nullable */
+  gsize dispatch_histogram_n_elements;
+
+  /* Sequence of dispatches which followed a g_source_set_ready_time() call,
+   * keyed by the timestamp of the dispatch. */
+  DflTimeSequence/*<SourceReadyTimeData>*/ ready_time_events;
+
+  /* The ready time waiting to be dispatched while walking the event sequence,
+   * or -1 if there is none; and whether the source’s check function last found
+   * it ready, in which case its next dispatch was not caused by the ready
+   * time. */
+  gint64 pending_ready_time;
+  gboolean pending_check_ready;
+
+  SourceClockData *clock;  /* owned */
+
+  /* Histogram of the lateness of the dispatches in @ready_time_events, built
+   * lazily by dfl_source_ensure_lateness_histogram(), and rebuilt if more
+   * dispatches have been appended or the clock offset has changed since. */
+  DflHistogram *lateness_histogram;  /* owned; nullable */
+  gsize lateness_histogram_n_elements;
+  gint64 lateness_histogram_clock_offset;
+
   gchar *name;  /* owned; nullable */
 
   DflId attach_context;
@@ -105,6 +161,7 @@ typedef enum
   PROP_MIN_DISPATCH_DURATION,
   PROP_MEDIAN_DISPATCH_DURATION,
   PROP_MAX_DISPATCH_DURATION,
+  PROP_HANDOFF_LATENCY,
 } DflSourceProperty;
 
 static void
@@ -370,6 +427,27 @@ dfl_source_class_init (DflSourceClass *klass)
                                                        0, G_MAXINT64, 0,
                                                        G_PARAM_READABLE |
                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * DflSource:handoff-latency:
+   *
+   * Time from the source being attached from one thread to it first being
+   * dispatched on another, in microseconds, or -1 if the source was not
+   * handed off between threads. See dfl_source_get_handoff_latency().
+   *
+   * Since: UNRELEASED
+   */
+  g_object_class_install_property (object_class, PROP_HANDOFF_LATENCY,
+                                   g_param_spec_int64 ("handoff-latency",
+                                                       "Handoff Latency",
+                                                       "Time from the source "
+                                                       "being attached from "
+                                                       "one thread to it first "
+                                                       "being dispatched on "
+                                                       "another.",
+                                                       -1, G_MAXINT64, -1,
+                                                       G_PARAM_READABLE |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -378,6 +456,16 @@ dfl_source_init (DflSource *self)
   dfl_time_sequence_init (&self->dispatch_events,
                           sizeof (DflSourceDispatchData),
                           (GDestroyNotify) dfl_source_dispatch_data_clear, 0);
+  dfl_time_sequence_enable_summaries (&self->dispatch_events,
+                                      G_STRUCT_OFFSET (DflSourceDispatchData,
+                                                       duration),
+                                      G_STRUCT_OFFSET (DflSourceDispatchData,
+                                                       thread_id));
+  dfl_time_sequence_init (&self->ready_time_events,
+                          sizeof (SourceReadyTimeData), NULL, 0);
+
+  self->pending_ready_time = -1;
+  self->clock = source_clock_data_new ();
 
   self->children = g_ptr_array_new_with_free_func (g_object_unref);
 }
@@ -464,6 +552,9 @@ dfl_source_get_property (GObject     *object,
         g_value_set_int64 (value, max_duration);
         break;
       }
+    case PROP_HANDOFF_LATENCY:
+      g_value_set_int64 (value, dfl_source_get_handoff_latency (self, NULL));
+      break;
     default:
       g_assert_not_reached ();
     }
@@ -544,6 +635,10 @@ dfl_source_dispose (GObject *object)
   DflSource *self = DFL_SOURCE (object);
 
   dfl_time_sequence_clear (&self->dispatch_events);
+  g_clear_pointer (&self->dispatch_histogram, dfl_histogram_free);
+  dfl_time_sequence_clear (&self->ready_time_events);
+  g_clear_pointer (&self->lateness_histogram, dfl_histogram_free);
+  g_clear_pointer (&self->clock, source_clock_data_unref);
   g_clear_pointer (&self->name, g_free);
 
   g_clear_pointer (&self->children, g_ptr_array_unref);
@@ -583,6 +678,78 @@ dfl_source_new (DflId        id,
                        NULL);
 }
 
+static SourceClockData *
+source_clock_data_new (void)
+{
+  SourceClockData *data = NULL;
+
+  data = g_new0 (SourceClockData, 1);
+  data->ref_count = 1;
+  data->deltas = g_array_new (FALSE, FALSE, sizeof (gint64));
+  data->offset = G_MAXINT64;
+
+  return data;
+}
+
+static SourceClockData *
+source_clock_data_ref (SourceClockData *data)
+{
+  g_atomic_int_inc (&data->ref_count);
+
+  return data;
+}
+
+static void
+source_clock_data_unref (SourceClockData *data)
+{
+  if (!g_atomic_int_dec_and_test (&data->ref_count))
+    return;
+
+  g_array_unref (data->deltas);
+  g_free (data);
+}
+
+static gint
+compare_gint64 (gconstpointer a,
+                gconstpointer b)
+{
+  const gint64 *value_a = a, *value_b = b;
+
+  if (*value_a < *value_b)
+    return -1;
+  else if (*value_a > *value_b)
+    return 1;
+  else
+    return 0;
+}
+
+/* Get the clock offset, recomputing it if more deltas have been added since it
+ * was last computed. The order of @deltas does not matter, so they are sorted
+ * in place. */
+static gint64
+source_clock_data_get_offset (SourceClockData *data)
+{
+  gdouble exact_rank;
+  guint rank;
+
+  if (data->offset_n_deltas == data->deltas->len)
+    return data->offset;
+
+  g_array_sort (data->deltas, compare_gint64);
+
+  /* Nearest rank, rounded up. */
+  exact_rank = CLOCK_OFFSET_PERCENTILE / 100.0 * data->deltas->len;
+  rank = (guint) exact_rank;
+  if ((gdouble) rank < exact_rank)
+    rank++;
+  rank = CLAMP (rank, 1, data->deltas->len);
+
+  data->offset = g_array_index (data->deltas, gint64, rank - 1);
+  data->offset_n_deltas = data->deltas->len;
+
+  return data->offset;
+}
+
 static void
 source_before_after_dispatch_cb (DflEventSequence *sequence,
                                  DflEvent         *event,
@@ -697,6 +864,77 @@ source_before_after_dispatch_cb (DflEventSequence *sequence,
     }
 }
 
+static void
+source_set_ready_time_cb (DflEventSequence *sequence,
+                          DflEvent         *event,
+                          gpointer          user_data)
+{
+  DflSource *source = user_data;
+  gint64 ready_time;
+
+  /* Does this event correspond to the right source? */
+  g_assert (dfl_event_get_parameter_id (event, 0) == source->id);
+
+  ready_time = dfl_event_get_parameter_int64 (event, 1);
+
+  /* A ready time of -1 unsets it; one of 0 means the source should be
+   * dispatched as soon as possible, so it cannot be late. */
+  source->pending_ready_time = (ready_time > 0) ? ready_time : -1;
+}
+
+static void
+source_after_check_cb (DflEventSequence *sequence,
+                       DflEvent         *event,
+                       gpointer          user_data)
+{
+  DflSource *source = user_data;
+
+  /* Does this event correspond to the right source? */
+  g_assert (dfl_event_get_parameter_id (event, 0) == source->id);
+
+  source->pending_check_ready = (dfl_event_get_parameter_id (event, 2) != 0);
+}
+
+/* Pair each dispatch with the ready time set before it. Repeating timeouts
+ * set their next ready time during the dispatch, which will be paired with
+ * the following dispatch. Dispatches where the source’s check function found
+ * it ready (for example, because a file descriptor became readable) were not
+ * caused by the ready time, so they are skipped and the ready time stays
+ * pending. */
+static void
+source_ready_time_before_dispatch_cb (DflEventSequence *sequence,
+                                      DflEvent         *event,
+                                      gpointer          user_data)
+{
+  DflSource *source = user_data;
+  DflTimestamp timestamp;
+  SourceReadyTimeData *ready_time_data;
+  gint64 delta;
+
+  /* Does this event correspond to the right source? */
+  g_assert (dfl_event_get_parameter_id (event, 0) == source->id);
+
+  if (source->pending_check_ready)
+    {
+      source->pending_check_ready = FALSE;
+      return;
+    }
+
+  if (source->pending_ready_time < 0)
+    return;
+
+  timestamp = dfl_event_get_timestamp (event);
+
+  ready_time_data = dfl_time_sequence_append (&source->ready_time_events,
+                                              timestamp);
+  ready_time_data->thread_id = dfl_event_get_thread_id (event);
+  ready_time_data->ready_time = source->pending_ready_time;
+
+  delta = (gint64) timestamp - source->pending_ready_time;
+  g_array_append_val (source->clock->deltas, delta);
+  source->pending_ready_time = -1;
+}
+
 static void
 source_before_free_cb (DflEventSequence *sequence,
                        DflEvent         *event,
@@ -799,12 +1037,68 @@ source_destroy_cb (DflEventSequence *sequence,
   source->destroy_thread_id = dfl_event_get_thread_id (event);
 }
 
+/* State for the walkers in dfl_source_factory_from_event_sequence(). */
+typedef struct
+{
+  gint ref_count;  /* atomic */
+  GPtrArray/*<owned DflSource>*/ *sources;  /* owned */
+  GHashTable/*<owned guint64, unowned DflSource>*/ *sources_by_id;  /* owned */
+  SourceClockData *clock;  /* owned */
+} SourceFactoryData;
+
+/* Allocate a key for a table using g_int64_hash() and g_int64_equal(), so
+ * source IDs are compared in full whatever the size of a pointer. */
+static guint64 *
+id_key_new (guint64 id)
+{
+  guint64 *key = g_new (guint64, 1);
+
+  *key = id;
+
+  return key;  /* transfer */
+}
+
+static SourceFactoryData *
+source_factory_data_new (GPtrArray *sources)
+{
+  SourceFactoryData *data = NULL;
+
+  data = g_new0 (SourceFactoryData, 1);
+  data->ref_count = 1;
+  data->sources = g_ptr_array_ref (sources);
+  data->sources_by_id = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                               g_free, NULL);
+  data->clock = source_clock_data_new ();
+
+  return data;
+}
+
+static SourceFactoryData *
+source_factory_data_ref (SourceFactoryData *data)
+{
+  g_atomic_int_inc (&data->ref_count);
+
+  return data;
+}
+
+static void
+source_factory_data_unref (SourceFactoryData *data)
+{
+  if (!g_atomic_int_dec_and_test (&data->ref_count))
+    return;
+
+  source_clock_data_unref (data->clock);
+  g_hash_table_unref (data->sources_by_id);
+  g_ptr_array_unref (data->sources);
+  g_free (data);
+}
+
 static void
 source_new_cb (DflEventSequence *sequence,
                DflEvent         *event,
                gpointer          user_data)
 {
-  GPtrArray/*<owned DflSource>*/ *sources = user_data;
+  SourceFactoryData *data = user_data;
   DflSource *source = NULL;
   DflId source_id;
 
@@ -813,6 +1107,10 @@ source_new_cb (DflEventSequence *sequence,
                            dfl_event_get_timestamp (event),
                            dfl_event_get_thread_id (event));
 
+  /* Share the clock offset estimate between all the sources. */
+  source_clock_data_unref (source->clock);
+  source->clock = source_clock_data_ref (data->clock);
+
   dfl_event_sequence_start_walker_group (sequence);
 
   dfl_event_sequence_add_walker (sequence, "g_source_set_name", source_id,
@@ -836,6 +1134,20 @@ source_new_cb (DflEventSequence *sequence,
                                  source_before_after_dispatch_cb,
                                  g_object_ref (source),
                                  (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_source_set_ready_time",
+                                 source_id,
+                                 source_set_ready_time_cb,
+                                 g_object_ref (source),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_source_after_check", source_id,
+                                 source_after_check_cb,
+                                 g_object_ref (source),
+                                 (GDestroyNotify) g_object_unref);
+  dfl_event_sequence_add_walker (sequence, "g_source_before_dispatch",
+                                 source_id,
+                                 source_ready_time_before_dispatch_cb,
+                                 g_object_ref (source),
+                                 (GDestroyNotify) g_object_unref);
   dfl_event_sequence_add_walker (sequence, "g_source_attach", source_id,
                                  source_attach_cb,
                                  g_object_ref (source),
@@ -849,7 +1161,11 @@ source_new_cb (DflEventSequence *sequence,
   dfl_event_sequence_end_walker_group (sequence, "g_source_before_free",
                                        source_id);
 
-  g_ptr_array_add (sources, source);  /* transfer */
+  g_ptr_array_add (data->sources, source);  /* transfer */
+
+  /* Source IDs are addresses, so may be reused once a source is freed. Make
+   * sure the newest source with a given ID is found. */
+  g_hash_table_replace (data->sources_by_id, id_key_new (source_id), source);
 }
 
 static void
@@ -857,27 +1173,16 @@ source_add_child_source_cb (DflEventSequence *sequence,
                             DflEvent         *event,
                             gpointer          user_data)
 {
-  GPtrArray/*<owned DflSource>*/ *sources = user_data;
+  SourceFactoryData *data = user_data;
   DflSource *parent_source = NULL, *child_source = NULL;
-  DflId parent_source_id, child_source_id;
-  gsize i;
+  guint64 parent_source_id, child_source_id;
 
   parent_source_id = dfl_event_get_parameter_id (event, 0);
   child_source_id = dfl_event_get_parameter_id (event, 1);
 
   /* Find the two sources. */
-  for (i = 0;
-       i < sources->len && (parent_source == NULL || child_source == NULL);
-       i++)
-    {
-      if (parent_source == NULL &&
-          dfl_source_get_id (sources->pdata[i]) == parent_source_id)
-        parent_source = DFL_SOURCE (sources->pdata[i]);
-
-      if (child_source == NULL &&
-          dfl_source_get_id (sources->pdata[i]) == child_source_id)
-        child_source = DFL_SOURCE (sources->pdata[i]);
-    }
+  parent_source = g_hash_table_lookup (data->sources_by_id, &parent_source_id);
+  child_source = g_hash_table_lookup (data->sources_by_id, &child_source_id);
 
   if (parent_source == NULL || child_source == NULL)
     {
@@ -910,16 +1215,21 @@ GPtrArray *
 dfl_source_factory_from_event_sequence (DflEventSequence *sequence)
 {
   GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  SourceFactoryData *data = NULL;
 
   sources = g_ptr_array_new_with_free_func (g_object_unref);
+  data = source_factory_data_new (sources);
+
   dfl_event_sequence_add_walker (sequence, "g_source_new", DFL_ID_INVALID,
                                  source_new_cb,
-                                 g_ptr_array_ref (sources),
-                                 (GDestroyNotify) g_ptr_array_unref);
+                                 source_factory_data_ref (data),
+                                 (GDestroyNotify) source_factory_data_unref);
   dfl_event_sequence_add_walker (sequence, "g_source_add_child_source",
                                  DFL_ID_INVALID, source_add_child_source_cb,
-                                 g_ptr_array_ref (sources),
-                                 (GDestroyNotify) g_ptr_array_unref);
+                                 source_factory_data_ref (data),
+                                 (GDestroyNotify) source_factory_data_unref);
+
+  source_factory_data_unref (data);
 
   return sources;
 }
@@ -1115,6 +1425,33 @@ dfl_source_dispatch_iter (DflSource           *self,
   dfl_time_sequence_iter_init (iter, &self->dispatch_events, start);
 }
 
+/**
+ * dfl_source_dispatch_foreach_overlapping:
+ * @self: a #DflSource
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each dispatch overlapping the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each dispatch of this source which overlaps [@start, @end], in
+ * timestamp order. See dfl_time_sequence_foreach_overlapping().
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_source_dispatch_foreach_overlapping (DflSource                  *self,
+                                         DflTimestamp                start,
+                                         DflTimestamp                end,
+                                         DflTimeSequenceOverlapFunc  func,
+                                         gpointer                    user_data)
+{
+  g_return_if_fail (DFL_IS_SOURCE (self));
+  g_return_if_fail (func != NULL);
+
+  dfl_time_sequence_foreach_overlapping (&self->dispatch_events, start, end,
+                                         func, user_data);
+}
+
 /**
  * dfl_source_get_n_long_dispatches:
  * @self: a #DflSource
@@ -1131,39 +1468,216 @@ gsize
 dfl_source_get_n_long_dispatches (DflSource   *self,
                                   DflDuration  min_duration)
 {
-  DflTimeSequenceIter iter;
-  DflSourceDispatchData *dispatch_data;
-  gsize count;
-
   g_return_val_if_fail (DFL_IS_SOURCE (self), 0);
 
   /* Fast path. */
   if (min_duration == 0)
     return dfl_time_sequence_get_n_elements (&self->dispatch_events);
 
-  /* Iteration path. */
+  return dfl_time_sequence_get_n_long_elements (&self->dispatch_events, 0, 0,
+                                                min_duration);
+}
+
+/* Build (or rebuild) the histogram of dispatch durations, in a single pass
+ * over the dispatches. This is done lazily, rather than while walking the
+ * event sequence, as the walk may revise durations which it has already
+ * filled in when it finds unpaired events. */
+static void
+dfl_source_ensure_dispatch_histogram (DflSource *self)
+{
+  DflTimeSequenceIter iter;
+  DflSourceDispatchData *dispatch_data;
+  gsize n_elements;
+
+  n_elements = dfl_time_sequence_get_n_elements (&self->dispatch_events);
+
+  if (self->dispatch_histogram != NULL &&
+      self->dispatch_histogram_n_elements == n_elements)
+    return;
+
+  g_clear_pointer (&self->dispatch_histogram, dfl_histogram_free);
+  self->dispatch_histogram = dfl_histogram_new ();
+  self->dispatch_histogram_n_elements = n_elements;
+
   dfl_time_sequence_iter_init (&iter, &self->dispatch_events, 0);
-  count = 0;
 
   while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &dispatch_data))
     {
-      if (dispatch_data->duration >= min_duration)
-        count++;
+      if (dispatch_data->duration >= 0)
+        dfl_histogram_record (self->dispatch_histogram,
+                              dispatch_data->duration);
     }
+}
 
-  return count;
+/**
+ * dfl_source_get_dispatch_histogram:
+ * @self: a #DflSource
+ *
+ * Get a histogram of the durations of all the dispatches of this source,
+ * which can be used to query percentiles of the dispatch duration. Dispatches
+ * which never finished are not included.
+ *
+ * Returns: (transfer none): histogram of dispatch durations
+ * Since: UNRELEASED
+ */
+const DflHistogram *
+dfl_source_get_dispatch_histogram (DflSource *self)
+{
+  g_return_val_if_fail (DFL_IS_SOURCE (self), NULL);
+
+  dfl_source_ensure_dispatch_histogram (self);
+
+  return self->dispatch_histogram;
 }
 
-static gint
-compare_durations (gconstpointer a,
-                   gconstpointer b)
+/* Build (or rebuild) the histogram of how late each ready time was
+ * dispatched. This is done lazily, as the clock offset is only known once the
+ * whole event sequence has been walked. */
+static void
+dfl_source_ensure_lateness_histogram (DflSource *self)
+{
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  SourceReadyTimeData *ready_time_data;
+  gsize n_elements;
+  gint64 clock_offset;
+
+  n_elements = dfl_time_sequence_get_n_elements (&self->ready_time_events);
+  clock_offset = source_clock_data_get_offset (self->clock);
+
+  if (self->lateness_histogram != NULL &&
+      self->lateness_histogram_n_elements == n_elements &&
+      self->lateness_histogram_clock_offset == clock_offset)
+    return;
+
+  g_clear_pointer (&self->lateness_histogram, dfl_histogram_free);
+  self->lateness_histogram = dfl_histogram_new ();
+  self->lateness_histogram_n_elements = n_elements;
+  self->lateness_histogram_clock_offset = clock_offset;
+
+  dfl_time_sequence_iter_init (&iter, &self->ready_time_events, 0);
+
+  while (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                      (gpointer *) &ready_time_data))
+    {
+      DflDuration lateness;
+
+      /* Dispatches below the offset percentile count as on time. */
+      lateness = (gint64) timestamp - ready_time_data->ready_time -
+                 clock_offset;
+      dfl_histogram_record (self->lateness_histogram, MAX (lateness, 0));
+    }
+}
+
+/**
+ * dfl_source_get_lateness_histogram:
+ * @self: a #DflSource
+ *
+ * Get a histogram of how late this source was dispatched after each ready
+ * time set with g_source_set_ready_time(), as done by timeout sources. Long
+ * lateness typically means the source was starved by long dispatches of other
+ * sources at the same or a higher priority.
+ *
+ * Ready times are in the monotonic clock, while event timestamps are not, so
+ * the lateness is measured relative to the 5th percentile of the lateness of
+ * all the sources in the same log, which is assumed to have been on time;
+ * dispatches below it are counted as on time. Dispatches where the source’s
+ * check function found it ready before its ready time are not caused by the
+ * ready time, so they are not counted.
+ *
+ * Returns: (transfer none): histogram of dispatch lateness, in microseconds
+ * Since: UNRELEASED
+ */
+const DflHistogram *
+dfl_source_get_lateness_histogram (DflSource *self)
 {
-  const DflDuration *duration_a = a, *duration_b = b;
+  g_return_val_if_fail (DFL_IS_SOURCE (self), NULL);
+
+  dfl_source_ensure_lateness_histogram (self);
 
-  return (*duration_a - *duration_b);
+  return self->lateness_histogram;
 }
 
-/* TODO: Docs */
+/**
+ * dfl_source_get_handoff_latency:
+ * @self: a #DflSource
+ * @callback_name: (out) (optional) (nullable) (transfer none): return location
+ *    for the name of the callback of the first dispatch
+ *
+ * Get the latency of handing this source off from the thread which attached
+ * it to the thread which dispatched it: the time from the source being
+ * attached to its first dispatch. This is the latency of the common pattern of
+ * calling g_idle_add() from a worker thread to return a result to the main
+ * thread.
+ *
+ * The source only counts as being handed off if its first dispatch was on a
+ * different thread from the one which attached it; the dispatching thread is
+ * the thread which emitted the source’s first dispatch event, whichever thread
+ * owned the main context at the time. If the source was dispatched on the
+ * attaching thread, was never attached, or was never dispatched, -1 is
+ * returned and @callback_name is set to %NULL.
+ *
+ * Returns: handoff latency in microseconds, or -1
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_source_get_handoff_latency (DflSource    *self,
+                                const gchar **callback_name)
+{
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflSourceDispatchData *dispatch_data;
+
+  g_return_val_if_fail (DFL_IS_SOURCE (self), -1);
+
+  if (callback_name != NULL)
+    *callback_name = NULL;
+
+  if (self->attach_timestamp == 0)
+    return -1;
+
+  /* Find the first dispatch after the attach. */
+  dfl_time_sequence_iter_init (&iter, &self->dispatch_events,
+                               self->attach_timestamp);
+
+  do
+    {
+      if (!dfl_time_sequence_iter_next (&iter, &timestamp,
+                                        (gpointer *) &dispatch_data))
+        return -1;
+    }
+  while (timestamp < self->attach_timestamp);
+
+  if (dispatch_data->thread_id == self->attach_thread_id)
+    return -1;
+
+  if (callback_name != NULL)
+    *callback_name = dispatch_data->callback_name;
+
+  return timestamp - self->attach_timestamp;
+}
+
+/**
+ * dfl_source_get_dispatch_statistics:
+ * @self: a #DflSource
+ * @n_dispatches: (out caller-allocates) (optional): return location for the
+ *    number of dispatches
+ * @min_duration: (out caller-allocates) (optional): return location for the
+ *    shortest dispatch duration, in microseconds
+ * @median_duration: (out caller-allocates) (optional): return location for
+ *    the median dispatch duration, in microseconds
+ * @max_duration: (out caller-allocates) (optional): return location for the
+ *    longest dispatch duration, in microseconds
+ *
+ * Get summary statistics about the dispatches of this source. The durations
+ * all come from dfl_source_get_dispatch_histogram(), so dispatches which never
+ * finished are counted in @n_dispatches but not in the durations. All
+ * durations are 0 if no dispatches have finished. The median has the
+ * precision documented in dfl_histogram_get_percentile(); the other
+ * statistics are exact.
+ *
+ * Since: UNRELEASED
+ */
 void
 dfl_source_get_dispatch_statistics (DflSource   *self,
                                     gsize       *n_dispatches,
@@ -1171,58 +1685,24 @@ dfl_source_get_dispatch_statistics (DflSource   *self,
                                     DflDuration *median_duration,
                                     DflDuration *max_duration)
 {
-  g_autoptr (GArray) durations = NULL;  /* (element-type DflDuration) */
-  DflTimeSequenceIter iter;
-  DflSourceDispatchData *dispatch_data;
-
   g_return_if_fail (DFL_IS_SOURCE (self));
 
   if (n_dispatches != NULL)
     *n_dispatches = dfl_time_sequence_get_n_elements (&self->dispatch_events);
 
-  /* Fast paths. */
+  /* Fast path. */
   if (min_duration == NULL && median_duration == NULL && max_duration == NULL)
     return;
 
-  if (dfl_time_sequence_get_n_elements (&self->dispatch_events) == 0)
-    {
-      if (min_duration != NULL)
-        *min_duration = 0;
-      if (median_duration != NULL)
-        *median_duration = 0;
-      if (max_duration != NULL)
-        *max_duration = 0;
+  dfl_source_ensure_dispatch_histogram (self);
 
-      return;
-    }
-
-  /* In order to calculate the median, we need to order all the dispatches by
-   * duration. */
-  durations = g_array_sized_new (FALSE, FALSE, sizeof (DflDuration),
-                                 dfl_time_sequence_get_n_elements (&self->dispatch_events));
-
-  dfl_time_sequence_iter_init (&iter, &self->dispatch_events, 0);
-
-  while (dfl_time_sequence_iter_next (&iter, NULL, (gpointer *) &dispatch_data))
-    g_array_append_val (durations, dispatch_data->duration);
-
-  g_array_sort (durations, compare_durations);
-
-  /* Calculate the aggregates. */
   if (min_duration != NULL)
-    *min_duration = g_array_index (durations, DflDuration, 0);
-
-  if (max_duration != NULL)
-    *max_duration = g_array_index (durations, DflDuration, durations->len - 1);
-
+    *min_duration = dfl_histogram_get_min (self->dispatch_histogram);
   if (median_duration != NULL)
-    {
-      if ((durations->len % 2) == 0)
-        *median_duration = (g_array_index (durations, DflDuration, durations->len / 2) +
-                            g_array_index (durations, DflDuration, durations->len / 2 + 1)) / 2;
-      else
-        *median_duration = g_array_index (durations, DflDuration, durations->len / 2);
-    }
+    *median_duration = dfl_histogram_get_percentile (self->dispatch_histogram,
+                                                     50.0);
+  if (max_duration != NULL)
+    *max_duration = dfl_histogram_get_max (self->dispatch_histogram);
 }
 
 /**
@@ -23,6 +23,7 @@
 #include <glib-object.h>
 
 #include "event-sequence.h"
+#include "histogram.h"
 #include "time-sequence.h"
 
 G_BEGIN_DECLS
@@ -82,10 +83,21 @@ DflThreadId dfl_source_get_new_thread_id (DflSource *self);
 void dfl_source_dispatch_iter (DflSource           *self,
                                DflTimeSequenceIter *iter,
                                DflTimestamp         start);
+void dfl_source_dispatch_foreach_overlapping (DflSource                  *self,
+                                              DflTimestamp                start,
+                                              DflTimestamp                end,
+                                              DflTimeSequenceOverlapFunc  func,
+                                              gpointer                    user_data);
 
 gsize dfl_source_get_n_long_dispatches (DflSource   *self,
                                         DflDuration  min_duration);
 
+const DflHistogram *dfl_source_get_dispatch_histogram (DflSource *self);
+const DflHistogram *dfl_source_get_lateness_histogram (DflSource *self);
+
+DflDuration dfl_source_get_handoff_latency (DflSource    *self,
+                                            const gchar **callback_name);
+
 void dfl_source_get_dispatch_statistics (DflSource   *self,
                                          gsize       *n_dispatches,
                                          DflDuration *min_duration,
@@ -101,6 +101,9 @@ typedef enum
   PROP_RUN_IN_THREAD_CANCELLED,
   PROP_RUN_DURATION,
   PROP_RUN_IN_THREAD_DURATION,
+  PROP_QUEUE_WAIT_DURATION,
+  PROP_RETURN_HANDOFF_DURATION,
+  PROP_CALLBACK_DELIVERY_DURATION,
 } DflTaskProperty;
 
 static void
@@ -429,6 +432,63 @@ dfl_task_class_init (DflTaskClass *klass)
                                                        0, G_MAXINT64, 0,
                                                        G_PARAM_READABLE |
                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * DflTask:queue-wait-duration:
+   *
+   * Duration of the %DFL_TASK_PHASE_QUEUE_WAIT phase of the task, or -1 if
+   * the task was not run in a thread. See dfl_task_get_phase_duration().
+   *
+   * Since: UNRELEASED
+   */
+  g_object_class_install_property (object_class, PROP_QUEUE_WAIT_DURATION,
+                                   g_param_spec_int64 ("queue-wait-duration",
+                                                       "Queue Wait Duration",
+                                                       "Time between creating "
+                                                       "the task and starting "
+                                                       "to run it in a thread.",
+                                                       -1, G_MAXINT64, -1,
+                                                       G_PARAM_READABLE |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * DflTask:return-handoff-duration:
+   *
+   * Duration of the %DFL_TASK_PHASE_RETURN_HANDOFF phase of the task, or -1
+   * if the task was not run in a thread or never returned. See
+   * dfl_task_get_phase_duration().
+   *
+   * Since: UNRELEASED
+   */
+  g_object_class_install_property (object_class, PROP_RETURN_HANDOFF_DURATION,
+                                   g_param_spec_int64 ("return-handoff-duration",
+                                                       "Return Handoff Duration",
+                                                       "Time between the "
+                                                       "thread finishing and "
+                                                       "the task returning.",
+                                                       -1, G_MAXINT64, -1,
+                                                       G_PARAM_READABLE |
+                                                       G_PARAM_STATIC_STRINGS));
+
+  /**
+   * DflTask:callback-delivery-duration:
+   *
+   * Duration of the %DFL_TASK_PHASE_CALLBACK_DELIVERY phase of the task, or
+   * -1 if the task never returned or its result was never propagated. See
+   * dfl_task_get_phase_duration().
+   *
+   * Since: UNRELEASED
+   */
+  g_object_class_install_property (object_class, PROP_CALLBACK_DELIVERY_DURATION,
+                                   g_param_spec_int64 ("callback-delivery-duration",
+                                                       "Callback Delivery Duration",
+                                                       "Time between the task "
+                                                       "returning and its "
+                                                       "result being "
+                                                       "propagated.",
+                                                       -1, G_MAXINT64, -1,
+                                                       G_PARAM_READABLE |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -509,6 +569,21 @@ dfl_task_get_property (GObject     *object,
                          self->after_run_in_thread_timestamp -
                          self->before_run_in_thread_timestamp);
       break;
+    case PROP_QUEUE_WAIT_DURATION:
+      g_value_set_int64 (value,
+                         dfl_task_get_phase_duration (self,
+                                                      DFL_TASK_PHASE_QUEUE_WAIT));
+      break;
+    case PROP_RETURN_HANDOFF_DURATION:
+      g_value_set_int64 (value,
+                         dfl_task_get_phase_duration (self,
+                                                      DFL_TASK_PHASE_RETURN_HANDOFF));
+      break;
+    case PROP_CALLBACK_DELIVERY_DURATION:
+      g_value_set_int64 (value,
+                         dfl_task_get_phase_duration (self,
+                                                      DFL_TASK_PHASE_CALLBACK_DELIVERY));
+      break;
     default:
       g_assert_not_reached ();
     }
@@ -597,6 +672,9 @@ dfl_task_set_property (GObject           *object,
       break;
     case PROP_RUN_DURATION:
     case PROP_RUN_IN_THREAD_DURATION:
+    case PROP_QUEUE_WAIT_DURATION:
+    case PROP_RETURN_HANDOFF_DURATION:
+    case PROP_CALLBACK_DELIVERY_DURATION:
       /* Read only. */
     default:
       g_assert_not_reached ();
@@ -968,3 +1046,54 @@ dfl_task_get_source_tag_name (DflTask *self)
 
   return self->source_tag_name;
 }
+
+/* Duration from @start to @end, or -1 if either of them was never seen. If
+ * they are out of order (for example, if a thread returned its result before
+ * finishing), the phase is treated as taking no time. */
+static DflDuration
+phase_duration (DflTimestamp start,
+                DflTimestamp end)
+{
+  if (start == 0 || end == 0)
+    return -1;
+
+  return (end > start) ? (DflDuration) (end - start) : 0;
+}
+
+/**
+ * dfl_task_get_phase_duration:
+ * @self: a #DflTask
+ * @phase: the phase to get the duration of
+ *
+ * Get the duration of one @phase of the task’s lifecycle. See #DflTaskPhase
+ * for the definitions of the phases. Phases which did not happen for this
+ * task (for example, %DFL_TASK_PHASE_WORKER_RUN for a task which was never run
+ * in a thread) have a duration of -1.
+ *
+ * Returns: duration of the phase in microseconds, or -1 if it did not happen
+ * Since: UNRELEASED
+ */
+DflDuration
+dfl_task_get_phase_duration (DflTask      *self,
+                             DflTaskPhase  phase)
+{
+  g_return_val_if_fail (DFL_IS_TASK (self), -1);
+
+  switch (phase)
+    {
+    case DFL_TASK_PHASE_QUEUE_WAIT:
+      return phase_duration (self->new_timestamp,
+                             self->before_run_in_thread_timestamp);
+    case DFL_TASK_PHASE_WORKER_RUN:
+      return phase_duration (self->before_run_in_thread_timestamp,
+                             self->after_run_in_thread_timestamp);
+    case DFL_TASK_PHASE_RETURN_HANDOFF:
+      return phase_duration (self->after_run_in_thread_timestamp,
+                             self->return_timestamp);
+    case DFL_TASK_PHASE_CALLBACK_DELIVERY:
+      return phase_duration (self->return_timestamp,
+                             self->propagate_timestamp);
+    default:
+      g_return_val_if_reached (-1);
+    }
+}
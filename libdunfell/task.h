@@ -37,6 +37,39 @@ G_BEGIN_DECLS
 #define DFL_TYPE_TASK dfl_task_get_type ()
 G_DECLARE_FINAL_TYPE (DflTask, dfl_task, DFL, TASK, GObject)
 
+/**
+ * DflTaskPhase:
+ * @DFL_TASK_PHASE_QUEUE_WAIT: from the task being created to it starting to
+ *    run in a worker thread; long waits indicate a saturated thread pool
+ * @DFL_TASK_PHASE_WORKER_RUN: from the task starting to run in a worker
+ *    thread to it finishing there
+ * @DFL_TASK_PHASE_RETURN_HANDOFF: from the task finishing in the worker
+ *    thread to it returning its result
+ * @DFL_TASK_PHASE_CALLBACK_DELIVERY: from the task returning its result to the
+ *    result being propagated in the task’s callback
+ *
+ * Phases of the lifecycle of a #GTask. The first three only apply to tasks
+ * run with g_task_run_in_thread() or similar.
+ *
+ * Since: UNRELEASED
+ */
+typedef enum
+{
+  DFL_TASK_PHASE_QUEUE_WAIT,
+  DFL_TASK_PHASE_WORKER_RUN,
+  DFL_TASK_PHASE_RETURN_HANDOFF,
+  DFL_TASK_PHASE_CALLBACK_DELIVERY,
+} DflTaskPhase;
+
+/**
+ * DFL_TASK_N_PHASES:
+ *
+ * Number of values in #DflTaskPhase.
+ *
+ * Since: UNRELEASED
+ */
+#define DFL_TASK_N_PHASES (DFL_TASK_PHASE_CALLBACK_DELIVERY + 1)
+
 DflTask *dfl_task_new (DflId        id,
                        DflTimestamp new_timestamp,
                        DflThreadId  new_thread_id);
@@ -61,6 +94,9 @@ DflThreadId dfl_task_get_thread_id (DflTask *self);
 const gchar *dfl_task_get_callback_name (DflTask *self);
 const gchar *dfl_task_get_source_tag_name (DflTask *self);
 
+DflDuration dfl_task_get_phase_duration (DflTask      *self,
+                                         DflTaskPhase  phase);
+
 G_END_DECLS
 
 #endif /* !DFL_TASK_H */
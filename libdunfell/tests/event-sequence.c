@@ -86,22 +86,40 @@ test_event_sequence_empty (void)
   g_object_unref (sequence);
 }
 
-/* Test the properties of an event sequence containing a single event. */
+/* Test the properties of an event sequence containing a single event. The
+ * sequence doesn’t store #DflEvent objects, so each item is a new copy of the
+ * event. */
 static void
 test_event_sequence_single (void)
 {
   DflEventSequence *sequence = NULL;
   DflEvent *event = NULL;
+  DflEvent *item1 = NULL, *item2 = NULL;
+  const gchar *parameters[] = { "42", "not an ID", NULL };
 
-  event = g_object_new (DFL_TYPE_EVENT, NULL);
+  event = dfl_event_new ("type_a", 5, 7, parameters);
   sequence = dfl_event_sequence_new ((const DflEvent **) &event, 1, 123456);
   g_object_unref (event);
 
   g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sequence)), ==, 1);
-  g_assert (g_list_model_get_item (G_LIST_MODEL (sequence), 0) == event);
-  g_assert (DFL_IS_EVENT (g_list_model_get_item (G_LIST_MODEL (sequence), 0)));
-  g_assert (g_list_model_get_item (G_LIST_MODEL (sequence), 0) ==
-            g_list_model_get_object (G_LIST_MODEL (sequence), 0));
+
+  item1 = g_list_model_get_item (G_LIST_MODEL (sequence), 0);
+  item2 = g_list_model_get_item (G_LIST_MODEL (sequence), 0);
+  g_assert (DFL_IS_EVENT (item1));
+  g_assert (DFL_IS_EVENT (item2));
+  g_assert (item1 != item2);
+
+  g_assert_cmpstr (dfl_event_get_event_type (item1), ==, "type_a");
+  g_assert (dfl_event_get_event_type (item1) ==
+            dfl_event_get_event_type (item2));
+  g_assert_cmpuint (dfl_event_get_timestamp (item1), ==, 5);
+  g_assert_cmpuint (dfl_event_get_thread_id (item1), ==, 7);
+  g_assert_cmpuint (dfl_event_get_parameter_id (item1, 0), ==, 42);
+  g_assert_cmpstr (dfl_event_get_parameter_utf8 (item1, 1), ==, "not an ID");
+
+  g_object_unref (item2);
+  g_object_unref (item1);
+
   g_assert_null (g_list_model_get_item (G_LIST_MODEL (sequence), 1));
   g_assert_cmpuint (g_list_model_get_item_type (G_LIST_MODEL (sequence)), ==,
                     DFL_TYPE_EVENT);
@@ -109,6 +127,50 @@ test_event_sequence_single (void)
   g_object_unref (sequence);
 }
 
+/* Test that appending events to a sequence stores copies of them after the
+ * existing events. */
+static void
+test_event_sequence_append (void)
+{
+  DflEventSequence *sequence = NULL;
+  GPtrArray/*<owned DflEvent>*/ *events = NULL;
+  const EventVector vectors1[] = {
+    { "type_a", 1 },
+    { "type_b", 2 },
+  };
+  const EventVector vectors2[] = {
+    { "type_c", 3 },
+  };
+  const EventVector *expected[] = {
+    &vectors1[0], &vectors1[1], &vectors2[0],
+  };
+  guint i;
+
+  sequence = event_sequence_from_vectors (vectors1, G_N_ELEMENTS (vectors1));
+
+  events = event_array_from_vectors (vectors2, G_N_ELEMENTS (vectors2));
+  dfl_event_sequence_append (sequence, (const DflEvent **) events->pdata,
+                             events->len);
+  g_ptr_array_unref (events);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sequence)), ==,
+                    G_N_ELEMENTS (expected));
+
+  for (i = 0; i < G_N_ELEMENTS (expected); i++)
+    {
+      DflEvent *event = g_list_model_get_item (G_LIST_MODEL (sequence), i);
+
+      g_assert_cmpstr (dfl_event_get_event_type (event), ==,
+                       expected[i]->event_type);
+      g_assert_cmpuint (dfl_event_get_parameter_id (event, 0), ==,
+                        expected[i]->id);
+
+      g_object_unref (event);
+    }
+
+  g_object_unref (sequence);
+}
+
 /* Test that walking over a short sequence with no walkers added is OK. */
 static void
 test_event_sequence_walk_no_walkers (void)
@@ -158,6 +220,27 @@ walker_match_event_type (DflEventSequence *sequence,
   g_assert_cmpstr (dfl_event_get_event_type (event), ==, event_type);
 }
 
+static void
+walker_keep_event (DflEventSequence *sequence,
+                   DflEvent         *event,
+                   gpointer          user_data)
+{
+  GPtrArray/*<owned DflEvent>*/ *kept_events = user_data;
+
+  g_ptr_array_add (kept_events, g_object_ref (event));
+}
+
+static void
+walker_ref_unref_event (DflEventSequence *sequence,
+                        DflEvent         *event,
+                        gpointer          user_data)
+{
+  GPtrArray/*<unowned DflEvent>*/ *seen_events = user_data;
+
+  g_object_unref (g_object_ref (event));
+  g_ptr_array_add (seen_events, event);
+}
+
 static void
 walker_count (DflEventSequence *sequence,
               DflEvent         *event,
@@ -294,6 +377,151 @@ test_event_sequence_walk_empty_group (void)
   g_object_unref (sequence);
 }
 
+static void
+walker_add_counter (DflEventSequence *sequence,
+                    DflEvent         *event,
+                    gpointer          user_data)
+{
+  guint *counter = user_data;
+
+  dfl_event_sequence_add_walker (sequence, "type_a", DFL_ID_INVALID,
+                                 walker_count, counter, NULL);
+}
+
+/* Test that walkers added during a walk only match from the next event. */
+static void
+test_event_sequence_walk_add_during_walk (void)
+{
+  DflEventSequence *sequence = NULL;
+  const EventVector vectors[] = {
+    { "type_a", 1 },  /* this adds a walker */
+    { "type_b", 2 },
+    { "type_a", 3 },  /* this is counted */
+  };
+  guint walker_id;
+  guint counter = 0;
+
+  sequence = event_sequence_from_vectors (vectors, G_N_ELEMENTS (vectors));
+  walker_id = dfl_event_sequence_add_walker (sequence, "type_a", 1,
+                                             walker_add_counter, &counter,
+                                             NULL);
+  dfl_event_sequence_walk (sequence);
+  g_assert_cmpuint (counter, ==, 1);
+
+  /* Walking again should count both type_a events, and add another walker
+   * which counts the second one. */
+  dfl_event_sequence_walk (sequence);
+  g_assert_cmpuint (counter, ==, 4);
+
+  dfl_event_sequence_remove_walker (sequence, walker_id);
+  g_object_unref (sequence);
+}
+
+/* Test that removing lots of walkers, some of them for the same event type and
+ * ID, leaves the others matching. */
+static void
+test_event_sequence_walk_remove_many (void)
+{
+  DflEventSequence *sequence = NULL;
+  const EventVector vectors[] = {
+    { "type_a", 1 },
+    { "type_a", 2 },
+    { "type_b", 1 },
+  };
+  GArray/*<guint>*/ *walker_ids = NULL;
+  guint i, counter = 0;
+
+  sequence = event_sequence_from_vectors (vectors, G_N_ELEMENTS (vectors));
+  walker_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < 1000; i++)
+    {
+      guint walker_id;
+
+      walker_id = dfl_event_sequence_add_walker (sequence, "type_a", i % 4,
+                                                 walker_count, &counter, NULL);
+      g_array_append_val (walker_ids, walker_id);
+    }
+
+  /* Remove all but the last two walkers for each ID. */
+  for (i = 0; i < 1000 - 8; i++)
+    dfl_event_sequence_remove_walker (sequence,
+                                      g_array_index (walker_ids, guint, i));
+
+  dfl_event_sequence_walk (sequence);
+  g_assert_cmpuint (counter, ==, 4);
+
+  g_array_unref (walker_ids);
+  g_object_unref (sequence);
+}
+
+/* Test that walkers which (incorrectly) keep a reference to the event they are
+ * passed don’t see it change when later events are walked over. */
+static void
+test_event_sequence_walk_keep_event (void)
+{
+  DflEventSequence *sequence = NULL;
+  GPtrArray/*<owned DflEvent>*/ *kept_events = NULL;
+  const EventVector vectors[] = {
+    { "type_a", 1 },
+    { "type_b", 2 },
+    { "type_a", 3 },
+  };
+  guint i;
+
+  kept_events = g_ptr_array_new_with_free_func (g_object_unref);
+
+  sequence = event_sequence_from_vectors (vectors, G_N_ELEMENTS (vectors));
+  dfl_event_sequence_add_walker (sequence, NULL, DFL_ID_INVALID,
+                                 walker_keep_event, kept_events, NULL);
+  dfl_event_sequence_walk (sequence);
+  g_object_unref (sequence);
+
+  g_assert_cmpuint (kept_events->len, ==, G_N_ELEMENTS (vectors));
+
+  for (i = 0; i < kept_events->len; i++)
+    {
+      DflEvent *event = kept_events->pdata[i];
+
+      g_assert_cmpstr (dfl_event_get_event_type (event), ==,
+                       vectors[i].event_type);
+      g_assert_cmpuint (dfl_event_get_parameter_id (event, 0), ==,
+                        vectors[i].id);
+    }
+
+  g_ptr_array_unref (kept_events);
+}
+
+/* Test that the event passed to walkers is still reused if a walker only holds
+ * a reference to it for the duration of its callback. */
+static void
+test_event_sequence_walk_reuse_event (void)
+{
+  DflEventSequence *sequence = NULL;
+  GPtrArray/*<unowned DflEvent>*/ *seen_events = NULL;
+  const EventVector vectors[] = {
+    { "type_a", 1 },
+    { "type_b", 2 },
+    { "type_a", 3 },
+  };
+  guint i;
+
+  seen_events = g_ptr_array_new ();
+
+  sequence = event_sequence_from_vectors (vectors, G_N_ELEMENTS (vectors));
+  dfl_event_sequence_add_walker (sequence, NULL, DFL_ID_INVALID,
+                                 walker_ref_unref_event, seen_events, NULL);
+  dfl_event_sequence_walk (sequence);
+  g_object_unref (sequence);
+
+  g_assert_cmpuint (seen_events->len, ==, G_N_ELEMENTS (vectors));
+
+  for (i = 1; i < seen_events->len; i++)
+    g_assert (seen_events->pdata[i] == seen_events->pdata[0]);
+
+  g_ptr_array_unref (seen_events);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -303,6 +531,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/event-sequence/empty", test_event_sequence_empty);
   g_test_add_func ("/event-sequence/single", test_event_sequence_single);
+  g_test_add_func ("/event-sequence/append", test_event_sequence_append);
   g_test_add_func ("/event-sequence/walk/empty",
                    test_event_sequence_walk_empty);
   g_test_add_func ("/event-sequence/walk/no-walkers",
@@ -317,6 +546,14 @@ main (int argc, char *argv[])
                    test_event_sequence_walk_remove_group_then_id_reuse);
   g_test_add_func ("/event-sequence/walk/empty-group",
                    test_event_sequence_walk_empty_group);
+  g_test_add_func ("/event-sequence/walk/add-during-walk",
+                   test_event_sequence_walk_add_during_walk);
+  g_test_add_func ("/event-sequence/walk/remove-many",
+                   test_event_sequence_walk_remove_many);
+  g_test_add_func ("/event-sequence/walk/keep-event",
+                   test_event_sequence_walk_keep_event);
+  g_test_add_func ("/event-sequence/walk/reuse-event",
+                   test_event_sequence_walk_reuse_event);
 
   return g_test_run ();
 }
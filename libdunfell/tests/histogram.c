@@ -0,0 +1,160 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Collabora Ltd. 2016
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+
+#include "histogram.h"
+
+
+/* Test the properties of an empty histogram. */
+static void
+test_histogram_empty (void)
+{
+  g_autoptr (DflHistogram) histogram = NULL;
+
+  histogram = dfl_histogram_new ();
+
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_min (histogram), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 0.0), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 50.0), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 100.0), ==, 0);
+}
+
+/* Test that small values are counted exactly, and that the median of an even
+ * number of values is the lower middle value. */
+static void
+test_histogram_exact (void)
+{
+  g_autoptr (DflHistogram) histogram = NULL;
+  const DflDuration values[] = { 7, 3, 50, 1, 0, 12 };
+  gsize i;
+
+  histogram = dfl_histogram_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    dfl_histogram_record (histogram, values[i]);
+
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==,
+                    G_N_ELEMENTS (values));
+  g_assert_cmpint (dfl_histogram_get_min (histogram), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 50);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 0.0), ==, 0);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 50.0), ==, 3);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 51.0), ==, 7);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 90.0), ==, 50);
+  g_assert_cmpint (dfl_histogram_get_percentile (histogram, 100.0), ==, 50);
+}
+
+static gint
+compare_durations (gconstpointer a,
+                   gconstpointer b)
+{
+  const DflDuration *duration_a = a, *duration_b = b;
+
+  if (*duration_a < *duration_b)
+    return -1;
+  else if (*duration_a > *duration_b)
+    return 1;
+  else
+    return 0;
+}
+
+/* Test percentiles of a large range of values against the exact answers, both
+ * with a single histogram and with one merged from two halves. */
+static void
+test_histogram_percentiles (void)
+{
+  g_autoptr (DflHistogram) histogram = NULL;
+  g_autoptr (DflHistogram) other_histogram = NULL;
+  g_autoptr (DflHistogram) copy = NULL;
+  g_autoptr (GArray) values = NULL;  /* (element-type DflDuration) */
+  const gdouble percentiles[] = { 0.0, 1.0, 25.0, 50.0, 90.0, 99.0, 99.9,
+                                  100.0 };
+  gsize i;
+
+  histogram = dfl_histogram_new ();
+  other_histogram = dfl_histogram_new ();
+  values = g_array_new (FALSE, FALSE, sizeof (DflDuration));
+
+  /* Cover a wide range of magnitudes, including the largest possible
+   * duration. */
+  for (i = 0; i < 10000; i++)
+    {
+      DflDuration value;
+
+      value = (DflDuration) g_test_rand_int_range (0, G_MAXINT32) >>
+              g_test_rand_int_range (0, 31);
+      value <<= g_test_rand_int_range (0, 32);
+
+      if (i == 0)
+        value = G_MAXINT64;
+
+      g_array_append_val (values, value);
+      dfl_histogram_record ((i % 2 == 0) ? histogram : other_histogram, value);
+    }
+
+  dfl_histogram_merge (histogram, other_histogram);
+  copy = dfl_histogram_copy (histogram);
+
+  g_array_sort (values, compare_durations);
+
+  g_assert_cmpuint (dfl_histogram_get_n_values (copy), ==, values->len);
+  g_assert_cmpint (dfl_histogram_get_min (copy), ==,
+                   g_array_index (values, DflDuration, 0));
+  g_assert_cmpint (dfl_histogram_get_max (copy), ==,
+                   g_array_index (values, DflDuration, values->len - 1));
+
+  for (i = 0; i < G_N_ELEMENTS (percentiles); i++)
+    {
+      gsize rank;
+      DflDuration expected, actual;
+
+      g_test_message ("Percentile %f", percentiles[i]);
+
+      /* Nearest rank. */
+      rank = (gsize) (percentiles[i] / 100.0 * values->len);
+      if ((gdouble) rank < percentiles[i] / 100.0 * values->len)
+        rank++;
+      rank = MAX (rank, 1);
+
+      expected = g_array_index (values, DflDuration, rank - 1);
+      actual = dfl_histogram_get_percentile (copy, percentiles[i]);
+
+      /* The result must be no smaller than the exact answer, and within 1/32
+       * of it. */
+      g_assert_cmpint (actual, >=, expected);
+      g_assert_cmpint (actual - expected, <=, expected / 32);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/histogram/empty", test_histogram_empty);
+  g_test_add_func ("/histogram/exact", test_histogram_exact);
+  g_test_add_func ("/histogram/percentiles", test_histogram_percentiles);
+
+  return g_test_run ();
+}
@@ -101,6 +101,333 @@ test_main_context_parse_log_single_context_single_thread (void)
   g_ptr_array_unref (main_contexts);
 }
 
+/* Test that the phases of a main context iteration are extracted from the
+ * log, and that dispatches outside an iteration are not counted as one. */
+static void
+test_main_context_parse_log_iteration_phases (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflMainContextIterationData *iteration;
+  DflDuration prepare, query, poll_duration, check, dispatch;
+
+  /* Timestamps: 1+; thread ID: 1000; context ID: 666 */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_before_prepare,10,1000,666\n"
+    "g_main_context_after_prepare,12,1000,666,0,0\n"
+    "g_main_context_before_query,12,1000,666,0\n"
+    "g_main_context_after_query,13,1000,666,500,2\n"
+    "g_main_context_before_check,100,1000,666,0,2\n"
+    "g_main_context_after_check,101,1000,666,1\n"
+    "g_main_context_before_dispatch,101,1000,666\n"
+    "g_main_context_after_dispatch,110,1000,666\n"
+    "g_main_context_before_dispatch,111,1000,666\n"
+    "g_main_context_after_dispatch,115,1000,666\n"
+    "g_main_context_free,120,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  dfl_main_context_iteration_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &iteration));
+  g_assert_cmpuint (timestamp, ==, 10);
+  g_assert_cmpuint (iteration->thread_id, ==, 1000);
+  g_assert_cmpint (iteration->duration, ==, 100);
+  g_assert_cmpint (iteration->prepare_duration, ==, 2);
+  g_assert_cmpint (iteration->query_duration, ==, 1);
+  g_assert_cmpint (iteration->poll_duration, ==, 87);
+  g_assert_cmpint (iteration->check_duration, ==, 1);
+  g_assert_cmpint (iteration->dispatch_duration, ==, 9);
+  g_assert_cmpint (iteration->poll_timeout, ==, 500);
+  g_assert_cmpint (iteration->n_ready, ==, 1);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  g_assert_cmpuint (dfl_main_context_get_iteration_phase_totals (context,
+                                                                 &prepare,
+                                                                 &query,
+                                                                 &poll_duration,
+                                                                 &check,
+                                                                 &dispatch),
+                    ==, 1);
+  g_assert_cmpint (prepare, ==, 2);
+  g_assert_cmpint (query, ==, 1);
+  g_assert_cmpint (poll_duration, ==, 87);
+  g_assert_cmpint (check, ==, 1);
+  g_assert_cmpint (dispatch, ==, 9);
+
+  g_ptr_array_unref (main_contexts);
+}
+
+/* Test that wakeups are paired with their acknowledgements and the following
+ * dispatch, and that only cross-thread wakeups are counted in the histogram. */
+static void
+test_main_context_parse_log_wakeups (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflMainContextWakeupData *wakeup;
+  const DflHistogram *histogram;
+
+  /* Timestamps: 1+; thread IDs: 1000 (owner), 2000, 2001; context ID: 666 */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_wakeup,10,2000,666\n"
+    "g_main_context_wakeup,11,2001,666\n"
+    "g_main_context_wakeup_acknowledge,15,1000,666\n"
+    "g_main_context_before_dispatch,20,1000,666\n"
+    "g_main_context_after_dispatch,25,1000,666\n"
+    "g_main_context_wakeup,30,1000,666\n"
+    "g_main_context_wakeup_acknowledge,31,1000,666\n"
+    "g_main_context_before_dispatch,32,1000,666\n"
+    "g_main_context_after_dispatch,33,1000,666\n"
+    "g_main_context_free,40,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  dfl_main_context_wakeup_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &wakeup));
+  g_assert_cmpuint (timestamp, ==, 10);
+  g_assert_cmpuint (wakeup->thread_id, ==, 2000);
+  g_assert_cmpuint (wakeup->n_wakeups, ==, 2);
+  g_assert_cmpint (wakeup->acknowledge_duration, ==, 5);
+  g_assert_cmpuint (wakeup->acknowledge_thread_id, ==, 1000);
+  g_assert_cmpint (wakeup->duration, ==, 10);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &wakeup));
+  g_assert_cmpuint (timestamp, ==, 30);
+  g_assert_cmpuint (wakeup->thread_id, ==, 1000);
+  g_assert_cmpuint (wakeup->n_wakeups, ==, 1);
+  g_assert_cmpint (wakeup->acknowledge_duration, ==, 1);
+  g_assert_cmpint (wakeup->duration, ==, 2);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  histogram = dfl_main_context_get_wakeup_histogram (context);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 1);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 10);
+
+  g_ptr_array_unref (main_contexts);
+}
+
+/* Test that failed acquires do not change the owner of a main context, and
+ * that they are paired with the owner releasing it to measure contention. */
+static void
+test_main_context_parse_log_contention (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflMainContextContentionData *contention;
+  DflThreadOwnershipData *ownership;
+  gsize n_failures;
+
+  /* Timestamps: 1+; thread IDs: 1000, 2000, 2001; context ID: 666 */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_acquire,10,1000,666,1\n"
+    "g_main_context_acquire,12,2000,666,0\n"
+    "g_main_context_acquire,15,2000,666,0\n"
+    "g_main_context_acquire,16,2001,666,0\n"
+    "g_main_context_release,20,1000,666\n"
+    "g_main_context_acquire,21,2000,666,1\n"
+    "g_main_context_acquire,25,2001,666,0\n"
+    "g_main_context_release,30,2000,666\n"
+    "g_main_context_free,40,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  /* Only the successful acquires start ownership spans. */
+  dfl_main_context_thread_ownership_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &ownership));
+  g_assert_cmpuint (timestamp, ==, 10);
+  g_assert_cmpuint (ownership->thread_id, ==, 1000);
+  g_assert_cmpint (ownership->duration, ==, 10);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &ownership));
+  g_assert_cmpuint (timestamp, ==, 21);
+  g_assert_cmpuint (ownership->thread_id, ==, 2000);
+  g_assert_cmpint (ownership->duration, ==, 9);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  /* Repeated failures by the same thread are coalesced until the release. */
+  dfl_main_context_contention_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &contention));
+  g_assert_cmpuint (timestamp, ==, 12);
+  g_assert_cmpuint (contention->thread_id, ==, 2000);
+  g_assert_cmpuint (contention->owner_thread_id, ==, 1000);
+  g_assert_cmpuint (contention->n_failures, ==, 2);
+  g_assert_cmpint (contention->duration, ==, 8);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &contention));
+  g_assert_cmpuint (timestamp, ==, 16);
+  g_assert_cmpuint (contention->thread_id, ==, 2001);
+  g_assert_cmpuint (contention->owner_thread_id, ==, 1000);
+  g_assert_cmpuint (contention->n_failures, ==, 1);
+  g_assert_cmpint (contention->duration, ==, 4);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &contention));
+  g_assert_cmpuint (timestamp, ==, 25);
+  g_assert_cmpuint (contention->thread_id, ==, 2001);
+  g_assert_cmpuint (contention->owner_thread_id, ==, 2000);
+  g_assert_cmpuint (contention->n_failures, ==, 1);
+  g_assert_cmpint (contention->duration, ==, 5);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  /* Totals, per thread and for the whole context. */
+  g_assert_cmpint (dfl_main_context_get_contention_totals (context, 2000,
+                                                           &n_failures),
+                   ==, 8);
+  g_assert_cmpuint (n_failures, ==, 2);
+  g_assert_cmpint (dfl_main_context_get_contention_totals (context, 2001,
+                                                           &n_failures),
+                   ==, 9);
+  g_assert_cmpuint (n_failures, ==, 2);
+  g_assert_cmpint (dfl_main_context_get_contention_totals (context, 1000,
+                                                           &n_failures),
+                   ==, 0);
+  g_assert_cmpuint (n_failures, ==, 0);
+  g_assert_cmpint (dfl_main_context_get_contention_totals (context, 0,
+                                                           &n_failures),
+                   ==, 17);
+  g_assert_cmpuint (n_failures, ==, 4);
+
+  g_ptr_array_unref (main_contexts);
+}
+
+/* Test that recursive acquires by the owner do not start new ownership spans,
+ * and that contention only ends once the owner has released the context as
+ * many times as it acquired it. */
+static void
+test_main_context_parse_log_contention_recursive (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflMainContextContentionData *contention;
+  DflThreadOwnershipData *ownership;
+
+  /* Timestamps: 1+; thread IDs: 1000, 2000; context ID: 666 */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_acquire,10,1000,666,1\n"
+    "g_main_context_acquire,11,1000,666,1\n"
+    "g_main_context_acquire,12,2000,666,0\n"
+    "g_main_context_release,14,1000,666\n"
+    "g_main_context_acquire,15,2000,666,0\n"
+    "g_main_context_release,20,1000,666\n"
+    "g_main_context_acquire,21,2000,666,1\n"
+    "g_main_context_release,30,2000,666\n"
+    "g_main_context_free,40,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  dfl_main_context_thread_ownership_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &ownership));
+  g_assert_cmpuint (timestamp, ==, 10);
+  g_assert_cmpuint (ownership->thread_id, ==, 1000);
+  g_assert_cmpint (ownership->duration, ==, 10);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &ownership));
+  g_assert_cmpuint (timestamp, ==, 21);
+  g_assert_cmpuint (ownership->thread_id, ==, 2000);
+  g_assert_cmpint (ownership->duration, ==, 9);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  /* The inner release at 14 does not end the contention. */
+  dfl_main_context_contention_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &contention));
+  g_assert_cmpuint (timestamp, ==, 12);
+  g_assert_cmpuint (contention->thread_id, ==, 2000);
+  g_assert_cmpuint (contention->owner_thread_id, ==, 1000);
+  g_assert_cmpuint (contention->n_failures, ==, 2);
+  g_assert_cmpint (contention->duration, ==, 8);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  g_ptr_array_unref (main_contexts);
+}
+
+/* Test that a thread’s contention interval ends when it acquires the context,
+ * even if the previous owner’s release was not logged. */
+static void
+test_main_context_parse_log_contention_own_acquire (void)
+{
+  GPtrArray/*<owned DflMainContext>*/ *main_contexts = NULL;
+  DflMainContext *context;
+  DflTimeSequenceIter iter;
+  DflTimestamp timestamp;
+  DflMainContextContentionData *contention;
+  gsize n_failures;
+
+  /* Timestamps: 1+; thread ID: 2000; context ID: 666. The context is owned by
+   * an unknown thread when the log starts. */
+  main_contexts = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_main_context_new,1,1000,666\n"
+    "g_main_context_acquire,5,2000,666,0\n"
+    "g_main_context_acquire,7,2000,666,0\n"
+    "g_main_context_acquire,9,2000,666,1\n"
+    "g_main_context_release,12,2000,666\n"
+    "g_main_context_free,40,1000,666\n");
+
+  g_assert_cmpuint (main_contexts->len, ==, 1);
+  context = main_contexts->pdata[0];
+
+  dfl_main_context_contention_iter (context, &iter, 0);
+
+  g_assert_true (dfl_time_sequence_iter_next (&iter, &timestamp,
+                                              (gpointer *) &contention));
+  g_assert_cmpuint (timestamp, ==, 5);
+  g_assert_cmpuint (contention->thread_id, ==, 2000);
+  g_assert_cmpuint (contention->owner_thread_id, ==, 0);
+  g_assert_cmpuint (contention->n_failures, ==, 2);
+  g_assert_cmpint (contention->duration, ==, 4);
+
+  g_assert_false (dfl_time_sequence_iter_next (&iter, NULL, NULL));
+
+  g_assert_cmpint (dfl_main_context_get_contention_totals (context, 2000,
+                                                           &n_failures),
+                   ==, 4);
+  g_assert_cmpuint (n_failures, ==, 2);
+
+  g_ptr_array_unref (main_contexts);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -114,6 +441,16 @@ main (int argc, char *argv[])
                    test_main_context_parse_log_empty);
   g_test_add_func ("/main-context/parse-log/single-context-single-thread",
                    test_main_context_parse_log_single_context_single_thread);
+  g_test_add_func ("/main-context/parse-log/iteration-phases",
+                   test_main_context_parse_log_iteration_phases);
+  g_test_add_func ("/main-context/parse-log/wakeups",
+                   test_main_context_parse_log_wakeups);
+  g_test_add_func ("/main-context/parse-log/contention",
+                   test_main_context_parse_log_contention);
+  g_test_add_func ("/main-context/parse-log/contention-recursive",
+                   test_main_context_parse_log_contention_recursive);
+  g_test_add_func ("/main-context/parse-log/contention-own-acquire",
+                   test_main_context_parse_log_contention_own_acquire);
 
   return g_test_run ();
 }
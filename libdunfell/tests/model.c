@@ -0,0 +1,298 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "main-context.h"
+#include "model.h"
+#include "parser.h"
+#include "profile.h"
+#include "source.h"
+#include "thread.h"
+
+
+static DflModel *
+model_helper_with_max_threads (const gchar *log,
+                               guint        max_threads)
+{
+  DflParser *parser = NULL;
+  DflEventSequence *sequence;
+  DflModel *model = NULL;
+  GError *error = NULL;
+
+  /* Parse the log into an event sequence. */
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log, strlen (log),
+                             &error);
+  g_assert_no_error (error);
+
+  sequence = dfl_parser_get_event_sequence (parser);
+  g_assert_nonnull (sequence);
+
+  /* Analyse the event sequence. */
+  model = g_object_new (DFL_TYPE_MODEL,
+                        "event-sequence", sequence,
+                        "max-threads", max_threads,
+                        NULL);
+
+  g_object_unref (parser);
+
+  return model;  /* transfer */
+}
+
+static DflModel *
+model_helper (const gchar *log)
+{
+  return model_helper_with_max_threads (log, 0);
+}
+
+static void
+assert_profile_entry (const DflProfileEntry *entry,
+                      const gchar           *source_name,
+                      gsize                  n_dispatches,
+                      DflDuration            total_duration,
+                      DflDuration            self_duration)
+{
+  g_assert_cmpstr (entry->source_name, ==, source_name);
+  g_assert_cmpuint (entry->n_dispatches, ==, n_dispatches);
+  g_assert_cmpint (entry->total_duration, ==, total_duration);
+  g_assert_cmpint (entry->self_duration, ==, self_duration);
+}
+
+/* Test that the self time of a dispatch excludes the dispatches nested inside
+ * it on the same thread, but not those overlapping it on other threads; and
+ * that dispatches which never finished are not counted. */
+static void
+test_model_profile_nested (void)
+{
+  DflModel *model = NULL;
+  GPtrArray/*<unowned DflProfileEntry>*/ *profile = NULL;
+
+  /* Timestamps: 1+; thread IDs: 1000, 2000; source IDs: 100, 200, 300 */
+  model = model_helper (
+    "Dunfell log,1.0,1\n"
+    "g_source_new,1,1000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,2,1000,100,outer\n"
+    "g_source_new,3,1000,200,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,4,1000,200,inner\n"
+    "g_source_new,5,2000,300,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,6,2000,300,other\n"
+    "g_source_before_dispatch,10,1000,100,dispatch,callback,0\n"
+    "g_source_before_dispatch,15,1000,200,dispatch,callback,0\n"
+    "g_source_before_dispatch,20,2000,300,dispatch,callback,0\n"
+    "g_source_after_dispatch,25,1000,200,dispatch,0\n"
+    "g_source_before_dispatch,28,1000,200,dispatch,callback,0\n"
+    "g_source_after_dispatch,30,2000,300,dispatch,0\n"
+    "g_source_after_dispatch,33,1000,200,dispatch,0\n"
+    "g_source_after_dispatch,40,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,50,2000,300,dispatch,callback,0\n");
+
+  profile = dfl_model_dup_profile (model, 0);
+
+  /* Sorted by decreasing total duration. */
+  g_assert_cmpuint (profile->len, ==, 3);
+  assert_profile_entry (profile->pdata[0], "outer", 1, 30, 15);
+  assert_profile_entry (profile->pdata[1], "inner", 2, 15, 15);
+  assert_profile_entry (profile->pdata[2], "other", 1, 10, 10);
+
+  g_ptr_array_unref (profile);
+
+  /* Only the top entries. */
+  profile = dfl_model_dup_profile (model, 1);
+  g_assert_cmpuint (profile->len, ==, 1);
+  assert_profile_entry (profile->pdata[0], "outer", 1, 30, 15);
+  g_ptr_array_unref (profile);
+
+  g_object_unref (model);
+}
+
+/* Test that analysing a log in several threads gives the same results as
+ * analysing it in one. */
+static void
+test_model_analyse_parallel (void)
+{
+  const gchar *log =
+    "Dunfell log,1.0,1\n"
+    "g_thread_spawned,1,1000,1,2000,worker\n"
+    "g_main_context_new,2,1000,666\n"
+    "g_main_context_new,3,2000,667\n"
+    "g_source_new,4,1000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,5,1000,100,first\n"
+    "g_source_attach,6,1000,100,666,1\n"
+    "g_source_new,7,2000,200,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,8,2000,200,667,1\n"
+    "g_main_context_acquire,10,1000,666,1\n"
+    "g_main_context_acquire,11,2000,667,1\n"
+    "g_main_context_before_dispatch,12,1000,666\n"
+    "g_source_before_dispatch,13,1000,100,dispatch,callback,0\n"
+    "g_source_after_dispatch,15,1000,100,dispatch,0\n"
+    "g_main_context_after_dispatch,16,1000,666\n"
+    "g_main_context_before_dispatch,17,2000,667\n"
+    "g_source_before_dispatch,18,2000,200,dispatch,callback,0\n"
+    "g_source_after_dispatch,21,2000,200,dispatch,0\n"
+    "g_main_context_after_dispatch,22,2000,667\n"
+    "g_main_context_release,30,1000,666\n"
+    "g_main_context_release,31,2000,667\n"
+    "g_source_before_free,40,1000,100,666,finalize\n"
+    "g_main_context_free,41,1000,666\n";
+  DflModel *serial_model = NULL, *parallel_model = NULL;
+  GPtrArray *serial = NULL, *parallel = NULL;
+  gsize i;
+
+  serial_model = model_helper_with_max_threads (log, 1);
+  parallel_model = model_helper_with_max_threads (log, 4);
+
+  /* Threads. */
+  serial = dfl_model_dup_threads (serial_model);
+  parallel = dfl_model_dup_threads (parallel_model);
+
+  g_assert_cmpuint (serial->len, ==, 2);
+  g_assert_cmpuint (parallel->len, ==, serial->len);
+
+  for (i = 0; i < serial->len; i++)
+    {
+      g_assert_cmpuint (dfl_thread_get_id (parallel->pdata[i]), ==,
+                        dfl_thread_get_id (serial->pdata[i]));
+      g_assert_cmpstr (dfl_thread_get_name (parallel->pdata[i]), ==,
+                       dfl_thread_get_name (serial->pdata[i]));
+      g_assert_cmpuint (dfl_thread_get_free_timestamp (parallel->pdata[i]), ==,
+                        dfl_thread_get_free_timestamp (serial->pdata[i]));
+    }
+
+  g_ptr_array_unref (parallel);
+  g_ptr_array_unref (serial);
+
+  /* Sources. */
+  serial = dfl_model_dup_sources (serial_model);
+  parallel = dfl_model_dup_sources (parallel_model);
+
+  g_assert_cmpuint (serial->len, ==, 2);
+  g_assert_cmpuint (parallel->len, ==, serial->len);
+
+  for (i = 0; i < serial->len; i++)
+    {
+      gsize serial_n_dispatches, parallel_n_dispatches;
+      DflDuration serial_max_duration, parallel_max_duration;
+
+      g_assert_cmpuint (dfl_source_get_id (parallel->pdata[i]), ==,
+                        dfl_source_get_id (serial->pdata[i]));
+      g_assert_cmpstr (dfl_source_get_name (parallel->pdata[i]), ==,
+                       dfl_source_get_name (serial->pdata[i]));
+      g_assert_cmpuint (dfl_source_get_free_timestamp (parallel->pdata[i]), ==,
+                        dfl_source_get_free_timestamp (serial->pdata[i]));
+
+      dfl_source_get_dispatch_statistics (serial->pdata[i],
+                                          &serial_n_dispatches, NULL, NULL,
+                                          &serial_max_duration);
+      dfl_source_get_dispatch_statistics (parallel->pdata[i],
+                                          &parallel_n_dispatches, NULL, NULL,
+                                          &parallel_max_duration);
+      g_assert_cmpuint (serial_n_dispatches, ==, 1);
+      g_assert_cmpuint (parallel_n_dispatches, ==, serial_n_dispatches);
+      g_assert_cmpint (parallel_max_duration, ==, serial_max_duration);
+    }
+
+  g_ptr_array_unref (parallel);
+  g_ptr_array_unref (serial);
+
+  /* Main contexts. */
+  serial = dfl_model_dup_main_contexts (serial_model);
+  parallel = dfl_model_dup_main_contexts (parallel_model);
+
+  g_assert_cmpuint (serial->len, ==, 2);
+  g_assert_cmpuint (parallel->len, ==, serial->len);
+
+  for (i = 0; i < serial->len; i++)
+    {
+      g_assert_cmpuint (dfl_main_context_get_id (parallel->pdata[i]), ==,
+                        dfl_main_context_get_id (serial->pdata[i]));
+      g_assert_cmpuint (dfl_main_context_get_free_timestamp (parallel->pdata[i]),
+                        ==,
+                        dfl_main_context_get_free_timestamp (serial->pdata[i]));
+      g_assert_cmpuint (dfl_main_context_get_n_thread_switches (parallel->pdata[i]),
+                        ==,
+                        dfl_main_context_get_n_thread_switches (serial->pdata[i]));
+    }
+
+  g_ptr_array_unref (parallel);
+  g_ptr_array_unref (serial);
+
+  g_object_unref (parallel_model);
+  g_object_unref (serial_model);
+}
+
+/* Test that looking up objects by ID works for IDs wider than 32 bits, and
+ * that a reused ID returns the most recently created object with it. */
+static void
+test_model_lookup (void)
+{
+  DflModel *model = NULL;
+  DflMainContext *main_context;
+  DflSource *source;
+  DflThread *thread;
+
+  /* Timestamps: 1+; thread IDs: 1000, 2000; main context ID: 666; source ID:
+   * 140000000000000 (reused) */
+  model = model_helper (
+    "Dunfell log,1.0,1\n"
+    "g_thread_spawned,1,1000,1,2000,worker\n"
+    "g_main_context_new,2,2000,666\n"
+    "g_source_new,3,1000,140000000000000,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,4,1000,140000000000000,first\n"
+    "g_source_before_free,5,1000,140000000000000,666,finalize\n"
+    "g_source_new,6,2000,140000000000000,prepare,check,dispatch,finalize,96\n"
+    "g_source_set_name,7,2000,140000000000000,second\n");
+
+  source = dfl_model_lookup_source (model, (DflId) 140000000000000);
+  g_assert_nonnull (source);
+  g_assert_cmpstr (dfl_source_get_name (source), ==, "second");
+  g_assert_cmpuint (dfl_source_get_new_timestamp (source), ==, 6);
+
+  main_context = dfl_model_lookup_main_context (model, 666);
+  g_assert_nonnull (main_context);
+  g_assert_cmpuint (dfl_main_context_get_id (main_context), ==, 666);
+
+  thread = dfl_model_lookup_thread (model, 2000);
+  g_assert_nonnull (thread);
+  g_assert_cmpstr (dfl_thread_get_name (thread), ==, "worker");
+
+  /* Unknown IDs. */
+  g_assert_null (dfl_model_lookup_source (model, 100));
+  g_assert_null (dfl_model_lookup_main_context (model, 667));
+  g_assert_null (dfl_model_lookup_thread (model, 3000));
+  g_assert_null (dfl_model_lookup_task (model, 666));
+
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/model/analyse/parallel", test_model_analyse_parallel);
+  g_test_add_func ("/model/lookup", test_model_lookup);
+  g_test_add_func ("/model/profile/nested", test_model_profile_nested);
+
+  return g_test_run ();
+}
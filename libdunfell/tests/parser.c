@@ -16,11 +16,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "config.h"
+
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
 #include <locale.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "parser.h"
+#include "parser-private.h"
 
 
 typedef struct
@@ -40,13 +46,25 @@ test_parser_construction (void)
   g_object_unref (parser);
 }
 
+static void
+assert_n_events (DflParser *parser,
+                 guint      n_events_expected)
+{
+  DflEventSequence *sequence;
+
+  sequence = dfl_parser_get_event_sequence (parser);
+  g_assert_nonnull (sequence);
+  g_assert (DFL_IS_EVENT_SEQUENCE (sequence));
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sequence)), ==,
+                    n_events_expected);
+}
+
 /* Test that the parser correctly loads and parses various test log files. */
 static void
 test_parser_log (gconstpointer data)
 {
   const LogTestVector *vector = data;
   DflParser *parser = NULL;
-  DflEventSequence *sequence;
   GError *error = NULL;
 
   parser = dfl_parser_new ();
@@ -55,15 +73,892 @@ test_parser_log (gconstpointer data)
                              strlen (vector->log), &error);
   g_assert_no_error (error);
 
-  sequence = dfl_parser_get_event_sequence (parser);
-  g_assert_nonnull (sequence);
-  g_assert (DFL_IS_EVENT_SEQUENCE (sequence));
-  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sequence)), ==,
-                    vector->n_events_expected);
+  assert_n_events (parser, vector->n_events_expected);
 
   g_object_unref (parser);
 }
 
+/* Test that loading the same logs from a (memory mapped) file gives the same
+ * results. */
+static void
+test_parser_log_file (gconstpointer data)
+{
+  const LogTestVector *vector = data;
+  DflParser *parser = NULL;
+  gchar *filename = NULL;
+  gint fd;
+  GError *error = NULL;
+
+  fd = g_file_open_tmp ("dunfell-parser-XXXXXX.log", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  g_file_set_contents (filename, vector->log, -1, &error);
+  g_assert_no_error (error);
+
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_file (parser, filename, &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, vector->n_events_expected);
+
+  g_object_unref (parser);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+/* Test that loading the same logs from a stream gives the same results. */
+static void
+test_parser_log_stream (gconstpointer data)
+{
+  const LogTestVector *vector = data;
+  DflParser *parser = NULL;
+  GInputStream *stream = NULL;
+  GError *error = NULL;
+
+  stream = g_memory_input_stream_new_from_data (vector->log, -1, NULL);
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_stream (parser, stream, NULL, &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, vector->n_events_expected);
+
+  g_object_unref (parser);
+  g_object_unref (stream);
+}
+
+/* Compress @data with gzip. */
+static GBytes *
+gzip_bytes (GBytes *data)
+{
+  GZlibCompressor *compressor = NULL;
+  GInputStream *stream = NULL, *compressed_stream = NULL;
+  GOutputStream *output_stream = NULL;
+  GBytes *compressed = NULL;
+  GError *error = NULL;
+
+  compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+  stream = g_memory_input_stream_new_from_bytes (data);
+  compressed_stream = g_converter_input_stream_new (stream,
+                                                    G_CONVERTER (compressor));
+  output_stream = g_memory_output_stream_new_resizable ();
+
+  g_output_stream_splice (output_stream, compressed_stream,
+                          G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, NULL, &error);
+  g_assert_no_error (error);
+
+  compressed = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output_stream));
+
+  g_object_unref (output_stream);
+  g_object_unref (compressed_stream);
+  g_object_unref (stream);
+  g_object_unref (compressor);
+
+  return compressed;
+}
+
+/* Test that gzip-compressed logs are decompressed on the fly and give the same
+ * results. */
+static void
+test_parser_log_gzip (gconstpointer data)
+{
+  const LogTestVector *vector = data;
+  DflParser *parser = NULL;
+  GInputStream *stream = NULL;
+  GBytes *log = NULL, *compressed = NULL;
+  GError *error = NULL;
+
+  /* Compress the log. */
+  log = g_bytes_new_static (vector->log, strlen (vector->log));
+  compressed = gzip_bytes (log);
+
+  /* Parse it. */
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, g_bytes_get_data (compressed, NULL),
+                             g_bytes_get_size (compressed), &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, vector->n_events_expected);
+  g_object_unref (parser);
+
+  /* And again as a stream, decompressed and parsed in small chunks. */
+  parser = dfl_parser_new ();
+  stream = g_memory_input_stream_new_from_bytes (compressed);
+
+  dfl_parser_load_from_stream_in_chunks (parser, stream, 16, &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, vector->n_events_expected);
+
+  g_object_unref (parser);
+  g_object_unref (stream);
+  g_bytes_unref (compressed);
+  g_bytes_unref (log);
+}
+
+/* Test that logs compressed more than once are rejected, rather than being
+ * decompressed repeatedly. */
+static void
+test_parser_gzip_nested (void)
+{
+  const gchar *log =
+    "Dunfell log,1.0,123\n"
+    "g_main_context_acquire,124,1,0,0\n";
+  DflParser *parser = NULL;
+  GBytes *data = NULL, *compressed = NULL, *compressed_twice = NULL;
+  GError *error = NULL;
+
+  data = g_bytes_new_static (log, strlen (log));
+  compressed = gzip_bytes (data);
+  compressed_twice = gzip_bytes (compressed);
+
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, g_bytes_get_data (compressed, NULL),
+                             g_bytes_get_size (compressed), &error);
+  g_assert_no_error (error);
+  assert_n_events (parser, 1);
+
+  dfl_parser_load_from_data (parser, g_bytes_get_data (compressed_twice, NULL),
+                             g_bytes_get_size (compressed_twice), &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+  g_clear_error (&error);
+
+  g_object_unref (parser);
+  g_bytes_unref (compressed_twice);
+  g_bytes_unref (compressed);
+  g_bytes_unref (data);
+}
+
+/* Test that zstd-compressed logs made of several frames are decompressed
+ * correctly, if zstd support is enabled; or are rejected if not. */
+static void
+test_parser_zstd (void)
+{
+  /* Generated using:
+   *    printf 'Dunfell log,1.0,123\ng_main_context_acquire,124,1,0,0\n' | \
+   *       zstd > a.zst
+   *    printf 'g_main_context_acquire,125,1,0,0\n'\
+   *       'g_main_context_release,126,1,0\n' | zstd > b.zst
+   *    cat a.zst b.zst
+   * with the sizes stored in the frame headers, which must not be trusted. */
+  const gchar log[] =
+  "\x28\xb5\x2f\xfd\x24\x35\xa9\x01\x00\x44\x75\x6e\x66\x65\x6c\x6c"
+  "\x20\x6c\x6f\x67\x2c\x31\x2e\x30\x2c\x31\x32\x33\x0a\x67\x5f\x6d"
+  "\x61\x69\x6e\x5f\x63\x6f\x6e\x74\x65\x78\x74\x5f\x61\x63\x71\x75"
+  "\x69\x72\x65\x2c\x31\x32\x34\x2c\x31\x2c\x30\x2c\x30\x0a\xb3\x8c"
+  "\x86\x18\x28\xb5\x2f\xfd\x24\x40\xbd\x01\x00\xd4\x02\x67\x5f\x6d"
+  "\x61\x69\x6e\x5f\x63\x6f\x6e\x74\x65\x78\x74\x5f\x61\x63\x71\x75"
+  "\x69\x72\x65\x2c\x31\x32\x35\x2c\x31\x2c\x30\x2c\x30\x0a\x72\x65"
+  "\x6c\x65\x61\x73\x36\x2c\x31\x2c\x30\x0a\x02\x00\x20\x28\x21\x9d"
+  "\x7a\x02\xae\x78\x7d\xea";
+  DflParser *parser = NULL;
+  GError *error = NULL;
+
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log, sizeof (log) - 1,
+                             &error);
+
+#ifdef HAVE_ZSTD
+  g_assert_no_error (error);
+  assert_n_events (parser, 3);
+#else
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+  g_clear_error (&error);
+#endif
+
+  /* Truncated frames must be rejected. */
+  dfl_parser_load_from_data (parser, (const guint8 *) log, sizeof (log) - 10,
+                             &error);
+#ifdef HAVE_ZSTD
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN);
+#else
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+#endif
+  g_clear_error (&error);
+
+  g_object_unref (parser);
+}
+
+/* Test that event parameters are decoded according to their types, and can
+ * still be retrieved in string form. */
+static void
+test_parser_parameters (void)
+{
+  const gchar *log =
+    "Dunfell log,1.0,123\n"
+    "g_source_set_name,124,1,140407983871120,my source\n"
+    "g_source_set_name,125,1,140407983871120,my source\n"
+    "g_main_context_acquire,126,1,18446744073709551615,1\n";
+  DflParser *parser = NULL;
+  GListModel *events;
+  DflEvent *event1, *event2, *event3;
+  gchar **parameters = NULL;
+  GError *error = NULL;
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, (const guint8 *) log, strlen (log),
+                             &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, 3);
+
+  events = G_LIST_MODEL (dfl_parser_get_event_sequence (parser));
+  event1 = g_list_model_get_item (events, 0);
+  event2 = g_list_model_get_item (events, 1);
+  event3 = g_list_model_get_item (events, 2);
+
+  g_assert_cmpuint (dfl_event_get_parameter_id (event1, 0), ==,
+                    G_GUINT64_CONSTANT (140407983871120));
+  g_assert_cmpstr (dfl_event_get_parameter_utf8 (event1, 0), ==,
+                   "140407983871120");
+  g_assert_cmpstr (dfl_event_get_parameter_utf8 (event1, 1), ==, "my source");
+
+  /* String parameters are interned. */
+  g_assert (dfl_event_get_parameter_utf8 (event1, 1) ==
+            dfl_event_get_parameter_utf8 (event2, 1));
+
+  g_assert_cmpuint (dfl_event_get_parameter_id (event3, 0), ==, G_MAXUINT64);
+  g_assert_cmpint (dfl_event_get_parameter_int64 (event3, 1), ==, 1);
+
+  g_object_get (event3, "parameters", &parameters, NULL);
+  g_assert_cmpuint (g_strv_length (parameters), ==, 2);
+  g_assert_cmpstr (parameters[0], ==, "18446744073709551615");
+  g_assert_cmpstr (parameters[1], ==, "1");
+  g_strfreev (parameters);
+
+  g_object_unref (event3);
+  g_object_unref (event2);
+  g_object_unref (event1);
+  g_object_unref (parser);
+}
+
+/* Test that string parameters are interned once per event sequence, even when
+ * the log is parsed in parallel chunks, and that events keep them alive after
+ * the sequence is freed. */
+static void
+test_parser_strings (void)
+{
+  GString *log = NULL;
+  DflParser *parser = NULL;
+  GListModel *events;
+  DflEvent *first_event = NULL;
+  const gchar *first_name = NULL;
+  guint i, n_events;
+  GError *error = NULL;
+
+  log = g_string_new ("Dunfell log,1.0,100\n");
+
+  for (i = 1; i <= 100; i++)
+    g_string_append_printf (log, "g_source_set_name,%u,1,%u,my source\n",
+                            100 + i, i);
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data_in_chunks (parser, (const guint8 *) log->str,
+                                       log->len, 7, &error);
+  g_assert_no_error (error);
+
+  events = G_LIST_MODEL (dfl_parser_get_event_sequence (parser));
+  n_events = g_list_model_get_n_items (events);
+  g_assert_cmpuint (n_events, ==, 100);
+
+  for (i = 0; i < n_events; i++)
+    {
+      DflEvent *event = g_list_model_get_item (events, i);
+      const gchar *name = dfl_event_get_parameter_utf8 (event, 1);
+
+      g_assert_cmpstr (name, ==, "my source");
+
+      if (first_event == NULL)
+        {
+          first_event = g_object_ref (event);
+          first_name = name;
+        }
+      else
+        {
+          g_assert (name == first_name);
+        }
+
+      g_object_unref (event);
+    }
+
+  g_object_unref (parser);
+  g_string_free (log, TRUE);
+
+  g_assert_cmpstr (dfl_event_get_parameter_utf8 (first_event, 1), ==,
+                   "my source");
+  g_object_unref (first_event);
+}
+
+static void
+events_parsed_cb (DflParser *parser,
+                  guint      position,
+                  guint      n_events,
+                  gpointer   user_data)
+{
+  guint *n_events_parsed = user_data;
+
+  /* Events must be announced in order, once each. */
+  g_assert_cmpuint (position, ==, *n_events_parsed);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (dfl_parser_get_event_sequence (parser))), ==,
+                    position + n_events);
+
+  *n_events_parsed += n_events;
+}
+
+/* Test that feeding the same logs into the parser incrementally gives the same
+ * results, however they are split into fragments (including in the middle of
+ * lines). */
+static void
+test_parser_log_feed (gconstpointer data)
+{
+  const LogTestVector *vector = data;
+  DflParser *parser = NULL;
+  gsize fragment_size, i, length;
+  guint n_events_parsed;
+  GError *error = NULL;
+
+  length = strlen (vector->log);
+  parser = dfl_parser_new ();
+  g_signal_connect (parser, "events-parsed", (GCallback) events_parsed_cb,
+                    &n_events_parsed);
+
+  for (fragment_size = 1; fragment_size <= length; fragment_size++)
+    {
+      n_events_parsed = 0;
+
+      for (i = 0; i < length; i += fragment_size)
+        {
+          dfl_parser_feed (parser, (const guint8 *) vector->log + i,
+                           MIN (fragment_size, length - i), &error);
+          g_assert_no_error (error);
+        }
+
+      dfl_parser_feed_end (parser, &error);
+      g_assert_no_error (error);
+
+      assert_n_events (parser, vector->n_events_expected);
+      g_assert_cmpuint (n_events_parsed, ==, vector->n_events_expected);
+    }
+
+  g_object_unref (parser);
+}
+
+/* Test that errors are reported when feeding a log incrementally, and that the
+ * events before the error are kept. */
+static void
+test_parser_feed_error (void)
+{
+  const gchar *log =
+    "Dunfell log,1.0,123\n"
+    "g_main_context_acquire,124,1,0,0\n"
+    "g_main_context_acquire,125,1,0,0\n"
+    "g_main_context_acquire,120,1,0,0\n";
+  DflParser *parser = NULL;
+  GError *error = NULL;
+
+  parser = dfl_parser_new ();
+
+  dfl_parser_feed (parser, (const guint8 *) log, 40, &error);
+  g_assert_no_error (error);
+  assert_n_events (parser, 0);
+
+  dfl_parser_feed (parser, (const guint8 *) log + 40, strlen (log) - 40,
+                   &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN);
+  g_assert_nonnull (strstr (error->message, "monotonically increasing"));
+  g_clear_error (&error);
+
+  assert_n_events (parser, 2);
+
+  g_object_unref (parser);
+}
+
+/* Build a log large enough to be parsed in parallel chunks, with events from
+ * two threads interleaved. If @non_monotonic is %TRUE, a third thread emits
+ * one event at the start of the log and another with a lower timestamp at the
+ * end, so the non-monotonicity spans chunk boundaries. */
+static GString *
+build_large_log (guint    n_events,
+                 gboolean non_monotonic)
+{
+  GString *log = NULL;
+  guint i;
+
+  log = g_string_new ("Dunfell log,1.0,100\n");
+
+  for (i = 1; i <= n_events; i++)
+    {
+      guint64 timestamp = 100 + i;
+      guint tid = 1 + (i % 2);
+
+      if (non_monotonic && i == 1)
+        {
+          timestamp = G_MAXUINT32;
+          tid = 3;
+        }
+      else if (non_monotonic && i == n_events)
+        {
+          tid = 3;
+        }
+
+      g_string_append_printf (log,
+                              "g_main_context_acquire,%" G_GUINT64_FORMAT
+                              ",%u,140407983871120,1\n",
+                              timestamp, tid);
+    }
+
+  return log;
+}
+
+/* Test that large logs, which are split into chunks and parsed in parallel,
+ * give the same results as parsing them sequentially, including detecting
+ * non-monotonic timestamps across chunk boundaries. */
+static void
+test_parser_parallel (void)
+{
+  const guint n_events = 200000;
+  GString *log = NULL;
+  DflParser *parser = NULL;
+  GError *error = NULL;
+
+  /* Valid log. */
+  log = build_large_log (n_events, FALSE);
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_no_error (error);
+
+  assert_n_events (parser, n_events);
+
+  g_object_unref (parser);
+  g_string_free (log, TRUE);
+
+  /* Invalid log, with timestamps in one thread going backwards between the
+   * first and last chunks. */
+  log = build_large_log (n_events, TRUE);
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN);
+  g_assert_nonnull (strstr (error->message, "monotonically increasing"));
+  g_clear_error (&error);
+
+  g_assert_null (dfl_parser_get_event_sequence (parser));
+
+  g_object_unref (parser);
+  g_string_free (log, TRUE);
+}
+
+/* Assert that two event sequences contain the same events, with the same
+ * parameters, in the same order. */
+static void
+assert_event_sequences_equal (DflEventSequence *sequence1,
+                              DflEventSequence *sequence2)
+{
+  GListModel *events1 = G_LIST_MODEL (sequence1);
+  GListModel *events2 = G_LIST_MODEL (sequence2);
+  guint i;
+
+  g_assert_cmpuint (g_list_model_get_n_items (events1), ==,
+                    g_list_model_get_n_items (events2));
+
+  for (i = 0; i < g_list_model_get_n_items (events1); i++)
+    {
+      DflEvent *event1 = NULL, *event2 = NULL;
+      gchar **parameters1 = NULL, **parameters2 = NULL;
+      guint j;
+
+      event1 = g_list_model_get_item (events1, i);
+      event2 = g_list_model_get_item (events2, i);
+
+      g_assert_cmpstr (dfl_event_get_event_type (event1), ==,
+                       dfl_event_get_event_type (event2));
+      g_assert_cmpuint (dfl_event_get_timestamp (event1), ==,
+                        dfl_event_get_timestamp (event2));
+      g_assert_cmpuint (dfl_event_get_thread_id (event1), ==,
+                        dfl_event_get_thread_id (event2));
+
+      g_object_get (event1, "parameters", &parameters1, NULL);
+      g_object_get (event2, "parameters", &parameters2, NULL);
+
+      g_assert_cmpuint (g_strv_length (parameters1), ==,
+                        g_strv_length (parameters2));
+
+      for (j = 0; parameters1[j] != NULL; j++)
+        g_assert_cmpstr (parameters1[j], ==, parameters2[j]);
+
+      g_strfreev (parameters2);
+      g_strfreev (parameters1);
+      g_object_unref (event2);
+      g_object_unref (event1);
+    }
+}
+
+/* Build a log with lines of varying lengths, including comments, for the
+ * chunked parsing tests. */
+static GString *
+chunks_log_new (void)
+{
+  GString *log = NULL;
+  guint i;
+
+  log = g_string_new ("Dunfell log,1.0,100\n");
+
+  for (i = 1; i <= 200; i++)
+    {
+      switch (i % 4)
+        {
+        case 0:
+          g_string_append_printf (log, "g_main_context_acquire,%u,%u,%u,1\n",
+                                  100 + i, 1 + (i % 3), i);
+          break;
+        case 1:
+          g_string_append_printf (log, "g_source_set_name,%u,%u,%u,source %u\n",
+                                  100 + i, 1 + (i % 3), i * 1000, i);
+          break;
+        case 2:
+          g_string_append_printf (log, "# Comment %u\n", i);
+          break;
+        case 3:
+          g_string_append_printf (log,
+                                  "g_source_attach,%u,%u,%u,%u,%u\n",
+                                  100 + i, 1 + (i % 3), i, i * 7, i * 13);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  return log;
+}
+
+/* Test that splitting a log into chunks, parsed in parallel, gives the same
+ * event sequence as parsing it sequentially, for many different numbers of
+ * chunks so that the nominal chunk boundaries fall in the middle of lines of
+ * different lengths. Invalid logs must fail in the same way. */
+static void
+test_parser_chunks (void)
+{
+  GString *log = NULL;
+  DflParser *parser = NULL, *chunked_parser = NULL;
+  GError *error = NULL, *chunked_error = NULL;
+  guint n_chunks;
+
+  log = chunks_log_new ();
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_no_error (error);
+
+  for (n_chunks = 1; n_chunks <= 17; n_chunks++)
+    {
+      g_test_message ("%u chunks", n_chunks);
+
+      chunked_parser = dfl_parser_new ();
+      dfl_parser_load_from_data_in_chunks (chunked_parser,
+                                           (const guint8 *) log->str, log->len,
+                                           n_chunks, &chunked_error);
+      g_assert_no_error (chunked_error);
+
+      assert_event_sequences_equal (dfl_parser_get_event_sequence (parser),
+                                    dfl_parser_get_event_sequence (chunked_parser));
+
+      g_object_unref (chunked_parser);
+    }
+
+  g_object_unref (parser);
+
+  /* Make thread 1 go backwards in time at the end of the log, which is in a
+   * different chunk from its earlier events. */
+  g_string_append (log, "g_main_context_acquire,101,1,1,1\n");
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_nonnull (error);
+
+  for (n_chunks = 2; n_chunks <= 17; n_chunks++)
+    {
+      chunked_parser = dfl_parser_new ();
+      dfl_parser_load_from_data_in_chunks (chunked_parser,
+                                           (const guint8 *) log->str, log->len,
+                                           n_chunks, &chunked_error);
+      g_assert_error (chunked_error, error->domain, error->code);
+      g_assert_cmpstr (chunked_error->message, ==, error->message);
+      g_assert_null (dfl_parser_get_event_sequence (chunked_parser));
+      g_clear_error (&chunked_error);
+
+      g_object_unref (chunked_parser);
+    }
+
+  g_clear_error (&error);
+  g_object_unref (parser);
+  g_string_free (log, TRUE);
+}
+
+/* Test that reading a log from a stream in chunks, which are parsed in
+ * parallel, gives the same event sequence as parsing it all at once, for many
+ * different chunk sizes so that chunk boundaries fall in the middle of lines,
+ * and with lines longer than a chunk. Invalid logs must fail in the same
+ * way. */
+static void
+test_parser_stream_chunks (void)
+{
+  GString *log = NULL;
+  DflParser *parser = NULL, *chunked_parser = NULL;
+  GInputStream *stream = NULL;
+  GError *error = NULL, *chunked_error = NULL;
+  gsize chunk_size;
+
+  log = chunks_log_new ();
+
+  /* End with an unterminated line. */
+  g_string_append (log, "g_main_context_acquire,400,1,1,1");
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_no_error (error);
+
+  for (chunk_size = 1; chunk_size <= log->len;
+       chunk_size = chunk_size * 3 / 2 + 1)
+    {
+      g_test_message ("Chunk size %" G_GSIZE_FORMAT, chunk_size);
+
+      stream = g_memory_input_stream_new_from_data (log->str, log->len, NULL);
+      chunked_parser = dfl_parser_new ();
+      dfl_parser_load_from_stream_in_chunks (chunked_parser, stream,
+                                             chunk_size, &chunked_error);
+      g_assert_no_error (chunked_error);
+
+      assert_event_sequences_equal (dfl_parser_get_event_sequence (parser),
+                                    dfl_parser_get_event_sequence (chunked_parser));
+
+      g_object_unref (chunked_parser);
+      g_object_unref (stream);
+    }
+
+  g_object_unref (parser);
+
+  /* Make thread 1 go backwards in time at the end of the log, which is in a
+   * different chunk from its earlier events. */
+  g_string_append (log, "\ng_main_context_acquire,101,1,1,1\n");
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, (const guint8 *) log->str, log->len,
+                             &error);
+  g_assert_nonnull (error);
+
+  for (chunk_size = 1; chunk_size <= log->len;
+       chunk_size = chunk_size * 3 / 2 + 1)
+    {
+      stream = g_memory_input_stream_new_from_data (log->str, log->len, NULL);
+      chunked_parser = dfl_parser_new ();
+      dfl_parser_load_from_stream_in_chunks (chunked_parser, stream,
+                                             chunk_size, &chunked_error);
+      g_assert_error (chunked_error, error->domain, error->code);
+      g_assert_cmpstr (chunked_error->message, ==, error->message);
+      g_assert_null (dfl_parser_get_event_sequence (chunked_parser));
+      g_clear_error (&chunked_error);
+
+      g_object_unref (chunked_parser);
+      g_object_unref (stream);
+    }
+
+  g_clear_error (&error);
+  g_object_unref (parser);
+  g_string_free (log, TRUE);
+}
+
+/* Test that unsigned integers are parsed correctly by both the SWAR and scalar
+ * code paths, including around the lengths where the SWAR code changes
+ * strategy and where values overflow. */
+static void
+test_parser_parse_uint64 (void)
+{
+  const struct
+    {
+      const gchar *str;
+      gboolean valid;
+      guint64 value;
+    }
+  vectors[] = {
+    { "", FALSE, 0 },
+    { "0", TRUE, 0 },
+    { "7", TRUE, 7 },
+    { "1234567", TRUE, 1234567 },
+    { "12345678", TRUE, 12345678 },
+    { "123456789", TRUE, 123456789 },
+    { "1234567890123456", TRUE, G_GUINT64_CONSTANT (1234567890123456) },
+    { "1234567890123456789", TRUE, G_GUINT64_CONSTANT (1234567890123456789) },
+    { "9999999999999999999", TRUE, G_GUINT64_CONSTANT (9999999999999999999) },
+    { "10000000000000000000", TRUE, G_GUINT64_CONSTANT (10000000000000000000) },
+    { "18446744073709551615", TRUE, G_MAXUINT64 },
+    { "18446744073709551616", FALSE, 0 },
+    { "99999999999999999999", FALSE, 0 },
+    { "123456789012345678901", FALSE, 0 },
+    { "00000000000000000001", TRUE, 1 },
+    { "1234a678", FALSE, 0 },
+    { "1234567/", FALSE, 0 },
+    { "123456:8", FALSE, 0 },
+    { "12345678901234567x9", FALSE, 0 },
+    { "1234567890123456789x", FALSE, 0 },
+    { "-1", FALSE, 0 },
+    { " 1", FALSE, 0 },
+    { "1 ", FALSE, 0 },
+  };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (vectors); i++)
+    {
+      guint64 value, scalar_value;
+      gboolean valid, scalar_valid;
+
+      g_test_message ("Vector %" G_GSIZE_FORMAT ": ‘%s’", i, vectors[i].str);
+
+      value = scalar_value = 0;
+      valid = dfl_parser_parse_uint64 (vectors[i].str, strlen (vectors[i].str),
+                                       FALSE, &value);
+      scalar_valid = dfl_parser_parse_uint64 (vectors[i].str,
+                                              strlen (vectors[i].str), TRUE,
+                                              &scalar_value);
+
+      g_assert_cmpint (valid, ==, vectors[i].valid);
+      g_assert_cmpint (scalar_valid, ==, vectors[i].valid);
+
+      if (vectors[i].valid)
+        {
+          g_assert_cmpuint (value, ==, vectors[i].value);
+          g_assert_cmpuint (scalar_value, ==, vectors[i].value);
+        }
+    }
+}
+
+/* Check that the vectorised and scalar tokenisers agree on the line at the
+ * start of @data, and return its length. */
+static gsize
+assert_tokenize_line_paths_equal (const gchar *data,
+                                  gsize        length)
+{
+  GArray/*<gsize>*/ *offsets = NULL, *scalar_offsets = NULL;
+  gsize line_length, scalar_line_length;
+  guint n_commas, scalar_n_commas;
+  gboolean needs_validation, scalar_needs_validation;
+
+  offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+  scalar_offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+
+  line_length = dfl_parser_tokenize_line (data, length, FALSE, offsets,
+                                          &n_commas, &needs_validation);
+  scalar_line_length = dfl_parser_tokenize_line (data, length, TRUE,
+                                                 scalar_offsets,
+                                                 &scalar_n_commas,
+                                                 &scalar_needs_validation);
+
+  g_assert_cmpuint (line_length, ==, scalar_line_length);
+  g_assert_cmpuint (n_commas, ==, scalar_n_commas);
+  g_assert_cmpint (needs_validation, ==, scalar_needs_validation);
+  g_assert_cmpuint (offsets->len, ==, scalar_offsets->len);
+  g_assert_cmpint (memcmp (offsets->data, scalar_offsets->data,
+                           offsets->len * sizeof (gsize)), ==, 0);
+
+  g_array_unref (scalar_offsets);
+  g_array_unref (offsets);
+
+  return line_length;
+}
+
+/* Test that the vectorised tokeniser finds the same line ends, commas and
+ * non-ASCII bytes as the scalar one, especially where they fall at or either
+ * side of the 16- and 32-byte block boundaries, and with empty fields. */
+static void
+test_parser_tokenize_line (void)
+{
+  /* Text after the first newline, which must not affect the first line. */
+  const gchar trailer[] = "\n,,\xc3\xa9,x,\n,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,";
+  GArray/*<gsize>*/ *offsets = NULL;
+  guint n_commas;
+  gboolean needs_validation;
+  gsize line_length, position;
+
+  for (line_length = 0; line_length <= 70; line_length++)
+    {
+      for (position = 0; position <= line_length; position++)
+        {
+          GString *line = NULL;
+
+          g_test_message ("Line length %" G_GSIZE_FORMAT ", position %"
+                          G_GSIZE_FORMAT, line_length, position);
+
+          /* A comma, followed by an empty field if there is room. */
+          line = g_string_new (NULL);
+          g_string_append_len (line, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+                                     "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+                               line_length);
+
+          if (position < line_length)
+            line->str[position] = ',';
+          if (position + 1 < line_length)
+            line->str[position + 1] = ',';
+
+          /* Ending at the end of the data, and at a newline. */
+          g_assert_cmpuint (assert_tokenize_line_paths_equal (line->str,
+                                                              line->len),
+                            ==, line_length);
+          g_string_append_len (line, trailer, sizeof (trailer) - 1);
+          g_assert_cmpuint (assert_tokenize_line_paths_equal (line->str,
+                                                              line->len),
+                            ==, line_length);
+
+          /* A non-ASCII byte instead of the commas. */
+          if (position < line_length)
+            {
+              line->str[position] = '\xc3';
+              assert_tokenize_line_paths_equal (line->str, line->len);
+              assert_tokenize_line_paths_equal (line->str, line_length);
+            }
+
+          g_string_free (line, TRUE);
+        }
+    }
+
+  /* A few lines checked against known answers, with a comma just before the
+   * newline at the end of the first 16-byte block, and commas either side of
+   * the 32-byte boundary. */
+  offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+
+  g_assert_cmpuint (dfl_parser_tokenize_line ("aaaaaaaaaaaaaaa,\nbbbb,", 22,
+                                              FALSE, offsets, &n_commas,
+                                              &needs_validation), ==, 16);
+  g_assert_cmpuint (n_commas, ==, 1);
+  g_assert_cmpuint (g_array_index (offsets, gsize, 0), ==, 15);
+  g_assert_false (needs_validation);
+
+  g_assert_cmpuint (dfl_parser_tokenize_line ("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa,"
+                                              ",aaaaaaaaaaaaaaa\n", 49,
+                                              FALSE, offsets, &n_commas,
+                                              &needs_validation), ==, 48);
+  g_assert_cmpuint (n_commas, ==, 2);
+  g_assert_cmpuint (g_array_index (offsets, gsize, 0), ==, 31);
+  g_assert_cmpuint (g_array_index (offsets, gsize, 1), ==, 32);
+  g_assert_false (needs_validation);
+
+  g_assert_cmpuint (dfl_parser_tokenize_line (",,,,,,,,,,,,,,,,", 16,
+                                              FALSE, offsets, &n_commas,
+                                              &needs_validation), ==, 16);
+  g_assert_cmpuint (n_commas, ==, 16);
+
+  g_array_unref (offsets);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -100,6 +995,13 @@ main (int argc, char *argv[])
       "Dunfell log,1.0,123\n"
       "g_main_context_acquire,124,1,0,0\n"
       "nonexistent_event,125\n" },
+    { 3,
+      "Dunfell log,1.0,123\n"
+      "g_source_attach,124,1,10,20,30\n"
+      "g_main_context_acquirx,125,1,0,0\n"
+      "g_task_new,126,1,1,2,3,4,5\n"
+      "g_task_ne,127,1\n"
+      "g_thread_spawned,128,1,1,2,thread-name\n" },
   };
 
   setlocale (LC_ALL, "");
@@ -107,6 +1009,16 @@ main (int argc, char *argv[])
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/parser/construction", test_parser_construction);
+  g_test_add_func ("/parser/parallel", test_parser_parallel);
+  g_test_add_func ("/parser/chunks", test_parser_chunks);
+  g_test_add_func ("/parser/stream-chunks", test_parser_stream_chunks);
+  g_test_add_func ("/parser/feed-error", test_parser_feed_error);
+  g_test_add_func ("/parser/parameters", test_parser_parameters);
+  g_test_add_func ("/parser/strings", test_parser_strings);
+  g_test_add_func ("/parser/zstd", test_parser_zstd);
+  g_test_add_func ("/parser/gzip-nested", test_parser_gzip_nested);
+  g_test_add_func ("/parser/parse-uint64", test_parser_parse_uint64);
+  g_test_add_func ("/parser/tokenize-line", test_parser_tokenize_line);
 
   for (i = 0; i < G_N_ELEMENTS (test_vectors); i++)
     {
@@ -115,6 +1027,23 @@ main (int argc, char *argv[])
       test_name = g_strdup_printf ("/parser/log/%u", i);
       g_test_add_data_func (test_name, &test_vectors[i], test_parser_log);
       g_free (test_name);
+
+      test_name = g_strdup_printf ("/parser/log-file/%u", i);
+      g_test_add_data_func (test_name, &test_vectors[i], test_parser_log_file);
+      g_free (test_name);
+
+      test_name = g_strdup_printf ("/parser/log-stream/%u", i);
+      g_test_add_data_func (test_name, &test_vectors[i],
+                            test_parser_log_stream);
+      g_free (test_name);
+
+      test_name = g_strdup_printf ("/parser/log-gzip/%u", i);
+      g_test_add_data_func (test_name, &test_vectors[i], test_parser_log_gzip);
+      g_free (test_name);
+
+      test_name = g_strdup_printf ("/parser/log-feed/%u", i);
+      g_test_add_data_func (test_name, &test_vectors[i], test_parser_log_feed);
+      g_free (test_name);
     }
 
   return g_test_run ();
@@ -0,0 +1,262 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "parser.h"
+#include "source.h"
+
+
+/* Test the properties of newly constructed #DflSource. */
+static void
+test_source_construction (void)
+{
+  DflSource *source = NULL;
+
+  source = dfl_source_new (1, 123, 1000);
+  g_assert_cmpuint (dfl_source_get_id (source), ==, 1);
+  g_assert_cmpuint (dfl_source_get_new_timestamp (source), ==, 123);
+  g_assert_cmpuint (dfl_source_get_new_thread_id (source), ==, 1000);
+  g_assert_cmpuint (dfl_histogram_get_n_values (dfl_source_get_lateness_histogram (source)),
+                    ==, 0);
+  g_object_unref (source);
+}
+
+static GPtrArray/*<owned DflSource>*/ *
+parser_helper (const gchar *log)
+{
+  DflParser *parser = NULL;
+  DflEventSequence *sequence;
+  GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  GError *error = NULL;
+
+  /* Parse the log into an event sequence. */
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log, strlen (log),
+                             &error);
+  g_assert_no_error (error);
+
+  sequence = dfl_parser_get_event_sequence (parser);
+  g_assert_nonnull (sequence);
+  g_assert (DFL_IS_EVENT_SEQUENCE (sequence));
+
+  /* Analyse the event sequence. */
+  sources = dfl_source_factory_from_event_sequence (sequence);
+  dfl_event_sequence_walk (sequence);
+
+  g_object_unref (parser);
+
+  return sources;  /* transfer */
+}
+
+/* Test that dispatches are paired with the ready times set before them, and
+ * that lateness is measured relative to the least late dispatch of any
+ * source, since ready times and timestamps use different clocks. */
+static void
+test_source_parse_log_lateness (void)
+{
+  GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  const DflHistogram *histogram;
+
+  /* Timestamps: 1+; thread ID: 1000; source IDs: 100, 200; context ID: 666;
+   * ready times are offset by 1002 from timestamps */
+  sources = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_source_new,1,1000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_new,2,1000,200,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,3,1000,100,666,1\n"
+    "g_source_attach,4,1000,200,666,2\n"
+    "g_source_set_ready_time,1000,1000,100,50\n"
+    "g_source_set_ready_time,1001,1000,200,300\n"
+    "g_source_before_dispatch,1055,1000,100,dispatch,callback,0\n"
+    "g_source_set_ready_time,1056,1000,100,150\n"
+    "g_source_after_dispatch,1057,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,1170,1000,100,dispatch,callback,0\n"
+    "g_source_set_ready_time,1171,1000,100,-1\n"
+    "g_source_after_dispatch,1172,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,1302,1000,200,dispatch,callback,0\n"
+    "g_source_after_dispatch,1303,1000,200,dispatch,0\n"
+    "g_source_before_dispatch,1400,1000,200,dispatch,callback,0\n"
+    "g_source_after_dispatch,1401,1000,200,dispatch,0\n");
+
+  g_assert_cmpuint (sources->len, ==, 2);
+
+  histogram = dfl_source_get_lateness_histogram (sources->pdata[0]);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 2);
+  g_assert_cmpint (dfl_histogram_get_min (histogram), ==, 3);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 18);
+
+  histogram = dfl_source_get_lateness_histogram (sources->pdata[1]);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 1);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 0);
+
+  g_ptr_array_unref (sources);
+}
+
+/* Test that a dispatch which happened before its ready time, because the
+ * source’s check function found it ready, does not skew the clock offset and
+ * hence the lateness of other sources. */
+static void
+test_source_parse_log_lateness_early (void)
+{
+  GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  const DflHistogram *histogram;
+
+  /* Timestamps: 1+; thread ID: 1000; source IDs: 100, 200, 300; context ID:
+   * 666; ready times are offset by 1002 from timestamps. Source 300 is
+   * dispatched early at 1450, due to its check function, and then when its
+   * ready time is reached. */
+  sources = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_source_new,1,1000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_new,2,1000,200,prepare,check,dispatch,finalize,96\n"
+    "g_source_new,3,1000,300,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,4,1000,100,666,1\n"
+    "g_source_attach,5,1000,200,666,2\n"
+    "g_source_attach,6,1000,300,666,3\n"
+    "g_source_set_ready_time,1000,1000,100,50\n"
+    "g_source_set_ready_time,1001,1000,200,300\n"
+    "g_source_set_ready_time,1002,1000,300,500\n"
+    "g_source_after_check,1054,1000,100,check,0\n"
+    "g_source_before_dispatch,1055,1000,100,dispatch,callback,0\n"
+    "g_source_set_ready_time,1056,1000,100,150\n"
+    "g_source_after_dispatch,1057,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,1170,1000,100,dispatch,callback,0\n"
+    "g_source_set_ready_time,1171,1000,100,-1\n"
+    "g_source_after_dispatch,1172,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,1302,1000,200,dispatch,callback,0\n"
+    "g_source_after_dispatch,1303,1000,200,dispatch,0\n"
+    "g_source_after_check,1449,1000,300,check,1\n"
+    "g_source_before_dispatch,1450,1000,300,dispatch,callback,0\n"
+    "g_source_after_dispatch,1451,1000,300,dispatch,0\n"
+    "g_source_after_check,1509,1000,300,check,0\n"
+    "g_source_before_dispatch,1510,1000,300,dispatch,callback,0\n"
+    "g_source_after_dispatch,1511,1000,300,dispatch,0\n");
+
+  g_assert_cmpuint (sources->len, ==, 3);
+
+  /* The same as in test_source_parse_log_lateness(). */
+  histogram = dfl_source_get_lateness_histogram (sources->pdata[0]);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 2);
+  g_assert_cmpint (dfl_histogram_get_min (histogram), ==, 3);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 18);
+
+  histogram = dfl_source_get_lateness_histogram (sources->pdata[1]);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 1);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 0);
+
+  /* Only the dispatch caused by the ready time is counted. */
+  histogram = dfl_source_get_lateness_histogram (sources->pdata[2]);
+  g_assert_cmpuint (dfl_histogram_get_n_values (histogram), ==, 1);
+  g_assert_cmpint (dfl_histogram_get_max (histogram), ==, 8);
+
+  g_ptr_array_unref (sources);
+}
+
+/* Test that the handoff latency is only measured for sources attached from a
+ * different thread to the one which dispatches them. */
+static void
+test_source_parse_log_handoff (void)
+{
+  GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  const gchar *callback_name;
+
+  /* Timestamps: 1+; thread IDs: 1000 (owner), 2000 (worker); source IDs:
+   * 100, 200; context ID: 666 */
+  sources = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_source_new,1,2000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,10,2000,100,666,1\n"
+    "g_source_new,11,1000,200,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,12,1000,200,666,2\n"
+    "g_source_before_dispatch,25,1000,100,dispatch,worker_done_cb,0\n"
+    "g_source_after_dispatch,26,1000,100,dispatch,1\n"
+    "g_source_before_dispatch,30,1000,200,dispatch,idle_cb,0\n"
+    "g_source_after_dispatch,31,1000,200,dispatch,1\n");
+
+  g_assert_cmpuint (sources->len, ==, 2);
+
+  g_assert_cmpint (dfl_source_get_handoff_latency (sources->pdata[0],
+                                                   &callback_name), ==, 15);
+  g_assert_cmpstr (callback_name, ==, "worker_done_cb");
+
+  g_assert_cmpint (dfl_source_get_handoff_latency (sources->pdata[1],
+                                                   &callback_name), ==, -1);
+  g_assert_null (callback_name);
+
+  g_ptr_array_unref (sources);
+}
+
+/* Test that the dispatch statistics are all calculated from the dispatches
+ * which finished, but count those which did not. */
+static void
+test_source_parse_log_dispatch_statistics (void)
+{
+  GPtrArray/*<owned DflSource>*/ *sources = NULL;
+  gsize n_dispatches;
+  DflDuration min_duration, median_duration, max_duration;
+
+  /* Timestamps: 1+; thread ID: 1000; source ID: 100; context ID: 666. The
+   * last dispatch never finishes. */
+  sources = parser_helper (
+    "Dunfell log,1.0,1\n"
+    "g_source_new,1,1000,100,prepare,check,dispatch,finalize,96\n"
+    "g_source_attach,2,1000,100,666,1\n"
+    "g_source_before_dispatch,10,1000,100,dispatch,callback,0\n"
+    "g_source_after_dispatch,19,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,20,1000,100,dispatch,callback,0\n"
+    "g_source_after_dispatch,22,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,30,1000,100,dispatch,callback,0\n"
+    "g_source_after_dispatch,35,1000,100,dispatch,0\n"
+    "g_source_before_dispatch,40,1000,100,dispatch,callback,0\n");
+
+  g_assert_cmpuint (sources->len, ==, 1);
+
+  dfl_source_get_dispatch_statistics (sources->pdata[0], &n_dispatches,
+                                      &min_duration, &median_duration,
+                                      &max_duration);
+  g_assert_cmpuint (n_dispatches, ==, 4);
+  g_assert_cmpint (min_duration, ==, 2);
+  g_assert_cmpint (median_duration, ==, 5);
+  g_assert_cmpint (max_duration, ==, 9);
+
+  g_ptr_array_unref (sources);
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/source/construction", test_source_construction);
+  g_test_add_func ("/source/parse-log/lateness",
+                   test_source_parse_log_lateness);
+  g_test_add_func ("/source/parse-log/lateness-early",
+                   test_source_parse_log_lateness_early);
+  g_test_add_func ("/source/parse-log/handoff",
+                   test_source_parse_log_handoff);
+  g_test_add_func ("/source/parse-log/dispatch-statistics",
+                   test_source_parse_log_dispatch_statistics);
+
+  return g_test_run ();
+}
@@ -0,0 +1,174 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <locale.h>
+#include <string.h>
+
+#include "model.h"
+#include "parser.h"
+#include "profile.h"
+#include "task.h"
+
+
+/* Tasks: 10 is run in a thread; 20 and 30 share a callback and are not run in
+ * a thread, and 30 never returns. */
+static const gchar *tasks_log =
+  "Dunfell log,1.0,1\n"
+  "g_task_new,100,1000,10,0,0,callback_a,0\n"
+  "g_task_set_source_tag,101,1000,10,tag_a\n"
+  "g_task_before_run_in_thread,110,2000,10,worker\n"
+  "g_task_after_run_in_thread,150,2000,10,0\n"
+  "g_task_before_return,155,2000,10,0,callback_a,0\n"
+  "g_task_propagate,170,1000,10,0\n"
+  "g_task_new,200,1000,20,0,0,callback_b,0\n"
+  "g_task_before_return,210,1000,20,0,callback_b,0\n"
+  "g_task_propagate,212,1000,20,0\n"
+  "g_task_new,300,1000,30,0,0,callback_b,0\n";
+
+static DflModel *
+model_helper (const gchar *log)
+{
+  DflParser *parser = NULL;
+  DflEventSequence *sequence;
+  DflModel *model = NULL;
+  GError *error = NULL;
+
+  /* Parse the log into an event sequence. */
+  parser = dfl_parser_new ();
+
+  dfl_parser_load_from_data (parser, (const guint8 *) log, strlen (log),
+                             &error);
+  g_assert_no_error (error);
+
+  sequence = dfl_parser_get_event_sequence (parser);
+  g_assert_nonnull (sequence);
+
+  /* Analyse the event sequence. */
+  model = dfl_model_new (sequence);
+
+  g_object_unref (parser);
+
+  return model;  /* transfer */
+}
+
+static void
+assert_task_phases (DflTask     *task,
+                    DflDuration  queue_wait,
+                    DflDuration  worker_run,
+                    DflDuration  return_handoff,
+                    DflDuration  callback_delivery)
+{
+  gint64 queue_wait_property, return_handoff_property;
+  gint64 callback_delivery_property;
+
+  g_assert_cmpint (dfl_task_get_phase_duration (task,
+                                                DFL_TASK_PHASE_QUEUE_WAIT),
+                   ==, queue_wait);
+  g_assert_cmpint (dfl_task_get_phase_duration (task,
+                                                DFL_TASK_PHASE_WORKER_RUN),
+                   ==, worker_run);
+  g_assert_cmpint (dfl_task_get_phase_duration (task,
+                                                DFL_TASK_PHASE_RETURN_HANDOFF),
+                   ==, return_handoff);
+  g_assert_cmpint (dfl_task_get_phase_duration (task,
+                                                DFL_TASK_PHASE_CALLBACK_DELIVERY),
+                   ==, callback_delivery);
+
+  /* The properties shown as columns in the viewer. */
+  g_object_get (task,
+                "queue-wait-duration", &queue_wait_property,
+                "return-handoff-duration", &return_handoff_property,
+                "callback-delivery-duration", &callback_delivery_property,
+                NULL);
+
+  g_assert_cmpint (queue_wait_property, ==, queue_wait);
+  g_assert_cmpint (return_handoff_property, ==, return_handoff);
+  g_assert_cmpint (callback_delivery_property, ==, callback_delivery);
+}
+
+/* Test the durations of each phase of a task’s lifecycle, including phases
+ * which did not happen. */
+static void
+test_task_phase_durations (void)
+{
+  DflModel *model = NULL;
+
+  model = model_helper (tasks_log);
+
+  assert_task_phases (dfl_model_lookup_task (model, 10), 10, 40, 5, 15);
+  assert_task_phases (dfl_model_lookup_task (model, 20), -1, -1, -1, 2);
+  assert_task_phases (dfl_model_lookup_task (model, 30), -1, -1, -1, -1);
+
+  g_object_unref (model);
+}
+
+/* Test that the task profile groups tasks by source tag and callback, only
+ * counts the phases which happened, and is limited to the top entries. */
+static void
+test_task_profile (void)
+{
+  DflModel *model = NULL;
+  GPtrArray/*<unowned DflTaskProfileEntry>*/ *profile = NULL;
+  const DflTaskProfileEntry *entry;
+
+  model = model_helper (tasks_log);
+
+  profile = dfl_model_dup_task_profile (model, 0);
+  g_assert_cmpuint (profile->len, ==, 2);
+
+  /* Sorted by decreasing number of tasks. */
+  entry = profile->pdata[0];
+  g_assert_null (entry->source_tag_name);
+  g_assert_cmpstr (entry->callback_name, ==, "callback_b");
+  g_assert_cmpuint (entry->n_tasks, ==, 2);
+  g_assert_cmpuint (dfl_histogram_get_n_values (entry->phase_histograms[DFL_TASK_PHASE_QUEUE_WAIT]),
+                    ==, 0);
+  g_assert_cmpuint (dfl_histogram_get_n_values (entry->phase_histograms[DFL_TASK_PHASE_CALLBACK_DELIVERY]),
+                    ==, 1);
+
+  entry = profile->pdata[1];
+  g_assert_cmpstr (entry->source_tag_name, ==, "tag_a");
+  g_assert_cmpstr (entry->callback_name, ==, "callback_a");
+  g_assert_cmpuint (entry->n_tasks, ==, 1);
+  g_assert_cmpint (dfl_histogram_get_max (entry->phase_histograms[DFL_TASK_PHASE_WORKER_RUN]),
+                   ==, 40);
+
+  g_ptr_array_unref (profile);
+
+  profile = dfl_model_dup_task_profile (model, 1);
+  g_assert_cmpuint (profile->len, ==, 1);
+  entry = profile->pdata[0];
+  g_assert_cmpstr (entry->callback_name, ==, "callback_b");
+  g_ptr_array_unref (profile);
+
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/task/phase-durations", test_task_phase_durations);
+  g_test_add_func ("/task/profile", test_task_profile);
+
+  return g_test_run ();
+}
@@ -288,6 +288,324 @@ test_time_sequence_iter_multiple (void)
     }
 }
 
+/* Test that initialising several iterators at once gives the same results as
+ * initialising them individually, including for runs of elements with the same
+ * timestamp and for start timestamps which are not in order. */
+static void
+test_time_sequence_iter_init_many (void)
+{
+  g_auto (DflTimeSequence) sequence;
+  const DflTimestamp timestamps[] = { 10, 50, 100, 100, 100, 200, 500 };
+  const DflTimestamp starts[] = { 0, 10, 99, 100, 101, 150, 600, 50, 100 };
+  DflTimeSequenceIter iters[G_N_ELEMENTS (starts)];
+  gsize i;
+
+  dfl_time_sequence_init (&sequence, sizeof (guint), NULL, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (timestamps); i++)
+    {
+      guint *data;
+
+      data = dfl_time_sequence_append (&sequence, timestamps[i]);
+      *data = (guint) i;
+    }
+
+  dfl_time_sequence_iter_init_many (iters, &sequence, starts,
+                                    G_N_ELEMENTS (starts));
+
+  for (i = 0; i < G_N_ELEMENTS (starts); i++)
+    {
+      DflTimeSequenceIter iter;
+
+      g_test_message ("i: %" G_GSIZE_FORMAT, i);
+
+      dfl_time_sequence_iter_init (&iter, &sequence, starts[i]);
+      g_assert_true (dfl_time_sequence_iter_equal (&iters[i], &iter));
+    }
+
+  /* The iterators should start at the first of a run of equal timestamps. */
+  g_assert_true (dfl_time_sequence_iter_previous (&iters[4], NULL, NULL));
+  g_assert_cmpuint (dfl_time_sequence_iter_get_timestamp (&iters[4]), ==, 50);
+}
+
+typedef struct
+{
+  DflThreadId thread_id;
+  DflDuration duration;
+} SummaryData;
+
+/* Test that window summaries match the elements in the window, including
+ * windows which span many levels of the summary index. */
+static void
+test_time_sequence_summary (void)
+{
+  g_auto (DflTimeSequence) sequence;
+  const gsize n_elements = 10000;
+  const struct
+    {
+      DflTimestamp start;
+      DflTimestamp end;
+    }
+  windows[] =
+    {
+      { 0, 0 },
+      { 0, 1 },
+      { 1, 2 },
+      { 100, 0 },
+      { 63, 4097 },
+      { 500, 9999 },
+      { 9999, 0 },
+      { 20000, 0 },
+      { 5000, 10 },
+    };
+  DflTimeSequenceSummary summary;
+  gsize i, j;
+
+  dfl_time_sequence_init (&sequence, sizeof (SummaryData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&sequence,
+                                      G_STRUCT_OFFSET (SummaryData, duration),
+                                      G_STRUCT_OFFSET (SummaryData,
+                                                       thread_id));
+
+  /* Empty sequence. */
+  dfl_time_sequence_get_summary (&sequence, 0, 0, &summary);
+  g_assert_cmpuint (summary.n_elements, ==, 0);
+  g_assert_cmpint (summary.min_duration, ==, 0);
+  g_assert_cmpint (summary.max_duration, ==, 0);
+
+  for (i = 0; i < n_elements; i++)
+    {
+      SummaryData *data;
+
+      data = dfl_time_sequence_append (&sequence, i);
+      data->thread_id = (i / 3) % 2;
+      data->duration = (i * 7919) % 1000;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (windows); i++)
+    {
+      DflTimestamp start = windows[i].start, end = windows[i].end;
+      gsize expected_n_elements = 0, expected_n_thread_switches = 0;
+      gsize expected_n_long_elements = 0;
+      DflDuration expected_sum = 0, expected_min = 0, expected_max = 0;
+
+      g_test_message ("Window %" G_GSIZE_FORMAT ": [%" G_GUINT64_FORMAT
+                      ", %" G_GUINT64_FORMAT ")", i, start, end);
+
+      for (j = start; j < n_elements && (end == 0 || j < end); j++)
+        {
+          DflDuration duration = (j * 7919) % 1000;
+
+          if (expected_n_elements == 0)
+            {
+              expected_min = duration;
+              expected_max = duration;
+            }
+          else if ((j / 3) % 2 != ((j - 1) / 3) % 2)
+            {
+              expected_n_thread_switches++;
+            }
+
+          expected_n_elements++;
+          expected_sum += duration;
+          expected_min = MIN (expected_min, duration);
+          expected_max = MAX (expected_max, duration);
+
+          if (duration >= 900)
+            expected_n_long_elements++;
+        }
+
+      dfl_time_sequence_get_summary (&sequence, start, end, &summary);
+
+      g_assert_cmpuint (summary.n_elements, ==, expected_n_elements);
+      g_assert_cmpint (summary.sum_duration, ==, expected_sum);
+      g_assert_cmpint (summary.min_duration, ==, expected_min);
+      g_assert_cmpint (summary.max_duration, ==, expected_max);
+      g_assert_cmpuint (summary.n_thread_switches, ==,
+                        expected_n_thread_switches);
+      g_assert_cmpuint (dfl_time_sequence_get_n_long_elements (&sequence,
+                                                               start, end,
+                                                               900), ==,
+                        expected_n_long_elements);
+    }
+}
+
+/* Test that modifying an element which has already been summarised, and
+ * invalidating it, updates the summaries containing it. */
+static void
+test_time_sequence_summary_invalidate (void)
+{
+  g_auto (DflTimeSequence) sequence;
+  const gsize n_elements = 64 * 64 * 2 + 1;
+  DflTimeSequenceSummary summary;
+  DflTimeSequenceIter iter;
+  SummaryData *data;
+  gsize i;
+
+  dfl_time_sequence_init (&sequence, sizeof (SummaryData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&sequence,
+                                      G_STRUCT_OFFSET (SummaryData, duration),
+                                      G_STRUCT_OFFSET (SummaryData,
+                                                       thread_id));
+
+  for (i = 0; i < n_elements; i++)
+    {
+      data = dfl_time_sequence_append (&sequence, i);
+      data->thread_id = 1;
+      data->duration = 1;
+    }
+
+  /* Build the index. */
+  dfl_time_sequence_get_summary (&sequence, 0, 0, &summary);
+  g_assert_cmpint (summary.sum_duration, ==, n_elements);
+  g_assert_cmpint (summary.max_duration, ==, 1);
+
+  /* Modify an element in the middle of the second level-2 node. */
+  dfl_time_sequence_iter_init (&iter, &sequence, 64 * 64 + 100);
+  g_assert_true (dfl_time_sequence_iter_next (&iter, NULL,
+                                              (gpointer *) &data));
+  data->thread_id = 2;
+  data->duration = 50;
+  dfl_time_sequence_invalidate_summary (&sequence, 64 * 64 + 100);
+
+  dfl_time_sequence_get_summary (&sequence, 0, 0, &summary);
+  g_assert_cmpuint (summary.n_elements, ==, n_elements);
+  g_assert_cmpint (summary.sum_duration, ==, n_elements + 49);
+  g_assert_cmpint (summary.min_duration, ==, 1);
+  g_assert_cmpint (summary.max_duration, ==, 50);
+  g_assert_cmpuint (summary.n_thread_switches, ==, 2);
+
+  dfl_time_sequence_get_summary (&sequence, 64, 64 * 64 * 2, &summary);
+  g_assert_cmpint (summary.sum_duration, ==, 64 * 64 * 2 - 64 + 49);
+  g_assert_cmpuint (dfl_time_sequence_get_n_long_elements (&sequence, 0, 0,
+                                                           50), ==, 1);
+}
+
+static gboolean
+overlapping_cb (DflTimeSequenceIter *iter,
+                gpointer             user_data)
+{
+  GArray *timestamps = user_data;
+  DflTimestamp timestamp = dfl_time_sequence_iter_get_timestamp (iter);
+
+  g_array_append_val (timestamps, timestamp);
+
+  return TRUE;
+}
+
+/* Test that stabbing queries find all the elements whose spans overlap the
+ * window, including long elements which started well before it. */
+static void
+test_time_sequence_overlapping (void)
+{
+  g_auto (DflTimeSequence) sequence;
+  const gsize n_elements = 10000;
+  const struct
+    {
+      DflTimestamp start;
+      DflTimestamp end;
+    }
+  windows[] =
+    {
+      { 0, 0 },
+      { 5, 5 },
+      { 11, 11 },
+      { 1000, 1000 },
+      { 4999, 5005 },
+      { 99990, 200000 },
+    };
+  gsize i, j;
+
+  dfl_time_sequence_init (&sequence, sizeof (SummaryData), NULL, 0);
+  dfl_time_sequence_enable_summaries (&sequence,
+                                      G_STRUCT_OFFSET (SummaryData, duration),
+                                      G_STRUCT_OFFSET (SummaryData,
+                                                       thread_id));
+
+  /* Elements every 10 units, lasting 5 units, apart from every 1000th one,
+   * which lasts for 4000 units. */
+  for (i = 0; i < n_elements; i++)
+    {
+      SummaryData *data;
+
+      data = dfl_time_sequence_append (&sequence, i * 10);
+      data->thread_id = 0;
+      data->duration = (i % 1000 == 0) ? 4000 : 5;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (windows); i++)
+    {
+      DflTimestamp start = windows[i].start, end = windows[i].end;
+      g_autoptr (GArray) timestamps = NULL;
+      gsize n_expected = 0;
+
+      g_test_message ("Window %" G_GSIZE_FORMAT ": [%" G_GUINT64_FORMAT
+                      ", %" G_GUINT64_FORMAT "]", i, start, end);
+
+      timestamps = g_array_new (FALSE, FALSE, sizeof (DflTimestamp));
+      dfl_time_sequence_foreach_overlapping (&sequence, start, end,
+                                             overlapping_cb, timestamps);
+
+      for (j = 0; j < n_elements; j++)
+        {
+          DflTimestamp element_start = j * 10;
+          DflTimestamp element_end = element_start +
+                                     ((j % 1000 == 0) ? 4000 : 5);
+
+          if (element_start > end || element_end < start)
+            continue;
+
+          g_assert_cmpuint (n_expected, <, timestamps->len);
+          g_assert_cmpuint (g_array_index (timestamps, DflTimestamp,
+                                           n_expected), ==, element_start);
+          n_expected++;
+        }
+
+      g_assert_cmpuint (timestamps->len, ==, n_expected);
+    }
+}
+
+/* Test that pointers to elements stay valid as more elements are appended,
+ * and that searching works across many storage blocks, including runs of
+ * equal timestamps which span more than one block. */
+static void
+test_time_sequence_many (void)
+{
+  g_auto (DflTimeSequence) sequence;
+  g_autofree guint **elements = NULL;
+  const gsize n_elements = 100000;
+  gsize i;
+
+  dfl_time_sequence_init (&sequence, sizeof (guint), NULL, 0);
+  elements = g_new (guint *, n_elements);
+
+  for (i = 0; i < n_elements; i++)
+    {
+      /* Ten elements share each timestamp. */
+      elements[i] = dfl_time_sequence_append (&sequence, i / 10);
+      *elements[i] = (guint) i;
+    }
+
+  g_assert_cmpuint (dfl_time_sequence_get_n_elements (&sequence), ==,
+                    n_elements);
+
+  for (i = 0; i < n_elements; i++)
+    g_assert_cmpuint (*elements[i], ==, i);
+
+  for (i = 0; i < n_elements / 10; i += 7)
+    {
+      DflTimeSequenceIter iter;
+      guint *data;
+
+      g_test_message ("i: %" G_GSIZE_FORMAT, i);
+
+      dfl_time_sequence_iter_init (&iter, &sequence, i);
+      g_assert_true (dfl_time_sequence_iter_next (&iter, NULL,
+                                                  (gpointer *) &data));
+      g_assert_true (data == elements[i * 10]);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -303,6 +621,14 @@ main (int argc, char *argv[])
   g_test_add_func ("/time-sequence/multiple", test_time_sequence_multiple);
   g_test_add_func ("/time-sequence/iter/multiple",
                    test_time_sequence_iter_multiple);
+  g_test_add_func ("/time-sequence/many", test_time_sequence_many);
+  g_test_add_func ("/time-sequence/summary", test_time_sequence_summary);
+  g_test_add_func ("/time-sequence/summary/invalidate",
+                   test_time_sequence_summary_invalidate);
+  g_test_add_func ("/time-sequence/overlapping",
+                   test_time_sequence_overlapping);
+  g_test_add_func ("/time-sequence/iter/init-many",
+                   test_time_sequence_iter_init_many);
 
   return g_test_run ();
 }
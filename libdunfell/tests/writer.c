@@ -0,0 +1,212 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <locale.h>
+#include <string.h>
+
+#include "event.h"
+#include "event-sequence.h"
+#include "parser.h"
+#include "writer.h"
+
+
+/* A log containing every parameter type, and repeated strings to exercise
+ * de-duplication in the binary string table. */
+static const gchar *test_log =
+  "Dunfell log,1.0,123\n"
+  "g_main_context_new,124,1,140407983871120\n"
+  "g_source_new,125,1,140407983871200,idle_prepare,idle_check,idle_dispatch,idle_finalize,96\n"
+  "g_source_set_name,126,1,140407983871200,idle source\n"
+  "g_source_attach,127,1,140407983871200,140407983871120,1\n"
+  "g_thread_spawned,128,2,1,2,worker thread\n"
+  "g_source_before_dispatch,129,2,140407983871200,idle_dispatch,idle_cb,0\n"
+  "g_source_after_dispatch,130,2,140407983871200,idle_dispatch,0\n"
+  "nonexistent_event,131,1\n"
+  "g_source_destroy,132,1,140407983871200,140407983871120\n";
+
+static DflEventSequence *
+load_log (const guint8  *data,
+          gsize          length,
+          DflParser    **parser_out)
+{
+  DflParser *parser = NULL;
+  GError *error = NULL;
+
+  parser = dfl_parser_new ();
+  dfl_parser_load_from_data (parser, data, length, &error);
+  g_assert_no_error (error);
+
+  *parser_out = parser;
+
+  return dfl_parser_get_event_sequence (parser);
+}
+
+static GBytes *
+save_log (DflEventSequence *sequence,
+          DflLogFormat      format)
+{
+  DflWriter *writer = NULL;
+  GOutputStream *stream = NULL;
+  GBytes *bytes = NULL;
+  GError *error = NULL;
+
+  writer = dfl_writer_new ();
+  stream = g_memory_output_stream_new_resizable ();
+
+  dfl_writer_save_to_stream (writer, sequence, format, stream, NULL, &error);
+  g_assert_no_error (error);
+
+  g_output_stream_close (stream, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (stream));
+
+  g_object_unref (stream);
+  g_object_unref (writer);
+
+  return bytes;
+}
+
+static void
+assert_sequences_equal (DflEventSequence *sequence1,
+                        DflEventSequence *sequence2)
+{
+  GListModel *model1 = G_LIST_MODEL (sequence1);
+  GListModel *model2 = G_LIST_MODEL (sequence2);
+  guint i, j, n_events;
+
+  g_assert_cmpuint (dfl_event_sequence_get_initial_timestamp (sequence1), ==,
+                    dfl_event_sequence_get_initial_timestamp (sequence2));
+
+  n_events = g_list_model_get_n_items (model1);
+  g_assert_cmpuint (g_list_model_get_n_items (model2), ==, n_events);
+
+  for (i = 0; i < n_events; i++)
+    {
+      DflEvent *event1 = g_list_model_get_item (model1, i);
+      DflEvent *event2 = g_list_model_get_item (model2, i);
+      gchar **parameters1 = NULL, **parameters2 = NULL;
+
+      g_assert_cmpstr (dfl_event_get_event_type (event1), ==,
+                       dfl_event_get_event_type (event2));
+      g_assert_cmpuint (dfl_event_get_timestamp (event1), ==,
+                        dfl_event_get_timestamp (event2));
+      g_assert_cmpuint (dfl_event_get_thread_id (event1), ==,
+                        dfl_event_get_thread_id (event2));
+      g_object_get (event1, "parameters", &parameters1, NULL);
+      g_object_get (event2, "parameters", &parameters2, NULL);
+
+      g_assert_cmpuint (g_strv_length (parameters1), ==,
+                        g_strv_length (parameters2));
+
+      for (j = 0; parameters1[j] != NULL; j++)
+        g_assert_cmpstr (parameters1[j], ==, parameters2[j]);
+
+      g_strfreev (parameters2);
+      g_strfreev (parameters1);
+      g_object_unref (event2);
+      g_object_unref (event1);
+    }
+}
+
+/* Test that a log survives being written out and parsed again in the given
+ * format, with the exception of events of unknown types, which are dropped. */
+static void
+test_writer_round_trip (gconstpointer data)
+{
+  DflLogFormat format = GPOINTER_TO_UINT (data);
+  DflParser *parser1 = NULL, *parser2 = NULL;
+  DflEventSequence *sequence1, *sequence2;
+  GBytes *bytes = NULL;
+
+  sequence1 = load_log ((const guint8 *) test_log, strlen (test_log), &parser1);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (sequence1)), ==,
+                    8);
+
+  bytes = save_log (sequence1, format);
+  sequence2 = load_log (g_bytes_get_data (bytes, NULL),
+                        g_bytes_get_size (bytes), &parser2);
+
+  assert_sequences_equal (sequence1, sequence2);
+
+  g_bytes_unref (bytes);
+  g_object_unref (parser2);
+  g_object_unref (parser1);
+}
+
+/* Test that truncated binary logs are rejected, rather than read past the end
+ * of the buffer. */
+static void
+test_writer_binary_truncated (void)
+{
+  DflParser *parser1 = NULL, *parser2 = NULL;
+  DflEventSequence *sequence;
+  GBytes *bytes = NULL;
+  const guint8 *data;
+  gsize length, truncated_length;
+  GError *error = NULL;
+
+  sequence = load_log ((const guint8 *) test_log, strlen (test_log), &parser1);
+  bytes = save_log (sequence, DFL_LOG_FORMAT_BINARY);
+  data = g_bytes_get_data (bytes, &length);
+
+  /* Start after the 8-byte magic, since anything shorter is not recognised
+   * as a binary log at all. */
+  for (truncated_length = 8; truncated_length < length; truncated_length += 7)
+    {
+      g_test_message ("Truncating to %" G_GSIZE_FORMAT " bytes",
+                      truncated_length);
+
+      parser2 = dfl_parser_new ();
+      dfl_parser_load_from_data (parser2, data, truncated_length, &error);
+
+      /* A log truncated exactly at a block boundary is valid, but misses
+       * some events. */
+      if (error == NULL)
+        g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (dfl_parser_get_event_sequence (parser2))), <,
+                          g_list_model_get_n_items (G_LIST_MODEL (sequence)));
+      else
+        g_assert_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN);
+
+      g_clear_error (&error);
+      g_object_unref (parser2);
+    }
+
+  g_bytes_unref (bytes);
+  g_object_unref (parser1);
+}
+
+int
+main (int argc, char *argv[])
+{
+  setlocale (LC_ALL, "");
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/writer/round-trip/text",
+                        GUINT_TO_POINTER (DFL_LOG_FORMAT_TEXT),
+                        test_writer_round_trip);
+  g_test_add_data_func ("/writer/round-trip/binary",
+                        GUINT_TO_POINTER (DFL_LOG_FORMAT_BINARY),
+                        test_writer_round_trip);
+  g_test_add_func ("/writer/binary-truncated", test_writer_binary_truncated);
+
+  return g_test_run ();
+}
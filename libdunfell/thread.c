@@ -111,30 +111,41 @@ dfl_thread_new (DflThreadId   id,
   return thread;
 }
 
+/* State for the walker in dfl_thread_factory_from_event_sequence(). */
+typedef struct
+{
+  GPtrArray/*<owned DflThread>*/ *threads;  /* owned */
+  GHashTable/*<unowned DflThreadId, unowned DflThread>*/ *threads_by_id;  /* owned */
+} ThreadFactoryData;
+
+static void
+thread_factory_data_free (ThreadFactoryData *data)
+{
+  g_hash_table_unref (data->threads_by_id);
+  g_ptr_array_unref (data->threads);
+  g_free (data);
+}
+
 static void
 event_cb (DflEventSequence *sequence,
           DflEvent         *event,
           gpointer          user_data)
 {
-  GPtrArray/*<owned DflThread>*/ *threads = user_data;
+  ThreadFactoryData *data = user_data;
   DflThread *thread = NULL;
   DflThreadId thread_id;
-  guint i;
   const gchar *name = NULL;
 
   thread_id = dfl_event_get_thread_id (event);
 
   /* Check the ID doesn’t already exist. If it does, update its final
    * timestamp. */
-  for (i = 0; i < threads->len; i++)
-    {
-      DflThread *t = threads->pdata[i];
+  thread = g_hash_table_lookup (data->threads_by_id, &thread_id);
 
-      if (t->id == thread_id)
-        {
-          t->free_timestamp = dfl_event_get_timestamp (event);
-          return;
-        }
+  if (thread != NULL)
+    {
+      thread->free_timestamp = dfl_event_get_timestamp (event);
+      return;
     }
 
   /* We can know the thread’s nickname if it was detected from a
@@ -144,7 +155,10 @@ event_cb (DflEventSequence *sequence,
     name = dfl_event_get_parameter_utf8 (event, 2);
 
   thread = dfl_thread_new (thread_id, dfl_event_get_timestamp (event), name);
-  g_ptr_array_add (threads, thread);  /* transfer */
+  g_ptr_array_add (data->threads, thread);  /* transfer */
+
+  /* The key is owned by the thread, which is kept alive by @threads. */
+  g_hash_table_insert (data->threads_by_id, &thread->id, thread);
 }
 
 /**
@@ -161,11 +175,17 @@ GPtrArray *
 dfl_thread_factory_from_event_sequence (DflEventSequence *sequence)
 {
   GPtrArray/*<owned DflThread>*/ *threads = NULL;
+  ThreadFactoryData *data = NULL;
 
   threads = g_ptr_array_new_with_free_func (g_object_unref);
+
+  data = g_new0 (ThreadFactoryData, 1);
+  data->threads = g_ptr_array_ref (threads);
+  data->threads_by_id = g_hash_table_new (g_int64_hash, g_int64_equal);
+
   dfl_event_sequence_add_walker (sequence, NULL, DFL_ID_INVALID, event_cb,
-                                 g_ptr_array_ref (threads),
-                                 (GDestroyNotify) g_ptr_array_unref);
+                                 data,
+                                 (GDestroyNotify) thread_factory_data_free);
 
   return threads;
 }
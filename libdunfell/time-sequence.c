@@ -31,40 +31,220 @@
 
 #include <errno.h>
 #include <glib.h>
+#include <string.h>
 
 #include "time-sequence.h"
 
 
-typedef struct
-{
-  DflTimestamp timestamp;
-  guint8 data[];
-} DflTimeSequenceElement;
-
 typedef struct
 {
   DflTimeSequence *sequence;
   gsize index;
-  DflTimeSequenceElement *last_returned_element;  /* (nullable) (ownership none) */
+  gsize last_returned_index;  /* LAST_RETURNED_NONE if nothing was returned */
 } DflTimeSequenceIterReal;
 
+#define LAST_RETURNED_NONE G_MAXSIZE
+
 G_STATIC_ASSERT (sizeof (DflTimeSequenceIterReal) ==
                  sizeof (DflTimeSequenceIter));
 
 G_DEFINE_BOXED_TYPE (DflTimeSequenceIter, dfl_time_sequence_iter,
                      dfl_time_sequence_iter_copy, dfl_time_sequence_iter_free)
 
+/* Index of summaries of the elements, built by
+ * dfl_time_sequence_ensure_index(). Level 0 of the index is the elements
+ * themselves; each node in level n ≥ 1 summarises INDEX_FANOUT consecutive
+ * nodes from level n − 1, and is stored in @levels[n − 1]. Only complete runs
+ * of INDEX_FANOUT nodes are summarised, so every level is a little behind the
+ * one below it, but never by more than INDEX_FANOUT − 1 nodes.
+ *
+ * The last element in the sequence is never summarised, as callers commonly
+ * modify it after appending it (for example, to fill in its duration once the
+ * following event is seen). */
+typedef struct
+{
+  gsize duration_offset;  /* in bytes, into each element */
+  gsize thread_id_offset;  /* in bytes, into each element */
+  GPtrArray *levels;  /* (element-type GArray<DflTimeSequenceSummary>) */
+} DflTimeSequenceIndex;
+
+#define INDEX_FANOUT 64
+/* Enough for INDEX_FANOUT^MAX_INDEX_LEVELS > G_MAXSIZE. */
+#define MAX_INDEX_LEVELS 12
+
+/* Elements are stored in a series of blocks, each of which is allocated once
+ * and never moved, so appending never copies existing elements and pointers
+ * to elements stay valid until the sequence is cleared. The first blocks
+ * double in size, starting from FIRST_BLOCK_SIZE elements, so that short
+ * sequences stay small; after that, every block has MAX_BLOCK_SIZE elements.
+ *
+ * Within each block, the timestamps are stored in their own array, separately
+ * from the element data, so that searching for a timestamp only touches the
+ * timestamps, which are packed densely into cache lines. The first timestamp
+ * of each block is also stored in @first_timestamps, so a search can find the
+ * right block without touching any of the others.
+ *
+ * The block table is allocated separately from #DflTimeSequenceReal, so that
+ * the public #DflTimeSequence structure keeps its size. */
+typedef struct
+{
+  gsize n_allocated;
+  guint8 **data;  /* n_allocated of them; NULL if not allocated yet */
+  DflTimestamp *first_timestamps;  /* n_allocated of them */
+} DflTimeSequenceBlocks;
+
 typedef struct
 {
-  gsize element_size;  /* does not include sizeof(DflTimeSequenceElement); in bytes */
+  gsize element_size;  /* in bytes */
   GDestroyNotify element_destroy_notify;
   gsize n_elements_valid;
-  gsize n_elements_allocated;
-  gpointer *elements;  /* actually DflTimeSequenceElement+element_size */
+  DflTimeSequenceBlocks *blocks;  /* owned; NULL until a block is allocated */
+  DflTimeSequenceIndex *index;  /* owned; NULL unless summaries are enabled */
 } DflTimeSequenceReal;
 
 G_STATIC_ASSERT (sizeof (DflTimeSequenceReal) == sizeof (DflTimeSequence));
 
+#define FIRST_BLOCK_SHIFT 4
+#define MAX_BLOCK_SHIFT 12
+#define FIRST_BLOCK_SIZE ((gsize) 1 << FIRST_BLOCK_SHIFT)
+#define MAX_BLOCK_SIZE ((gsize) 1 << MAX_BLOCK_SHIFT)
+/* Number of blocks before the block size stops growing, and the number of
+ * elements they contain in total. */
+#define N_GROWING_BLOCKS (MAX_BLOCK_SHIFT - FIRST_BLOCK_SHIFT)
+#define N_GROWING_BLOCK_ELEMENTS \
+  ((((gsize) 1 << N_GROWING_BLOCKS) - 1) << FIRST_BLOCK_SHIFT)
+
+static inline gsize
+block_get_size (gsize block)
+{
+  if (block < N_GROWING_BLOCKS)
+    return FIRST_BLOCK_SIZE << block;
+  else
+    return MAX_BLOCK_SIZE;
+}
+
+/* Index of the first element in @block. */
+static inline gsize
+block_get_start (gsize block)
+{
+  if (block < N_GROWING_BLOCKS)
+    return (((gsize) 1 << block) - 1) << FIRST_BLOCK_SHIFT;
+  else
+    return (N_GROWING_BLOCK_ELEMENTS +
+            ((block - N_GROWING_BLOCKS) << MAX_BLOCK_SHIFT));
+}
+
+/* Find the block containing the element at @index, and its offset in it. */
+static inline void
+block_locate (gsize  index,
+              gsize *block,
+              gsize *offset)
+{
+  if (index < N_GROWING_BLOCK_ELEMENTS)
+    {
+      gsize i = index + FIRST_BLOCK_SIZE;
+      guint bit = g_bit_storage (i) - 1;
+
+      *block = bit - FIRST_BLOCK_SHIFT;
+      *offset = i - ((gsize) 1 << bit);
+    }
+  else
+    {
+      gsize i = index - N_GROWING_BLOCK_ELEMENTS;
+
+      *block = N_GROWING_BLOCKS + (i >> MAX_BLOCK_SHIFT);
+      *offset = i & (MAX_BLOCK_SIZE - 1);
+    }
+}
+
+/* Each block is a single allocation: block_get_size() timestamps, followed by
+ * the same number of elements. */
+static inline DflTimestamp *
+block_get_timestamps (DflTimeSequenceReal *self,
+                      gsize                block)
+{
+  return (DflTimestamp *) self->blocks->data[block];
+}
+
+static inline guint8 *
+block_get_elements (DflTimeSequenceReal *self,
+                    gsize                block)
+{
+  return (self->blocks->data[block] +
+          block_get_size (block) * sizeof (DflTimestamp));
+}
+
+/* Number of valid elements in @block. */
+static inline gsize
+block_get_n_valid (DflTimeSequenceReal *self,
+                   gsize                block)
+{
+  gsize start = block_get_start (block);
+
+  if (start >= self->n_elements_valid)
+    return 0;
+
+  return MIN (self->n_elements_valid - start, block_get_size (block));
+}
+
+/* Number of blocks containing at least one valid element. */
+static inline gsize
+dfl_time_sequence_get_n_blocks_valid (DflTimeSequenceReal *self)
+{
+  gsize block, offset;
+
+  if (self->n_elements_valid == 0)
+    return 0;
+
+  block_locate (self->n_elements_valid - 1, &block, &offset);
+
+  return block + 1;
+}
+
+/* Ensure the block index has space for at least @n_blocks blocks, and that
+ * they are all allocated. */
+static void
+dfl_time_sequence_ensure_blocks (DflTimeSequenceReal *self,
+                                 gsize                n_blocks)
+{
+  DflTimeSequenceBlocks *blocks;
+  gsize i;
+
+  if (self->blocks == NULL)
+    self->blocks = g_new0 (DflTimeSequenceBlocks, 1);
+
+  blocks = self->blocks;
+
+  if (n_blocks > blocks->n_allocated)
+    {
+      gsize new_n_allocated = MAX (blocks->n_allocated, 4);
+
+      while (new_n_allocated < n_blocks)
+        new_n_allocated *= 2;
+
+      blocks->data = g_renew (guint8 *, blocks->data, new_n_allocated);
+      blocks->first_timestamps = g_renew (DflTimestamp,
+                                          blocks->first_timestamps,
+                                          new_n_allocated);
+
+      for (i = blocks->n_allocated; i < new_n_allocated; i++)
+        {
+          blocks->data[i] = NULL;
+          blocks->first_timestamps[i] = 0;
+        }
+
+      blocks->n_allocated = new_n_allocated;
+    }
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      if (blocks->data[i] == NULL)
+        blocks->data[i] = g_malloc_n (block_get_size (i),
+                                      sizeof (DflTimestamp) +
+                                      self->element_size);
+    }
+}
+
 /**
  * dfl_time_sequence_init:
  * @sequence: an uninitialised #DflTimeSequence
@@ -86,145 +266,173 @@ dfl_time_sequence_init (DflTimeSequence *sequence,
   DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
 
   g_return_if_fail (sequence != NULL);
-  g_return_if_fail (element_size <= G_MAXSIZE - sizeof (DflTimeSequenceElement));
 
   self->element_size = element_size;
   self->element_destroy_notify = element_destroy_notify;
   self->n_elements_valid = 0;
-  self->n_elements_allocated = n_elements_preallocated;
-  self->elements = g_malloc_n (n_elements_preallocated,
-                               sizeof (DflTimeSequenceElement) + element_size);
+  self->blocks = NULL;
+  self->index = NULL;
+
+  if (n_elements_preallocated > 0)
+    {
+      gsize block, offset;
+
+      block_locate (n_elements_preallocated - 1, &block, &offset);
+      dfl_time_sequence_ensure_blocks (self, block + 1);
+    }
 }
 
-static gboolean
-dfl_time_sequence_is_valid_element (DflTimeSequence        *sequence,
-                                    DflTimeSequenceElement *element)
+static inline gpointer
+dfl_time_sequence_index (DflTimeSequence *sequence,
+                         gsize            index)
 {
   DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
-  gsize element_size;  /* size, in bytes, of a single element */
-  gsize elements_length;  /* length, in bytes, of the self->elements allocation */
+  gsize block, offset;
+
+  g_assert (index < self->n_elements_valid);
 
-  element_size = sizeof (DflTimeSequenceElement) + self->element_size;
-  elements_length = self->n_elements_valid * element_size;
+  block_locate (index, &block, &offset);
 
-  return ((guint8 *) element >= (guint8 *) self->elements &&
-          (guint8 *) element < (guint8 *) self->elements + elements_length &&
-          (((guint8 *) element - (guint8 *) self->elements) % element_size) == 0);
+  return block_get_elements (self, block) + offset * self->element_size;
 }
 
-static DflTimeSequenceElement *
-dfl_time_sequence_index (DflTimeSequence *sequence,
-                         gsize            index)
+static inline DflTimestamp
+dfl_time_sequence_index_timestamp (DflTimeSequence *sequence,
+                                   gsize            index)
 {
   DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
-  gpointer element;
+  gsize block, offset;
 
   g_assert (index < self->n_elements_valid);
 
-  element = ((guint8 *) self->elements +
-             index * (sizeof (DflTimeSequenceElement) + self->element_size));
+  block_locate (index, &block, &offset);
 
-  g_return_val_if_fail (dfl_time_sequence_is_valid_element (sequence, element),
-                        NULL);
-  return (DflTimeSequenceElement *) element;
+  return block_get_timestamps (self, block)[offset];
+}
+
+/* Return the index of the first of the @n_timestamps @timestamps which is
+ * > @timestamp, or @n_timestamps if there is none. @timestamps must be sorted.
+ * The loop has no data-dependent branches, so doesn’t suffer from branch
+ * mispredictions, and the compiler can turn the comparison into a
+ * conditional move. */
+static inline gsize
+timestamps_upper_bound (const DflTimestamp *timestamps,
+                        gsize               n_timestamps,
+                        DflTimestamp        timestamp)
+{
+  const DflTimestamp *base = timestamps;
+
+  if (n_timestamps == 0)
+    return 0;
+
+  while (n_timestamps > 1)
+    {
+      gsize half = n_timestamps / 2;
+
+      base = (base[half] <= timestamp) ? base + half : base;
+      n_timestamps -= half;
+    }
+
+  return (base - timestamps) + (*base <= timestamp);
+}
+
+/* Return the index of the first of the @n_timestamps @timestamps which is
+ * ≥ @timestamp, or @n_timestamps if there is none. See
+ * timestamps_upper_bound(). */
+static inline gsize
+timestamps_lower_bound (const DflTimestamp *timestamps,
+                        gsize               n_timestamps,
+                        DflTimestamp        timestamp)
+{
+  const DflTimestamp *base = timestamps;
+
+  if (n_timestamps == 0)
+    return 0;
+
+  while (n_timestamps > 1)
+    {
+      gsize half = n_timestamps / 2;
+
+      base = (base[half] < timestamp) ? base + half : base;
+      n_timestamps -= half;
+    }
+
+  return (base - timestamps) + (*base < timestamp);
 }
 
 /* Find the element with the largest timestamp ≤ @timestamp and return its
  * index in @index. If there are multiple elements with the same timestamp,
  * return the first of them. Return %FALSE if no element with a timestamp ≤
  * @timestamp was found; return %TRUE otherwise. If %FALSE is returned, @index
- * is guaranteed to be set to 0. */
+ * is guaranteed to be set to 0.
+ *
+ * Only elements from the block containing @start_index onwards are searched;
+ * @start_index must be no later than the result. */
 static gboolean
 dfl_time_sequence_find_timestamp (DflTimeSequence *sequence,
                                   DflTimestamp     timestamp,
+                                  gsize            start_index,
                                   gsize           *index)
 {
   DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
-  gsize left_index, right_index, middle;
-  DflTimeSequenceElement *element, *prev_element, *next_element;
-  gsize _index;
-  gboolean valid;
-
-  /* Trivial cases. */
-  if (self->n_elements_valid == 0)
-    {
-      _index = 0;
-      valid = FALSE;
-      goto done;
-    }
+  const DflTimestamp *timestamps;
+  DflTimestamp last_timestamp;
+  gsize n_blocks, start_block, block, offset, end;
 
-  if (timestamp == 0)
-    {
-      _index = 0;
-      valid = TRUE;
-      goto done;
-    }
+  g_assert (start_index <= self->n_elements_valid);
 
-  /* Binary search. */
-  left_index = 0;
-  right_index = self->n_elements_valid - 1;
+  n_blocks = dfl_time_sequence_get_n_blocks_valid (self);
 
-  do
+  if (n_blocks == 0)
     {
-      middle = (left_index + right_index) / 2;  /* truncate */
-      element = dfl_time_sequence_index (sequence, middle);
-
-      if (element->timestamp > timestamp && middle > 0)
-        right_index = middle - 1;
-      else if (element->timestamp < timestamp && middle < G_MAXSIZE)
-        left_index = middle + 1;
-      else
-        break;
+      *index = 0;
+      return FALSE;
     }
-  while (left_index <= right_index);
 
-  /* Work backwards until we find the first of the matching elements. (Multiple
-   * elements can have the same timestamp.) */
-  prev_element = (middle > 0) ? dfl_time_sequence_index (sequence, middle - 1) : NULL;
+  block_locate (MIN (start_index, self->n_elements_valid - 1), &start_block,
+                &offset);
 
-  while (middle > 1 &&
-         (prev_element->timestamp >= timestamp ||
-          prev_element->timestamp == element->timestamp))
-    {
-      middle--;
-      element = prev_element;
-      prev_element = dfl_time_sequence_index (sequence, middle - 1);
-    }
+  /* Find the last block which starts ≤ @timestamp, then the first element
+   * after @timestamp in it. The one before that is the last element
+   * ≤ @timestamp. */
+  block = start_block +
+          timestamps_upper_bound (self->blocks->first_timestamps + start_block,
+                                  n_blocks - start_block, timestamp);
 
-  if (element->timestamp <= timestamp)
+  if (block == start_block)
     {
-      _index = middle;
-      valid = TRUE;
+      g_assert (start_block == 0);
+      *index = 0;
+      return FALSE;
     }
-  else
+
+  block--;
+  timestamps = block_get_timestamps (self, block);
+  end = timestamps_upper_bound (timestamps, block_get_n_valid (self, block),
+                                timestamp);
+  g_assert (end > 0);
+  last_timestamp = timestamps[end - 1];
+
+  /* Find the first element with the same timestamp as that one. The run of
+   * elements with that timestamp may start in an earlier block: find the last
+   * block which starts < @last_timestamp. */
+  block = start_block +
+          timestamps_lower_bound (self->blocks->first_timestamps + start_block,
+                                  block + 1 - start_block, last_timestamp);
+
+  if (block == start_block)
     {
-      _index = 0;
-      valid = FALSE;
+      *index = block_get_start (start_block);
+      return TRUE;
     }
 
-done:
-  element = valid ? dfl_time_sequence_index (sequence, _index) : NULL;
-  prev_element = (_index > 0) ? dfl_time_sequence_index (sequence, _index - 1) : NULL;
-  next_element = (_index + 1 < self->n_elements_valid) ?
-                 dfl_time_sequence_index (sequence, _index + 1) : NULL;
-
-  g_assert (valid || _index == 0);
-  g_assert (_index == 0 || element->timestamp <= timestamp);
-  g_assert (_index == 0 || prev_element->timestamp < timestamp);
-  g_assert (_index == 0 || prev_element->timestamp < element->timestamp);
-  g_assert (_index == 0 || _index + 1 == self->n_elements_valid ||
-            next_element->timestamp > timestamp ||
-            next_element->timestamp == element->timestamp);
-
-  if (valid)
-    g_debug ("%s: timestamp: %" G_GUINT64_FORMAT "; returning index: "
-             "%" G_GSIZE_FORMAT, G_STRFUNC, timestamp, _index);
-  else
-    g_debug ("%s: timestamp: %" G_GUINT64_FORMAT "; failure",
-             G_STRFUNC, timestamp);
+  block--;
+  *index = block_get_start (block) +
+           timestamps_lower_bound (block_get_timestamps (self, block),
+                                   block_get_n_valid (self, block),
+                                   last_timestamp);
 
-  *index = _index;
-  return valid;
+  return TRUE;
 }
 
 /**
@@ -246,18 +454,27 @@ dfl_time_sequence_clear (DflTimeSequence *sequence)
   if (self->element_destroy_notify != NULL)
     {
       for (i = 0; i < self->n_elements_valid; i++)
-        {
-          DflTimeSequenceElement *element;
+        self->element_destroy_notify (dfl_time_sequence_index (sequence, i));
+    }
 
-          element = dfl_time_sequence_index (sequence, i);
-          self->element_destroy_notify (element->data);
-        }
+  if (self->blocks != NULL)
+    {
+      for (i = 0; i < self->blocks->n_allocated; i++)
+        g_free (self->blocks->data[i]);
+
+      g_free (self->blocks->data);
+      g_free (self->blocks->first_timestamps);
+      g_clear_pointer (&self->blocks, g_free);
     }
 
-  g_free (self->elements);
-  self->elements = NULL;
   self->n_elements_valid = 0;
-  self->n_elements_allocated = 0;
+
+  if (self->index != NULL)
+    {
+      g_ptr_array_unref (self->index->levels);
+      g_free (self->index);
+      self->index = NULL;
+    }
 }
 
 /**
@@ -306,11 +523,11 @@ dfl_time_sequence_get_last_element (DflTimeSequence *sequence,
     }
   else
     {
-      DflTimeSequenceElement *element;
-
-      element = dfl_time_sequence_index (sequence, self->n_elements_valid - 1);
-      element_data = element->data;
-      element_timestamp = element->timestamp;
+      element_data = dfl_time_sequence_index (sequence,
+                                              self->n_elements_valid - 1);
+      element_timestamp =
+        dfl_time_sequence_index_timestamp (sequence,
+                                           self->n_elements_valid - 1);
     }
 
   if (timestamp != NULL)
@@ -326,10 +543,8 @@ dfl_time_sequence_get_last_element (DflTimeSequence *sequence,
  *
  * TODO
  *
- * Note that the pointers returned from dfl_time_sequence_append() may change
- * if dfl_time_sequence_append() is called again, due to internal reallocations.
- * The returned pointer is only valid until the next call to
- * dfl_time_sequence_append().
+ * Elements are never moved once they have been appended, so the returned
+ * pointer remains valid until dfl_time_sequence_clear() is called.
  *
  * Returns: (transfer none): TODO
  * Since: 0.1.0
@@ -341,7 +556,7 @@ dfl_time_sequence_append (DflTimeSequence *sequence,
   DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
   DflTimestamp last_timestamp;
   gpointer last_element;
-  DflTimeSequenceElement *element;
+  gsize block, offset;
 
   g_return_val_if_fail (sequence != NULL, NULL);
   g_return_val_if_fail (self->n_elements_valid < G_MAXSIZE, NULL);
@@ -351,25 +566,575 @@ dfl_time_sequence_append (DflTimeSequence *sequence,
   g_return_val_if_fail (last_element == NULL || timestamp >= last_timestamp,
                        NULL);
 
-  /* Do we need to expand the array first? */
-  if (self->n_elements_valid == self->n_elements_allocated)
+  /* Do we need to start a new block first? */
+  block_locate (self->n_elements_valid, &block, &offset);
+
+  if (offset == 0)
     {
-      self->n_elements_allocated =
-        ((gsize) 1 << (g_bit_nth_msf (self->n_elements_allocated, -1) + 1));
-      self->elements = g_realloc_n (self->elements, self->n_elements_allocated,
-                                    sizeof (DflTimeSequenceElement) +
-                                    self->element_size);
+      dfl_time_sequence_ensure_blocks (self, block + 1);
+      self->blocks->first_timestamps[block] = timestamp;
     }
 
-  g_assert (self->n_elements_allocated > self->n_elements_valid);
-
   /* Append the new element. */
+  block_get_timestamps (self, block)[offset] = timestamp;
   self->n_elements_valid++;
 
-  element = dfl_time_sequence_index (sequence, self->n_elements_valid - 1);
-  element->timestamp = timestamp;
+  return block_get_elements (self, block) + offset * self->element_size;
+}
+
+/* Return the index of the first element with a timestamp ≥ @timestamp, or the
+ * number of elements if there is none. */
+static gsize
+dfl_time_sequence_lower_bound (DflTimeSequenceReal *self,
+                               DflTimestamp         timestamp)
+{
+  gsize n_blocks, block;
+
+  n_blocks = dfl_time_sequence_get_n_blocks_valid (self);
+
+  if (n_blocks == 0)
+    return 0;
+
+  /* Find the last block which starts < @timestamp; the element is either in
+   * it or is the first element of the following block. */
+  block = timestamps_lower_bound (self->blocks->first_timestamps, n_blocks,
+                                  timestamp);
+
+  if (block == 0)
+    return 0;
+
+  block--;
+
+  return block_get_start (block) +
+         timestamps_lower_bound (block_get_timestamps (self, block),
+                                 block_get_n_valid (self, block),
+                                 timestamp);
+}
+
+static inline void
+summary_init (DflTimeSequenceSummary *summary)
+{
+  summary->n_elements = 0;
+  summary->sum_duration = 0;
+  summary->min_duration = 0;
+  summary->max_duration = 0;
+  summary->n_thread_switches = 0;
+  summary->first_thread_id = 0;
+  summary->last_thread_id = 0;
+  summary->max_end_timestamp = 0;
+}
+
+/* Update @summary to also summarise @next, which must immediately follow the
+ * elements already summarised by @summary. */
+static inline void
+summary_append (DflTimeSequenceSummary       *summary,
+                const DflTimeSequenceSummary *next)
+{
+  if (next->n_elements == 0)
+    return;
+
+  if (summary->n_elements == 0)
+    {
+      *summary = *next;
+      return;
+    }
 
-  return element->data;
+  summary->n_elements += next->n_elements;
+  summary->sum_duration += next->sum_duration;
+  summary->min_duration = MIN (summary->min_duration, next->min_duration);
+  summary->max_duration = MAX (summary->max_duration, next->max_duration);
+  summary->n_thread_switches += next->n_thread_switches +
+                                ((summary->last_thread_id !=
+                                  next->first_thread_id) ? 1 : 0);
+  summary->last_thread_id = next->last_thread_id;
+  summary->max_end_timestamp = MAX (summary->max_end_timestamp,
+                                    next->max_end_timestamp);
+}
+
+/* Number of nodes in @level of the index. */
+static inline gsize
+index_get_n_nodes (DflTimeSequenceReal *self,
+                   guint                level)
+{
+  if (level == 0)
+    return self->n_elements_valid;
+  else if (level <= self->index->levels->len)
+    return ((GArray *) self->index->levels->pdata[level - 1])->len;
+  else
+    return 0;
+}
+
+/* Get the summary of node @node in @level of the index. */
+static inline void
+index_get_node (DflTimeSequenceReal    *self,
+                guint                   level,
+                gsize                   node,
+                DflTimeSequenceSummary *summary)
+{
+  if (level == 0)
+    {
+      const guint8 *element;
+      DflDuration duration;
+      DflThreadId thread_id;
+
+      element = dfl_time_sequence_index ((DflTimeSequence *) self, node);
+      memcpy (&duration, element + self->index->duration_offset,
+              sizeof (duration));
+      memcpy (&thread_id, element + self->index->thread_id_offset,
+              sizeof (thread_id));
+
+      summary->n_elements = 1;
+      summary->sum_duration = duration;
+      summary->min_duration = duration;
+      summary->max_duration = duration;
+      summary->n_thread_switches = 0;
+      summary->first_thread_id = thread_id;
+      summary->last_thread_id = thread_id;
+
+      /* Elements which haven’t finished yet have a negative duration. */
+      summary->max_end_timestamp =
+        dfl_time_sequence_index_timestamp ((DflTimeSequence *) self, node) +
+        MAX (duration, 0);
+    }
+  else
+    {
+      GArray *nodes = self->index->levels->pdata[level - 1];
+
+      *summary = g_array_index (nodes, DflTimeSequenceSummary, node);
+    }
+}
+
+/* Summarise the INDEX_FANOUT children of node @node in @level ≥ 1 of the
+ * index, which must all exist. */
+static void
+index_summarise_node (DflTimeSequenceReal    *self,
+                      guint                   level,
+                      gsize                   node,
+                      DflTimeSequenceSummary *summary)
+{
+  gsize j;
+
+  summary_init (summary);
+
+  for (j = node * INDEX_FANOUT; j < (node + 1) * INDEX_FANOUT; j++)
+    {
+      DflTimeSequenceSummary child;
+
+      index_get_node (self, level - 1, j, &child);
+      summary_append (summary, &child);
+    }
+}
+
+/* Bring the index up to date with the elements appended since it was last
+ * used. This only ever summarises new nodes, so is amortised O(1) per
+ * element. */
+static void
+dfl_time_sequence_ensure_index (DflTimeSequenceReal *self)
+{
+  gsize n_nodes;
+  guint level;
+
+  /* Don’t summarise the last element, as it may still be modified. */
+  n_nodes = (self->n_elements_valid > 0) ? self->n_elements_valid - 1 : 0;
+
+  for (level = 1; n_nodes >= INDEX_FANOUT; level++)
+    {
+      GArray *nodes;
+      gsize n_parent_nodes, i;
+
+      g_assert (level < MAX_INDEX_LEVELS);
+
+      n_parent_nodes = n_nodes / INDEX_FANOUT;
+
+      if (level > self->index->levels->len)
+        g_ptr_array_add (self->index->levels,
+                         g_array_new (FALSE, FALSE,
+                                      sizeof (DflTimeSequenceSummary)));
+
+      nodes = self->index->levels->pdata[level - 1];
+
+      for (i = nodes->len; i < n_parent_nodes; i++)
+        {
+          DflTimeSequenceSummary summary;
+
+          index_summarise_node (self, level, i, &summary);
+          g_array_append_val (nodes, summary);
+        }
+
+      n_nodes = n_parent_nodes;
+    }
+}
+
+typedef struct
+{
+  guint level;
+  gsize start;
+  gsize end;  /* exclusive */
+} IndexRange;
+
+/* Split the elements [@start, @end) into a sequence of ranges of index nodes
+ * which exactly cover them, using as few nodes as possible. At most
+ * 2 × INDEX_FANOUT nodes are used from each level. The ranges are returned in
+ * element order in @ranges, and the number of them is returned. */
+static guint
+dfl_time_sequence_split_range (DflTimeSequenceReal *self,
+                               gsize                start,
+                               gsize                end,
+                               IndexRange           ranges[2 * MAX_INDEX_LEVELS + 1])
+{
+  IndexRange right_ranges[MAX_INDEX_LEVELS];
+  guint n_ranges = 0, n_right_ranges = 0, level, i;
+
+  dfl_time_sequence_ensure_index (self);
+
+  for (level = 0; start < end; level++)
+    {
+      gsize parent_start, parent_end;
+
+      g_assert (level < MAX_INDEX_LEVELS);
+
+      /* Which nodes on this level are covered by complete parent nodes? */
+      parent_start = (start + INDEX_FANOUT - 1) / INDEX_FANOUT * INDEX_FANOUT;
+      parent_end = MIN (end / INDEX_FANOUT,
+                        index_get_n_nodes (self, level + 1)) * INDEX_FANOUT;
+
+      if (parent_start >= parent_end)
+        {
+          ranges[n_ranges++] = (IndexRange) { level, start, end };
+          break;
+        }
+
+      if (start < parent_start)
+        ranges[n_ranges++] = (IndexRange) { level, start, parent_start };
+      if (parent_end < end)
+        right_ranges[n_right_ranges++] = (IndexRange) { level, parent_end, end };
+
+      start = parent_start / INDEX_FANOUT;
+      end = parent_end / INDEX_FANOUT;
+    }
+
+  for (i = n_right_ranges; i > 0; i--)
+    ranges[n_ranges++] = right_ranges[i - 1];
+
+  return n_ranges;
+}
+
+/**
+ * dfl_time_sequence_enable_summaries:
+ * @sequence: a #DflTimeSequence
+ * @duration_offset: offset of a #DflDuration in each element, in bytes
+ * @thread_id_offset: offset of a #DflThreadId in each element, in bytes
+ *
+ * Enable dfl_time_sequence_get_summary() and
+ * dfl_time_sequence_get_n_long_elements() for this sequence, which summarise
+ * the #DflDuration and #DflThreadId at the given offsets in each element. For
+ * example, pass `G_STRUCT_OFFSET (DflSourceDispatchData, duration)`.
+ *
+ * The summaries are stored in an index of aggregates over increasingly large
+ * blocks of elements, which is built lazily, the first time it is needed after
+ * elements are appended. Summary queries therefore take logarithmic time in the
+ * number of elements, but the sequence must not be queried from multiple
+ * threads at once. The last element may be modified freely, but if the
+ * duration or thread ID of any other element is modified after it was
+ * appended, dfl_time_sequence_invalidate_summary() must be called for it.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_time_sequence_enable_summaries (DflTimeSequence *sequence,
+                                    gsize            duration_offset,
+                                    gsize            thread_id_offset)
+{
+  DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
+
+  g_return_if_fail (sequence != NULL);
+  g_return_if_fail (self->index == NULL);
+  g_return_if_fail (duration_offset + sizeof (DflDuration) <=
+                    self->element_size);
+  g_return_if_fail (thread_id_offset + sizeof (DflThreadId) <=
+                    self->element_size);
+
+  self->index = g_new0 (DflTimeSequenceIndex, 1);
+  self->index->duration_offset = duration_offset;
+  self->index->thread_id_offset = thread_id_offset;
+  self->index->levels = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+}
+
+/**
+ * dfl_time_sequence_invalidate_summary:
+ * @sequence: a #DflTimeSequence
+ * @index: index of the modified element
+ *
+ * Update the summaries of the element at @index after its duration or thread
+ * ID has been modified, so later calls to dfl_time_sequence_get_summary() and
+ * similar include the new values. Only the index nodes containing the element
+ * are recalculated, so this takes logarithmic time in the number of elements.
+ * dfl_time_sequence_enable_summaries() must have been called on the sequence
+ * first.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_time_sequence_invalidate_summary (DflTimeSequence *sequence,
+                                      gsize            index)
+{
+  DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
+  gsize node;
+  guint level;
+
+  g_return_if_fail (sequence != NULL);
+  g_return_if_fail (self->index != NULL);
+  g_return_if_fail (index < self->n_elements_valid);
+
+  node = index;
+
+  for (level = 1; level <= self->index->levels->len; level++)
+    {
+      GArray *nodes = self->index->levels->pdata[level - 1];
+
+      node /= INDEX_FANOUT;
+
+      /* Nodes which haven’t been summarised yet will pick up the change when
+       * they are. */
+      if (node >= nodes->len)
+        break;
+
+      index_summarise_node (self, level, node,
+                            &g_array_index (nodes, DflTimeSequenceSummary,
+                                            node));
+    }
+}
+
+/* Convert the window [@start, @end) to a range of element indices. */
+static void
+dfl_time_sequence_get_window (DflTimeSequenceReal *self,
+                              DflTimestamp         start,
+                              DflTimestamp         end,
+                              gsize               *start_index,
+                              gsize               *end_index)
+{
+  *start_index = (start == 0) ? 0 : dfl_time_sequence_lower_bound (self, start);
+  *end_index = (end == 0) ? self->n_elements_valid :
+                            dfl_time_sequence_lower_bound (self, end);
+  *end_index = MAX (*start_index, *end_index);
+}
+
+/**
+ * dfl_time_sequence_get_summary:
+ * @sequence: a #DflTimeSequence
+ * @start: timestamp to start the window at (inclusive), or 0
+ * @end: timestamp to end the window at (exclusive), or 0 to include all
+ *    elements from @start onwards
+ * @summary: (out caller-allocates): return location for the summary
+ *
+ * Summarise the durations and thread IDs of the elements with timestamps in
+ * the window [@start, @end). dfl_time_sequence_enable_summaries() must have
+ * been called on the sequence first.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_time_sequence_get_summary (DflTimeSequence        *sequence,
+                               DflTimestamp            start,
+                               DflTimestamp            end,
+                               DflTimeSequenceSummary *summary)
+{
+  DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
+  IndexRange ranges[2 * MAX_INDEX_LEVELS + 1];
+  gsize start_index, end_index, j;
+  guint n_ranges, i;
+
+  g_return_if_fail (sequence != NULL);
+  g_return_if_fail (self->index != NULL);
+  g_return_if_fail (summary != NULL);
+
+  summary_init (summary);
+
+  dfl_time_sequence_get_window (self, start, end, &start_index, &end_index);
+  n_ranges = dfl_time_sequence_split_range (self, start_index, end_index,
+                                            ranges);
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      for (j = ranges[i].start; j < ranges[i].end; j++)
+        {
+          DflTimeSequenceSummary node;
+
+          index_get_node (self, ranges[i].level, j, &node);
+          summary_append (summary, &node);
+        }
+    }
+}
+
+/* Count the elements summarised by @node in @level of the index which have a
+ * duration ≥ @min_duration. Only descend into the nodes whose durations
+ * straddle @min_duration. */
+static gsize
+index_count_long_elements (DflTimeSequenceReal *self,
+                           guint                level,
+                           gsize                node,
+                           DflDuration          min_duration)
+{
+  DflTimeSequenceSummary summary;
+  gsize count, i;
+
+  index_get_node (self, level, node, &summary);
+
+  if (summary.min_duration >= min_duration)
+    return summary.n_elements;
+  else if (summary.max_duration < min_duration)
+    return 0;
+
+  g_assert (level > 0);
+  count = 0;
+
+  for (i = node * INDEX_FANOUT; i < (node + 1) * INDEX_FANOUT; i++)
+    count += index_count_long_elements (self, level - 1, i, min_duration);
+
+  return count;
+}
+
+/**
+ * dfl_time_sequence_get_n_long_elements:
+ * @sequence: a #DflTimeSequence
+ * @start: timestamp to start the window at (inclusive), or 0
+ * @end: timestamp to end the window at (exclusive), or 0 to include all
+ *    elements from @start onwards
+ * @min_duration: minimum duration to count (inclusive)
+ *
+ * Count the elements with timestamps in the window [@start, @end) whose
+ * durations are equal to or greater than @min_duration.
+ * dfl_time_sequence_enable_summaries() must have been called on the sequence
+ * first.
+ *
+ * Returns: number of elements in the window with a duration of at least
+ *    @min_duration
+ * Since: UNRELEASED
+ */
+gsize
+dfl_time_sequence_get_n_long_elements (DflTimeSequence *sequence,
+                                       DflTimestamp     start,
+                                       DflTimestamp     end,
+                                       DflDuration      min_duration)
+{
+  DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
+  IndexRange ranges[2 * MAX_INDEX_LEVELS + 1];
+  gsize start_index, end_index, j, count;
+  guint n_ranges, i;
+
+  g_return_val_if_fail (sequence != NULL, 0);
+  g_return_val_if_fail (self->index != NULL, 0);
+
+  dfl_time_sequence_get_window (self, start, end, &start_index, &end_index);
+  n_ranges = dfl_time_sequence_split_range (self, start_index, end_index,
+                                            ranges);
+  count = 0;
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      for (j = ranges[i].start; j < ranges[i].end; j++)
+        count += index_count_long_elements (self, ranges[i].level, j,
+                                            min_duration);
+    }
+
+  return count;
+}
+
+/* Call @func on each element summarised by @node in @level of the index which
+ * ends at or after @start, in order. Only descend into the nodes which contain
+ * at least one such element. Return %FALSE if @func asked to stop. */
+static gboolean
+index_foreach_overlapping (DflTimeSequenceReal        *self,
+                           guint                       level,
+                           gsize                       node,
+                           DflTimestamp                start,
+                           DflTimeSequenceOverlapFunc  func,
+                           gpointer                    user_data)
+{
+  DflTimeSequenceSummary summary;
+  gsize i;
+
+  index_get_node (self, level, node, &summary);
+
+  if (summary.max_end_timestamp < start)
+    return TRUE;
+
+  if (level == 0)
+    {
+      DflTimeSequenceIterReal iter;
+
+      iter.sequence = (DflTimeSequence *) self;
+      iter.index = node + 1;
+      iter.last_returned_index = node;
+
+      return func ((DflTimeSequenceIter *) &iter, user_data);
+    }
+
+  for (i = node * INDEX_FANOUT; i < (node + 1) * INDEX_FANOUT; i++)
+    {
+      if (!index_foreach_overlapping (self, level - 1, i, start, func,
+                                      user_data))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * dfl_time_sequence_foreach_overlapping:
+ * @sequence: a #DflTimeSequence
+ * @start: timestamp to start the window at (inclusive)
+ * @end: timestamp to end the window at (inclusive)
+ * @func: function to call on each element which overlaps the window
+ * @user_data: user data to pass to @func
+ *
+ * Call @func on each element whose span overlaps the window [@start, @end], in
+ * timestamp order, until @func returns %FALSE. The span of an element runs from
+ * its timestamp to its timestamp plus its duration, inclusive; elements with a
+ * negative duration (which haven’t finished yet) have zero-length spans. Pass
+ * the same timestamp as @start and @end to find the elements which were
+ * in progress at that time.
+ *
+ * dfl_time_sequence_enable_summaries() must have been called on the sequence
+ * first. The summary index stores the latest end timestamp of each group of
+ * elements, so groups which end before @start can be skipped, and only
+ * O(log n + k) elements are examined, where k is the number of elements
+ * returned.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_time_sequence_foreach_overlapping (DflTimeSequence            *sequence,
+                                       DflTimestamp                start,
+                                       DflTimestamp                end,
+                                       DflTimeSequenceOverlapFunc  func,
+                                       gpointer                    user_data)
+{
+  DflTimeSequenceReal *self = (DflTimeSequenceReal *) sequence;
+  IndexRange ranges[2 * MAX_INDEX_LEVELS + 1];
+  gsize end_index, j;
+  guint n_ranges, i;
+
+  g_return_if_fail (sequence != NULL);
+  g_return_if_fail (self->index != NULL);
+  g_return_if_fail (start <= end);
+  g_return_if_fail (func != NULL);
+
+  /* Only elements which start at or before @end can overlap the window. */
+  end_index = (end == G_MAXUINT64) ? self->n_elements_valid :
+                                     dfl_time_sequence_lower_bound (self,
+                                                                    end + 1);
+  n_ranges = dfl_time_sequence_split_range (self, 0, end_index, ranges);
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      for (j = ranges[i].start; j < ranges[i].end; j++)
+        {
+          if (!index_foreach_overlapping (self, ranges[i].level, j, start,
+                                          func, user_data))
+            return;
+        }
+    }
 }
 
 static gboolean
@@ -381,9 +1146,8 @@ dfl_time_sequence_iter_is_valid (DflTimeSequenceIter *iter)
   return (self != NULL &&
           self->sequence != NULL &&
           self->index <= sequence->n_elements_valid &&
-          (self->last_returned_element == NULL ||
-           dfl_time_sequence_is_valid_element (self->sequence,
-                                               self->last_returned_element)));
+          (self->last_returned_index == LAST_RETURNED_NONE ||
+           self->last_returned_index < sequence->n_elements_valid));
 }
 
 /**
@@ -407,8 +1171,55 @@ dfl_time_sequence_iter_init (DflTimeSequenceIter *iter,
   g_return_if_fail (sequence != NULL);
 
   self->sequence = sequence;
-  self->last_returned_element = NULL;
-  dfl_time_sequence_find_timestamp (sequence, start, &self->index);
+  self->last_returned_index = LAST_RETURNED_NONE;
+  dfl_time_sequence_find_timestamp (sequence, start, 0, &self->index);
+}
+
+/**
+ * dfl_time_sequence_iter_init_many:
+ * @iters: (array length=n_iters): array of uninitialised #DflTimeSequenceIters
+ * @sequence: the #DflTimeSequence to iterate over
+ * @starts: (array length=n_iters): timestamps to start each iterator from
+ * @n_iters: number of elements in @iters and @starts
+ *
+ * Initialise each of the @iters as if by calling dfl_time_sequence_iter_init()
+ * with the corresponding timestamp from @starts. This is faster than calling
+ * dfl_time_sequence_iter_init() for each of them if the @starts are in
+ * ascending order, as each search starts from the result of the previous one.
+ * This is useful for finding the elements at many positions in a viewport at
+ * once, such as one per row of pixels.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_time_sequence_iter_init_many (DflTimeSequenceIter *iters,
+                                  DflTimeSequence     *sequence,
+                                  const DflTimestamp  *starts,
+                                  gsize                n_iters)
+{
+  gsize i, search_start;
+
+  g_return_if_fail (n_iters == 0 || iters != NULL);
+  g_return_if_fail (sequence != NULL);
+  g_return_if_fail (n_iters == 0 || starts != NULL);
+
+  search_start = 0;
+
+  for (i = 0; i < n_iters; i++)
+    {
+      DflTimeSequenceIterReal *iter = (DflTimeSequenceIterReal *) &iters[i];
+
+      /* If the starts go backwards, search from the beginning again. */
+      if (i > 0 && starts[i] < starts[i - 1])
+        search_start = 0;
+
+      iter->sequence = sequence;
+      iter->last_returned_index = LAST_RETURNED_NONE;
+      dfl_time_sequence_find_timestamp (sequence, starts[i], search_start,
+                                        &iter->index);
+
+      search_start = iter->index;
+    }
 }
 
 /**
@@ -429,7 +1240,6 @@ dfl_time_sequence_iter_next (DflTimeSequenceIter *iter,
 {
   DflTimeSequenceIterReal *self = (DflTimeSequenceIterReal *) iter;
   DflTimeSequenceReal *sequence;
-  DflTimeSequenceElement *element;
 
   g_return_val_if_fail (dfl_time_sequence_iter_is_valid (iter), FALSE);
 
@@ -438,18 +1248,18 @@ dfl_time_sequence_iter_next (DflTimeSequenceIter *iter,
   /* Reached the end? */
   if (self->index >= sequence->n_elements_valid)
     {
-      self->last_returned_element = NULL;
+      self->last_returned_index = LAST_RETURNED_NONE;
       return FALSE;
     }
 
   /* Return the next element. */
-  element = dfl_time_sequence_index (self->sequence, self->index);
-  self->last_returned_element = element;
+  self->last_returned_index = self->index;
 
   if (timestamp != NULL)
-    *timestamp = element->timestamp;
+    *timestamp = dfl_time_sequence_index_timestamp (self->sequence,
+                                                    self->index);
   if (data != NULL)
-    *data = element->data;
+    *data = dfl_time_sequence_index (self->sequence, self->index);
 
   self->index++;
 
@@ -473,26 +1283,25 @@ dfl_time_sequence_iter_previous (DflTimeSequenceIter *iter,
                                  gpointer            *data)
 {
   DflTimeSequenceIterReal *self = (DflTimeSequenceIterReal *) iter;
-  DflTimeSequenceElement *element;
 
   g_return_val_if_fail (dfl_time_sequence_iter_is_valid (iter), FALSE);
 
   /* Reached the end? */
   if (self->index == 0)
     {
-      self->last_returned_element = NULL;
+      self->last_returned_index = LAST_RETURNED_NONE;
       return FALSE;
     }
 
   /* Return the previous element. */
   self->index--;
-  element = dfl_time_sequence_index (self->sequence, self->index);
-  self->last_returned_element = element;
+  self->last_returned_index = self->index;
 
   if (timestamp != NULL)
-    *timestamp = element->timestamp;
+    *timestamp = dfl_time_sequence_index_timestamp (self->sequence,
+                                                    self->index);
   if (data != NULL)
-    *data = element->data;
+    *data = dfl_time_sequence_index (self->sequence, self->index);
 
   return TRUE;
 }
@@ -521,7 +1330,7 @@ dfl_time_sequence_iter_copy (DflTimeSequenceIter *iter)
 
   new_iter_real->sequence = iter_real->sequence;
   new_iter_real->index = iter_real->index;
-  new_iter_real->last_returned_element = iter_real->last_returned_element;
+  new_iter_real->last_returned_index = iter_real->last_returned_index;
 
   return g_steal_pointer (&new_iter);
 }
@@ -591,10 +1400,11 @@ dfl_time_sequence_iter_get_timestamp (DflTimeSequenceIter *iter)
 
   g_return_val_if_fail (dfl_time_sequence_iter_is_valid (iter), 0);
 
-  if (self->last_returned_element == NULL)
+  if (self->last_returned_index == LAST_RETURNED_NONE)
     return 0;
 
-  return self->last_returned_element->timestamp;
+  return dfl_time_sequence_index_timestamp (self->sequence,
+                                            self->last_returned_index);
 }
 
 /**
@@ -615,8 +1425,8 @@ dfl_time_sequence_iter_get_data (DflTimeSequenceIter *iter)
 
   g_return_val_if_fail (dfl_time_sequence_iter_is_valid (iter), NULL);
 
-  if (self->last_returned_element == NULL)
+  if (self->last_returned_index == LAST_RETURNED_NONE)
     return NULL;
 
-  return self->last_returned_element->data;
+  return dfl_time_sequence_index (self->sequence, self->last_returned_index);
 }
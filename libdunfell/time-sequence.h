@@ -67,11 +67,82 @@ typedef struct
   gpointer dummy[3];
 } DflTimeSequenceIter;
 
+/**
+ * DflTimeSequenceSummary:
+ * @n_elements: number of elements summarised
+ * @sum_duration: sum of the durations of the elements
+ * @min_duration: smallest duration of any of the elements, or 0 if there are
+ *    none
+ * @max_duration: largest duration of any of the elements, or 0 if there are
+ *    none
+ * @n_thread_switches: number of times the thread ID changes between
+ *    consecutive elements
+ * @first_thread_id: thread ID of the first element, or 0 if there are none
+ * @last_thread_id: thread ID of the last element, or 0 if there are none
+ * @max_end_timestamp: largest end timestamp (timestamp plus duration) of any
+ *    of the elements, or 0 if there are none
+ *
+ * Aggregate statistics about a range of elements in a #DflTimeSequence, as
+ * returned by dfl_time_sequence_get_summary().
+ *
+ * Since: UNRELEASED
+ */
+typedef struct
+{
+  gsize n_elements;
+  DflDuration sum_duration;
+  DflDuration min_duration;
+  DflDuration max_duration;
+  gsize n_thread_switches;
+  DflThreadId first_thread_id;
+  DflThreadId last_thread_id;
+  DflTimestamp max_end_timestamp;
+} DflTimeSequenceSummary;
+
+/**
+ * DflTimeSequenceOverlapFunc:
+ * @iter: iterator pointing at the element, as if it had just been returned by
+ *    dfl_time_sequence_iter_next()
+ * @user_data: user data passed to dfl_time_sequence_foreach_overlapping()
+ *
+ * Callback for each element found by dfl_time_sequence_foreach_overlapping().
+ * @iter is only valid for the duration of the call; use
+ * dfl_time_sequence_iter_copy() to keep it.
+ *
+ * Returns: %TRUE to continue to the next element; %FALSE to stop
+ * Since: UNRELEASED
+ */
+typedef gboolean (*DflTimeSequenceOverlapFunc) (DflTimeSequenceIter *iter,
+                                                gpointer             user_data);
+
+void  dfl_time_sequence_enable_summaries    (DflTimeSequence            *sequence,
+                                             gsize                       duration_offset,
+                                             gsize                       thread_id_offset);
+void  dfl_time_sequence_invalidate_summary  (DflTimeSequence            *sequence,
+                                             gsize                       index);
+void  dfl_time_sequence_get_summary         (DflTimeSequence            *sequence,
+                                             DflTimestamp                start,
+                                             DflTimestamp                end,
+                                             DflTimeSequenceSummary     *summary);
+gsize dfl_time_sequence_get_n_long_elements (DflTimeSequence            *sequence,
+                                             DflTimestamp                start,
+                                             DflTimestamp                end,
+                                             DflDuration                 min_duration);
+void  dfl_time_sequence_foreach_overlapping (DflTimeSequence            *sequence,
+                                             DflTimestamp                start,
+                                             DflTimestamp                end,
+                                             DflTimeSequenceOverlapFunc  func,
+                                             gpointer                    user_data);
+
 GType dfl_time_sequence_iter_get_type (void);
 
 void     dfl_time_sequence_iter_init (DflTimeSequenceIter *iter,
                                       DflTimeSequence     *sequence,
                                       DflTimestamp         start);
+void     dfl_time_sequence_iter_init_many (DflTimeSequenceIter *iters,
+                                           DflTimeSequence     *sequence,
+                                           const DflTimestamp  *starts,
+                                           gsize                n_iters);
 gboolean dfl_time_sequence_iter_next (DflTimeSequenceIter *iter,
                                       DflTimestamp        *timestamp,
                                       gpointer            *data);
@@ -0,0 +1,514 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:writer
+ * @short_description: Dunfell log file writer
+ * @stability: Unstable
+ * @include: libdunfell/writer.h
+ *
+ * #DflWriter serialises a #DflEventSequence to a log file, in any of the
+ * formats which #DflParser can read (see #DflLogFormat). This can be used to
+ * convert between formats.
+ *
+ * Events whose types are not known to libdunfell are not written, as the
+ * parser would ignore them anyway.
+ *
+ * Since: UNRELEASED
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <string.h>
+
+#include "binary-log-private.h"
+#include "event.h"
+#include "event-private.h"
+#include "event-sequence.h"
+#include "event-sequence-private.h"
+#include "writer.h"
+
+
+/* Size of the buffer to accumulate output in before writing it to the
+ * stream. */
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+struct _DflWriter
+{
+  GObject parent;
+};
+
+G_DEFINE_TYPE (DflWriter, dfl_writer, G_TYPE_OBJECT)
+
+static void
+dfl_writer_class_init (DflWriterClass *klass)
+{
+  dfl_event_type_table_ensure ();
+}
+
+static void
+dfl_writer_init (DflWriter *self)
+{
+  /* Nothing to see here. */
+}
+
+/**
+ * dfl_writer_new:
+ *
+ * Create a new #DflWriter.
+ *
+ * Returns: (transfer full): a new #DflWriter
+ * Since: UNRELEASED
+ */
+DflWriter *
+dfl_writer_new (void)
+{
+  return g_object_new (DFL_TYPE_WRITER, NULL);
+}
+
+/* Write out the contents of @buffer if it has reached @threshold bytes, and
+ * clear it. */
+static gboolean
+flush_buffer (GString        *buffer,
+              gsize           threshold,
+              GOutputStream  *stream,
+              GCancellable   *cancellable,
+              GError        **error)
+{
+  if (buffer->len < threshold || buffer->len == 0)
+    return TRUE;
+
+  if (!g_output_stream_write_all (stream, buffer->str, buffer->len, NULL,
+                                  cancellable, error))
+    return FALSE;
+
+  g_string_truncate (buffer, 0);
+
+  return TRUE;
+}
+
+/* Get the schema for the type of @event, or %NULL if it’s not known, or if the
+ * event’s parameters don’t match it (which is only possible for events
+ * constructed with dfl_event_new()). */
+static const DflEventTypeData *
+event_get_type_data (DflEvent *event)
+{
+  const DflEventTypeData *event_data;
+  guint n_parameters;
+
+  event_data = dfl_event_type_get_data (dfl_event_get_event_type_enum (event));
+  dfl_event_get_parameters (event, &n_parameters);
+
+  if (event_data == NULL || n_parameters != event_data->n_parameters)
+    return NULL;
+
+  return event_data;
+}
+
+static void
+append_text_parameter (GString                 *buffer,
+                       const DflEventParameter *parameter)
+{
+  switch (parameter->type)
+    {
+    case DFL_PARAMETER_TYPE_ID:
+      g_string_append_printf (buffer, "%" G_GUINT64_FORMAT,
+                              parameter->value.id);
+      break;
+    case DFL_PARAMETER_TYPE_INT64:
+      g_string_append_printf (buffer, "%" G_GINT64_FORMAT,
+                              parameter->value.int64);
+      break;
+    case DFL_PARAMETER_TYPE_STRING:
+    case DFL_PARAMETER_TYPE_BYTES:
+      g_string_append (buffer, parameter->value.string);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+save_text (DflEventSequence  *sequence,
+           GOutputStream     *stream,
+           GCancellable      *cancellable,
+           GError           **error)
+{
+  const DflEventStore *events;
+  DflEvent *event = NULL;
+  GString *buffer = NULL;
+  guint i, j, n_events;
+  gboolean success = TRUE;
+
+  /* Load each event into the same #DflEvent wrapper, rather than creating a
+   * new one for each event using g_list_model_get_item(). */
+  events = dfl_event_sequence_get_store (sequence);
+  event = g_object_new (DFL_TYPE_EVENT, NULL);
+  buffer = g_string_sized_new (WRITE_BUFFER_SIZE);
+
+  g_string_append_printf (buffer, "Dunfell log,1.0,%" G_GUINT64_FORMAT "\n",
+                          dfl_event_sequence_get_initial_timestamp (sequence));
+
+  for (i = 0, n_events = dfl_event_store_get_n_events (events);
+       i < n_events && success; i++)
+    {
+      const DflEventTypeData *event_data;
+      const DflEventParameter *parameters;
+      guint n_parameters;
+
+      dfl_event_store_load_event (events, i, event);
+      event_data = event_get_type_data (event);
+      if (event_data == NULL)
+        continue;
+
+      parameters = dfl_event_get_parameters (event, &n_parameters);
+
+      g_string_append_printf (buffer,
+                              "%s,%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT,
+                              event_data->name,
+                              dfl_event_get_timestamp (event),
+                              dfl_event_get_thread_id (event));
+
+      for (j = 0; j < n_parameters; j++)
+        {
+          g_string_append_c (buffer, ',');
+          append_text_parameter (buffer, &parameters[j]);
+        }
+
+      g_string_append_c (buffer, '\n');
+
+      success = flush_buffer (buffer, WRITE_BUFFER_SIZE, stream, cancellable,
+                              error);
+    }
+
+  if (success)
+    success = flush_buffer (buffer, 0, stream, cancellable, error);
+
+  g_string_free (buffer, TRUE);
+  g_object_unref (event);
+
+  return success;
+}
+
+static void
+append_block_header (GString            *buffer,
+                     DflBinaryBlockType  block_type,
+                     guint32             n_entries,
+                     guint64             length)
+{
+  DflBinaryBlockHeader header;
+
+  header.block_type = GUINT32_TO_LE (block_type);
+  header.n_entries = GUINT32_TO_LE (n_entries);
+  header.length = GUINT64_TO_LE (length);
+
+  g_string_append_len (buffer, (const gchar *) &header, sizeof (header));
+}
+
+/* Look up the slot in @string_indices for @str, which must be interned in the
+ * string table of @events. */
+static guint *
+lookup_string_index (const DflEventStore *events,
+                     GArray              *string_indices,
+                     const gchar         *str)
+{
+  guint table_index;
+  gboolean found;
+
+  found = dfl_string_table_lookup_index (events->strings, str, &table_index);
+  g_assert (found && table_index < string_indices->len);
+
+  return &g_array_index (string_indices, guint, table_index);
+}
+
+static gboolean
+save_binary (DflEventSequence  *sequence,
+             GOutputStream     *stream,
+             GCancellable      *cancellable,
+             GError           **error)
+{
+  const DflEventStore *events;
+  DflEvent *event = NULL;
+  GString *buffer = NULL;
+  GString *block = NULL;
+  GArray/*<guint>*/ *string_indices = NULL;
+  GPtrArray/*<unowned utf8>*/ *strings = NULL;
+  DflBinaryLogHeader header;
+  guint i, j, n_events, n_block_records;
+  gsize strings_length;
+  gboolean success = TRUE;
+
+  /* As with save_text(), reuse a single #DflEvent wrapper. */
+  events = dfl_event_sequence_get_store (sequence);
+  event = g_object_new (DFL_TYPE_EVENT, NULL);
+  n_events = dfl_event_store_get_n_events (events);
+
+  /* Build the string table first, de-duplicating the strings using the
+   * store’s string table, which they are all interned in. Only the strings
+   * used by string parameters are written, as the store’s table may also
+   * contain parameters which couldn’t be decoded, which aren’t valid UTF-8.
+   * @string_indices maps an index in the store’s table to one in the log’s. */
+  string_indices = g_array_new (FALSE, FALSE, sizeof (guint));
+  g_array_set_size (string_indices,
+                    dfl_string_table_get_n_strings (events->strings));
+  memset (string_indices->data, 0xff, string_indices->len * sizeof (guint));
+  strings = g_ptr_array_new ();
+  strings_length = 0;
+
+  for (i = 0; i < n_events; i++)
+    {
+      const DflEventTypeData *event_data;
+      const DflEventParameter *parameters;
+      guint n_parameters;
+
+      dfl_event_store_load_event (events, i, event);
+      event_data = event_get_type_data (event);
+      if (event_data == NULL)
+        continue;
+
+      parameters = dfl_event_get_parameters (event, &n_parameters);
+
+      for (j = 0; j < n_parameters; j++)
+        {
+          const gchar *str;
+          guint *string_index;
+
+          /* Parameters whose schema type is string are always stored as
+           * interned strings. */
+          if (event_data->parameter_types[j] != DFL_PARAMETER_TYPE_STRING)
+            continue;
+
+          str = parameters[j].value.string;
+          string_index = lookup_string_index (events, string_indices, str);
+
+          if (*string_index == G_MAXUINT)
+            {
+              *string_index = strings->len;
+              g_ptr_array_add (strings, (gpointer) str);
+              strings_length += sizeof (guint32) + strlen (str);
+            }
+        }
+    }
+
+  buffer = g_string_sized_new (WRITE_BUFFER_SIZE);
+
+  /* Header. */
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, DFL_BINARY_LOG_MAGIC, DFL_BINARY_LOG_MAGIC_LENGTH);
+  header.version_major = GUINT16_TO_LE (DFL_BINARY_LOG_VERSION_MAJOR);
+  header.version_minor = GUINT16_TO_LE (DFL_BINARY_LOG_VERSION_MINOR);
+  header.initial_timestamp = GUINT64_TO_LE (dfl_event_sequence_get_initial_timestamp (sequence));
+
+  g_string_append_len (buffer, (const gchar *) &header, sizeof (header));
+
+  /* String table. */
+  append_block_header (buffer, DFL_BINARY_BLOCK_STRINGS, strings->len,
+                       strings_length);
+
+  for (i = 0; i < strings->len && success; i++)
+    {
+      const gchar *str = strings->pdata[i];
+      guint32 length = strlen (str);
+      guint32 length_le = GUINT32_TO_LE (length);
+
+      g_string_append_len (buffer, (const gchar *) &length_le,
+                           sizeof (length_le));
+      g_string_append_len (buffer, str, length);
+
+      success = flush_buffer (buffer, WRITE_BUFFER_SIZE, stream, cancellable,
+                              error);
+    }
+
+  /* Events, in blocks of up to %DFL_BINARY_LOG_BLOCK_SIZE records. */
+  block = g_string_sized_new (DFL_BINARY_LOG_BLOCK_SIZE *
+                              sizeof (DflBinaryEventRecord));
+  n_block_records = 0;
+
+  for (i = 0; i < n_events && success; i++)
+    {
+      const DflEventTypeData *event_data;
+      const DflEventParameter *parameters;
+      guint n_parameters;
+      DflBinaryEventRecord record;
+
+      dfl_event_store_load_event (events, i, event);
+      event_data = event_get_type_data (event);
+
+      if (event_data != NULL)
+        {
+          parameters = dfl_event_get_parameters (event, &n_parameters);
+
+          memset (&record, 0, sizeof (record));
+          record.event_type = GUINT16_TO_LE (dfl_event_get_event_type_enum (event));
+          record.n_parameters = GUINT16_TO_LE (event_data->n_parameters);
+          record.timestamp = GUINT64_TO_LE (dfl_event_get_timestamp (event));
+          record.thread_id = GUINT64_TO_LE (dfl_event_get_thread_id (event));
+
+          for (j = 0; j < event_data->n_parameters; j++)
+            {
+              guint64 parameter;
+
+              switch ((DflParameterType) event_data->parameter_types[j])
+                {
+                case DFL_PARAMETER_TYPE_ID:
+                  parameter = dfl_event_get_parameter_id (event, j);
+                  break;
+                case DFL_PARAMETER_TYPE_INT64:
+                  parameter = (guint64) dfl_event_get_parameter_int64 (event, j);
+                  break;
+                case DFL_PARAMETER_TYPE_STRING:
+                  parameter = *lookup_string_index (events, string_indices,
+                                                    parameters[j].value.string);
+                  break;
+                case DFL_PARAMETER_TYPE_BYTES:
+                default:
+                  g_assert_not_reached ();
+                }
+
+              record.parameters[j] = GUINT64_TO_LE (parameter);
+            }
+
+          g_string_append_len (block, (const gchar *) &record, sizeof (record));
+          n_block_records++;
+        }
+
+      /* Finish the block if it’s full, or if this is the last event. */
+      if (n_block_records == DFL_BINARY_LOG_BLOCK_SIZE ||
+          (i == n_events - 1 && n_block_records > 0))
+        {
+          append_block_header (buffer, DFL_BINARY_BLOCK_EVENTS,
+                               n_block_records, block->len);
+          g_string_append_len (buffer, block->str, block->len);
+
+          g_string_truncate (block, 0);
+          n_block_records = 0;
+
+          success = flush_buffer (buffer, WRITE_BUFFER_SIZE, stream,
+                                  cancellable, error);
+        }
+    }
+
+  if (success)
+    success = flush_buffer (buffer, 0, stream, cancellable, error);
+
+  g_string_free (block, TRUE);
+  g_string_free (buffer, TRUE);
+  g_ptr_array_unref (strings);
+  g_array_unref (string_indices);
+  g_object_unref (event);
+
+  return success;
+}
+
+/**
+ * dfl_writer_save_to_stream:
+ * @self: a #DflWriter
+ * @sequence: event sequence to save
+ * @format: format to save the log in
+ * @stream: output stream to write the log to
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Write all the events in @sequence to @stream as a log in the given @format.
+ * @stream is not closed afterwards.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_writer_save_to_stream (DflWriter         *self,
+                           DflEventSequence  *sequence,
+                           DflLogFormat       format,
+                           GOutputStream     *stream,
+                           GCancellable      *cancellable,
+                           GError           **error)
+{
+  g_return_if_fail (DFL_IS_WRITER (self));
+  g_return_if_fail (DFL_IS_EVENT_SEQUENCE (sequence));
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  switch (format)
+    {
+    case DFL_LOG_FORMAT_TEXT:
+      save_text (sequence, stream, cancellable, error);
+      break;
+    case DFL_LOG_FORMAT_BINARY:
+      save_binary (sequence, stream, cancellable, error);
+      break;
+    default:
+      g_return_if_reached ();
+    }
+}
+
+/**
+ * dfl_writer_save_to_file:
+ * @self: a #DflWriter
+ * @sequence: event sequence to save
+ * @format: format to save the log in
+ * @filename: path to the file to write the log to
+ * @error: return location for a #GError, or %NULL
+ *
+ * Write all the events in @sequence to the file at @filename as a log in the
+ * given @format. Any existing file is replaced.
+ *
+ * Since: UNRELEASED
+ */
+void
+dfl_writer_save_to_file (DflWriter         *self,
+                         DflEventSequence  *sequence,
+                         DflLogFormat       format,
+                         const gchar       *filename,
+                         GError           **error)
+{
+  GFile *file = NULL;
+  GFileOutputStream *stream = NULL;
+  GError *child_error = NULL;
+
+  g_return_if_fail (DFL_IS_WRITER (self));
+  g_return_if_fail (DFL_IS_EVENT_SEQUENCE (sequence));
+  g_return_if_fail (filename != NULL);
+  g_return_if_fail (error == NULL || *error == NULL);
+
+  file = g_file_new_for_path (filename);
+  stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL,
+                           &child_error);
+  g_object_unref (file);
+
+  if (stream == NULL)
+    {
+      g_propagate_error (error, child_error);
+      return;
+    }
+
+  dfl_writer_save_to_stream (self, sequence, format, G_OUTPUT_STREAM (stream),
+                             NULL, &child_error);
+
+  /* Always close the stream, but don’t overwrite the first error. */
+  if (child_error == NULL)
+    g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &child_error);
+  else
+    g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, NULL);
+
+  if (child_error != NULL)
+    g_propagate_error (error, child_error);
+
+  g_object_unref (stream);
+}
@@ -0,0 +1,74 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_WRITER_H
+#define DFL_WRITER_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "event-sequence.h"
+
+G_BEGIN_DECLS
+
+/**
+ * DflLogFormat:
+ * @DFL_LOG_FORMAT_TEXT: Comma-separated text log format, version 1.0, as
+ *    output by `dunfell-record`.
+ * @DFL_LOG_FORMAT_BINARY: Binary log format, version 2.0, which is smaller
+ *    and faster to parse.
+ *
+ * Formats which a #DflWriter can write logs in. #DflParser can read all of
+ * them, detecting the format automatically.
+ *
+ * Since: UNRELEASED
+ */
+typedef enum
+{
+  DFL_LOG_FORMAT_TEXT,
+  DFL_LOG_FORMAT_BINARY,
+} DflLogFormat;
+
+/**
+ * DflWriter:
+ *
+ * All the fields in this structure are private.
+ *
+ * Since: UNRELEASED
+ */
+#define DFL_TYPE_WRITER dfl_writer_get_type ()
+G_DECLARE_FINAL_TYPE (DflWriter, dfl_writer, DFL, WRITER, GObject)
+
+DflWriter *dfl_writer_new (void);
+
+void dfl_writer_save_to_stream (DflWriter         *self,
+                                DflEventSequence  *sequence,
+                                DflLogFormat       format,
+                                GOutputStream     *stream,
+                                GCancellable      *cancellable,
+                                GError           **error);
+void dfl_writer_save_to_file   (DflWriter         *self,
+                                DflEventSequence  *sequence,
+                                DflLogFormat       format,
+                                const gchar       *filename,
+                                GError           **error);
+
+G_END_DECLS
+
+#endif /* !DFL_WRITER_H */
@@ -0,0 +1,48 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DFL_ZSTD_DECOMPRESSOR_PRIVATE_H
+#define DFL_ZSTD_DECOMPRESSOR_PRIVATE_H
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#ifdef HAVE_ZSTD
+
+/*
+ * DflZstdDecompressor:
+ *
+ * A #GConverter which decompresses a stream of one or more zstd frames, for
+ * use with #GConverterInputStream. Frames are decompressed in a streaming
+ * fashion, so the decompressed sizes recorded in their headers are never used
+ * to allocate memory.
+ */
+#define DFL_TYPE_ZSTD_DECOMPRESSOR dfl_zstd_decompressor_get_type ()
+G_DECLARE_FINAL_TYPE (DflZstdDecompressor, dfl_zstd_decompressor, DFL,
+                      ZSTD_DECOMPRESSOR, GObject)
+
+DflZstdDecompressor *dfl_zstd_decompressor_new (void);
+
+#endif  /* HAVE_ZSTD */
+
+G_END_DECLS
+
+#endif /* !DFL_ZSTD_DECOMPRESSOR_PRIVATE_H */
@@ -0,0 +1,183 @@
+/* vim:set et sw=2 cin cino=t0,f0,(0,{s,>2s,n-s,^-s,e2s: */
+/*
+ * Copyright © Philip Withnall 2016 <philip@tecnocode.co.uk>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib-object.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "zstd-decompressor-private.h"
+
+
+#ifdef HAVE_ZSTD
+
+static void dfl_zstd_decompressor_converter_init (GConverterIface *iface);
+static void dfl_zstd_decompressor_finalize (GObject *object);
+static GConverterResult dfl_zstd_decompressor_convert (GConverter       *converter,
+                                                       const void       *inbuf,
+                                                       gsize             inbuf_size,
+                                                       void             *outbuf,
+                                                       gsize             outbuf_size,
+                                                       GConverterFlags   flags,
+                                                       gsize            *bytes_read,
+                                                       gsize            *bytes_written,
+                                                       GError          **error);
+static void dfl_zstd_decompressor_reset (GConverter *converter);
+
+struct _DflZstdDecompressor
+{
+  GObject parent;
+
+  ZSTD_DStream *stream;  /* owned */
+
+  /* Whether the last frame seen has been completely decompressed and flushed,
+   * so the input may end here. */
+  gboolean frame_finished;
+};
+
+G_DEFINE_TYPE_WITH_CODE (DflZstdDecompressor, dfl_zstd_decompressor,
+                         G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
+                                                dfl_zstd_decompressor_converter_init))
+
+static void
+dfl_zstd_decompressor_class_init (DflZstdDecompressorClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = dfl_zstd_decompressor_finalize;
+}
+
+static void
+dfl_zstd_decompressor_converter_init (GConverterIface *iface)
+{
+  iface->convert = dfl_zstd_decompressor_convert;
+  iface->reset = dfl_zstd_decompressor_reset;
+}
+
+static void
+dfl_zstd_decompressor_init (DflZstdDecompressor *self)
+{
+  /* The default maximum window size limits the memory a frame can make the
+   * decompressor allocate, whatever its header claims. */
+  self->stream = ZSTD_createDStream ();
+  ZSTD_initDStream (self->stream);
+  self->frame_finished = FALSE;
+}
+
+static void
+dfl_zstd_decompressor_finalize (GObject *object)
+{
+  DflZstdDecompressor *self = DFL_ZSTD_DECOMPRESSOR (object);
+
+  ZSTD_freeDStream (self->stream);
+
+  /* Chain up to the parent class */
+  G_OBJECT_CLASS (dfl_zstd_decompressor_parent_class)->finalize (object);
+}
+
+static void
+set_zstd_error (GError      **error,
+                const gchar  *message)
+{
+  /* TODO: Use a proper error code here. */
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_UNKNOWN,
+               "Invalid zstd-compressed log — %s", message);
+}
+
+static GConverterResult
+dfl_zstd_decompressor_convert (GConverter       *converter,
+                               const void       *inbuf,
+                               gsize             inbuf_size,
+                               void             *outbuf,
+                               gsize             outbuf_size,
+                               GConverterFlags   flags,
+                               gsize            *bytes_read,
+                               gsize            *bytes_written,
+                               GError          **error)
+{
+  DflZstdDecompressor *self = DFL_ZSTD_DECOMPRESSOR (converter);
+  ZSTD_inBuffer input = { inbuf, inbuf_size, 0 };
+  ZSTD_outBuffer output = { outbuf, outbuf_size, 0 };
+  gsize ret;
+
+  ret = ZSTD_decompressStream (self->stream, &output, &input);
+
+  if (ZSTD_isError (ret))
+    {
+      set_zstd_error (error, ZSTD_getErrorName (ret));
+      return G_CONVERTER_ERROR;
+    }
+
+  *bytes_read = input.pos;
+  *bytes_written = output.pos;
+
+  /* A return value of zero means a frame has been completely decompressed
+   * and flushed. Another frame may follow it. */
+  if (input.pos > 0 || output.pos > 0)
+    self->frame_finished = (ret == 0);
+
+  if ((flags & G_CONVERTER_INPUT_AT_END) && input.pos == input.size)
+    {
+      if (self->frame_finished)
+        return G_CONVERTER_FINISHED;
+
+      if (output.pos == 0)
+        {
+          set_zstd_error (error, "truncated frame");
+          return G_CONVERTER_ERROR;
+        }
+    }
+  else if (input.pos == 0 && output.pos == 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                           "Need more input");
+      return G_CONVERTER_ERROR;
+    }
+
+  return G_CONVERTER_CONVERTED;
+}
+
+static void
+dfl_zstd_decompressor_reset (GConverter *converter)
+{
+  DflZstdDecompressor *self = DFL_ZSTD_DECOMPRESSOR (converter);
+
+  ZSTD_initDStream (self->stream);
+  self->frame_finished = FALSE;
+}
+
+/*
+ * dfl_zstd_decompressor_new:
+ *
+ * Create a new #DflZstdDecompressor.
+ *
+ * Returns: (transfer full): a new #DflZstdDecompressor
+ */
+DflZstdDecompressor *
+dfl_zstd_decompressor_new (void)
+{
+  return g_object_new (DFL_TYPE_ZSTD_DECOMPRESSOR, NULL);
+}
+
+#endif  /* HAVE_ZSTD */
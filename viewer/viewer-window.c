@@ -81,6 +81,11 @@ static void number_renderer_cb (GtkTreeViewColumn *tree_column,
                                 GtkTreeModel      *tree_model,
                                 GtkTreeIter       *iter,
                                 gpointer           user_data);
+static void optional_number_renderer_cb (GtkTreeViewColumn *tree_column,
+                                         GtkCellRenderer   *cell,
+                                         GtkTreeModel      *tree_model,
+                                         GtkTreeIter       *iter,
+                                         gpointer           user_data);
 static void empty_string_renderer_cb (GtkTreeViewColumn *tree_column,
                                       GtkCellRenderer   *cell,
                                       GtkTreeModel      *tree_model,
@@ -120,6 +125,8 @@ struct _DfvViewerWindow
   GtkCellRenderer *sources_median_dispatch_duration_renderer;
   GtkTreeViewColumn *sources_max_dispatch_duration_column;
   GtkCellRenderer *sources_max_dispatch_duration_renderer;
+  GtkTreeViewColumn *sources_handoff_latency_column;
+  GtkCellRenderer *sources_handoff_latency_renderer;
 
   /* Tasks tree view. */
   GtkTreeView *tasks_tree_view;
@@ -129,6 +136,12 @@ struct _DfvViewerWindow
   GtkCellRenderer *tasks_run_duration_renderer;
   GtkTreeViewColumn *tasks_thread_run_duration_column;
   GtkCellRenderer *tasks_thread_run_duration_renderer;
+  GtkTreeViewColumn *tasks_queue_wait_duration_column;
+  GtkCellRenderer *tasks_queue_wait_duration_renderer;
+  GtkTreeViewColumn *tasks_return_handoff_duration_column;
+  GtkCellRenderer *tasks_return_handoff_duration_renderer;
+  GtkTreeViewColumn *tasks_callback_delivery_duration_column;
+  GtkCellRenderer *tasks_callback_delivery_duration_renderer;
   GtkTreeViewColumn *tasks_thread_name_column;
   GtkCellRenderer *tasks_thread_name_renderer;
 };
@@ -190,6 +203,10 @@ dfv_viewer_window_class_init (DfvViewerWindowClass *klass)
                                         sources_max_dispatch_duration_column);
   gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
                                         sources_max_dispatch_duration_renderer);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        sources_handoff_latency_column);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        sources_handoff_latency_renderer);
 
   gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
                                         tasks_tree_view);
@@ -205,6 +222,18 @@ dfv_viewer_window_class_init (DfvViewerWindowClass *klass)
                                         tasks_thread_run_duration_column);
   gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
                                         tasks_thread_run_duration_renderer);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_queue_wait_duration_column);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_queue_wait_duration_renderer);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_return_handoff_duration_column);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_return_handoff_duration_renderer);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_callback_delivery_duration_column);
+  gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
+                                        tasks_callback_delivery_duration_renderer);
   gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
                                         tasks_thread_name_column);
   gtk_widget_class_bind_template_child (widget_class, DfvViewerWindow,
@@ -307,6 +336,11 @@ dfv_viewer_window_init (DfvViewerWindow *self)
                                            number_renderer_cb,
                                            GINT_TO_POINTER (15)  /* column index */,
                                            NULL);
+  gtk_tree_view_column_set_cell_data_func (self->sources_handoff_latency_column,
+                                           self->sources_handoff_latency_renderer,
+                                           optional_number_renderer_cb,
+                                           GINT_TO_POINTER (16)  /* column index */,
+                                           NULL);
 
   /* Set up the tasks tree view. */
   gtk_tree_view_column_set_cell_data_func (self->tasks_address_column,
@@ -324,6 +358,21 @@ dfv_viewer_window_init (DfvViewerWindow *self)
                                            number_renderer_cb,
                                            GINT_TO_POINTER (19),  /* column index */
                                            NULL);
+  gtk_tree_view_column_set_cell_data_func (self->tasks_queue_wait_duration_column,
+                                           self->tasks_queue_wait_duration_renderer,
+                                           optional_number_renderer_cb,
+                                           GINT_TO_POINTER (20),  /* column index */
+                                           NULL);
+  gtk_tree_view_column_set_cell_data_func (self->tasks_return_handoff_duration_column,
+                                           self->tasks_return_handoff_duration_renderer,
+                                           optional_number_renderer_cb,
+                                           GINT_TO_POINTER (21),  /* column index */
+                                           NULL);
+  gtk_tree_view_column_set_cell_data_func (self->tasks_callback_delivery_duration_column,
+                                           self->tasks_callback_delivery_duration_renderer,
+                                           optional_number_renderer_cb,
+                                           GINT_TO_POINTER (22),  /* column index */
+                                           NULL);
 
   empty_string_data = g_new0 (EmptyStringRendererData, 1);
   empty_string_data->text = _("Task not threaded");
@@ -445,6 +494,35 @@ number_renderer_cb (GtkTreeViewColumn *tree_column,
                 NULL);
 }
 
+/* Like number_renderer_cb(), but render negative values (which indicate that
+ * the value is not applicable) as empty cells. */
+static void
+optional_number_renderer_cb (GtkTreeViewColumn *tree_column,
+                             GtkCellRenderer   *cell,
+                             GtkTreeModel      *tree_model,
+                             GtkTreeIter       *iter,
+                             gpointer           user_data)
+{
+  g_auto (GValue) value = G_VALUE_INIT, int64_value = G_VALUE_INIT;
+  gint column_index;
+
+  g_assert (GTK_IS_CELL_RENDERER_TEXT (cell));
+
+  column_index = GPOINTER_TO_INT (user_data);
+
+  gtk_tree_model_get_value (tree_model, iter, column_index, &value);
+
+  g_value_init (&int64_value, G_TYPE_INT64);
+  g_assert (g_value_transform (&value, &int64_value));
+
+  if (g_value_get_int64 (&int64_value) < 0)
+    g_object_set (G_OBJECT (cell),
+                  "text", "",
+                  NULL);
+  else
+    number_renderer_cb (tree_column, cell, tree_model, iter, user_data);
+}
+
 static void
 empty_string_renderer_cb (GtkTreeViewColumn *tree_column,
                           GtkCellRenderer   *cell,
@@ -808,6 +886,7 @@ set_file_cb2 (GObject      *source_object,
   DflEventSequence *sequence;
   g_autoptr (DflModel) model = NULL;
   g_autoptr (DwlSourceModel) source_model = NULL;
+  g_autoptr (GtkTreeModel) sorted_source_model = NULL;
   g_autoptr (DwlTaskModel) task_model = NULL;
   g_autoptr (GPtrArray) sources = NULL;  /* (element-type DflSource) */
   g_autoptr (GPtrArray) tasks = NULL;  /* (element-type DflTask) */
@@ -851,8 +930,8 @@ set_file_cb2 (GObject      *source_object,
 
   sources = dfl_model_dup_sources (model);
   source_model = dwl_source_model_new (sources);
-  gtk_tree_view_set_model (self->sources_tree_view,
-                           GTK_TREE_MODEL (source_model));
+  sorted_source_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (source_model));
+  gtk_tree_view_set_model (self->sources_tree_view, sorted_source_model);
 
   tasks = dfl_model_dup_tasks (model);
   task_model = dwl_task_model_new (tasks);